@@ -0,0 +1,75 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef COMMON_ATOI_H
+#define COMMON_ATOI_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Conversion of strings of decimal digits to unsigned integers.
+//
+// Parsing a number one digit at a time requires a multiplication per
+// digit, each of which depends on the result of the previous one. The
+// functions below convert eight digits at once by loading them into a
+// single 64-bit word. Adjacent digits are combined into pairs, pairs
+// into groups of four and groups of four into a group of eight, using
+// three multiplications that operate on all digits in parallel.
+//
+// These functions are the counterpart of the ones in <common/itoa.h>.
+
+// Loads eight characters into a word, placing the first character in
+// the least significant byte.
+static inline uint64_t atoi_load8(const char *s) {
+  uint64_t word;
+  memcpy(&word, s, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif
+  return word;
+}
+
+// Converts a word containing eight decimal digits to its value.
+static inline uint32_t atoi10_eight(uint64_t word) {
+  word -= 0x3030303030303030;
+  word = word * 10 + (word >> 8);
+  return ((word & 0x000000ff000000ff) * (100 + (UINT64_C(1000000) << 32)) +
+          ((word >> 16) & 0x000000ff000000ff) *
+              (1 + (UINT64_C(10000) << 32))) >>
+         32;
+}
+
+// Converts a string of up to 19 decimal digits.
+static inline uint64_t atoi10(const char *digits, size_t ndigits) {
+  uint64_t value = 0;
+  while (ndigits >= 8) {
+    value = value * 100000000 + atoi10_eight(atoi_load8(digits));
+    digits += 8;
+    ndigits -= 8;
+  }
+  while (ndigits > 0) {
+    value = value * 10 + (*digits++ - '0');
+    --ndigits;
+  }
+  return value;
+}
+
+// Converts up to eight decimal digits at the start of a string,
+// appending them to an existing value. Returns the number of digits
+// consumed. Characters are inspected one by one before loading them,
+// so that no bytes past the end of the string are read. The digits are
+// only converted once their number is known.
+static inline size_t atoi10_append8(const char *s, uintmax_t *value) {
+  static const uint32_t powers[] = {1,      10,      100,      1000,
+                                    10000,  100000,  1000000,  10000000,
+                                    100000000};
+  size_t ndigits = 0;
+  while (ndigits < 8 && s[ndigits] >= '0' && s[ndigits] <= '9')
+    ++ndigits;
+  *value = *value * powers[ndigits] + atoi10(s, ndigits);
+  return ndigits;
+}
+
+#endif
@@ -0,0 +1,62 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/atoi.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "gtest/gtest.h"
+
+TEST(atoi, eight) {
+  ASSERT_EQ(0, atoi10_eight(atoi_load8("00000000")));
+  ASSERT_EQ(1, atoi10_eight(atoi_load8("00000001")));
+  ASSERT_EQ(10000000, atoi10_eight(atoi_load8("10000000")));
+  ASSERT_EQ(12345678, atoi10_eight(atoi_load8("12345678")));
+  ASSERT_EQ(87654321, atoi10_eight(atoi_load8("87654321")));
+  ASSERT_EQ(99999999, atoi10_eight(atoi_load8("99999999")));
+}
+
+TEST(atoi, append8) {
+  uintmax_t value = 42;
+  ASSERT_EQ(0, atoi10_append8("", &value));
+  ASSERT_EQ(42, value);
+  ASSERT_EQ(0, atoi10_append8("x1234567", &value));
+  ASSERT_EQ(42, value);
+  ASSERT_EQ(3, atoi10_append8("123/5678", &value));
+  ASSERT_EQ(42123, value);
+  ASSERT_EQ(7, atoi10_append8("1234567:", &value));
+  ASSERT_EQ(421231234567, value);
+
+  value = 0;
+  ASSERT_EQ(8, atoi10_append8("12345678", &value));
+  ASSERT_EQ(12345678, value);
+  ASSERT_EQ(8, atoi10_append8("024681357", &value));
+  ASSERT_EQ(1234567802468135, value);
+}
+
+TEST(atoi, atoi10) {
+  ASSERT_EQ(0, atoi10("", 0));
+  ASSERT_EQ(7, atoi10("7", 1));
+  ASSERT_EQ(1234567, atoi10("1234567", 7));
+  ASSERT_EQ(123456789, atoi10("123456789", 9));
+  ASSERT_EQ(1234567890123456, atoi10("1234567890123456", 16));
+  ASSERT_EQ(UINT64_C(9999999999999999999), atoi10("9999999999999999999", 19));
+
+  // Only the provided number of digits should be converted.
+  ASSERT_EQ(12345, atoi10("123456789", 5));
+}
+
+TEST(atoi, random) {
+  for (int i = 0; i < 10000; ++i) {
+    uint64_t expected;
+    arc4random_buf(&expected, sizeof(expected));
+    expected %= UINT64_C(10000000000000000000);
+    char buf[20];
+    int length = snprintf(buf, sizeof(buf), "%ju", (uintmax_t)expected);
+    SCOPED_TRACE(buf);
+    ASSERT_EQ(expected, atoi10(buf, length));
+  }
+}
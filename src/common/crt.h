@@ -48,12 +48,18 @@ extern size_t __pt_tls_align;           // Alignment of TLS data.
 noreturn void _start(const cloudabi_auxv_t *);
 
 // Multi-threading: pthread_t handle and thread ID.
+struct pthread_stacks {
+  void *safe_stack;         // Safe stack buffer.
+  size_t safe_stacksize;    // Size of the safe stack buffer.
+  void *unsafe_stack;       // Unsafe stack buffer.
+  size_t unsafe_stacksize;  // Size of the unsafe stack buffer.
+  size_t guardsize;         // Size of the guard below both buffers.
+};
+
 struct __pthread {
   _Atomic(cloudabi_lock_t) join;  // Join queue used by pthread_join().
   void *return_value;             // Value returned by pthread_join().
-  void *safe_stack;               // Safe stack buffer used by this thread.
-  void *unsafe_stack;             // Unsafe stack buffer used by this thread.
-  size_t unsafe_stacksize;        // Size of the unsafe stack buffer.
+  struct pthread_stacks stacks;   // Stack buffers used by this thread.
   refcount_t refcount;            // Thread handle and stack reference count.
 
   void *(*start_routine)(void *);  // User-supplied startup routine.
@@ -5,16 +5,29 @@
 #ifndef COMMON_FLOAT10_H
 #define COMMON_FLOAT10_H
 
+#include <stdbool.h>
 #include <stddef.h>
 
 // Handling of base-10 floating point numbers. These functions are
-// wrappers around the double-conversion library.
+// wrappers around the double-conversion library, except for
+// __f10dec_double(), which converts doubles to their exact decimal
+// representation. It may return up to F10DEC_DOUBLE_DIG digits.
+//
+// __f10enc_fast_*() convert numbers having at most 19 significant
+// digits without using the double-conversion library. They return
+// false for numbers that they cannot convert.
+
+#define F10DEC_DOUBLE_DIG 767
 
 __BEGIN_DECLS
 float __f10enc_get_float(const char *, size_t, int);
 double __f10enc_get_double(const char *, size_t, int);
 long double __f10enc_get_long_double(const char *, size_t, int);
+bool __f10enc_fast_float(const char *, size_t, int, float *);
+bool __f10enc_fast_double(const char *, size_t, int, double *);
 void __f10dec(long double, unsigned int, unsigned char *, size_t *, int *, int);
+void __f10dec_double(double, unsigned int, unsigned char *, size_t *, int *,
+                     int);
 __END_DECLS
 
 #endif
@@ -0,0 +1,169 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef COMMON_ITOA_H
+#define COMMON_ITOA_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Conversion of unsigned integers to strings of digits.
+//
+// Functions like printf() and inet_ntop() spend a considerable amount
+// of time converting integers to strings. Doing this one digit at a
+// time requires a division per digit, which is expensive, especially
+// when using 64-bit values on 32-bit systems. The functions below
+// convert decimal numbers two digits at a time using a lookup table
+// and only perform 64-bit divisions to split off groups of eight
+// digits. Hexadecimal and octal numbers are converted using shifts.
+//
+// The itoa*() functions write the digits backwards, ending right
+// before the provided pointer, and return a pointer to the first
+// digit. This allows callers to use a buffer that is large enough to
+// hold the largest value, without computing the length up front:
+//
+//   char buf[20];
+//   char *digits = itoa10(buf + sizeof(buf), value);
+//   fwrite(digits, 1, buf + sizeof(buf) - digits, stdout);
+//
+// The *_append() functions write the digits at the start of the buffer
+// instead, returning a pointer right after the last digit. No null
+// terminator is added.
+
+static_assert(sizeof(uintmax_t) == sizeof(unsigned long long),
+              "uintmax_t has an unexpected size");
+
+// All pairs of decimal digits.
+static const char itoa_pairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Number of bits needed to represent a value, which is at least one.
+static inline unsigned int itoa_bits(uintmax_t value) {
+  return sizeof(unsigned long long) * 8 - __builtin_clzll(value | 1);
+}
+
+// Returns the number of decimal digits of a value.
+static inline unsigned int itoa_digits10(uintmax_t value) {
+  // Smallest value having a given number of digits, except for zero,
+  // which also has a single digit.
+  static const uintmax_t powers[] = {
+      0,
+      10,
+      100,
+      1000,
+      10000,
+      100000,
+      1000000,
+      10000000,
+      100000000,
+      1000000000,
+      10000000000,
+      100000000000,
+      1000000000000,
+      10000000000000,
+      100000000000000,
+      1000000000000000,
+      10000000000000000,
+      100000000000000000,
+      1000000000000000000,
+      10000000000000000000U,
+  };
+  // Estimate log10(value) based on log2(value). 1233 / 4096 is slightly
+  // smaller than log10(2), meaning that the estimate is either correct
+  // or one too high.
+  unsigned int estimate = itoa_bits(value) * 1233 >> 12;
+  return estimate + 1 - (value < powers[estimate]);
+}
+
+// Returns the number of hexadecimal digits of a value.
+static inline unsigned int itoa_digits16(uintmax_t value) {
+  return (itoa_bits(value) + 3) / 4;
+}
+
+// Writes a value in the range [0, 100) as two digits.
+static inline char *itoa10_pair(char *end, uint32_t value) {
+  end -= 2;
+  memcpy(end, &itoa_pairs[value * 2], 2);
+  return end;
+}
+
+// Writes a value in the range [0, 10^8) as exactly eight digits.
+static inline char *itoa10_eight(char *end, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    end = itoa10_pair(end, value % 100);
+    value /= 100;
+  }
+  return end;
+}
+
+// Writes a value as decimal digits.
+static inline char *itoa10(char *end, uintmax_t value) {
+  // Split off groups of eight digits, so that the remainder can be
+  // processed using 32-bit arithmetic.
+  while (value > UINT32_MAX) {
+    uintmax_t upper = value / 100000000;
+    end = itoa10_eight(end, value - upper * 100000000);
+    value = upper;
+  }
+
+  uint32_t lower = value;
+  while (lower >= 100) {
+    end = itoa10_pair(end, lower % 100);
+    lower /= 100;
+  }
+  if (lower >= 10)
+    return itoa10_pair(end, lower);
+  *--end = '0' + lower;
+  return end;
+}
+
+// Writes a value as decimal digits, prepending zeroes until at least a
+// given number of digits is written.
+static inline char *itoa10_padded(char *end, uintmax_t value,
+                                  size_t ndigits) {
+  char *digits = itoa10(end, value);
+  while ((size_t)(end - digits) < ndigits)
+    *--digits = '0';
+  return digits;
+}
+
+// Writes a value as hexadecimal digits. The character set determines
+// whether the digits are written in lowercase or uppercase.
+static inline char *itoa16(char *end, uintmax_t value, const char *charset) {
+  do {
+    *--end = charset[value & 0xf];
+    value >>= 4;
+  } while (value != 0);
+  return end;
+}
+
+// Writes a value as octal digits.
+static inline char *itoa8(char *end, uintmax_t value) {
+  do {
+    *--end = '0' + (value & 0x7);
+    value >>= 3;
+  } while (value != 0);
+  return end;
+}
+
+static inline char *itoa10_append(char *buf, uintmax_t value) {
+  char *end = buf + itoa_digits10(value);
+  itoa10(end, value);
+  return end;
+}
+
+static inline char *itoa16_append(char *buf, uintmax_t value,
+                                  const char *charset) {
+  char *end = buf + itoa_digits16(value);
+  itoa16(end, value, charset);
+  return end;
+}
+
+#endif
@@ -0,0 +1,60 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/itoa.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+
+#include "gtest/gtest.h"
+
+// Benchmark of the integer to string conversion used by printf(),
+// comparing it against converting one digit at a time. Values are taken
+// from a fixed pseudo-random sequence, truncated to 8, 16, 32 and 64
+// bits, so that the number of digits varies between iterations.
+
+namespace {
+
+constexpr unsigned int kIterations = 1 << 22;
+
+double now() {
+  struct timespec ts;
+  EXPECT_EQ(0, clock_gettime(CLOCK_MONOTONIC, &ts));
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+char *naive10(char *end, uintmax_t value) {
+  do {
+    *--end = '0' + value % 10;
+    value /= 10;
+  } while (value != 0);
+  return end;
+}
+
+void benchmark(const char *name, uintmax_t mask,
+               char *(*convert)(char *, uintmax_t)) {
+  char buf[20];
+  uintmax_t state = 0x853c49e6748fea9b;
+  uintmax_t checksum = 0;
+  double begin = now();
+  for (unsigned int i = 0; i < kIterations; ++i) {
+    state = state * 6364136223846793005 + 1442695040888963407;
+    uintmax_t value = (state >> (i % 32)) & mask;
+    checksum += *convert(buf + sizeof(buf), value);
+  }
+  double elapsed = now() - begin;
+  printf("%-8s %2d bits %8.2f ns/call (checksum %ju)\n", name,
+         __builtin_popcountll(mask), elapsed / kIterations * 1e9, checksum);
+}
+
+}  // namespace
+
+TEST(itoa, throughput) {
+  for (uintmax_t mask : {UINTMAX_C(0xff), UINTMAX_C(0xffff),
+                         UINTMAX_C(0xffffffff), UINTMAX_MAX}) {
+    benchmark("naive", mask, naive10);
+    benchmark("itoa10", mask, itoa10);
+  }
+}
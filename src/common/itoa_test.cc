@@ -0,0 +1,120 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/itoa.h>
+
+#include <cstdint>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string to_string10(uintmax_t value) {
+  char buf[20];
+  char *end = buf + sizeof(buf);
+  return std::string(itoa10(end, value), end);
+}
+
+std::string to_string16(uintmax_t value) {
+  char buf[16];
+  char *end = buf + sizeof(buf);
+  return std::string(itoa16(end, value, "0123456789abcdef"), end);
+}
+
+std::string to_string8(uintmax_t value) {
+  char buf[22];
+  char *end = buf + sizeof(buf);
+  return std::string(itoa8(end, value), end);
+}
+
+}  // namespace
+
+TEST(itoa, digits10) {
+  ASSERT_EQ(1, itoa_digits10(0));
+  ASSERT_EQ(1, itoa_digits10(9));
+  ASSERT_EQ(2, itoa_digits10(10));
+  uintmax_t power = 1;
+  for (unsigned int i = 1; i < 20; ++i) {
+    SCOPED_TRACE(i);
+    ASSERT_EQ(i, itoa_digits10(power));
+    ASSERT_EQ(i, itoa_digits10(power * 10 - 1));
+    power *= 10;
+  }
+  ASSERT_EQ(20, itoa_digits10(power));
+  ASSERT_EQ(20, itoa_digits10(UINTMAX_MAX));
+}
+
+TEST(itoa, digits16) {
+  ASSERT_EQ(1, itoa_digits16(0));
+  ASSERT_EQ(1, itoa_digits16(0xf));
+  ASSERT_EQ(2, itoa_digits16(0x10));
+  ASSERT_EQ(8, itoa_digits16(UINT32_MAX));
+  ASSERT_EQ(16, itoa_digits16(UINTMAX_MAX));
+}
+
+TEST(itoa, itoa10) {
+  ASSERT_EQ("0", to_string10(0));
+  ASSERT_EQ("7", to_string10(7));
+  ASSERT_EQ("10", to_string10(10));
+  ASSERT_EQ("99", to_string10(99));
+  ASSERT_EQ("100", to_string10(100));
+  ASSERT_EQ("12345", to_string10(12345));
+  ASSERT_EQ("4294967295", to_string10(UINT32_MAX));
+  ASSERT_EQ("4294967296", to_string10(UINT64_C(4294967296)));
+  ASSERT_EQ("100000000000000000", to_string10(UINT64_C(100000000000000000)));
+  ASSERT_EQ("18446744073709551615", to_string10(UINTMAX_MAX));
+
+  // Compare against a naive implementation.
+  for (uintmax_t value = 1; value < UINTMAX_MAX / 3; value *= 3) {
+    SCOPED_TRACE(value);
+    ASSERT_EQ(std::to_string(value - 1), to_string10(value - 1));
+    ASSERT_EQ(std::to_string(value), to_string10(value));
+  }
+}
+
+TEST(itoa, itoa10_padded) {
+  char buf[20];
+  char *end = buf + sizeof(buf);
+  ASSERT_EQ("000", std::string(itoa10_padded(end, 0, 3), end));
+  ASSERT_EQ("007", std::string(itoa10_padded(end, 7, 3), end));
+  ASSERT_EQ("123", std::string(itoa10_padded(end, 123, 3), end));
+  ASSERT_EQ("12345", std::string(itoa10_padded(end, 12345, 3), end));
+}
+
+TEST(itoa, itoa16) {
+  ASSERT_EQ("0", to_string16(0));
+  ASSERT_EQ("f", to_string16(15));
+  ASSERT_EQ("10", to_string16(16));
+  ASSERT_EQ("deadbeef", to_string16(0xdeadbeef));
+  ASSERT_EQ("ffffffffffffffff", to_string16(UINTMAX_MAX));
+
+  char buf[4];
+  char *end = buf + sizeof(buf);
+  ASSERT_EQ("BEEF",
+            std::string(itoa16(end, 0xbeef, "0123456789ABCDEF"), end));
+}
+
+TEST(itoa, itoa8) {
+  ASSERT_EQ("0", to_string8(0));
+  ASSERT_EQ("7", to_string8(7));
+  ASSERT_EQ("10", to_string8(8));
+  ASSERT_EQ("777", to_string8(0777));
+  ASSERT_EQ("1777777777777777777777", to_string8(UINTMAX_MAX));
+}
+
+TEST(itoa, append) {
+  char buf[20];
+  ASSERT_EQ(buf + 1, itoa10_append(buf, 0));
+  ASSERT_EQ('0', buf[0]);
+  ASSERT_EQ(buf + 3, itoa10_append(buf, 255));
+  ASSERT_EQ("255", std::string(buf, 3));
+  ASSERT_EQ(buf + 20, itoa10_append(buf, UINTMAX_MAX));
+  ASSERT_EQ("18446744073709551615", std::string(buf, 20));
+
+  ASSERT_EQ(buf + 1, itoa16_append(buf, 0, "0123456789abcdef"));
+  ASSERT_EQ('0', buf[0]);
+  ASSERT_EQ(buf + 4, itoa16_append(buf, 0x200c, "0123456789abcdef"));
+  ASSERT_EQ("200c", std::string(buf, 4));
+}
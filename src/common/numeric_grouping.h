@@ -99,4 +99,15 @@ static inline bool numeric_grouping_step(struct numeric_grouping *ng) {
   return true;
 }
 
+// Skips up to a given number of steps for which no grouping character
+// needs to be printed, returning the number of steps skipped. This
+// allows callers to print runs of digits at once.
+static inline size_t numeric_grouping_advance(struct numeric_grouping *ng,
+                                              size_t ndigits) {
+  if (ndigits > ng->steps)
+    ndigits = ng->steps;
+  ng->steps -= ndigits;
+  return ndigits;
+}
+
 #endif
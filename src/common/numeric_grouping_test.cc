@@ -4,6 +4,8 @@
 
 #include <common/numeric_grouping.h>
 
+#include <string>
+
 #include "gtest/gtest.h"
 
 TEST(numeric_grouping, examples) {
@@ -42,3 +44,32 @@ TEST(numeric_grouping, examples) {
   NG_TEST("\x03\xff", "1234567", "1234,567");
 #undef NG_TEST
 }
+
+TEST(numeric_grouping, advance) {
+#define NG_TEST(groupingstr, instr, outstr)                                  \
+  do {                                                                       \
+    struct numeric_grouping ng;                                              \
+    numeric_grouping_init(&ng, (const signed char *)groupingstr,             \
+                          sizeof(instr) - 1);                                \
+    std::string out;                                                         \
+    for (size_t i = 0; i < sizeof(instr) - 1;) {                             \
+      if (numeric_grouping_step(&ng))                                        \
+        out += ',';                                                          \
+      size_t run = 1 + numeric_grouping_advance(&ng, sizeof(instr) - 2 - i); \
+      out.append(&instr[i], run);                                            \
+      i += run;                                                              \
+    }                                                                        \
+    ASSERT_EQ(outstr, out);                                                  \
+  } while (0)
+  NG_TEST(NULL, "1234567", "1234567");
+  NG_TEST("", "1234567", "1234567");
+
+  NG_TEST("\x01", "1234567", "1,2,3,4,5,6,7");
+  NG_TEST("\x02", "1234567", "1,23,45,67");
+  NG_TEST("\x03", "1234567", "1,234,567");
+  NG_TEST("\x04", "1234567", "123,4567");
+  NG_TEST("\x07", "1234567", "1234567");
+  NG_TEST("\x03\x01\x02", "123456789", "1,23,45,6,789");
+  NG_TEST("\x03\xff", "1234567", "1234,567");
+#undef NG_TEST
+}
@@ -3,6 +3,10 @@
 // SPDX-License-Identifier: BSD-2-Clause
 
 // Parser of integer literals as performed by strtol(), scanf(), etc.
+//
+// Callers may optionally define PEEK_DIGITS8(n, value), which appends
+// up to eight decimal digits starting at offset n to a value at once,
+// returning the number of digits consumed.
 
 // Result of parsing.
 bool have_number = false;
@@ -48,6 +52,24 @@ int_t number = 0;
     }
 
     uintmax_t value = 0;
+#ifdef PEEK_DIGITS8
+    // Consume decimal digits eight at a time, for as long as this
+    // cannot cause an overflow. The bound is computed like the one
+    // above, but without depending on the radix, so that it can be
+    // evaluated at compile time.
+    if (radix == 10) {
+      uintmax_t ceil8 = negative ? -(min / 100000000) : max / 100000000;
+      while (value < ceil8) {
+        size_t ndigits = PEEK_DIGITS8(0, &value);
+        if (ndigits == 0)
+          break;
+        have_number = true;
+        SKIP(ndigits);
+        if (ndigits < 8)
+          break;
+      }
+    }
+#endif
     for (;;) {
       // Parse next digit.
       uint_fast8_t digit;
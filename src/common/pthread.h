@@ -12,6 +12,8 @@
 #include <cloudabi_types.h>
 #include <pthread.h>
 #include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdnoreturn.h>
 #include <threads.h>
@@ -27,6 +29,30 @@
 static_assert(PTHREAD_STACK_DEFAULT % PTHREAD_UNSAFE_STACK_ALIGNMENT == 0,
               "Default stack buffer needs to be properly aligned");
 
+// Thread stacks.
+//
+// Allocating stacks for new threads is relatively expensive, as they
+// are large and need to be faulted in by the thread. Instead of freeing
+// the stacks of threads that have been joined, up to
+// PTHREAD_STACK_CACHE_SIZE pairs of stacks are kept around for reuse by
+// pthread_create(). Stacks are only reused by threads with identical
+// stack and guard sizes. The size of the cache can be adjusted through
+// pthread_setstackcachesize_np(), up to PTHREAD_STACK_CACHE_MAX.
+//
+// Stacks are allocated through malloc(), unless a guard size is set.
+// In that case they are allocated through mmap(), placing inaccessible
+// pages right below both stacks to catch stack overflows.
+#define PTHREAD_STACK_CACHE_SIZE 8
+#define PTHREAD_STACK_CACHE_MAX 64
+
+struct pthread_stacks;
+
+// Allocates stacks with the sizes stored in the structure.
+bool __pthread_stacks_allocate(struct pthread_stacks *);
+
+// Releases the stacks of a thread that has been joined.
+void __pthread_stacks_free(const struct pthread_stacks *);
+
 // Number of threads currently active. This counter is used by
 // pthread_exit() to determine whether the process should be terminated
 // gracefully if the number of threads would reach zero.
@@ -43,30 +69,41 @@ extern refcount_t __pthread_num_threads;
 // generation counter when referring to the key object, meaning they can
 // determine whether the destructor function still corresponds with the
 // value of the key for that thread.
+//
+// Every key object is assigned a unique index upon allocation. As key
+// objects are reused, these indices remain dense. Threads store their
+// values in an array that is indexed directly by these indices. This
+// array is extended in chunks when values are set for keys that lie
+// beyond its end.
 
 struct __pthread_key {
   SLIST_ENTRY(__pthread_key) freelist;
+  size_t index;
   uint_least64_t generation;
   void (*destructor)(void *);
 };
 
 struct pthread_specific {
-  SLIST_ENTRY(pthread_specific) next;
   struct __pthread_key *key;
   void *value;
   uint_least64_t generation;
 };
 
+// Number of entries by which the per-thread value array is extended.
+#define PTHREAD_SPECIFICS_CHUNK 16
+
 // Key freelist.
 extern pthread_mutex_t __pthread_key_freelist_lock;
 extern SLIST_HEAD(pthread_key_freelist, __pthread_key) __pthread_key_freelist
     __guarded_by(__pthread_key_freelist_lock);
 
-// Per-thread specific value list.
-//
-// TODO(ed): Use a splay tree instead?
-extern thread_local SLIST_HEAD(pthread_specifics,
-                               pthread_specific) __pthread_specifics;
+// Number of key objects allocated.
+extern size_t __pthread_keys_allocated
+    __guarded_by(__pthread_key_freelist_lock);
+
+// Per-thread specific value array.
+extern thread_local struct pthread_specific *__pthread_specifics;
+extern thread_local size_t __pthread_specifics_size;
 
 // Locking.
 //
@@ -86,10 +123,104 @@ extern thread_local SLIST_HEAD(pthread_specifics,
 // those locks, but that would require too much storage space. Use a
 // simple counter instead.
 
-// Number of times locking in userspace should be attempted before
-// calling into the kernel.
-// TODO(ed): Determine the right number!
-#define LOCK_RETRY_COUNT 1
+// Adaptive spinning.
+//
+// Locks tend to be held for a short amount of time. Instead of calling
+// into the kernel as soon as a lock turns out to be held by another
+// thread, spin for a while in the hope that it gets released. Every
+// lock keeps track of an estimate of the amount of time it took to
+// acquire it in recent attempts, which approximates how long the lock
+// is typically held. Spinning is bounded by twice this estimate, so
+// that it automatically grows for locks with short critical sections.
+// Attempts that fail to acquire the lock count as zero, so that
+// spinning shrinks for locks that are rarely released in time.
+//
+// Time is expressed in the number of pause instructions executed.
+// Between attempts to acquire the lock, spinning backs off
+// exponentially to reduce the amount of traffic on the lock's cache
+// line.
+
+// Minimum and maximum amount of time spent spinning.
+#define LOCK_SPIN_MIN 16
+#define LOCK_SPIN_MAX 1024
+
+// Maximum amount of time between two attempts to acquire the lock.
+#define LOCK_BACKOFF_MAX 64
+
+// Attempts to acquire a read or write lock by spinning. Returns false
+// if the lock should be acquired by calling into the kernel.
+bool __pthread_rwlock_spin(pthread_rwlock_t *, bool);
+
+// Hints to the CPU that the thread is waiting for a lock to be
+// released by another thread.
+static inline void __pthread_spin_pause(void) {
+#if defined(__aarch64__)
+  asm volatile("yield");
+#elif defined(__i386__) || defined(__x86_64__)
+  asm volatile("pause");
+#else
+  asm volatile("" : : : "memory");
+#endif
+}
+
+// Lock contention profiling.
+//
+// While enabled through pthread_lockprof_start_np(), acquisitions of
+// mutexes and rwlocks are recorded in a per-thread table, keyed by the
+// address of the lock. As tables are only modified by the threads
+// owning them, recording doesn't require any locking. Tables are placed
+// in a global list, so that pthread_lockprof_report_np() can inspect
+// them. They are never freed, so that statistics of threads that have
+// terminated are retained.
+
+#define LOCKPROF_CONTENDED 0x1  // Lock was held by another thread.
+#define LOCKPROF_KERNEL 0x2     // Waited for the lock in the kernel.
+#define LOCKPROF_TIMEDOUT 0x4   // Lock was not acquired.
+
+// Exponent of the number of entries in a per-thread table.
+#define LOCKPROF_NBITS 8
+#define LOCKPROF_ENTRIES (1 << LOCKPROF_NBITS)
+
+// Number of stack frames stored for the call site of a lock.
+#define LOCKPROF_FRAMES 4
+
+struct lockprof_entry {
+  _Atomic(const void *) lock;      // Address of the lock.
+  _Atomic(uint64_t) acquisitions;  // Number of acquisitions.
+  _Atomic(uint64_t) contended;     // Number of contended attempts.
+  _Atomic(uint64_t) kernel;        // Number of kernel entries.
+  _Atomic(uint64_t) wait_time;     // Time spent waiting in ns.
+  _Atomic(size_t) nframes;         // Number of frames stored.
+  void *frames[LOCKPROF_FRAMES];   // First contended call site.
+};
+
+struct lockprof_table {
+  struct lockprof_table *next;                      // Next table in list.
+  _Atomic(uint64_t) dropped;                        // Locks not recorded.
+  struct lockprof_entry entries[LOCKPROF_ENTRIES];  // Entries.
+};
+
+extern atomic_bool __pthread_lockprof_enabled;
+extern _Atomic(struct lockprof_table *) __pthread_lockprof_tables;
+
+void __pthread_lockprof_add(const void *, cloudabi_timestamp_t, unsigned int);
+cloudabi_timestamp_t __pthread_lockprof_now(void);
+
+// Returns the time at which a thread starts waiting for a lock.
+static inline cloudabi_timestamp_t __pthread_lockprof_begin(void) {
+  return atomic_load_explicit(&__pthread_lockprof_enabled,
+                              memory_order_relaxed)
+             ? __pthread_lockprof_now()
+             : 0;
+}
+
+// Records an attempt to acquire a lock.
+static inline void __pthread_lockprof_record(const void *lock,
+                                             cloudabi_timestamp_t begin,
+                                             unsigned int flags) {
+  if (atomic_load_explicit(&__pthread_lockprof_enabled, memory_order_relaxed))
+    __pthread_lockprof_add(lock, begin, flags);
+}
 
 // The number of read locks acquired. This is used by
 // pthread_rwlock_rdlock() to determine whether to ignore waiting
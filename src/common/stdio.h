@@ -408,4 +408,10 @@ static inline off_t ftello_logical(FILE *stream) __requires_exclusive(*stream) {
 // Allocates a stream.
 FILE *__falloc(locale_t locale);
 
+// Returns the compiled representation of a printf() format string that
+// is stored in read-only memory, invoking the provided function to
+// compile it if it is not cached yet. Returns NULL if the format string
+// cannot be cached.
+const void *__printf_cache_get(const char *, const void *(*)(const char *));
+
 #endif
@@ -2,6 +2,7 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <common/atoi.h>
 #include <common/limits.h>
 #include <common/locale.h>
 #include <common/mbstate.h>
@@ -37,8 +38,12 @@ int_t NAME(const char_t *restrict str, char_t **restrict endptr, int base,
   } while (0)
 #include "parser_whitespace.h"
 
+#if !WIDE
+#define PEEK_DIGITS8(n, value) atoi10_append8(s + (n), value)
+#endif
 #include "parser_strtoint.h"
 #undef PEEK
+#undef PEEK_DIGITS8
 #undef SKIP
 
   if (!have_number)
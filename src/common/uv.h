@@ -8,6 +8,7 @@
 #include <assert.h>
 #include <cloudabi_syscalls.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -271,18 +272,14 @@ static inline int __uv_active_timers_cmp(const uv_timer_t *a,
 _UV_CIRCLEBUF_DECLARE_FUNCTIONS(__uv_pending_fds, int);
 _UV_HEAP_DECLARE_FUNCTIONS(__uv_active_timers, uv_timer_t);
 _UV_SLIST_DECLARE_FUNCTIONS(__uv_closing_handles, uv_handle_t);
-_UV_TAILQ_DECLARE_FUNCTIONS(__uv_active_asyncs, uv_async_t);
 _UV_TAILQ_DECLARE_FUNCTIONS(__uv_active_checks, uv_check_t);
 _UV_TAILQ_DECLARE_FUNCTIONS(__uv_active_idles, uv_idle_t);
 _UV_TAILQ_DECLARE_FUNCTIONS(__uv_active_prepares, uv_prepare_t);
-_UV_TAILQ_DECLARE_FUNCTIONS(__uv_active_processes, uv_process_t);
 _UV_TAILQ_DECLARE_FUNCTIONS(__uv_handles, uv_handle_t);
-_UV_TAILQ_DECLARE_FUNCTIONS(__uv_reading_polls, uv_poll_t);
-_UV_TAILQ_DECLARE_FUNCTIONS(__uv_reading_streams, uv_stream_t);
 _UV_TAILQ_DECLARE_FUNCTIONS(__uv_shutdowns, uv_shutdown_t);
+_UV_TAILQ_DECLARE_FUNCTIONS(__uv_udp_sends, uv_udp_send_t);
+_UV_TAILQ_DECLARE_FUNCTIONS(__uv_works, uv_work_t);
 _UV_TAILQ_DECLARE_FUNCTIONS(__uv_writes, uv_write_t);
-_UV_TAILQ_DECLARE_FUNCTIONS(__uv_writing_polls, uv_poll_t);
-_UV_TAILQ_DECLARE_FUNCTIONS(__uv_writing_streams, uv_stream_t);
 
 //
 // Error handling.
@@ -290,6 +287,134 @@ _UV_TAILQ_DECLARE_FUNCTIONS(__uv_writing_streams, uv_stream_t);
 
 const char *__uv_strerror_unknown(int);
 
+//
+// Wakeup pipes.
+//
+
+// Creates a non-blocking pipe that other threads can use to wake up
+// the event loop.
+static inline int __uv_wakeup_pipe_create(cloudabi_fd_t *readfd,
+                                          cloudabi_fd_t *writefd) {
+  cloudabi_errno_t error = cloudabi_sys_fd_create2(
+      CLOUDABI_FILETYPE_SOCKET_STREAM, readfd, writefd);
+  if (error != 0)
+    return -error;
+
+  // Make the pipe non-blocking.
+  cloudabi_fdstat_t fds = {.fs_flags = CLOUDABI_FDFLAG_NONBLOCK};
+  error = cloudabi_sys_fd_stat_put(*readfd, &fds, CLOUDABI_FDSTAT_FLAGS);
+  if (error == 0)
+    error = cloudabi_sys_fd_stat_put(*writefd, &fds, CLOUDABI_FDSTAT_FLAGS);
+  if (error != 0) {
+    cloudabi_sys_fd_close(*readfd);
+    cloudabi_sys_fd_close(*writefd);
+    return -error;
+  }
+  return 0;
+}
+
+static inline int __uv_wakeup_pipe_send(cloudabi_fd_t writefd) {
+  // Write a single byte into the pipe to wake up the event loop.
+  // If the write fails with EAGAIN, it means that other wakeups are
+  // pending, which is good.
+  char c = 0;
+  cloudabi_ciovec_t iov = {.buf = &c, .buf_len = 1};
+  size_t nwritten;
+  cloudabi_errno_t error = cloudabi_sys_fd_write(writefd, &iov, 1, &nwritten);
+  return error == CLOUDABI_EAGAIN ? 0 : -error;
+}
+
+static inline void __uv_wakeup_pipe_drain(cloudabi_fd_t readfd) {
+  // Discard any data present in the pipe used for notification.
+  char discard[1024];
+  cloudabi_iovec_t iov = {.buf = discard, .buf_len = sizeof(discard)};
+  size_t nread;
+  while (cloudabi_sys_fd_read(readfd, &iov, 1, &nread) == 0 &&
+         nread == sizeof(discard)) {
+  }
+}
+
+//
+// Poll subscriptions.
+//
+// The array of subscriptions passed to cloudabi_sys_poll() is kept
+// across iterations of the loop. Handles insert a subscription when
+// they start waiting for an event and remove it when they stop. The
+// index of the subscription is stored in the handle, so that it can be
+// removed in constant time by moving the last subscription in its
+// place.
+//
+
+// Ensures that a number of subscriptions can be inserted without
+// failing.
+static inline bool __uv_subscriptions_reserve(uv_loop_t *loop, size_t count) {
+  size_t needed = loop->__subscriptions_count + count;
+  if (needed <= loop->__subscriptions_capacity)
+    return true;
+  size_t capacity = 4;
+  while (capacity < needed)
+    capacity *= 2;
+  cloudabi_subscription_t *subscriptions =
+      reallocarray(loop->__subscriptions_buffer, capacity,
+                   sizeof(cloudabi_subscription_t));
+  if (subscriptions == NULL)
+    return false;
+  loop->__subscriptions_buffer = subscriptions;
+  size_t **slots =
+      reallocarray(loop->__subscriptions_slots, capacity, sizeof(size_t *));
+  if (slots == NULL)
+    return false;
+  loop->__subscriptions_slots = slots;
+  loop->__subscriptions_capacity = capacity;
+  return true;
+}
+
+static inline void __uv_subscriptions_insert(
+    uv_loop_t *loop, size_t *slot, const cloudabi_subscription_t *sub) {
+  assert(loop->__subscriptions_count < loop->__subscriptions_capacity &&
+         "Subscription has not been reserved");
+  size_t index = loop->__subscriptions_count++;
+  cloudabi_subscription_t *subscriptions = loop->__subscriptions_buffer;
+  subscriptions[index] = *sub;
+  loop->__subscriptions_slots[index] = slot;
+  *slot = index;
+  ++loop->__subscriptions_modified;
+}
+
+static inline void __uv_subscriptions_insert_fd(uv_loop_t *loop, size_t *slot,
+                                                const void *handle,
+                                                cloudabi_eventtype_t type,
+                                                cloudabi_fd_t fd) {
+  __uv_subscriptions_insert(
+      loop, slot,
+      &(cloudabi_subscription_t){
+          .userdata = (uintptr_t)handle,
+          .type = type,
+          .fd_readwrite.fd = fd,
+          .fd_readwrite.flags = CLOUDABI_SUBSCRIPTION_FD_READWRITE_POLL,
+      });
+}
+
+static inline void __uv_subscriptions_replace(
+    uv_loop_t *loop, size_t slot, const cloudabi_subscription_t *sub) {
+  assert(slot < loop->__subscriptions_count && "Slot out of bounds");
+  cloudabi_subscription_t *subscriptions = loop->__subscriptions_buffer;
+  subscriptions[slot] = *sub;
+  ++loop->__subscriptions_modified;
+}
+
+static inline void __uv_subscriptions_remove(uv_loop_t *loop, size_t slot) {
+  assert(slot < loop->__subscriptions_count && "Slot out of bounds");
+  size_t last = --loop->__subscriptions_count;
+  if (slot != last) {
+    cloudabi_subscription_t *subscriptions = loop->__subscriptions_buffer;
+    subscriptions[slot] = subscriptions[last];
+    loop->__subscriptions_slots[slot] = loop->__subscriptions_slots[last];
+    *loop->__subscriptions_slots[slot] = slot;
+    ++loop->__subscriptions_modified;
+  }
+}
+
 //
 // Handle management.
 //
@@ -363,11 +488,8 @@ static inline bool __uv_stream_has_ipc(uv_stream_t *handle) {
   return handle->type == UV_NAMED_PIPE && ((uv_pipe_t *)handle)->ipc != 0;
 }
 
-static inline int __uv_stream_open(uv_stream_t *handle, int fd) {
-  if (handle->__fd >= 0)
-    return UV_EBUSY;
-
-  // Switch the file descriptor to non-blocking mode.
+// Switches a file descriptor to non-blocking mode.
+static inline int __uv_set_nonblocking(cloudabi_fd_t fd) {
   cloudabi_fdstat_t fds;
   cloudabi_errno_t error = cloudabi_sys_fd_stat_get(fd, &fds);
   if (error != 0)
@@ -376,33 +498,51 @@ static inline int __uv_stream_open(uv_stream_t *handle, int fd) {
   error = cloudabi_sys_fd_stat_put(fd, &fds, CLOUDABI_FDSTAT_FLAGS);
   if (error != 0)
     return -error;
+  return 0;
+}
 
+static inline int __uv_stream_open(uv_stream_t *handle, int fd) {
+  if (handle->__fd >= 0)
+    return UV_EBUSY;
+  int error = __uv_set_nonblocking(fd);
+  if (error != 0)
+    return error;
   handle->__fd = fd;
   return 0;
 }
 
-static inline void __uv_stream_start_reading(uv_stream_t *handle) {
+static inline int __uv_stream_start_reading(uv_stream_t *handle) {
   if (handle->__read_cb == NULL) {
-    __uv_reading_streams_insert_last(&handle->loop->__reading_streams, handle);
+    uv_loop_t *loop = handle->loop;
+    if (!__uv_subscriptions_reserve(loop, 1))
+      return UV_ENOMEM;
+    __uv_subscriptions_insert_fd(loop, &handle->__read_slot, handle,
+                                 CLOUDABI_EVENTTYPE_FD_READ, handle->__fd);
     if (__uv_shutdowns_empty(&handle->__shutdown_queue) &&
         __uv_writes_empty(&handle->__write_queue))
       __uv_handle_start((uv_handle_t *)handle);
   }
+  return 0;
 }
 
-static inline void __uv_stream_start_writing(uv_stream_t *handle) {
+static inline int __uv_stream_start_writing(uv_stream_t *handle) {
   if (__uv_shutdowns_empty(&handle->__shutdown_queue) &&
       __uv_writes_empty(&handle->__write_queue)) {
-    __uv_writing_streams_insert_last(&handle->loop->__writing_streams, handle);
+    uv_loop_t *loop = handle->loop;
+    if (!__uv_subscriptions_reserve(loop, 1))
+      return UV_ENOMEM;
+    __uv_subscriptions_insert_fd(loop, &handle->__write_slot, handle,
+                                 CLOUDABI_EVENTTYPE_FD_WRITE, handle->__fd);
     if (handle->__read_cb == NULL)
       __uv_handle_start((uv_handle_t *)handle);
   }
+  return 0;
 }
 
 static inline void __uv_stream_stop_reading(uv_stream_t *handle) {
   assert(handle->__read_cb == NULL &&
          "Stream not actually stopped for reading");
-  __uv_reading_streams_remove(handle);
+  __uv_subscriptions_remove(handle->loop, handle->__read_slot);
   if (__uv_shutdowns_empty(&handle->__shutdown_queue) &&
       __uv_writes_empty(&handle->__write_queue))
     __uv_handle_stop((uv_handle_t *)handle);
@@ -413,21 +553,123 @@ static inline void __uv_stream_stop_writing(uv_stream_t *handle) {
       __uv_writes_empty(&handle->__write_queue)) {
     if (handle->__read_cb == NULL)
       __uv_handle_stop((uv_handle_t *)handle);
-    __uv_writing_streams_remove(handle);
+    __uv_subscriptions_remove(handle->loop, handle->__write_slot);
   }
 }
 
+// Writes data to a stream without blocking, optionally sending a file
+// descriptor along with it.
+cloudabi_errno_t __uv_stream_write(uv_stream_t *, const uv_buf_t *, size_t,
+                                   uv_stream_t *, size_t *);
+
+static inline void __uv_write_free_bufs(uv_write_t *req) {
+  if (req->__bufs != req->__bufsml)
+    free(req->__bufs);
+}
+
+// Schedules the invocation of the callback of a write request that has
+// already been completed.
+static inline void __uv_write_complete(uv_write_t *req, int status) {
+  uv_loop_t *loop = req->handle->loop;
+  req->__status = status;
+  __uv_writes_insert_last(&loop->__pending_writes, req);
+  ++loop->__active_ref_handles_reqs;
+}
+
+// Maximum size of a datagram, which is used as the suggested size of
+// receive buffers.
+#define UV_UDP_DGRAM_MAXSIZE 65536
+
+// UDP handles are active while they are receiving or have datagrams
+// queued for sending.
+static inline int __uv_udp_start_receiving(uv_udp_t *handle) {
+  if (handle->__recv_cb == NULL) {
+    uv_loop_t *loop = handle->loop;
+    if (!__uv_subscriptions_reserve(loop, 1))
+      return UV_ENOMEM;
+    __uv_subscriptions_insert_fd(loop, &handle->__read_slot, handle,
+                                 CLOUDABI_EVENTTYPE_FD_READ, handle->__fd);
+    if (__uv_udp_sends_empty(&handle->__send_queue))
+      __uv_handle_start((uv_handle_t *)handle);
+  }
+  return 0;
+}
+
+static inline void __uv_udp_stop_receiving(uv_udp_t *handle) {
+  assert(handle->__recv_cb == NULL &&
+         "Handle not actually stopped for receiving");
+  __uv_subscriptions_remove(handle->loop, handle->__read_slot);
+  if (__uv_udp_sends_empty(&handle->__send_queue))
+    __uv_handle_stop((uv_handle_t *)handle);
+}
+
+// Starts polling for writability. The caller must have reserved a
+// subscription and must ensure the send queue was empty.
+static inline void __uv_udp_start_sending(uv_udp_t *handle) {
+  assert(__uv_udp_sends_empty(&handle->__send_queue) &&
+         "Handle is already sending");
+  __uv_subscriptions_insert_fd(handle->loop, &handle->__write_slot, handle,
+                               CLOUDABI_EVENTTYPE_FD_WRITE, handle->__fd);
+  if (handle->__recv_cb == NULL)
+    __uv_handle_start((uv_handle_t *)handle);
+}
+
+static inline void __uv_udp_stop_sending(uv_udp_t *handle) {
+  assert(__uv_udp_sends_empty(&handle->__send_queue) &&
+         "Handle still has datagrams queued");
+  if (handle->__recv_cb == NULL)
+    __uv_handle_stop((uv_handle_t *)handle);
+  __uv_subscriptions_remove(handle->loop, handle->__write_slot);
+}
+
+// Sends a single datagram without blocking.
+static inline cloudabi_errno_t __uv_udp_send_datagram(uv_udp_t *handle,
+                                                      const uv_buf_t *bufs,
+                                                      unsigned int nbufs) {
+  size_t nwritten;
+  return cloudabi_sys_fd_write(handle->__fd, (const cloudabi_ciovec_t *)bufs,
+                               nbufs, &nwritten);
+}
+
+static inline void __uv_udp_send_free_bufs(uv_udp_send_t *req) {
+  if (req->__bufs != req->__bufsml)
+    free(req->__bufs);
+}
+
+// Schedules the invocation of the callback of a send request that has
+// already been completed.
+static inline void __uv_udp_send_complete(uv_udp_send_t *req, int status) {
+  uv_loop_t *loop = req->handle->loop;
+  req->__status = status;
+  __uv_udp_sends_insert_last(&loop->__pending_udp_sends, req);
+  ++loop->__active_ref_handles_reqs;
+}
+
 static inline void __uv_process_kill(uv_process_t *handle) {
   if (handle->__fd >= 0) {
     cloudabi_sys_fd_close(handle->__fd);
     handle->__fd = -1;
+
+    // We can no longer poll on the process descriptor. Replace the
+    // subscription by a timeout that triggers immediately, so that
+    // uv_run() generates a fictive SIGKILL event.
+    __uv_subscriptions_replace(
+        handle->loop, handle->__slot,
+        &(cloudabi_subscription_t){
+            .userdata = (uintptr_t)handle,
+            .type = CLOUDABI_EVENTTYPE_CLOCK,
+            .clock.clock_id = CLOUDABI_CLOCK_MONOTONIC,
+        });
   }
 }
 
 static inline void __uv_process_stop(uv_process_t *handle) {
   if (uv_is_active((uv_handle_t *)handle)) {
-    __uv_process_kill(handle);
-    __uv_active_processes_remove(handle);
+    if (handle->__fd >= 0) {
+      cloudabi_sys_fd_close(handle->__fd);
+      handle->__fd = -1;
+    }
+    __uv_subscriptions_remove(handle->loop, handle->__slot);
     __uv_handle_stop((uv_handle_t *)handle);
   }
 }
@@ -440,16 +682,70 @@ static inline void __uv_req_init(uv_req_t *req, uv_req_type type) {
   req->type = type;
 }
 
+//
+// Thread pool.
+//
+// Requests of type uv_fs_t, uv_getaddrinfo_t, uv_getnameinfo_t and
+// uv_work_t all start with the same fields, allowing them to be
+// processed by the thread pool as if they were a uv_work_t. The work
+// function is invoked on one of the worker threads, whereas the after
+// work function is invoked by uv_run() on the thread running the loop.
+//
+
+#define UV_WORK_QUEUED 1    // Waiting in the queue of a worker thread.
+#define UV_WORK_RUNNING 2   // Picked up by a worker thread.
+#define UV_WORK_CANCELED 3  // Removed from the queue by uv_cancel().
+#define UV_WORK_DONE 4      // Completion has been reported to the loop.
+
+// Initializes a request that may be processed by the thread pool.
+// Requests are marked as done until they are submitted, so that
+// uv_cancel() rejects requests that have never been queued, such as
+// synchronous file system requests.
+static inline void __uv_work_req_init(uv_work_t *req, uv_req_type type) {
+  __uv_req_init((uv_req_t *)req, type);
+  req->__work_state = UV_WORK_DONE;
+}
+
+int __uv_work_cancel(uv_work_t *);
+int __uv_work_submit(uv_loop_t *, uv_work_t *, void (*)(uv_work_t *),
+                     void (*)(uv_work_t *, int));
+
 //
 // File system operations.
 //
 
-static inline int __uv_fs_execute(uv_loop_t *loop, uv_fs_t *req,
-                                  uv_fs_type type,
-                                  ssize_t (*work_cb)(uv_fs_t *),
-                                  uv_fs_cb after_work_cb) {
-  // TODO(ed): Implement!
-  return UV_ENOSYS;
+// Executes a file system operation. Operations are performed on the
+// thread pool if a callback is provided. Otherwise they are performed
+// synchronously, returning the result of the operation.
+int __uv_fs_execute(uv_loop_t *, uv_fs_t *, uv_fs_type, ssize_t (*)(uv_fs_t *),
+                    uv_fs_cb);
+
+// Copies the buffers of a read or write operation into the request, as
+// the caller's array may go out of scope before the operation completes.
+static inline bool __uv_fs_copy_bufs(uv_buf_t **bufs, uv_buf_t *bufsml,
+                                     size_t bufsml_len, const uv_buf_t *src,
+                                     unsigned int nbufs) {
+  if (nbufs <= bufsml_len) {
+    *bufs = bufsml;
+  } else {
+    *bufs = reallocarray(NULL, nbufs, sizeof(uv_buf_t));
+    if (*bufs == NULL)
+      return false;
+  }
+  memcpy(*bufs, src, nbufs * sizeof(uv_buf_t));
+  return true;
+}
+
+static inline void __uv_fs_free_bufs(uv_fs_t *req) {
+  if (req->fs_type == UV_FS_READ) {
+    if (req->__arguments.__read.__bufs != req->__arguments.__read.__bufsml)
+      free(req->__arguments.__read.__bufs);
+    req->__arguments.__read.__bufs = NULL;
+  } else if (req->fs_type == UV_FS_WRITE) {
+    if (req->__arguments.__write.__bufs != req->__arguments.__write.__bufsml)
+      free(req->__arguments.__write.__bufs);
+    req->__arguments.__write.__bufs = NULL;
+  }
 }
 
 //
@@ -4,6 +4,7 @@
 
 #include <common/float10.h>
 #include <common/float16.h>
+#include <common/itoa.h>
 #include <common/locale.h>
 #include <common/mbstate.h>
 #include <common/numeric_grouping.h>
@@ -26,8 +27,10 @@
 
 #if WIDE
 typedef wchar_t char_t;
+#define MEMSET wmemset
 #else
 typedef char char_t;
+#define MEMSET memset
 #endif
 
 #include <common/vprintscanf.h>
@@ -61,6 +64,19 @@ typedef char char_t;
   ((lm) == LM_LONG_DOUBLE ? GET_ARG_FLOAT_T(long double, index) \
                           : GET_ARG_FLOAT_T(double, index))
 
+// Converts a floating point value to decimal digits. Values that were
+// passed in as a double are converted exactly. Long doubles fall back
+// to rounding their shortest decimal representation.
+static void float10_decode(enum length_modifier length, long double value,
+                           unsigned int precision, unsigned char *digits,
+                           size_t *ndigits, int *exponent) {
+  if (length == LM_LONG_DOUBLE)
+    __f10dec(value, precision, digits, ndigits, exponent, fegetround());
+  else
+    __f10dec_double(value, precision, digits, ndigits, exponent,
+                    fegetround());
+}
+
 // Scans through a format string and determines whether the format uses
 // numbered arguments. If so, it returns the highest numbered argument used.
 // This can be used to allocate space to store the numbered arguments.
@@ -249,6 +265,150 @@ static void get_numarg_values(size_t numarg_max,
 #undef GET_ARG_POINTER_T
 }
 
+// Conversion specification, as parsed from a format string, including
+// the literal text preceding it. The end of the format string is
+// represented by a conversion whose specifier is the null character.
+struct printf_conversion {
+  const char_t *literal;  // Literal text preceding the conversion.
+  size_t literal_len;
+  char_t specifier;       // Conversion specifier.
+  char positive_sign;     // '+', ' ' or '\0'.
+  bool grouping;
+  bool left_justified;
+  bool alternative_form;
+  bool zero_padding;
+  bool field_width_arg;  // Field width is provided as an argument.
+  bool precision_arg;    // Precision is provided as an argument.
+  enum length_modifier length;
+  size_t field_width;
+  int precision;
+  // Indices of numbered arguments.
+  size_t arg_value;
+  size_t arg_field_width;
+  size_t arg_precision;
+};
+
+// Parses the next conversion specification of a format string.
+static void parse_conversion(const char_t **format,
+                             struct printf_conversion *conversion,
+                             bool numbered) {
+  // Literal text.
+  const char_t *s = *format;
+  conversion->literal = s;
+  while (*s != '\0' && *s != '%')
+    ++s;
+  conversion->literal_len = s - conversion->literal;
+  if (*s == '\0') {
+    conversion->specifier = '\0';
+    *format = s;
+    return;
+  }
+  ++s;
+
+  // Field number, in case of numbered arguments.
+  conversion->arg_value = numbered ? get_numarg(&s) - 1 : 0;
+
+  // Flags.
+  conversion->positive_sign = '\0';
+  conversion->grouping = false;
+  conversion->left_justified = false;
+  conversion->alternative_form = false;
+  conversion->zero_padding = false;
+  for (;;) {
+    if (*s == '\'') {
+      conversion->grouping = true;
+    } else if (*s == '-') {
+      conversion->left_justified = true;
+    } else if (*s == '+') {
+      conversion->positive_sign = '+';
+    } else if (*s == ' ') {
+      if (conversion->positive_sign != '+')
+        conversion->positive_sign = ' ';
+    } else if (*s == '#') {
+      conversion->alternative_form = true;
+    } else if (*s == '0') {
+      conversion->zero_padding = true;
+    } else {
+      break;
+    }
+    ++s;
+  }
+  if (conversion->left_justified)
+    conversion->zero_padding = false;
+
+  // Minimum field width.
+  conversion->field_width_arg = *s == '*';
+  if (conversion->field_width_arg) {
+    ++s;
+    conversion->arg_field_width = numbered ? get_numarg(&s) - 1 : 0;
+    conversion->field_width = 0;
+  } else {
+    conversion->field_width = get_number(&s);
+  }
+
+  // Precision.
+  conversion->precision_arg = false;
+  conversion->precision = -1;
+  if (*s == '.') {
+    ++s;
+    if (*s == '*') {
+      ++s;
+      conversion->precision_arg = true;
+      conversion->arg_precision = numbered ? get_numarg(&s) - 1 : 0;
+    } else {
+      conversion->precision = get_number(&s);
+    }
+  }
+
+  // Length modifier and conversion specifier. Don't advance past the
+  // end of the format string if the conversion specifier is missing.
+  conversion->length = get_length_modifier(&s);
+  conversion->specifier = *s;
+  if (*s != '\0')
+    ++s;
+  *format = s;
+}
+
+// Format string that has been parsed in advance.
+struct printf_format {
+  size_t numarg_max;
+  struct printf_conversion conversions[];
+};
+
+#if !WIDE
+// Parses a format string in its entirety, so that it may be stored in
+// the cache of format strings.
+static const void *compile_format(const char *format) {
+  // Allocate space for the maximum number of conversions, which is
+  // bounded by the number of percent signs, plus one for the end.
+  size_t nconversions = 1;
+  for (const char *s = format; (s = strchr(s, '%')) != NULL; ++s)
+    ++nconversions;
+  struct printf_format *compiled = malloc(
+      sizeof(*compiled) + nconversions * sizeof(compiled->conversions[0]));
+  if (compiled == NULL)
+    return NULL;
+
+  compiled->numarg_max = get_numarg_max(format);
+  struct printf_conversion *conversion = compiled->conversions;
+  do {
+    parse_conversion(&format, conversion, compiled->numarg_max > 0);
+  } while ((conversion++)->specifier != '\0');
+  return compiled;
+}
+#endif
+
+// Output is generated through three primitives:
+//
+// - PUTCHAR(c): writes a single character.
+// - PUTSPAN(str, len): writes a run of characters of type char_t, such
+//   as literal text in the format string or a string argument.
+// - PUTPAD(c, len): writes a character repeatedly, used for padding.
+//
+// Every style provides PUTCHAR. Styles that can store runs of
+// characters more efficiently also provide PUTSPAN and PUTPAD, which
+// otherwise fall back to calling PUTCHAR for every character.
+
 #if STYLE == VASPRINTF
 int NAME(char_t **s, locale_t locale, const char_t *format, va_list ap) {
   // Already preallocate a buffer of 16 bytes.
@@ -257,18 +417,42 @@ int NAME(char_t **s, locale_t locale, const char_t *format, va_list ap) {
   if (result == NULL)
     return -1;
   size_t resultstored = 0;
-#define PUTCHAR(c)                                                     \
-  do {                                                                 \
-    if (resultstored == resultlen) {                                   \
-      resultlen *= 2;                                                  \
-      char_t *newresult = realloc(result, resultlen * sizeof(char_t)); \
-      if (newresult == NULL) {                                         \
-        free(result);                                                  \
-        return -1;                                                     \
-      }                                                                \
-      result = newresult;                                              \
-    }                                                                  \
-    result[resultstored++] = (c);                                      \
+#define RESERVE(len)                                                      \
+  do {                                                                    \
+    size_t needed = resultstored + (len);                                 \
+    if (needed > resultlen) {                                             \
+      size_t newresultlen = resultlen;                                    \
+      do                                                                  \
+        newresultlen *= 2;                                                \
+      while (newresultlen < needed);                                      \
+      char_t *newresult = realloc(result, newresultlen * sizeof(char_t)); \
+      if (newresult == NULL) {                                            \
+        free(result);                                                     \
+        return -1;                                                        \
+      }                                                                   \
+      result = newresult;                                                 \
+      resultlen = newresultlen;                                           \
+    }                                                                     \
+  } while (0)
+#define PUTCHAR(c)                \
+  do {                            \
+    RESERVE(1);                   \
+    result[resultstored++] = (c); \
+  } while (0)
+#define PUTSPAN(str, len)                                          \
+  do {                                                             \
+    const char_t *span = (str);                                    \
+    size_t spanlen = (len);                                        \
+    RESERVE(spanlen);                                              \
+    memcpy(result + resultstored, span, spanlen * sizeof(char_t)); \
+    resultstored += spanlen;                                       \
+  } while (0)
+#define PUTPAD(c, len)                          \
+  do {                                          \
+    size_t padlen = (len);                      \
+    RESERVE(padlen);                            \
+    MEMSET(result + resultstored, (c), padlen); \
+    resultstored += padlen;                     \
   } while (0)
 #elif STYLE == VDPRINTF
 int NAME(int fd, locale_t locale, const char_t *format, va_list ap) {
@@ -294,9 +478,8 @@ int NAME(int fd, locale_t locale, const char_t *format, va_list ap) {
     ++resultwritten;                                                    \
   } while (0)
 #else
-#define PUTCHAR(c)                                   \
+#define FLUSH_FULL()                                 \
   do {                                               \
-    result[resultstored++] = (c);                    \
     while (resultstored == sizeof(result)) {         \
       ssize_t l = write(fd, result, sizeof(result)); \
       if (l == -1)                                   \
@@ -304,7 +487,42 @@ int NAME(int fd, locale_t locale, const char_t *format, va_list ap) {
       memmove(result, result + l, resultstored - l); \
       resultstored -= l;                             \
     }                                                \
-    ++resultwritten;                                 \
+  } while (0)
+#define PUTCHAR(c)                \
+  do {                            \
+    result[resultstored++] = (c); \
+    FLUSH_FULL();                 \
+    ++resultwritten;              \
+  } while (0)
+#define PUTSPAN(str, len)                           \
+  do {                                              \
+    const char *span = (str);                       \
+    size_t spanlen = (len);                         \
+    resultwritten += spanlen;                       \
+    while (spanlen > 0) {                           \
+      size_t chunk = sizeof(result) - resultstored; \
+      if (chunk > spanlen)                          \
+        chunk = spanlen;                            \
+      memcpy(result + resultstored, span, chunk);   \
+      resultstored += chunk;                        \
+      span += chunk;                                \
+      spanlen -= chunk;                             \
+      FLUSH_FULL();                                 \
+    }                                               \
+  } while (0)
+#define PUTPAD(c, len)                              \
+  do {                                              \
+    size_t padlen = (len);                          \
+    resultwritten += padlen;                        \
+    while (padlen > 0) {                            \
+      size_t chunk = sizeof(result) - resultstored; \
+      if (chunk > padlen)                           \
+        chunk = padlen;                             \
+      memset(result + resultstored, (c), chunk);    \
+      resultstored += chunk;                        \
+      padlen -= chunk;                              \
+      FLUSH_FULL();                                 \
+    }                                               \
   } while (0)
 #endif
 #elif STYLE == VFPRINTF
@@ -329,6 +547,36 @@ int NAME(FILE *stream, locale_t locale, const char_t *format, va_list ap) {
     }                                      \
     ++resultwritten;                       \
   } while (0)
+// Copy runs directly into the write buffer of the stream, instead of
+// going through putc_unlocked() for every character.
+#define PUTSPAN(str, len)                                              \
+  do {                                                                 \
+    const char *span = (str);                                          \
+    size_t spanlen = (len);                                            \
+    if (spanlen > 0 && fwrite_put(stream, span, spanlen) != spanlen) { \
+      funlockfile(stream);                                             \
+      return -1;                                                       \
+    }                                                                  \
+    resultwritten += spanlen;                                          \
+  } while (0)
+#define PUTPAD(c, len)                                     \
+  do {                                                     \
+    size_t padlen = (len);                                 \
+    resultwritten += padlen;                               \
+    while (padlen > 0) {                                   \
+      char *writebuf;                                      \
+      size_t writebuflen;                                  \
+      if (!fwrite_peek(stream, &writebuf, &writebuflen)) { \
+        funlockfile(stream);                               \
+        return -1;                                         \
+      }                                                    \
+      if (writebuflen > padlen)                            \
+        writebuflen = padlen;                              \
+      memset(writebuf, (c), writebuflen);                  \
+      fwrite_produce(stream, writebuflen);                 \
+      padlen -= writebuflen;                               \
+    }                                                      \
+  } while (0)
 #endif
 #elif STYLE == VSNPRINTF
 int NAME(char_t *s, size_t n, locale_t locale, const char_t *format,
@@ -341,13 +589,75 @@ int NAME(char_t *s, size_t n, locale_t locale, const char_t *format,
       s[resultstored] = ch;   \
     ++resultstored;           \
   } while (0)
+// Runs are truncated to the space remaining in the buffer, leaving
+// room for the trailing null character.
+#define PUTSPAN(str, len)                                           \
+  do {                                                              \
+    const char_t *span = (str);                                     \
+    size_t spanlen = (len);                                         \
+    if (resultstored + 1 < n) {                                     \
+      size_t avail = n - 1 - resultstored;                          \
+      memcpy(s + resultstored, span,                                \
+             (spanlen < avail ? spanlen : avail) * sizeof(char_t)); \
+    }                                                               \
+    resultstored += spanlen;                                        \
+  } while (0)
+#define PUTPAD(c, len)                                                \
+  do {                                                                \
+    size_t padlen = (len);                                            \
+    if (resultstored + 1 < n) {                                       \
+      size_t avail = n - 1 - resultstored;                            \
+      MEMSET(s + resultstored, (c), padlen < avail ? padlen : avail); \
+    }                                                                 \
+    resultstored += padlen;                                           \
+  } while (0)
 #else
 #error "Unknown style"
 #endif
+#ifndef PUTSPAN
+#define PUTSPAN(str, len)                \
+  do {                                   \
+    const char_t *span = (str);          \
+    size_t spanlen = (len);              \
+    for (size_t i = 0; i < spanlen; ++i) \
+      PUTCHAR(span[i]);                  \
+  } while (0)
+#define PUTPAD(c, len)                  \
+  do {                                  \
+    size_t padlen = (len);              \
+    for (size_t i = 0; i < padlen; ++i) \
+      PUTCHAR(c);                       \
+  } while (0)
+#endif
+
+// Writes a run of narrow characters, such as converted digits. These
+// need to be widened one by one for the wide character functions.
+#if WIDE
+#define PUTNARROW(str, len)                \
+  do {                                     \
+    const char *narrow = (str);            \
+    size_t narrowlen = (len);              \
+    for (size_t i = 0; i < narrowlen; ++i) \
+      PUTCHAR(narrow[i]);                  \
+  } while (0)
+#else
+#define PUTNARROW(str, len) PUTSPAN(str, len)
+#endif
+
   // Save current errno for %m.
   int saved_errno = errno;
 
+#if WIDE
+  const struct printf_format *compiled = NULL;
   size_t numarg_max = get_numarg_max(format);
+#else
+  // Format strings stored in read-only memory only need to be parsed
+  // once. Others are parsed while being printed.
+  const struct printf_format *compiled =
+      __printf_cache_get(format, compile_format);
+  size_t numarg_max =
+      compiled != NULL ? compiled->numarg_max : get_numarg_max(format);
+#endif
   if (numarg_max > 0) {
     // Numbered arguments require us to construct a table with all
     // argument values explicitly, as va_lists cannot be accessed
@@ -362,7 +672,7 @@ int NAME(char_t *s, size_t n, locale_t locale, const char_t *format,
       // proper type.
       get_numarg_values(numarg_max, numarg_types, numarg_values, ap);
     }
-#define PARSE_ARGNUM(field) size_t field = get_numarg(&format) - 1
+#define NUMBERED true
 #define GET_ARG_SINT_T(type, index) ((type)numarg_values[index].v_sint)
 #define GET_ARG_UINT_T(type, index) ((type)numarg_values[index].v_uint)
 #define GET_ARG_POINTER_T(type, index) \
@@ -370,21 +680,21 @@ int NAME(char_t *s, size_t n, locale_t locale, const char_t *format,
 #define GET_ARG_FLOAT_T(type, index) ((type)numarg_values[index].v_float)
 #define LABEL(n) n##_1
 #include "vprintf_body.h"
-#undef PARSE_ARGNUM
+#undef NUMBERED
 #undef GET_ARG_SINT_T
 #undef GET_ARG_UINT_T
 #undef GET_ARG_POINTER_T
 #undef GET_ARG_FLOAT_T
 #undef LABEL
   } else {
-#define PARSE_ARGNUM(field)
+#define NUMBERED false
 #define GET_ARG_SINT_T(type, index) va_arg(ap, type)
 #define GET_ARG_UINT_T(type, index) va_arg(ap, type)
 #define GET_ARG_POINTER_T(type, index) va_arg(ap, const type *)
 #define GET_ARG_FLOAT_T(type, index) va_arg(ap, type)
 #define LABEL(n) n##_2
 #include "vprintf_body.h"
-#undef PARSE_ARGNUM
+#undef NUMBERED
 #undef GET_ARG_SINT_T
 #undef GET_ARG_UINT_T
 #undef GET_ARG_POINTER_T
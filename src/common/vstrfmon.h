@@ -9,7 +9,6 @@
 #include <assert.h>
 #include <errno.h>
 #include <fenv.h>
-#include <float.h>
 #include <limits.h>
 #include <math.h>
 #include <stdarg.h>
@@ -334,11 +333,11 @@ ssize_t NAME(char_t *restrict s, size_t maxsize, locale_t locale,
               !negative, separator, opposite_sep_by_space, locale);
 
         // Convert floating point value to decimal digits.
-        unsigned char digits[DECIMAL_DIG];
+        unsigned char digits[F10DEC_DOUBLE_DIG];
         size_t ndigits = sizeof(digits);
         int exponent;
-        __f10dec(value, right_precision, digits, &ndigits, &exponent,
-                 fegetround());
+        __f10dec_double(value, right_precision, digits, &ndigits, &exponent,
+                        fegetround());
 
         // Determine the number of characters printed before the decimal point.
         struct numeric_grouping numeric_grouping;
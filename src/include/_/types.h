@@ -217,13 +217,14 @@ typedef struct __lockable __pthread_lock {
   _Atomic(__uint32_t) __state;  // Kernelspace futex.
   __int32_t __write_recursion;  // Userspace write recursion counter.
   __uint8_t __pshared;
+  _Atomic(__uint16_t) __spin_estimate;  // Adaptive spinning estimate.
 } __pthread_lock_t;
 typedef struct {
   __pthread_lock_t __lock;
   __pthread_cond_t __cond;
   __uint32_t __init;
-  __uint32_t __remaining;
-  __uint32_t __generation;
+  _Atomic(__uint32_t) __remaining;
+  _Atomic(__uint32_t) __generation;
 } __pthread_barrier_t;
 typedef struct {
   _Atomic(__uint32_t) __state;
@@ -231,7 +232,7 @@ typedef struct {
 typedef struct {
   __pthread_lock_t __lock;
   __pthread_cond_t __cond;
-  __uint32_t __value;
+  _Atomic(__uint32_t) __value;
 } __sem_t;
 
 _Static_assert(sizeof(__pthread_barrier_t) == 36, "ABI broken");
@@ -243,6 +244,7 @@ _Static_assert(sizeof(__sem_t) == 28, "ABI broken");
 typedef struct {
   int __detachstate;
   __size_t __stacksize;
+  __size_t __guardsize;
 } __pthread_attr_t;
 typedef struct {
   int __pshared;
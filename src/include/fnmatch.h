@@ -26,6 +26,11 @@
 // Extensions:
 // - fnmatch_l():
 //   fnmatch() always uses the C locale.
+// - fnm_t, fnmcomp(), fnmexec() and fnmfree():
+//   Allows for matching a pattern against many strings, without
+//   processing the pattern every time.
+// - fnmcomp_l() and fnmexec_l():
+//   fnmcomp() and fnmexec() always use the C locale.
 
 #ifndef _FNMATCH_H_
 #define _FNMATCH_H_
@@ -38,9 +43,20 @@
 #define FNM_PERIOD 0x40
 #define FNM_NOESCAPE 0x80
 
+typedef struct {
+  __char32_t *__pattern;
+  __size_t __len;
+  int __flags;
+} fnm_t;
+
 __BEGIN_DECLS
 int fnmatch(const char *, const char *, int);
 int fnmatch_l(const char *, const char *, int, __locale_t);
+int fnmcomp(fnm_t *__restrict, const char *__restrict, int);
+int fnmcomp_l(fnm_t *__restrict, const char *__restrict, int, __locale_t);
+int fnmexec(const fnm_t *__restrict, const char *__restrict);
+int fnmexec_l(const fnm_t *__restrict, const char *__restrict, __locale_t);
+void fnmfree(fnm_t *);
 __END_DECLS
 
 #endif
@@ -63,7 +63,7 @@
 #define RE_DUP_MAX 255
 // RTSIG_MAX: Realtime signals are not supported.
 // SEM_NSEMS_MAX: Indeterminate.
-#define SEM_VALUE_MAX _UINT32_MAX
+#define SEM_VALUE_MAX _INT32_MAX
 // SIGQUEUE_MAX: Signal handling is not available.
 // STREAM_MAX: Streams are not supported.
 // SYMLOOP_MAX: Indeterminate.
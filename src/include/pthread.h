@@ -36,8 +36,15 @@
 // - pthread_cond_timedwait_relative_np():
 //   Identical to pthread_cond_timedwait(), except that it uses a
 //   relative timeout on the monotonic clock. Also present on macOS.
+// - pthread_lockprof_report_np(), pthread_lockprof_start_np() and
+//   pthread_lockprof_stop_np():
+//   Gathers statistics on acquisitions of mutexes and rwlocks, allowing
+//   contended locks to be identified.
 // - pthread_mutex_lock_pair_np():
 //   Acquires two locks using a deadlock avoidance algorithm.
+// - pthread_setstackcachesize_np():
+//   Sets the number of stacks of joined threads that are kept around
+//   for reuse by pthread_create(). Defaults to 8 and is at most 64.
 //
 // Features missing:
 // - PTHREAD_CANCEL_ASYNCHRONOUS, PTHREAD_CANCEL_ENABLE,
@@ -54,8 +61,6 @@
 //   pthread_mutex_getprioceiling(), pthread_mutex_setprioceiling(),
 //   pthread_mutexattr_getprioceiling() and pthread_mutexattr_setprioceiling():
 //   Mutexes always use PTHREAD_PRIO_INHERIT.
-// - pthread_attr_getguardsize() and pthread_attr_setguardsize():
-//   Guard size cannot be configured.
 // - pthread_attr_getschedparam() and pthread_attr_setschedparam():
 //   Scheduler interaction not available.
 
@@ -95,13 +100,13 @@
 #define PTHREAD_COND_INITIALIZER \
   { _PTHREAD_FUTEX_INITIALIZER(0), 3, PTHREAD_PROCESS_PRIVATE }
 #define PTHREAD_MUTEX_INITIALIZER \
-  { _PTHREAD_FUTEX_INITIALIZER(0), -1, PTHREAD_PROCESS_PRIVATE }
+  { _PTHREAD_FUTEX_INITIALIZER(0), -1, PTHREAD_PROCESS_PRIVATE, 0 }
 #define PTHREAD_ONCE_INIT \
   { _PTHREAD_FUTEX_INITIALIZER(0x80000000) }
 #define PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP \
-  { _PTHREAD_FUTEX_INITIALIZER(0), 0, PTHREAD_PROCESS_PRIVATE }
+  { _PTHREAD_FUTEX_INITIALIZER(0), 0, PTHREAD_PROCESS_PRIVATE, 0 }
 #define PTHREAD_RWLOCK_INITIALIZER \
-  { _PTHREAD_FUTEX_INITIALIZER(0), -1, PTHREAD_PROCESS_PRIVATE }
+  { _PTHREAD_FUTEX_INITIALIZER(0), -1, PTHREAD_PROCESS_PRIVATE, 0 }
 
 #ifndef _PTHREAD_ATTR_T_DECLARED
 typedef __pthread_attr_t pthread_attr_t;
@@ -190,10 +195,13 @@ __BEGIN_DECLS
 int pthread_atfork(void (*)(void), void (*)(void), void (*)(void));
 int pthread_attr_destroy(pthread_attr_t *);
 int pthread_attr_getdetachstate(const pthread_attr_t *, int *);
+int pthread_attr_getguardsize(const pthread_attr_t *__restrict,
+                              size_t *__restrict);
 int pthread_attr_getstacksize(const pthread_attr_t *__restrict,
                               size_t *__restrict);
 int pthread_attr_init(pthread_attr_t *);
 int pthread_attr_setdetachstate(pthread_attr_t *, int);
+int pthread_attr_setguardsize(pthread_attr_t *, size_t);
 int pthread_attr_setstacksize(pthread_attr_t *, size_t);
 int pthread_barrier_destroy(pthread_barrier_t *);
 int pthread_barrier_init(pthread_barrier_t *__restrict,
@@ -237,6 +245,9 @@ void *pthread_getspecific(pthread_key_t);
 int pthread_join(pthread_t, void **);
 int pthread_key_create(pthread_key_t *, void (*)(void *));
 int pthread_key_delete(pthread_key_t);
+int pthread_lockprof_report_np(int);
+int pthread_lockprof_start_np(void);
+int pthread_lockprof_stop_np(void);
 int pthread_mutex_destroy(pthread_mutex_t *__mutex)
     __requires_unlocked(*__mutex);
 int pthread_mutex_init(pthread_mutex_t *__restrict __mutex,
@@ -293,6 +304,7 @@ int pthread_rwlockattr_init(pthread_rwlockattr_t *);
 int pthread_rwlockattr_setpshared(pthread_rwlockattr_t *, int);
 pthread_t pthread_self(void);
 int pthread_setspecific(pthread_key_t, const void *);
+int pthread_setstackcachesize_np(size_t);
 int pthread_spin_destroy(pthread_spinlock_t *__lock)
     __requires_unlocked(*__lock);
 int pthread_spin_init(pthread_spinlock_t *__lock, int)
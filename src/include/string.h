@@ -24,8 +24,10 @@
 // <string.h> - string operations
 //
 // Extensions:
-// - memmem(), memrchr(), strlcat() and strlcpy(), strsep():
+// - memmem(), memrchr(), strchrnul(), strlcat() and strlcpy(), strsep():
 //   Available on many commonly used operating systems.
+// - rawmemchr():
+//   Present on Linux.
 // - strsignal_l():
 //   strsignal() always uses the C locale.
 // - strverscmp():
@@ -61,8 +63,10 @@ void *memmem(const void *, size_t, const void *, size_t) __pure;
 void *memmove(void *, const void *, size_t);
 void *memrchr(const void *, int, size_t) __pure;
 void *memset(void *, int, size_t);
+void *rawmemchr(const void *, int) __pure;
 char *stpncpy(char *__restrict, const char *__restrict, size_t);
 char *strchr(const char *, int) __pure;
+char *strchrnul(const char *, int) __pure;
 int strcmp(const char *, const char *) __pure;
 int strcoll(const char *, const char *) __pure;
 int strcoll_l(const char *, const char *, locale_t) __pure;
@@ -96,7 +100,9 @@ __END_DECLS
 #define memmem(s1, s1len, s2, s2len) \
   __preserve_const(void, memmem, s1, s1, s1len, s2, s2len)
 #define memrchr(s, c, n) __preserve_const(void, memrchr, s, s, c, n)
+#define rawmemchr(s, c) __preserve_const(void, rawmemchr, s, s, c)
 #define strchr(s, n) __preserve_const(char, strchr, s, s, n)
+#define strchrnul(s, n) __preserve_const(char, strchrnul, s, s, n)
 #define strpbrk(s1, s2) __preserve_const(char, strpbrk, s1, s1, s2)
 #define strrchr(s, n) __preserve_const(char, strrchr, s, s, n)
 #define strstr(s1, s2) __preserve_const(char, strstr, s1, s1, s2)
@@ -23,18 +23,29 @@
 
 // <uv.h> - event loops
 //
+// Extensions:
+// - uv_loop_subscription_stats_np():
+//   Returns the number of subscriptions that the loop could reuse and
+//   that it had to rebuild when polling for events, which is useful for
+//   analyzing the performance of loops with many handles.
+// - uv_threadpool_set_size_np():
+//   Sets the number of threads of the thread pool used by work and file
+//   system requests, which is otherwise equal to the number of CPUs.
+//   Must be called before the first request is submitted, as this
+//   environment does not provide the UV_THREADPOOL_SIZE environment
+//   variable. The size is at most 128.
+//
 // Features missing:
-// - UV_CONNECT, UV_UDP_IPV6ONLY, UV_UDP_REUSEADDR, UV_UDP_SEND,
-//   uv_connect_cb, uv_connect_t, uv_connection_cb, uv_membership,
-//   uv_udp_send_cb, uv_udp_send_t, uv_udp_t::send_queue_count,
-//   uv_udp_t::send_queue_size, uv_listen(), uv_pipe_bind(),
-//   uv_pipe_chmod(), uv_pipe_connect(), uv_pipe_pending_instances(),
-//   uv_tcp_bind(), uv_tcp_connect(), uv_tcp_simultaneous_accepts(),
-//   uv_udp_bind(), uv_udp_send(), uv_udp_set_broadcast(),
-//   uv_udp_set_membership(), uv_udp_set_multicast_interface(),
-//   uv_udp_set_multicast_loop(), uv_udp_set_multicast_ttl(),
-//   uv_udp_set_ttl() and uv_udp_try_send():
-//   Requires global network namespace.
+// - UV_CONNECT, UV_UDP_IPV6ONLY, UV_UDP_REUSEADDR, uv_connect_cb,
+//   uv_connect_t, uv_connection_cb, uv_membership, uv_listen(),
+//   uv_pipe_bind(), uv_pipe_chmod(), uv_pipe_connect(),
+//   uv_pipe_pending_instances(), uv_tcp_bind(), uv_tcp_connect(),
+//   uv_tcp_simultaneous_accepts(), uv_udp_bind(),
+//   uv_udp_set_broadcast(), uv_udp_set_membership(),
+//   uv_udp_set_multicast_interface(), uv_udp_set_multicast_loop(),
+//   uv_udp_set_multicast_ttl() and uv_udp_set_ttl():
+//   Requires global network namespace. uv_udp_send() and
+//   uv_udp_try_send() can only be used on connected sockets.
 // - UV_FS_ACCESS, UV_FS_CHMOD, UV_FS_CHOWN, UV_FS_COPYFILE, UV_FS_LINK,
 //   UV_FS_LSTAT, UV_FS_MKDIR, UV_FS_MKDTEMP, UV_FS_O_*, UV_FS_READLINK,
 //   UV_FS_REALPATH, UV_FS_RENAME, UV_FS_RMDIR, UV_FS_SCANDIR,
@@ -177,6 +188,7 @@ UV_HANDLE_TYPE_MAP(_UV_STRUCT_TYPE)
   func(GETNAMEINFO, getnameinfo) \
   func(REQ, req)                 \
   func(SHUTDOWN, shutdown)       \
+  func(UDP_SEND, udp_send)       \
   func(WORK, work)               \
   func(WRITE, write)
 
@@ -420,18 +432,14 @@ struct __uv_queue_link {
 _UV_CIRCLEBUF_DECLARE_STRUCTURES(__uv_pending_fds, int);
 _UV_HEAP_DECLARE_STRUCTURES(__uv_active_timers, uv_timer_t);
 _UV_SLIST_DECLARE_STRUCTURES(__uv_closing_handles, uv_handle_t);
-_UV_TAILQ_DECLARE_STRUCTURES(__uv_active_asyncs);
 _UV_TAILQ_DECLARE_STRUCTURES(__uv_active_checks);
 _UV_TAILQ_DECLARE_STRUCTURES(__uv_active_idles);
 _UV_TAILQ_DECLARE_STRUCTURES(__uv_active_prepares);
-_UV_TAILQ_DECLARE_STRUCTURES(__uv_active_processes);
 _UV_TAILQ_DECLARE_STRUCTURES(__uv_handles);
-_UV_TAILQ_DECLARE_STRUCTURES(__uv_reading_polls);
-_UV_TAILQ_DECLARE_STRUCTURES(__uv_reading_streams);
 _UV_TAILQ_DECLARE_STRUCTURES(__uv_shutdowns);  // TODO(ed): Use STAILQ?
+_UV_TAILQ_DECLARE_STRUCTURES(__uv_udp_sends);
+_UV_TAILQ_DECLARE_STRUCTURES(__uv_works);
 _UV_TAILQ_DECLARE_STRUCTURES(__uv_writes);     // TODO(ed): Use STAILQ?
-_UV_TAILQ_DECLARE_STRUCTURES(__uv_writing_polls);
-_UV_TAILQ_DECLARE_STRUCTURES(__uv_writing_streams);
 
 //
 // Version-checking macros and functions.
@@ -463,24 +471,43 @@ typedef struct uv_loop_s {
 
   struct __uv_handles_head __handles;
 
-  struct __uv_active_asyncs_head __active_asyncs;
   struct __uv_active_checks_head __active_checks;
   struct __uv_active_idles_head __active_idles;
   struct __uv_active_prepares_head __active_prepares;
-  struct __uv_active_processes_head __active_processes;
   struct __uv_active_timers_head __active_timers;
   struct __uv_closing_handles_head __closing_handles;
-  struct __uv_reading_polls_head __reading_polls;
-  struct __uv_reading_streams_head __reading_streams;
-  struct __uv_writing_polls_head __writing_polls;
-  struct __uv_writing_streams_head __writing_streams;
 
   size_t __active_ref_handles_reqs;
 
-  void *__events_buffer;
-  size_t __events_capacity;
+  // Write and send requests that have been completed without
+  // blocking, but whose callbacks still need to be invoked.
+  struct __uv_writes_head __pending_writes;
+  struct __uv_udp_sends_head __pending_udp_sends;
+
+  // Work requests that have been completed by the thread pool, but
+  // whose callbacks still need to be invoked on the loop.
+  __pthread_lock_t __work_lock;
+  struct __uv_works_head __completed_works;
+  size_t __active_works;
+  int __work_readfd;
+  int __work_writefd;
+
+  // Subscriptions on which the loop polls. Handles waiting for events
+  // own a slot in this array, so that it only needs to be modified when
+  // handles are started or stopped. The number of subscriptions that
+  // could be reused and that had to be rebuilt since the previous poll
+  // are accumulated in the counters below, which can be obtained
+  // through uv_loop_subscription_stats_np().
   void *__subscriptions_buffer;
+  size_t **__subscriptions_slots;
+  size_t __subscriptions_count;
   size_t __subscriptions_capacity;
+  size_t __subscriptions_modified;
+  uint64_t __subscriptions_reused;
+  uint64_t __subscriptions_rebuilt;
+
+  void *__events_buffer;
+  size_t __events_capacity;
 } uv_loop_t;
 
 typedef enum {
@@ -497,6 +524,8 @@ int uv_loop_alive(const uv_loop_t *);
 int uv_loop_close(uv_loop_t *);
 int uv_loop_init(uv_loop_t *);
 size_t uv_loop_size(void);
+void uv_loop_subscription_stats_np(const uv_loop_t *, uint64_t *,
+                                   uint64_t *);
 uint64_t uv_now(const uv_loop_t *);
 int uv_run(uv_loop_t *, uv_run_mode);
 void uv_stop(uv_loop_t *);
@@ -645,7 +674,7 @@ struct uv_async_s {
   __uint32_t __readfd;
   __uint32_t __writefd;
   uv_async_cb __cb;
-  struct __uv_active_asyncs_entry __uv_active_asyncs_entry;
+  size_t __slot;
 };
 
 __BEGIN_DECLS
@@ -667,8 +696,8 @@ struct uv_poll_s {
   int __events;
   int __status;
   int __revents;
-  struct __uv_reading_polls_entry __uv_reading_polls_entry;
-  struct __uv_writing_polls_entry __uv_writing_polls_entry;
+  size_t __read_slot;
+  size_t __write_slot;
 };
 
 enum uv_poll_event {
@@ -695,7 +724,7 @@ struct uv_process_s {
 
   uv_exit_cb __cb;
   int __fd;
-  struct __uv_active_processes_entry __uv_active_processes_entry;
+  size_t __slot;
 };
 
 __BEGIN_DECLS
@@ -723,8 +752,8 @@ struct uv_stream_s {
   struct __uv_shutdowns_head __shutdown_queue;                  \
   struct __uv_writes_head __write_queue;                        \
   struct __uv_pending_fds_head __pending_fds;                   \
-  struct __uv_reading_streams_entry __uv_reading_streams_entry; \
-  struct __uv_writing_streams_entry __uv_writing_streams_entry;
+  size_t __read_slot;                                           \
+  size_t __write_slot;
   _UV_STREAM_FIELDS
 };
 
@@ -747,7 +776,9 @@ struct uv_write_s {
   unsigned int __nbufs_done;
   unsigned int __nbufs_total;
   uv_write_cb __cb;
+  int __status;
   struct __uv_writes_entry __uv_writes_entry;
+  uv_buf_t __bufsml[4];
 };
 
 __BEGIN_DECLS
@@ -815,13 +846,41 @@ __END_DECLS
 
 typedef void (*uv_udp_recv_cb)(uv_udp_t *, ssize_t, const uv_buf_t *,
                                const struct sockaddr *, unsigned int);
+typedef void (*uv_udp_send_cb)(uv_udp_send_t *, int);
 
 struct uv_udp_s {
   _UV_HANDLE_FIELDS
+
+  size_t send_queue_size;
+  size_t send_queue_count;
+
+  int __fd;
+  unsigned int __flags;
+  uv_alloc_cb __alloc_cb;
+  uv_udp_recv_cb __recv_cb;
+  struct __uv_udp_sends_head __send_queue;
+  size_t __read_slot;
+  size_t __write_slot;
+};
+
+struct uv_udp_send_s {
+  _UV_REQ_FIELDS
+
+  uv_udp_t *handle;
+
+  uv_buf_t *__bufs;
+  unsigned int __nbufs;
+  uv_udp_send_cb __cb;
+  int __status;
+  struct __uv_udp_sends_entry __uv_udp_sends_entry;
+  uv_buf_t __bufsml[4];
 };
 
 enum uv_udp_flags {
   UV_UDP_PARTIAL = 0x1,
+  UV_UDP_MMSG_CHUNK = 0x8,
+  UV_UDP_MMSG_FREE = 0x10,
+  UV_UDP_RECVMMSG = 0x100,
 };
 
 __BEGIN_DECLS
@@ -830,6 +889,11 @@ int uv_udp_init_ex(uv_loop_t *, uv_udp_t *, unsigned int);
 int uv_udp_open(uv_udp_t *, uv_os_sock_t);
 int uv_udp_recv_start(uv_udp_t *, uv_alloc_cb, uv_udp_recv_cb);
 int uv_udp_recv_stop(uv_udp_t *);
+int uv_udp_send(uv_udp_send_t *, uv_udp_t *, const uv_buf_t *, unsigned int,
+                const struct sockaddr *, uv_udp_send_cb);
+int uv_udp_try_send(uv_udp_t *, const uv_buf_t *, unsigned int,
+                    const struct sockaddr *);
+int uv_udp_using_recvmmsg(const uv_udp_t *);
 __END_DECLS
 
 //
@@ -867,9 +931,16 @@ typedef enum {
 } uv_fs_type;
 
 struct uv_fs_s {
-#define _UV_WORK_FIELDS \
-  _UV_REQ_FIELDS        \
-  uv_loop_t *loop;
+#define _UV_WORK_FIELDS                       \
+  _UV_REQ_FIELDS                              \
+  uv_loop_t *loop;                            \
+                                              \
+  void (*__work_cb)(uv_work_t *);             \
+  void (*__after_work_cb)(uv_work_t *, int);  \
+  int __work_state;                           \
+  int __work_status;                          \
+  size_t __work_queue;                        \
+  struct __uv_works_entry __uv_works_entry;
 
   _UV_WORK_FIELDS
 
@@ -877,6 +948,8 @@ struct uv_fs_s {
   ssize_t result;
   uv_stat_t statbuf;
 
+  __ssize_t (*__work)(uv_fs_t *);
+  void (*__cb)(uv_fs_t *);
   union {
     struct {
       uv_file __file;
@@ -899,6 +972,26 @@ struct uv_fs_s {
       double __atime;
       double __mtime;
     } __futime;
+    struct {
+      uv_file __file;
+      uv_buf_t *__bufs;
+      unsigned int __nbufs;
+      int64_t __offset;
+      uv_buf_t __bufsml[4];
+    } __read;
+    struct {
+      uv_file __out_fd;
+      uv_file __in_fd;
+      int64_t __in_offset;
+      size_t __length;
+    } __sendfile;
+    struct {
+      uv_file __file;
+      uv_buf_t *__bufs;
+      unsigned int __nbufs;
+      int64_t __offset;
+      uv_buf_t __bufsml[4];
+    } __write;
   } __arguments;
 };
 
@@ -934,6 +1027,7 @@ typedef void (*uv_after_work_cb)(uv_work_t *, int);
 
 __BEGIN_DECLS
 int uv_queue_work(uv_loop_t *, uv_work_t *, uv_work_cb, uv_after_work_cb);
+int uv_threadpool_set_size_np(size_t);
 __END_DECLS
 
 //
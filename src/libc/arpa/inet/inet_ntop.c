@@ -2,31 +2,42 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <common/itoa.h>
+
 #include <sys/socket.h>
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
 
 #include <errno.h>
-#include <inttypes.h>
 #include <stdbool.h>
-#include <stdio.h>
+#include <stdint.h>
 #include <string.h>
 
+// Formats an IPv4 address in dotted decimal notation.
+static char *format_inet(char *buf, const uint8_t *src) {
+  for (size_t i = 0; i < 4; ++i) {
+    if (i > 0)
+      *buf++ = '.';
+    buf = itoa10_append(buf, src[i]);
+  }
+  return buf;
+}
+
 static const char *inet_ntop_inet(const uint8_t *restrict src,
                                   char *restrict dst, size_t size) {
   // Format the address.
   char buf[INET_ADDRSTRLEN];
-  size_t len =
-      snprintf(buf, sizeof(buf), "%" PRIu8 ".%" PRIu8 ".%" PRIu8 ".%" PRIu8,
-               src[0], src[1], src[2], src[3]);
+  char *bufend = format_inet(buf, src);
+  *bufend++ = '\0';
 
   // Copy it back.
-  if (len >= size) {
+  size_t len = bufend - buf;
+  if (len > size) {
     errno = ENOSPC;
     return NULL;
   }
-  strlcpy(dst, buf, size);
+  memcpy(dst, buf, len);
   return dst;
 }
 
@@ -56,27 +67,26 @@ static const char *inet_ntop_inet6(const struct in6_addr *restrict src,
   char buf[INET6_ADDRSTRLEN];
   char *bufend = buf;
   size_t i = 0;
-  int strip_colon = 1;
+  bool strip_colon = true;
   bool ipv4 = IN6_IS_ADDR_V4COMPAT(src) || IN6_IS_ADDR_V4MAPPED(src);
   do {
-    size_t bufsize = buf + sizeof(buf) - bufend;
     if (i == 6 && ipv4) {
       // End address with IPv4 representation of the last four bytes.
-      bufend +=
-          snprintf(bufend, bufsize,
-                   &":%" PRIu8 ".%" PRIu8 ".%" PRIu8 ".%" PRIu8[strip_colon],
-                   src->s6_addr[12], src->s6_addr[13], src->s6_addr[14],
-                   src->s6_addr[15]);
+      if (!strip_colon)
+        *bufend++ = ':';
+      bufend = format_inet(bufend, &src->s6_addr[12]);
       break;
     } else if (i == zeroes_best.start && zeroes_best.len > 1) {
       *bufend++ = ':';
       *bufend++ = ':';
       i += zeroes_best.len;
-      strip_colon = 1;
+      strip_colon = true;
     } else {
-      bufend += snprintf(bufend, bufsize, &":%" PRIx16[strip_colon], groups[i]);
+      if (!strip_colon)
+        *bufend++ = ':';
+      bufend = itoa16_append(bufend, groups[i], "0123456789abcdef");
       ++i;
-      strip_colon = 0;
+      strip_colon = false;
     }
   } while (i < __arraycount(groups));
   *bufend++ = '\0';
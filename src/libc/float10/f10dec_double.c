@@ -0,0 +1,275 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/float10.h>
+#include <common/itoa.h>
+
+#include <assert.h>
+#include <fenv.h>
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// Exact conversion of doubles to decimal digits.
+//
+// Every finite double has a finite decimal expansion, as it is an
+// integer multiplied by a power of two. This function computes this
+// expansion using a big number stored in base 10^9, so that every limb
+// yields nine decimal digits. Positive exponents are applied by
+// multiplying the big number by powers of two. Negative exponents are
+// applied by dividing it by powers of two, which adds limbs at the end.
+//
+// Only the digits needed to satisfy the requested precision are
+// retained. As divisions only propagate remainders towards the least
+// significant limbs, limbs beyond a fixed position after the radix
+// character can be discarded right away, as long as we keep track of
+// whether any of them were non-zero. This is sufficient to round the
+// digits correctly.
+
+#if DBL_MANT_DIG != 53
+#error "Unsupported format"
+#endif
+
+#define LIMB_BASE 1000000000
+#define LIMB_DIGITS 9
+
+// Largest shift that can be applied to a limb in a single step. For
+// divisions, 2^9 is the largest power of two that divides 10^9.
+#define MUL_SHIFT 29
+#define DIV_SHIFT 9
+
+// Number of limbs needed to store the big number. Each division step
+// adds at most one limb, while multiplications never yield more limbs
+// than that.
+#define NLIMBS ((DBL_MANT_DIG - DBL_MIN_EXP + DIV_SHIFT - 1) / DIV_SHIFT + 2)
+
+// Writes a limb as a fixed number of decimal digits.
+static void expand_limb(unsigned char *digits, uint32_t limb, size_t ndigits) {
+  while (ndigits > 0) {
+    digits[--ndigits] = limb % 10;
+    limb /= 10;
+  }
+}
+
+// Returns the digits of a non-zero number that is smaller than what the
+// precision allows to be shown. Either return zero or a single one
+// digit, depending on the rounding mode.
+static void round_tiny(unsigned int precision, unsigned char *digits,
+                       size_t *ndigits, int *exponent, int round) {
+  if (round == FE_UPWARD) {
+    digits[0] = 1;
+    *ndigits = 1;
+    *exponent = 1 - (int)precision;
+  } else {
+    *ndigits = 0;
+    *exponent = 1;
+  }
+}
+
+void __f10dec_double(double value, unsigned int precision,
+                     unsigned char *digits, size_t *ndigits, int *exponent,
+                     int round) {
+  // Invert the rounding mode if the value is negative, so that the code
+  // below does not need to take the sign bit into account.
+  if (signbit(value)) {
+    if (round == FE_UPWARD)
+      round = FE_DOWNWARD;
+    else if (round == FE_DOWNWARD)
+      round = FE_UPWARD;
+  }
+
+  // Extract the significand and the exponent from the floating point
+  // value, so that value = significand * 2^shift.
+  uint64_t bits;
+  static_assert(sizeof(bits) == sizeof(value), "Size mismatch");
+  memcpy(&bits, &value, sizeof(bits));
+  uint64_t significand = bits & (((uint64_t)1 << (DBL_MANT_DIG - 1)) - 1);
+  int shift = (bits >> (DBL_MANT_DIG - 1)) & 0x7ff;
+  if (shift == 0) {
+    // Subnormal floating point value.
+    shift = DBL_MIN_EXP - DBL_MANT_DIG;
+  } else {
+    significand |= (uint64_t)1 << (DBL_MANT_DIG - 1);
+    shift += DBL_MIN_EXP - DBL_MANT_DIG - 1;
+  }
+  if (significand == 0) {
+    // Floating point value zero.
+    *exponent = 1;
+    *ndigits = 0;
+    return;
+  }
+  int trailing_zeroes = __builtin_ctzll(significand);
+  significand >>= trailing_zeroes;
+  shift += trailing_zeroes;
+
+  // Determine the number of limbs after the radix character that need
+  // to be computed to obtain the requested number of significant digits
+  // and the requested number of digits after the radix character,
+  // including one extra digit that is used for rounding. The number of
+  // significant digits is computed relative to a lower bound of the
+  // decimal exponent, derived from the binary exponent.
+  assert(*ndigits > 0 && "No buffer provided to store digits");
+  size_t max_digits =
+      *ndigits < NLIMBS * LIMB_DIGITS ? *ndigits : NLIMBS * LIMB_DIGITS;
+
+  // Bound the decimal exponent. 78913 / 2^18 approximates log10(2).
+  int binary_exponent = shift + 63 - __builtin_clzll(significand);
+  int min_exponent = binary_exponent >= 0
+                         ? binary_exponent * 78913 >> 18
+                         : -((-binary_exponent * 78913 + 262143) >> 18);
+  long long fraction_limbs =
+      ((long long)max_digits + 1 - min_exponent + LIMB_DIGITS - 1) /
+      LIMB_DIGITS;
+  if (precision <= INT_MAX &&
+      fraction_limbs > (precision + LIMB_DIGITS) / LIMB_DIGITS)
+    fraction_limbs = (precision + LIMB_DIGITS) / LIMB_DIGITS;
+
+  // Store the significand in the big number. The limbs in [first, last)
+  // are in use, with the first limb being multiplied by
+  // 10^(9 * limb_exponent). Whether any non-zero limbs have been
+  // discarded is tracked separately.
+  uint32_t limbs[NLIMBS];
+  size_t first, last;
+  int limb_exponent;
+  bool inexact = false;
+  if (shift >= 0) {
+    // Multiplications add limbs at the front. Start at the end.
+    first = last = NLIMBS;
+    limbs[--first] = significand % LIMB_BASE;
+    if (significand >= LIMB_BASE)
+      limbs[--first] = significand / LIMB_BASE;
+    limb_exponent = last - first - 1;
+
+    while (shift > 0) {
+      int step = shift < MUL_SHIFT ? shift : MUL_SHIFT;
+      uint32_t carry = 0;
+      for (size_t i = last; i-- > first;) {
+        uint64_t product = ((uint64_t)limbs[i] << step) + carry;
+        limbs[i] = product % LIMB_BASE;
+        carry = product / LIMB_BASE;
+      }
+      if (carry != 0) {
+        limbs[--first] = carry;
+        ++limb_exponent;
+      }
+      shift -= step;
+    }
+  } else {
+    // Divisions add limbs at the end. Start at the front.
+    first = last = 0;
+    if (significand >= LIMB_BASE)
+      limbs[last++] = significand / LIMB_BASE;
+    limbs[last++] = significand % LIMB_BASE;
+    limb_exponent = last - first - 1;
+
+    while (shift < 0) {
+      int step = -shift < DIV_SHIFT ? -shift : DIV_SHIFT;
+      uint32_t mask = ((uint32_t)1 << step) - 1;
+      uint32_t carry = 0;
+      for (size_t i = first; i < last; ++i) {
+        uint32_t limb = limbs[i];
+        limbs[i] = (limb >> step) + carry;
+        carry = (limb & mask) * (LIMB_BASE >> step);
+      }
+
+      // Only retain the limbs that are needed. Discarding limbs does
+      // not affect the limbs preceding it, as long as the limbs are
+      // discarded at a fixed position.
+      if (carry != 0) {
+        if ((long long)(last - first) <= limb_exponent + fraction_limbs)
+          limbs[last++] = carry;
+        else
+          inexact = true;
+      }
+      if (limbs[first] == 0) {
+        if (++first == last) {
+          // All of the digits we are interested in are zero.
+          break;
+        }
+        --limb_exponent;
+      }
+      shift += step;
+    }
+  }
+  if (first == last) {
+    round_tiny(precision, digits, ndigits, exponent, round);
+    return;
+  }
+
+  // Expand the limbs to decimal digits. Leading zeroes of the first limb
+  // are omitted.
+  unsigned char expansion[NLIMBS * LIMB_DIGITS];
+  size_t nexpansion = itoa_digits10(limbs[first]);
+  *exponent = limb_exponent * LIMB_DIGITS + nexpansion;
+  expand_limb(expansion, limbs[first], nexpansion);
+  for (size_t i = first + 1; i < last; ++i) {
+    expand_limb(expansion + nexpansion, limbs[i], LIMB_DIGITS);
+    nexpansion += LIMB_DIGITS;
+  }
+
+  // Determine the number of digits to return, taking the requested
+  // precision into account.
+  long long count = max_digits;
+  if (precision <= INT_MAX && count > (long long)precision + *exponent)
+    count = (long long)precision + *exponent;
+  if (count < 0) {
+    round_tiny(precision, digits, ndigits, exponent, round);
+    return;
+  }
+  if (count > (long long)nexpansion)
+    count = nexpansion;
+
+  // Round the number to the number of requested digits according to
+  // the provided rounding mode. Ties are rounded to even.
+  unsigned int next = 0;
+  if (count < (long long)nexpansion) {
+    next = expansion[count];
+    for (size_t i = count + 1; i < nexpansion && !inexact; ++i)
+      if (expansion[i] != 0)
+        inexact = true;
+  }
+  bool round_up;
+  switch (round) {
+    case FE_TONEAREST:
+      round_up = next > 5 ||
+                 (next == 5 && (inexact || (count > 0 &&
+                                            expansion[count - 1] % 2 != 0)));
+      break;
+    case FE_UPWARD:
+      round_up = next != 0 || inexact;
+      break;
+    default:
+      round_up = false;
+      break;
+  }
+  if (round_up) {
+    for (;;) {
+      if (count == 0) {
+        // All digits have been rounded up to zero, or there were no
+        // digits to begin with.
+        digits[0] = 1;
+        *ndigits = 1;
+        ++*exponent;
+        return;
+      }
+      if (++expansion[count - 1] <= 9)
+        break;
+      --count;
+    }
+  }
+
+  // Return the remaining digits, without any trailing zeroes.
+  while (count > 0 && expansion[count - 1] == 0)
+    --count;
+  if (count == 0) {
+    *ndigits = 0;
+    *exponent = 1;
+    return;
+  }
+  memcpy(digits, expansion, count);
+  *ndigits = count;
+}
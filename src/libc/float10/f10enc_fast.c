@@ -0,0 +1,207 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/atoi.h>
+#include <common/float10.h>
+
+#include <assert.h>
+#include <fenv.h>
+#include <float.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "f10enc_pow5.h"
+
+// Fast conversion of decimal numbers to floating point values.
+//
+// Most numbers passed to strtod() have few significant digits, like the
+// ones found in CSV and JSON files. If the significand fits in a 64-bit
+// integer, there is no need to use the big number arithmetic of the
+// double-conversion library:
+//
+// - If both the significand and the power of ten can be represented
+//   exactly, the value can be computed using a single multiplication or
+//   division, which is correctly rounded (Clinger's fast path).
+//
+// - Otherwise, the significand is multiplied by a 128-bit approximation
+//   of the power of ten (the Eisel-Lemire algorithm). The result is
+//   precise enough to round correctly, except for a small number of
+//   inputs that lie extremely close to a halfway point. These are left
+//   to the double-conversion library.
+//
+// Like the double-conversion library, these functions always round to
+// nearest. Clinger's fast path is only used when the floating point
+// rounding mode is set accordingly.
+
+// Computes the full 128-bit product of two 64-bit integers, returning
+// the lower half.
+static uint64_t mul128(uint64_t a, uint64_t b, uint64_t *high) {
+#ifdef __SIZEOF_INT128__
+  unsigned __int128 product = (unsigned __int128)a * b;
+  *high = product >> 64;
+  return product;
+#else
+  uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+  uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+  uint64_t lo_lo = a_lo * b_lo;
+  uint64_t hi_lo = a_hi * b_lo;
+  uint64_t lo_hi = a_lo * b_hi;
+  uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+  *high = a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+  return cross << 32 | (uint32_t)lo_lo;
+#endif
+}
+
+// Computes the bits of the floating point number closest to
+// significand * 10^exponent. The floating point format is described by
+// the number of explicitly stored mantissa bits, the exponent bias and
+// the range of exponents for which the value may lie exactly halfway
+// between two floating point numbers.
+static bool eisel_lemire(uint64_t significand, int exponent,
+                         int mantissa_bits, int bias, int min_round_to_even,
+                         int max_round_to_even, uint64_t *bits) {
+  int infinite_power = 2 * bias + 1;
+  if (significand == 0 || exponent < POW5_MIN) {
+    *bits = 0;
+    return true;
+  }
+  if (exponent > POW5_MAX) {
+    *bits = (uint64_t)infinite_power << mantissa_bits;
+    return true;
+  }
+
+  // Normalize the significand and multiply it by 5^exponent. Only
+  // compute the lower half of the product if the upper half doesn't
+  // provide enough bits to determine the rounding.
+  int leading_zeroes = __builtin_clzll(significand);
+  significand <<= leading_zeroes;
+  const uint64_t *pow5 = f10enc_pow5[exponent - POW5_MIN];
+  uint64_t high;
+  uint64_t low = mul128(significand, pow5[0], &high);
+  uint64_t precision_mask = UINT64_MAX >> (mantissa_bits + 3);
+  if ((high & precision_mask) == precision_mask) {
+    uint64_t high2;
+    mul128(significand, pow5[1], &high2);
+    low += high2;
+    if (low < high2)
+      ++high;
+  }
+
+  // For exponents outside of this range, the approximation of the power
+  // of five is inexact. A product that ends with all ones may then be
+  // off by one.
+  if (low == UINT64_MAX && (exponent < -27 || exponent > 55))
+    return false;
+
+  // Extract the mantissa, including one bit that is used for rounding.
+  // 217706 / 2^16 approximates log2(10).
+  int upper_bit = high >> 63;
+  int shift = upper_bit + 64 - mantissa_bits - 3;
+  uint64_t mantissa = high >> shift;
+  int power2 = ((217706 * exponent) >> 16) + 63 + upper_bit - leading_zeroes +
+               bias;
+  if (power2 <= 0) {
+    // Subnormal number. Rounding up may yield the smallest normal
+    // number, in which case the mantissa overflows into the exponent.
+    if (-power2 + 1 >= 64) {
+      *bits = 0;
+      return true;
+    }
+    mantissa >>= -power2 + 1;
+    mantissa += mantissa & 1;
+    *bits = mantissa >> 1;
+    return true;
+  }
+
+  // Round to nearest. Values exactly halfway between two floating point
+  // numbers round to even.
+  if (low <= 1 && exponent >= min_round_to_even &&
+      exponent <= max_round_to_even && (mantissa & 3) == 1 &&
+      mantissa << shift == high)
+    mantissa &= ~(uint64_t)1;
+  mantissa += mantissa & 1;
+  mantissa >>= 1;
+  if (mantissa >= (uint64_t)2 << mantissa_bits) {
+    mantissa = (uint64_t)1 << mantissa_bits;
+    ++power2;
+  }
+  mantissa &= ~((uint64_t)1 << mantissa_bits);
+  if (power2 >= infinite_power) {
+    power2 = infinite_power;
+    mantissa = 0;
+  }
+  *bits = mantissa | (uint64_t)power2 << mantissa_bits;
+  return true;
+}
+
+// Converts a string of digits to a significand. Trailing zeroes are
+// discarded by adjusting the exponent.
+static bool get_significand(const char *digits, size_t ndigits,
+                            int *exponent, uint64_t *significand) {
+  while (ndigits > 0 && digits[ndigits - 1] == '0') {
+    --ndigits;
+    ++*exponent;
+  }
+  if (ndigits > 19)
+    return false;
+  *significand = atoi10(digits, ndigits);
+  return true;
+}
+
+bool __f10enc_fast_float(const char *digits, size_t ndigits, int exponent,
+                         float *value) {
+  uint64_t significand;
+  if (!get_significand(digits, ndigits, &exponent, &significand))
+    return false;
+
+#if FLT_EVAL_METHOD == 0
+  static const float powers[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+                                 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+  if (significand <= (uint64_t)1 << FLT_MANT_DIG && exponent >= -10 &&
+      exponent <= 10 && fegetround() == FE_TONEAREST) {
+    float result = significand;
+    *value = exponent < 0 ? result / powers[-exponent]
+                          : result * powers[exponent];
+    return true;
+  }
+#endif
+
+  uint64_t bits;
+  if (!eisel_lemire(significand, exponent, FLT_MANT_DIG - 1, 2 - FLT_MIN_EXP,
+                    -17, 10, &bits))
+    return false;
+  uint32_t bits32 = bits;
+  static_assert(sizeof(bits32) == sizeof(*value), "Size mismatch");
+  memcpy(value, &bits32, sizeof(bits32));
+  return true;
+}
+
+bool __f10enc_fast_double(const char *digits, size_t ndigits, int exponent,
+                          double *value) {
+  uint64_t significand;
+  if (!get_significand(digits, ndigits, &exponent, &significand))
+    return false;
+
+#if FLT_EVAL_METHOD == 0
+  static const double powers[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  if (significand <= (uint64_t)1 << DBL_MANT_DIG && exponent >= -22 &&
+      exponent <= 22 && fegetround() == FE_TONEAREST) {
+    double result = significand;
+    *value = exponent < 0 ? result / powers[-exponent]
+                          : result * powers[exponent];
+    return true;
+  }
+#endif
+
+  uint64_t bits;
+  if (!eisel_lemire(significand, exponent, DBL_MANT_DIG - 1, 2 - DBL_MIN_EXP,
+                    -4, 23, &bits))
+    return false;
+  static_assert(sizeof(bits) == sizeof(*value), "Size mismatch");
+  memcpy(value, &bits, sizeof(bits));
+  return true;
+}
@@ -7,6 +7,9 @@
 #include <double-conversion/strtod.h>
 
 double __f10enc_get_double(const char *str, size_t len, int exponent) {
+  double value;
+  if (__f10enc_fast_double(str, len, exponent, &value))
+    return value;
   return double_conversion::Strtod(
       double_conversion::Vector<const char>(str, len), exponent);
 }
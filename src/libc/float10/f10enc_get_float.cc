@@ -7,6 +7,9 @@
 #include <double-conversion/strtod.h>
 
 float __f10enc_get_float(const char *str, size_t len, int exponent) {
+  float value;
+  if (__f10enc_fast_float(str, len, exponent, &value))
+    return value;
   return double_conversion::Strtof(
       double_conversion::Vector<const char>(str, len), exponent);
 }
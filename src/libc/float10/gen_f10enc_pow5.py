@@ -0,0 +1,46 @@
+#!/usr/bin/env python
+
+# Copyright (c) 2019 Nuxi, https://nuxi.nl/
+#
+# SPDX-License-Identifier: BSD-2-Clause
+
+# Generates the table of 128-bit approximations of powers of five that
+# is used by the Eisel-Lemire algorithm in f10enc_fast.c.
+#
+# Every entry holds the 128 most significant bits of 5^q, shifted so
+# that the top bit is set. Positive powers are truncated. Negative
+# powers are computed as a reciprocal that is rounded up, which is
+# exact for powers down to 5^-27.
+
+POW5_MIN = -342
+POW5_MAX = 308
+
+print('// Copyright (c) 2019 Nuxi, https://nuxi.nl/')
+print('//')
+print('// SPDX-License-Identifier: BSD-2-Clause')
+print('')
+print('// 128-bit approximations of powers of five.')
+print('// This file has been generated by gen_f10enc_pow5.py.')
+print('')
+print('#define POW5_MIN (%d)' % POW5_MIN)
+print('#define POW5_MAX %d' % POW5_MAX)
+print('')
+print('static const uint64_t f10enc_pow5[][2] = {')
+for q in range(POW5_MIN, POW5_MAX + 1):
+  if q < 0:
+    power = 5 ** -q
+    z = power.bit_length()
+    if q >= -27:
+      c = 2 ** (z + 127) // power + 1
+    else:
+      c = 2 ** (2 * z + 128) // power + 1
+      while c >= 1 << 128:
+        c //= 2
+  else:
+    c = 5 ** q
+    while c < 1 << 127:
+      c *= 2
+    while c >= 1 << 128:
+      c //= 2
+  print('    {0x%016x, 0x%016x},  // 5^%d' % (c >> 64, c & (2 ** 64 - 1), q))
+print('};')
@@ -0,0 +1,282 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <errno.h>
+#include <fnmatch.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <uchar.h>
+#include <wctype.h>
+
+#include "fnmatch_impl.h"
+
+// Character value returned when peeking past the end of a pattern.
+#define CHAR_END 0xfffffffe
+
+// Bracket expression without a closing ']'. The opening '[' is then
+// matched literally.
+#define BRACKET_UNTERMINATED (-1)
+
+static char32_t pattern_peek(const struct fnmatch_text *pattern, size_t pos,
+                             size_t *width) {
+  if (pos >= pattern->len) {
+    *width = 0;
+    return CHAR_END;
+  }
+  char32_t c;
+  *width = fnmatch_text_get(pattern, pos, &c);
+  return c;
+}
+
+static bool pattern_at(const struct fnmatch_text *pattern, size_t pos,
+                       char32_t c) {
+  size_t width;
+  return pattern_peek(pattern, pos, &width) == c;
+}
+
+// Parses a single character of a bracket expression, which may be a
+// collating symbol or equivalence class of the form [.c.] or [=c=].
+static int bracket_char(const struct fnmatch_text *pattern, size_t *pos,
+                        int flags, char32_t *c) {
+  size_t width;
+  char32_t ch = pattern_peek(pattern, *pos, &width);
+  if (ch == '[') {
+    size_t delim_width;
+    char32_t delim = pattern_peek(pattern, *pos + width, &delim_width);
+    if (delim == '.' || delim == '=') {
+      size_t start = *pos + width + delim_width, value_width;
+      char32_t value = pattern_peek(pattern, start, &value_width);
+      if (value != CHAR_END && value != FNMATCH_CHAR_INVALID &&
+          pattern_at(pattern, start + value_width, delim) &&
+          pattern_at(pattern, start + value_width + delim_width, ']')) {
+        *c = value;
+        *pos = start + value_width + delim_width + 1;
+        return 0;
+      }
+      // Search for the terminator to distinguish between unsupported
+      // collating elements and unterminated bracket expressions.
+      for (size_t i = start; i < pattern->len; i += width) {
+        if (pattern_peek(pattern, i, &width) == delim &&
+            pattern_at(pattern, i + width, ']'))
+          return EINVAL;
+      }
+      return BRACKET_UNTERMINATED;
+    }
+  } else if (ch == '\\' && (flags & FNM_NOESCAPE) == 0) {
+    *pos += width;
+    ch = pattern_peek(pattern, *pos, &width);
+  }
+  if (ch == CHAR_END)
+    return BRACKET_UNTERMINATED;
+  if (ch == FNMATCH_CHAR_INVALID)
+    return EILSEQ;
+  *c = ch;
+  *pos += width;
+  return 0;
+}
+
+// Parses a character class of the form [:name:], testing whether it
+// contains a character.
+static int bracket_class(const struct fnmatch_text *pattern, size_t *pos,
+                         char32_t c, bool *contains) {
+  char name[16];
+  size_t len = 0, width;
+  for (size_t i = *pos + 2;; i += width) {
+    char32_t ch = pattern_peek(pattern, i, &width);
+    if (ch == CHAR_END)
+      return BRACKET_UNTERMINATED;
+    if (ch == ':' && pattern_at(pattern, i + 1, ']')) {
+      name[len] = '\0';
+      wctype_t class = wctype(name);
+      if (class == 0)
+        return EINVAL;
+      if (c <= 0x10ffff && iswctype(c, class))
+        *contains = true;
+      *pos = i + 2;
+      return 0;
+    }
+    if (ch == '\0' || ch >= 0x80 || len >= sizeof(name) - 1) {
+      // Invalid class name. Still search for the terminator to
+      // distinguish it from an unterminated bracket expression.
+      for (; i < pattern->len; i += width) {
+        if (pattern_peek(pattern, i, &width) == ':' &&
+            pattern_at(pattern, i + 1, ']'))
+          return EINVAL;
+      }
+      return BRACKET_UNTERMINATED;
+    }
+    name[len++] = ch;
+  }
+}
+
+// Parses a bracket expression, starting right after the opening '[',
+// testing whether it contains a character.
+static int bracket_match(const struct fnmatch_text *pattern, size_t *pos,
+                         char32_t c, int flags, bool *contains) {
+  size_t i = *pos;
+  bool negate = false;
+  if (pattern_at(pattern, i, '!') || pattern_at(pattern, i, '^')) {
+    negate = true;
+    ++i;
+  }
+
+  bool found = false;
+  for (bool first = true;; first = false) {
+    if (i >= pattern->len)
+      return BRACKET_UNTERMINATED;
+    if (pattern_at(pattern, i, ']') && !first) {
+      *pos = i + 1;
+      break;
+    }
+    if (pattern_at(pattern, i, '[') && pattern_at(pattern, i + 1, ':')) {
+      int error = bracket_class(pattern, &i, c, &found);
+      if (error != 0)
+        return error;
+      if (pattern_at(pattern, i, '-') && !pattern_at(pattern, i + 1, ']') &&
+          i + 1 < pattern->len) {
+        // Character classes cannot be used as range endpoints.
+        return EINVAL;
+      }
+      continue;
+    }
+
+    char32_t min, max;
+    int error = bracket_char(pattern, &i, flags, &min);
+    if (error != 0)
+      return error;
+    if (pattern_at(pattern, i, '-') && i + 1 < pattern->len &&
+        !pattern_at(pattern, i + 1, ']')) {
+      ++i;
+      error = bracket_char(pattern, &i, flags, &max);
+      if (error != 0)
+        return error;
+      if (max < min)
+        return EINVAL;
+    } else {
+      max = min;
+    }
+    if (c >= min && c <= max)
+      found = true;
+  }
+
+  // Slashes can only be matched explicitly when FNM_PATHNAME is set.
+  *contains = found != negate && (c != '/' || (flags & FNM_PATHNAME) == 0);
+  return 0;
+}
+
+// Tests whether a wildcard may match a character.
+static bool wildcard_accepts(char32_t c, bool leading, int flags) {
+  if (c == '/' && (flags & FNM_PATHNAME) != 0)
+    return false;
+  return c != '.' || !leading || (flags & FNM_PERIOD) == 0;
+}
+
+int __fnmatch_execute(const struct fnmatch_text *pattern,
+                      const struct fnmatch_text *string, int flags) {
+  size_t p = 0, s = 0;
+  // Position at which the current pathname component starts.
+  size_t component = 0;
+  // Pattern position following the last asterisk and the position in
+  // the string up to which it has matched.
+  size_t star_p = SIZE_MAX, star_s = 0;
+  for (;;) {
+    if (p < pattern->len) {
+      char32_t pc;
+      size_t next = p + fnmatch_text_get(pattern, p, &pc);
+      if (pc == FNMATCH_CHAR_INVALID)
+        return FNM_NOMATCH;
+      if (pc == '*') {
+        // Consecutive asterisks are equivalent to a single one.
+        while (pattern_at(pattern, next, '*'))
+          ++next;
+        // Asterisks may not match a leading period, not even when
+        // matching zero characters. The period would then have to be
+        // matched by the remainder of the pattern, which is not
+        // permitted either.
+        if (s == component && (flags & FNM_PERIOD) != 0 && s < string->len) {
+          char32_t sc;
+          fnmatch_text_get(string, s, &sc);
+          if (sc == '.')
+            return FNM_NOMATCH;
+        }
+        p = star_p = next;
+        star_s = s;
+        continue;
+      }
+
+      if (s < string->len) {
+        char32_t sc;
+        size_t width = fnmatch_text_get(string, s, &sc);
+        bool leading = s == component;
+        bool matched;
+        if (pc == '?') {
+          matched = wildcard_accepts(sc, leading, flags);
+        } else if (pc == '[') {
+          int error = bracket_match(pattern, &next, sc, flags, &matched);
+          if (error == BRACKET_UNTERMINATED)
+            matched = sc == '[';
+          else if (error != 0)
+            return FNM_NOMATCH;
+          else if (matched)
+            matched = wildcard_accepts(sc, leading, flags);
+        } else {
+          if (pc == '\\' && (flags & FNM_NOESCAPE) == 0 &&
+              next < pattern->len) {
+            next += fnmatch_text_get(pattern, next, &pc);
+            if (pc == FNMATCH_CHAR_INVALID)
+              return FNM_NOMATCH;
+          }
+          matched = pc == sc;
+        }
+
+        if (matched) {
+          p = next;
+          s += width;
+          if (sc == '/' && (flags & FNM_PATHNAME) != 0) {
+            // Slashes are only matched by slashes in the pattern, so
+            // asterisks before it never need to be retried.
+            star_p = SIZE_MAX;
+            component = s;
+          }
+          continue;
+        }
+      }
+    } else if (s == string->len) {
+      return 0;
+    }
+
+    // Mismatch. Let the last asterisk match one more character.
+    if (star_p == SIZE_MAX || star_s == string->len)
+      return FNM_NOMATCH;
+    char32_t sc;
+    size_t width = fnmatch_text_get(string, star_s, &sc);
+    if (!wildcard_accepts(sc, star_s == component, flags))
+      return FNM_NOMATCH;
+    p = star_p;
+    s = star_s += width;
+  }
+}
+
+int __fnmatch_validate(const struct fnmatch_text *pattern, int flags) {
+  for (size_t p = 0; p < pattern->len;) {
+    char32_t pc;
+    p += fnmatch_text_get(pattern, p, &pc);
+    if (pc == FNMATCH_CHAR_INVALID)
+      return EILSEQ;
+    if (pc == '\\' && (flags & FNM_NOESCAPE) == 0 && p < pattern->len) {
+      p += fnmatch_text_get(pattern, p, &pc);
+      if (pc == FNMATCH_CHAR_INVALID)
+        return EILSEQ;
+    } else if (pc == '[') {
+      size_t next = p;
+      bool contains;
+      int error = bracket_match(pattern, &next, '\0', flags, &contains);
+      if (error > 0)
+        return error;
+      if (error == 0)
+        p = next;
+    }
+  }
+  return 0;
+}
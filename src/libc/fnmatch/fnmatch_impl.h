@@ -0,0 +1,70 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef FNMATCH_FNMATCH_IMPL_H
+#define FNMATCH_FNMATCH_IMPL_H
+
+#include <common/locale.h>
+#include <common/mbstate.h>
+
+#include <sys/types.h>
+
+#include <stddef.h>
+#include <uchar.h>
+
+// Glob pattern matching.
+//
+// Patterns are interpreted directly, without compiling them to a
+// regular expression first. Matching uses the classic algorithm of
+// only retrying the last asterisk, which runs in O(n * m) time and
+// doesn't allocate any memory. With FNM_PATHNAME, asterisks cannot
+// match slashes, meaning that the retry point can be discarded every
+// time a slash is matched.
+
+// Special character value for invalid input sequences. This is never
+// part of a pattern.
+#define FNMATCH_CHAR_INVALID 0xffffffff
+
+// Pattern or string to be matched. Narrow strings are decoded on the
+// fly, using the character set of the locale.
+struct fnmatch_text {
+  const char *nstring;      // Narrow string.
+  const char32_t *ustring;  // Unicode string.
+  size_t len;
+  const struct lc_ctype *ctype;
+};
+
+int __fnmatch_execute(const struct fnmatch_text *, const struct fnmatch_text *,
+                      int);
+int __fnmatch_validate(const struct fnmatch_text *, int);
+
+// Extracts the character at a given position of a pattern or string,
+// returning the number of code units it spans.
+static inline size_t fnmatch_text_get(const struct fnmatch_text *text,
+                                      size_t pos, char32_t *c) {
+  if (text->ustring != NULL) {
+    *c = text->ustring[pos];
+    return 1;
+  }
+
+  unsigned char ch = text->nstring[pos];
+  if (ch < 0x80 && (text->ctype == &__ctype_us_ascii ||
+                    text->ctype == &__ctype_utf_8)) {
+    *c = ch;
+    return 1;
+  }
+  mbstate_t mbs;
+  mbstate_set_init(&mbs);
+  ssize_t l = text->ctype->mbtoc32(c, text->nstring + pos, text->len - pos,
+                                   &mbs, text->ctype->data);
+  if (l < 0) {
+    // Treat invalid and incomplete sequences as a single byte that only
+    // matches wildcards and non-matching lists.
+    *c = FNMATCH_CHAR_INVALID;
+    return 1;
+  }
+  return l > 0 ? l : 1;
+}
+
+#endif
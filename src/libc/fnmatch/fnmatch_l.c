@@ -2,21 +2,25 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
-#include <assert.h>
+#include <common/locale.h>
+
 #include <fnmatch.h>
 #include <locale.h>
-#include <regex.h>
+#include <string.h>
 
-static_assert(FNM_PATHNAME == REG_FNMATCH_PATHNAME, "Value mismatch");
-static_assert(FNM_PERIOD == REG_FNMATCH_PERIOD, "Value mismatch");
-static_assert(FNM_NOESCAPE == REG_FNMATCH_NOESCAPE, "Value mismatch");
+#include "fnmatch_impl.h"
 
 int fnmatch_l(const char *pattern, const char *string, int flags,
               locale_t locale) {
-  regex_t reg;
-  if (regcomp_l(&reg, pattern, REG_NOSUB | REG_FNMATCH | flags, locale) != 0)
-    return FNM_NOMATCH;
-  int result = regexec_l(&reg, string, 0, NULL, 0, locale);
-  regfree(&reg);
-  return result == 0 ? 0 : FNM_NOMATCH;
+  struct fnmatch_text npattern = {
+      .nstring = pattern,
+      .len = strlen(pattern),
+      .ctype = locale->ctype,
+  };
+  struct fnmatch_text nstring = {
+      .nstring = string,
+      .len = strlen(string),
+      .ctype = locale->ctype,
+  };
+  return __fnmatch_execute(&npattern, &nstring, flags);
 }
@@ -0,0 +1,128 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <fnmatch.h>
+#include <locale.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+TEST(fnmatch, literal) {
+  ASSERT_EQ(0, fnmatch("", "", 0));
+  ASSERT_EQ(0, fnmatch("hello", "hello", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("hello", "hell", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("hell", "hello", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("", "x", 0));
+}
+
+TEST(fnmatch, wildcards) {
+  ASSERT_EQ(0, fnmatch("*", "", 0));
+  ASSERT_EQ(0, fnmatch("*", "hello", 0));
+  ASSERT_EQ(0, fnmatch("h*o", "hello", 0));
+  ASSERT_EQ(0, fnmatch("h**o", "ho", 0));
+  ASSERT_EQ(0, fnmatch("*.c", "foo.c.c", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("*.c", "foo.c.h", 0));
+  ASSERT_EQ(0, fnmatch("*a*b*c", "xaxbxaxbxc", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("*a*b*c", "xaxbxaxbx", 0));
+  ASSERT_EQ(0, fnmatch("?", "x", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("?", "", 0));
+  ASSERT_EQ(0, fnmatch("??*?", "abc", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("??*?", "ab", 0));
+}
+
+TEST(fnmatch, bracket) {
+  ASSERT_EQ(0, fnmatch("[abc]", "b", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("[abc]", "d", 0));
+  ASSERT_EQ(0, fnmatch("[!abc]", "d", 0));
+  ASSERT_EQ(0, fnmatch("[^abc]", "d", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("[!abc]", "a", 0));
+  ASSERT_EQ(0, fnmatch("[a-z][0-9]", "q7", 0));
+  ASSERT_EQ(0, fnmatch("[]]", "]", 0));
+  ASSERT_EQ(0, fnmatch("[!]]", "x", 0));
+  ASSERT_EQ(0, fnmatch("[a-]", "-", 0));
+  ASSERT_EQ(0, fnmatch("[[:digit:][:upper:]]", "X", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("[[:digit:][:upper:]]", "x", 0));
+  ASSERT_EQ(0, fnmatch("[[.-.]]", "-", 0));
+  ASSERT_EQ(0, fnmatch("[[=a=]]", "a", 0));
+  ASSERT_EQ(0, fnmatch("[\\]]", "]", 0));
+  ASSERT_EQ(0, fnmatch("[\\]]", "\\]", FNM_NOESCAPE));
+
+  // Unterminated bracket expressions match literally.
+  ASSERT_EQ(0, fnmatch("[", "[", 0));
+  ASSERT_EQ(0, fnmatch("a[b", "a[b", 0));
+  ASSERT_EQ(0, fnmatch("[[:alpha:]", "[a", 0));
+
+  // Invalid bracket expressions never match.
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("[z-a]", "z", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("[[:foo:]]", "a", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("*[[.ab.]]", "ab", 0));
+}
+
+TEST(fnmatch, escape) {
+  ASSERT_EQ(0, fnmatch("\\*", "*", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("\\*", "x", 0));
+  ASSERT_EQ(0, fnmatch("\\*", "\\x", FNM_NOESCAPE));
+  ASSERT_EQ(0, fnmatch("a\\", "a\\", 0));
+}
+
+TEST(fnmatch, pathname) {
+  ASSERT_EQ(0, fnmatch("*", "a/b", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("*", "a/b", FNM_PATHNAME));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("a?b", "a/b", FNM_PATHNAME));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("a[/]b", "a/b", FNM_PATHNAME));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("a[!x]b", "a/b", FNM_PATHNAME));
+  ASSERT_EQ(0, fnmatch("*/*.c", "src/main.c", FNM_PATHNAME));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("*/*.c", "src/lib/main.c", FNM_PATHNAME));
+  ASSERT_EQ(0, fnmatch("*/*/*.c", "src/lib/main.c", FNM_PATHNAME));
+  ASSERT_EQ(0, fnmatch("a*\\/b", "ax/b", FNM_PATHNAME));
+}
+
+TEST(fnmatch, period) {
+  ASSERT_EQ(0, fnmatch("*", ".profile", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("*", ".profile", FNM_PERIOD));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("?profile", ".profile", FNM_PERIOD));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("[.]profile", ".profile", FNM_PERIOD));
+  ASSERT_EQ(0, fnmatch(".*", ".profile", FNM_PERIOD));
+  ASSERT_EQ(0, fnmatch("a*", "a.b", FNM_PERIOD));
+
+  // Leading periods of pathname components.
+  ASSERT_EQ(0, fnmatch("a/*", "a/.b", FNM_PERIOD));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("a/*", "a/.b", FNM_PATHNAME | FNM_PERIOD));
+  ASSERT_EQ(0, fnmatch("a/.*", "a/.b", FNM_PATHNAME | FNM_PERIOD));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("*/b", "./b", FNM_PATHNAME | FNM_PERIOD));
+
+  // Asterisks matching zero characters don't permit the leading period
+  // to be matched by the remainder of the pattern.
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("*.c", ".c", FNM_PERIOD));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("*.", ".", FNM_PERIOD));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("**.*", ".b.", FNM_PERIOD));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("a/*.c", "a/.c", FNM_PATHNAME | FNM_PERIOD));
+  ASSERT_EQ(0, fnmatch("a*.c", "a.c", FNM_PERIOD));
+  ASSERT_EQ(0, fnmatch("*.c", ".c", 0));
+}
+
+TEST(fnmatch, pathological) {
+  // Patterns with many asterisks should not take exponential time.
+  std::string string(10000, 'a');
+  ASSERT_EQ(FNM_NOMATCH,
+            fnmatch("*a*a*a*a*a*a*a*a*a*a*a*a*a*a*a*a*b", string.c_str(), 0));
+  string += 'b';
+  ASSERT_EQ(0,
+            fnmatch("*a*a*a*a*a*a*a*a*a*a*a*a*a*a*a*a*b", string.c_str(), 0));
+}
+
+TEST(fnmatch, utf8) {
+  locale_t locale = newlocale(LC_CTYPE_MASK, ".UTF-8", 0);
+  ASSERT_EQ(0, fnmatch_l("?", "€", 0, locale));
+  ASSERT_EQ(0, fnmatch_l("*é", "café", 0, locale));
+  ASSERT_EQ(0, fnmatch_l("[α-ω]*", "βeta", 0, locale));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch_l("[!€]", "€", 0, locale));
+
+  // Invalid sequences only match wildcards.
+  ASSERT_EQ(0, fnmatch_l("a?b", "a\xff" "b", 0, locale));
+  ASSERT_EQ(0, fnmatch_l("[!a]", "\xff", 0, locale));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch_l("\xff", "\xff", 0, locale));
+  freelocale(locale);
+}
@@ -0,0 +1,13 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/locale.h>
+
+#include <fnmatch.h>
+#include <locale.h>
+
+int fnmcomp(fnm_t *restrict fnm, const char *restrict pattern, int flags) {
+  DEFAULT_LOCALE(locale, LC_COLLATE_MASK | LC_CTYPE_MASK);
+  return fnmcomp_l(fnm, pattern, flags, locale);
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/locale.h>
+#include <common/mbstate.h>
+
+#include <sys/types.h>
+
+#include <errno.h>
+#include <fnmatch.h>
+#include <locale.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uchar.h>
+
+#include "fnmatch_impl.h"
+
+int fnmcomp_l(fnm_t *restrict fnm, const char *restrict pattern, int flags,
+              locale_t locale) {
+  // Convert the pattern to Unicode, so that it does not need to be
+  // decoded every time it is matched.
+  size_t len = strlen(pattern);
+  char32_t *upattern = reallocarray(NULL, len + 1, sizeof(*upattern));
+  if (upattern == NULL)
+    return ENOMEM;
+  const struct lc_ctype *ctype = locale->ctype;
+  mbstate_t mbs;
+  mbstate_set_init(&mbs);
+  size_t ulen = 0;
+  while (len > 0) {
+    ssize_t l = ctype->mbtoc32(&upattern[ulen++], pattern, len, &mbs,
+                               ctype->data);
+    if (l < 0) {
+      free(upattern);
+      return EILSEQ;
+    }
+    if (l == 0)
+      l = 1;
+    pattern += l;
+    len -= l;
+  }
+
+  // Reject malformed bracket expressions up front, so that they don't
+  // need to be accounted for while matching.
+  struct fnmatch_text text = {.ustring = upattern, .len = ulen};
+  int error = __fnmatch_validate(&text, flags);
+  if (error != 0) {
+    free(upattern);
+    return error;
+  }
+  *fnm = (fnm_t){
+      .__pattern = upattern,
+      .__len = ulen,
+      .__flags = flags,
+  };
+  return 0;
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <errno.h>
+#include <fnmatch.h>
+#include <locale.h>
+
+#include "gtest/gtest.h"
+
+TEST(fnmcomp, example) {
+  fnm_t fnm;
+  ASSERT_EQ(0, fnmcomp(&fnm, "*.[ch]", FNM_PERIOD));
+  ASSERT_EQ(0, fnmexec(&fnm, "main.c"));
+  ASSERT_EQ(0, fnmexec(&fnm, "stdio.h"));
+  ASSERT_EQ(FNM_NOMATCH, fnmexec(&fnm, "main.o"));
+  ASSERT_EQ(FNM_NOMATCH, fnmexec(&fnm, ".hidden.c"));
+  fnmfree(&fnm);
+}
+
+TEST(fnmcomp, period) {
+  // Asterisks matching zero characters don't permit the leading period
+  // to be matched by the remainder of the pattern.
+  fnm_t fnm;
+  ASSERT_EQ(0, fnmcomp(&fnm, "*.c", FNM_PERIOD));
+  ASSERT_EQ(FNM_NOMATCH, fnmexec(&fnm, ".c"));
+  ASSERT_EQ(0, fnmexec(&fnm, "a.c"));
+  fnmfree(&fnm);
+
+  ASSERT_EQ(0, fnmcomp(&fnm, "a/*.c", FNM_PATHNAME | FNM_PERIOD));
+  ASSERT_EQ(FNM_NOMATCH, fnmexec(&fnm, "a/.c"));
+  ASSERT_EQ(0, fnmexec(&fnm, "a/b.c"));
+  fnmfree(&fnm);
+
+  ASSERT_EQ(0, fnmcomp(&fnm, "a*.c", FNM_PERIOD));
+  ASSERT_EQ(0, fnmexec(&fnm, "a.c"));
+  fnmfree(&fnm);
+}
+
+TEST(fnmcomp, errors) {
+  fnm_t fnm;
+  ASSERT_EQ(EINVAL, fnmcomp(&fnm, "[z-a]", 0));
+  ASSERT_EQ(EINVAL, fnmcomp(&fnm, "x[[:foo:]]", 0));
+  ASSERT_EQ(EINVAL, fnmcomp(&fnm, "[[.ab.]]", 0));
+  ASSERT_EQ(EINVAL, fnmcomp(&fnm, "[[:alpha:]-z]", 0));
+
+  // Unterminated bracket expressions are matched literally.
+  ASSERT_EQ(0, fnmcomp(&fnm, "[a-", 0));
+  ASSERT_EQ(0, fnmexec(&fnm, "[a-"));
+  fnmfree(&fnm);
+}
+
+TEST(fnmcomp, utf8) {
+  locale_t locale = newlocale(LC_CTYPE_MASK, ".UTF-8", 0);
+  fnm_t fnm;
+  ASSERT_EQ(EILSEQ, fnmcomp_l(&fnm, "\xff", 0, locale));
+  ASSERT_EQ(0, fnmcomp_l(&fnm, "[€$]*", 0, locale));
+  ASSERT_EQ(0, fnmexec_l(&fnm, "€100", locale));
+  ASSERT_EQ(FNM_NOMATCH, fnmexec_l(&fnm, "£100", locale));
+  fnmfree(&fnm);
+  freelocale(locale);
+}
@@ -0,0 +1,13 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/locale.h>
+
+#include <fnmatch.h>
+#include <locale.h>
+
+int fnmexec(const fnm_t *restrict fnm, const char *restrict string) {
+  DEFAULT_LOCALE(locale, LC_COLLATE_MASK | LC_CTYPE_MASK);
+  return fnmexec_l(fnm, string, locale);
+}
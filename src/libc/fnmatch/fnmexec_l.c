@@ -0,0 +1,25 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/locale.h>
+
+#include <fnmatch.h>
+#include <locale.h>
+#include <string.h>
+
+#include "fnmatch_impl.h"
+
+int fnmexec_l(const fnm_t *restrict fnm, const char *restrict string,
+              locale_t locale) {
+  struct fnmatch_text upattern = {
+      .ustring = fnm->__pattern,
+      .len = fnm->__len,
+  };
+  struct fnmatch_text nstring = {
+      .nstring = string,
+      .len = strlen(string),
+      .ctype = locale->ctype,
+  };
+  return __fnmatch_execute(&upattern, &nstring, fnm->__flags);
+}
@@ -0,0 +1,10 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <fnmatch.h>
+#include <stdlib.h>
+
+void fnmfree(fnm_t *fnm) {
+  free(fnm->__pattern);
+}
@@ -4,6 +4,7 @@
 
 #include <mqueue.h>
 #include <pthread.h>
+#include <semaphore.h>
 #include <stdlib.h>
 
 #include "mqueue_impl.h"
@@ -15,6 +16,14 @@ int mq_destroy(mqd_t mqdes) {
   pthread_cond_destroy(&mqd->cond_receive);
   pthread_cond_destroy(&mqd->cond_send);
 
+  // Free storage of lock-free message queues.
+  if (mqd->lockfree) {
+    sem_destroy(&mqd->free_slots);
+    sem_destroy(&mqd->messages);
+    free(mqd->free_ring.cells);
+    free(mqd->slots);
+  }
+
   // Free all pending messages.
   struct message *m = mqd->queue_receive;
   while (m != NULL) {
@@ -4,6 +4,7 @@
 
 #include <mqueue.h>
 #include <pthread.h>
+#include <semaphore.h>
 
 #include "mqueue_impl.h"
 
@@ -13,5 +14,12 @@ int mq_getattr(mqd_t mqdes, struct mq_attr *mqstat) {
   pthread_mutex_lock(&mqd->lock);
   *mqstat = mqd->attr;
   pthread_mutex_unlock(&mqd->lock);
+  if (mqd->lockfree) {
+    // Lock-free message queues only track the number of messages
+    // through their semaphore.
+    int curmsgs;
+    sem_getvalue(&mqd->messages, &curmsgs);
+    mqstat->mq_curmsgs = curmsgs;
+  }
   return 0;
 }
@@ -6,15 +6,65 @@
 #include <fcntl.h>
 #include <mqueue.h>
 #include <pthread.h>
+#include <semaphore.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #include "mqueue_impl.h"
 
+// Preallocates storage for all messages of a lock-free message queue.
+static int mq_init_lockfree(struct __mqd *mqd) {
+  // Semaphores are used to count the number of messages, meaning the
+  // maximum number of messages is bounded by their maximum value.
+  size_t maxmsg = mqd->attr.mq_maxmsg;
+  if (maxmsg > SEM_VALUE_MAX) {
+    errno = EINVAL;
+    return -1;
+  }
+  size_t slot_size = (offsetof(struct message_slot, contents) +
+                      (size_t)mqd->attr.mq_msgsize + alignof(size_t) - 1) &
+                     ~(alignof(size_t) - 1);
+  if (slot_size > SIZE_MAX / maxmsg) {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  // Allocate storage for the message slots and the rings. The rings
+  // share a single allocation.
+  size_t ncells = 1;
+  while (ncells < maxmsg)
+    ncells *= 2;
+  char *slots = malloc(slot_size * maxmsg);
+  if (slots == NULL)
+    return -1;
+  struct mq_ring_cell *cells =
+      calloc(ncells * (MQ_LOCKFREE_PRIO_MAX + 1), sizeof(*cells));
+  if (cells == NULL) {
+    free(slots);
+    return -1;
+  }
+
+  // Initially all slots are free.
+  mqd->slots = slots;
+  mqd->slot_size = slot_size;
+  mq_ring_init(&mqd->free_ring, cells, ncells);
+  for (size_t i = 0; i < MQ_LOCKFREE_PRIO_MAX; ++i)
+    mq_ring_init(&mqd->ring_receive[i], cells + ncells * (i + 1), ncells);
+  for (size_t i = 0; i < maxmsg; ++i)
+    mq_ring_tryput(&mqd->free_ring, i);
+  sem_init(&mqd->free_slots, 0, maxmsg);
+  sem_init(&mqd->messages, 0, 0);
+  atomic_init(&mqd->priorities_used, 0);
+  return 0;
+}
+
 int mq_init(mqd_t *mqdes, const struct mq_attr *attr) {
-  // Only allow O_NONBLOCK to be set. Maximum number of messages and
-  // message size must be positive.
-  if ((attr->mq_flags & ~O_NONBLOCK) != 0 || attr->mq_maxmsg <= 0 ||
-      attr->mq_msgsize <= 0) {
+  // Only allow O_NONBLOCK and MQ_LOCKFREE to be set. Maximum number of
+  // messages and message size must be positive.
+  if ((attr->mq_flags & ~(O_NONBLOCK | MQ_LOCKFREE)) != 0 ||
+      attr->mq_maxmsg <= 0 || attr->mq_msgsize <= 0) {
     errno = EINVAL;
     return -1;
   }
@@ -23,6 +73,10 @@ int mq_init(mqd_t *mqdes, const struct mq_attr *attr) {
   struct __mqd *mqd = malloc(sizeof(*mqd));
   if (mqd == NULL)
     return -1;
+  mqd->attr = *attr;
+  mqd->attr.mq_curmsgs = 0;
+  mqd->lockfree = (attr->mq_flags & MQ_LOCKFREE) != 0;
+  atomic_init(&mqd->nonblock, (attr->mq_flags & O_NONBLOCK) != 0);
   if (pthread_mutex_init(&mqd->lock, NULL) != 0) {
     free(mqd);
     return -1;
@@ -38,8 +92,13 @@ int mq_init(mqd_t *mqdes, const struct mq_attr *attr) {
     free(mqd);
     return -1;
   }
-  mqd->attr = *attr;
-  mqd->attr.mq_curmsgs = 0;
+  if (mqd->lockfree && mq_init_lockfree(mqd) != 0) {
+    pthread_cond_destroy(&mqd->cond_send);
+    pthread_cond_destroy(&mqd->cond_receive);
+    pthread_mutex_destroy(&mqd->lock);
+    free(mqd);
+    return -1;
+  }
   mqd->queue_receive = NULL;
   mqd->queue_send = NULL;
   mqdes->__mqd = mqd;
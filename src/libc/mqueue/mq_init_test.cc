@@ -68,4 +68,16 @@ TEST(mq_init, example) {
     ASSERT_EQ(0, mq_init(&mqd, &attr));
     ASSERT_EQ(0, mq_destroy(mqd));
   }
+
+  // Open lock-free queue.
+  {
+    mqd_t mqd;
+    struct mq_attr attr = {
+        .mq_flags = MQ_LOCKFREE,
+        .mq_maxmsg = 100,
+        .mq_msgsize = 32,
+    };
+    ASSERT_EQ(0, mq_init(&mqd, &attr));
+    ASSERT_EQ(0, mq_destroy(mqd));
+  }
 }
@@ -10,6 +10,8 @@
 ssize_t mq_receive(mqd_t mqdes, char *msg_ptr, size_t msg_len,
                    unsigned int *msg_prio) {
   struct __mqd *mqd = mqdes.__mqd;
+  if (mqd->lockfree)
+    return mq_lockfree_receive(mqd, msg_ptr, msg_len, msg_prio, NULL);
   if (!mq_receive_pre(mqd, msg_len))
     return -1;
   while (mqd->attr.mq_curmsgs <= 0)
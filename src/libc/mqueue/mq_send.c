@@ -10,6 +10,8 @@
 int mq_send(mqd_t mqdes, const char *msg_ptr, size_t msg_len,
             unsigned int msg_prio) {
   struct __mqd *mqd = mqdes.__mqd;
+  if (mqd->lockfree)
+    return mq_lockfree_send(mqd, msg_ptr, msg_len, msg_prio, NULL);
   if (!mq_send_pre(mqd, msg_len))
     return -1;
   while (mqd->attr.mq_curmsgs >= mqd->attr.mq_maxmsg)
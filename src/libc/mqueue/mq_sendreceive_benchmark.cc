@@ -0,0 +1,88 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <mqueue.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "gtest/gtest.h"
+
+// Throughput benchmark for message queues. A varying number of
+// producers and consumers exchange small messages through a queue,
+// which is small enough to cause both producers and consumers to block
+// regularly.
+
+namespace {
+
+constexpr unsigned int kMessages = 1 << 18;
+constexpr unsigned int kMaxThreads = 8;
+
+double now() {
+  struct timespec ts;
+  EXPECT_EQ(0, clock_gettime(CLOCK_MONOTONIC, &ts));
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+struct worker {
+  mqd_t mqd;
+  unsigned int messages;
+};
+
+void *do_send(void *arg) {
+  const worker *w = static_cast<worker *>(arg);
+  for (unsigned int i = 0; i < w->messages; ++i)
+    EXPECT_EQ(0, mq_send(w->mqd, reinterpret_cast<const char *>(&i),
+                         sizeof(i), i % 4));
+  return nullptr;
+}
+
+void *do_receive(void *arg) {
+  const worker *w = static_cast<worker *>(arg);
+  for (unsigned int i = 0; i < w->messages; ++i) {
+    unsigned int value;
+    EXPECT_EQ(sizeof(value), mq_receive(w->mqd,
+                                        reinterpret_cast<char *>(&value),
+                                        sizeof(value), nullptr));
+  }
+  return nullptr;
+}
+
+void benchmark(const char *name, long flags, long maxmsg) {
+  for (unsigned int nthreads = 1; nthreads <= kMaxThreads; nthreads *= 2) {
+    worker w;
+    struct mq_attr attr = {
+        .mq_flags = flags,
+        .mq_maxmsg = maxmsg,
+        .mq_msgsize = sizeof(unsigned int),
+    };
+    ASSERT_EQ(0, mq_init(&w.mqd, &attr));
+    w.messages = kMessages / nthreads;
+
+    double begin = now();
+    pthread_t senders[kMaxThreads], receivers[kMaxThreads];
+    for (unsigned int i = 0; i < nthreads; ++i) {
+      ASSERT_EQ(0, pthread_create(&senders[i], nullptr, do_send, &w));
+      ASSERT_EQ(0, pthread_create(&receivers[i], nullptr, do_receive, &w));
+    }
+    for (unsigned int i = 0; i < nthreads; ++i) {
+      ASSERT_EQ(0, pthread_join(senders[i], nullptr));
+      ASSERT_EQ(0, pthread_join(receivers[i], nullptr));
+    }
+    double elapsed = now() - begin;
+
+    ASSERT_EQ(0, mq_destroy(w.mqd));
+    printf("%-8s maxmsg=%3ld threads=%ux%u %8.1f ns/message\n", name, maxmsg,
+           nthreads, nthreads, elapsed / (w.messages * nthreads) * 1e9);
+  }
+}
+
+}  // namespace
+
+TEST(mq_sendreceive, throughput) {
+  benchmark("locked", 0, 4);
+  benchmark("locked", 0, 256);
+  benchmark("lockfree", MQ_LOCKFREE, 4);
+  benchmark("lockfree", MQ_LOCKFREE, 256);
+}
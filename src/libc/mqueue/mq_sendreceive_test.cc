@@ -2,7 +2,10 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <errno.h>
+#include <limits.h>
 #include <mqueue.h>
+#include <pthread.h>
 #include <stdlib.h>
 
 #include "gtest/gtest.h"
@@ -68,3 +71,102 @@ TEST(mq_sendreceive, ordering) {
 
   ASSERT_EQ(0, mq_destroy(mqd));
 }
+
+TEST(mq_sendreceive, lockfree_ordering) {
+  mqd_t mqd;
+  {
+    struct mq_attr attr = {
+        .mq_flags = MQ_LOCKFREE,
+        .mq_maxmsg = 64,
+        .mq_msgsize = 1,
+    };
+    ASSERT_EQ(0, mq_init(&mqd, &attr));
+  }
+
+  // Priorities are limited in size.
+  ASSERT_EQ(-1, mq_send(mqd, "A", 1, _POSIX_MQ_PRIO_MAX));
+  ASSERT_EQ(EINVAL, errno);
+
+  // Messages should be returned in order of decreasing priority and
+  // in the order in which they were sent.
+  for (unsigned int i = 0; i < 64; ++i) {
+    char c = i;
+    ASSERT_EQ(0, mq_send(mqd, &c, 1, i % 4 * 10));
+  }
+  {
+    struct mq_attr attr;
+    ASSERT_EQ(0, mq_getattr(mqd, &attr));
+    ASSERT_EQ(MQ_LOCKFREE, attr.mq_flags);
+    ASSERT_EQ(64, attr.mq_curmsgs);
+  }
+  for (unsigned int i = 0; i < 64; ++i) {
+    char c;
+    unsigned int prio;
+    ASSERT_EQ(1, mq_receive(mqd, &c, 1, &prio));
+    ASSERT_EQ(3 - i / 16 + i % 16 * 4, c);
+    ASSERT_EQ(30 - i / 16 * 10, prio);
+  }
+  ASSERT_EQ(0, mq_destroy(mqd));
+}
+
+namespace {
+
+constexpr unsigned int kThreads = 4;
+constexpr unsigned int kMessagesPerThread = 10000;
+
+void *do_send(void *arg) {
+  mqd_t mqd = *static_cast<mqd_t *>(arg);
+  for (unsigned int i = 0; i < kMessagesPerThread; ++i)
+    EXPECT_EQ(0, mq_send(mqd, reinterpret_cast<char *>(&i), sizeof(i),
+                         i % _POSIX_MQ_PRIO_MAX));
+  return nullptr;
+}
+
+void *do_receive(void *arg) {
+  mqd_t mqd = *static_cast<mqd_t *>(arg);
+  unsigned int *count = new unsigned int[kMessagesPerThread]();
+  for (unsigned int i = 0; i < kMessagesPerThread; ++i) {
+    unsigned int value, prio;
+    EXPECT_EQ(sizeof(value), mq_receive(mqd, reinterpret_cast<char *>(&value),
+                                        sizeof(value), &prio));
+    EXPECT_GT(kMessagesPerThread, value);
+    EXPECT_EQ(value % _POSIX_MQ_PRIO_MAX, prio);
+    ++count[value];
+  }
+  return count;
+}
+
+}  // namespace
+
+TEST(mq_sendreceive, lockfree_threads) {
+  // Let multiple threads send and receive messages through a queue
+  // that is smaller than the number of messages.
+  mqd_t mqd;
+  {
+    struct mq_attr attr = {
+        .mq_flags = MQ_LOCKFREE,
+        .mq_maxmsg = 16,
+        .mq_msgsize = sizeof(unsigned int),
+    };
+    ASSERT_EQ(0, mq_init(&mqd, &attr));
+  }
+  pthread_t senders[kThreads], receivers[kThreads];
+  for (unsigned int i = 0; i < kThreads; ++i) {
+    ASSERT_EQ(0, pthread_create(&senders[i], nullptr, do_send, &mqd));
+    ASSERT_EQ(0, pthread_create(&receivers[i], nullptr, do_receive, &mqd));
+  }
+
+  // Every message should have been received exactly once.
+  unsigned int total[kMessagesPerThread] = {};
+  for (unsigned int i = 0; i < kThreads; ++i) {
+    ASSERT_EQ(0, pthread_join(senders[i], nullptr));
+    void *count;
+    ASSERT_EQ(0, pthread_join(receivers[i], &count));
+    for (unsigned int j = 0; j < kMessagesPerThread; ++j)
+      total[j] += static_cast<unsigned int *>(count)[j];
+    delete[] static_cast<unsigned int *>(count);
+  }
+  for (unsigned int i = 0; i < kMessagesPerThread; ++i)
+    ASSERT_EQ(kThreads, total[i]);
+  ASSERT_EQ(0, mq_destroy(mqd));
+}
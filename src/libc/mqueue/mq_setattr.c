@@ -6,13 +6,15 @@
 #include <fcntl.h>
 #include <mqueue.h>
 #include <pthread.h>
+#include <stdatomic.h>
 
 #include "mqueue_impl.h"
 
 int mq_setattr(mqd_t mqdes, const struct mq_attr *restrict mqstat,
                struct mq_attr *restrict omqstat) {
-  // Only allow O_NONBLOCK to be set.
-  if ((mqstat->mq_flags & ~O_NONBLOCK) != 0) {
+  // Only allow O_NONBLOCK to be set. MQ_LOCKFREE is ignored, so that
+  // attributes obtained through mq_getattr() can be passed in.
+  if ((mqstat->mq_flags & ~(O_NONBLOCK | MQ_LOCKFREE)) != 0) {
     errno = EINVAL;
     return -1;
   }
@@ -22,7 +24,11 @@ int mq_setattr(mqd_t mqdes, const struct mq_attr *restrict mqstat,
   pthread_mutex_lock(&mqd->lock);
   if (omqstat != NULL)
     *omqstat = mqd->attr;
-  mqd->attr.mq_flags = mqstat->mq_flags;
+  mqd->attr.mq_flags =
+      (mqd->attr.mq_flags & MQ_LOCKFREE) | (mqstat->mq_flags & O_NONBLOCK);
+  atomic_store_explicit(&mqd->nonblock,
+                        (mqstat->mq_flags & O_NONBLOCK) != 0,
+                        memory_order_relaxed);
   pthread_mutex_unlock(&mqd->lock);
   return 0;
 }
@@ -12,6 +12,8 @@ ssize_t mq_timedreceive(mqd_t mqdes, char *restrict msg_ptr, size_t msg_len,
                         unsigned int *restrict msg_prio,
                         const struct timespec *restrict abstime) {
   struct __mqd *mqd = mqdes.__mqd;
+  if (mqd->lockfree)
+    return mq_lockfree_receive(mqd, msg_ptr, msg_len, msg_prio, abstime);
   if (!mq_receive_pre(mqd, msg_len))
     return -1;
   while (mqd->attr.mq_curmsgs <= 0) {
@@ -5,14 +5,22 @@
 #ifndef MQUEUE_MQUEUE_IMPL_H
 #define MQUEUE_MQUEUE_IMPL_H
 
+#include <common/crt.h>
+#include <common/pthread.h>
+
 #include <sys/types.h>
 
+#include <cloudabi_syscalls.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <mqueue.h>
 #include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -37,6 +45,45 @@ struct message {
   char contents[];               // Message body.
 };
 
+// Lock-free message queues.
+//
+// Message queues created with MQ_LOCKFREE preallocate a contiguous
+// array of mq_maxmsg slots of mq_msgsize bytes. Indices of slots are
+// passed around through bounded multi-producer multi-consumer rings,
+// based on the design by Dmitry Vyukov. One ring holds the indices of
+// free slots, whereas every priority has a ring holding the indices of
+// slots containing messages. Every ring can hold all of the slots, so
+// that senders never have to allocate memory. This means that the rings
+// use _POSIX_MQ_PRIO_MAX + 1 cells per slot, which is documented in
+// <mqueue.h>.
+//
+// Two semaphores keep track of the number of free slots and the number
+// of messages. Threads first decrement one of the semaphores, meaning
+// that they only block when the queue is full or empty. Afterwards they
+// are guaranteed to be able to extract an index from one of the rings,
+// though they may have to retry while other threads are still in the
+// middle of inserting one.
+
+#define MQ_LOCKFREE_PRIO_MAX _POSIX_MQ_PRIO_MAX
+
+struct mq_ring_cell {
+  _Atomic(size_t) sequence;  // Position at which the cell is usable.
+  size_t slot;               // Index of the slot.
+};
+
+struct mq_ring {
+  _Atomic(size_t) head;        // Position of the next cell to extract.
+  _Atomic(size_t) tail;        // Position of the next cell to insert.
+  struct mq_ring_cell *cells;  // Cells. Number is a power of two.
+  size_t mask;                 // Number of cells, minus one.
+};
+
+// Message slot.
+struct message_slot {
+  size_t length;    // Length of the message body.
+  char contents[];  // Message body.
+};
+
 // Message queue.
 struct __mqd {
   pthread_mutex_t lock;           // Queue lock.
@@ -45,6 +92,17 @@ struct __mqd {
   struct mq_attr attr;            // Queue attributes.
   struct message *queue_receive;  // List of messages to be returned.
   struct message *queue_send;     // Last message of the highest priority.
+
+  // Fields only used by lock-free message queues.
+  bool lockfree;                      // Created with MQ_LOCKFREE.
+  atomic_bool nonblock;               // O_NONBLOCK is set.
+  sem_t free_slots;                   // Number of free slots.
+  sem_t messages;                     // Number of messages.
+  _Atomic(uint32_t) priorities_used;  // Priorities ever used for sending.
+  char *slots;                        // Storage of message slots.
+  size_t slot_size;                   // Size of a single message slot.
+  struct mq_ring free_ring;           // Free slots.
+  struct mq_ring ring_receive[MQ_LOCKFREE_PRIO_MAX];  // Slots per priority.
 };
 
 static inline bool mq_receive_pre(struct __mqd *mqd, size_t msg_len)
@@ -79,8 +137,8 @@ static inline size_t mq_receive_post(struct __mqd *mqd, char *msg_ptr,
   // skip list to point to the next priority.
   if (mqd->queue_send == m)
     mqd->queue_send = m->next_send;
-  pthread_mutex_unlock(&mqd->lock);
   pthread_cond_signal(&mqd->cond_send);
+  pthread_mutex_unlock(&mqd->lock);
 
   // Copy out the message contents and free it.
   size_t length = m->length;
@@ -158,8 +216,181 @@ static inline int mq_send_post(struct __mqd *mqd, const char *msg_ptr,
 inserted:
   // Successfully inserted the message into the queue.
   ++mqd->attr.mq_curmsgs;
-  pthread_mutex_unlock(&mqd->lock);
   pthread_cond_signal(&mqd->cond_receive);
+  pthread_mutex_unlock(&mqd->lock);
+  return 0;
+}
+
+static inline void mq_ring_init(struct mq_ring *ring,
+                                struct mq_ring_cell *cells, size_t ncells) {
+  atomic_init(&ring->head, 0);
+  atomic_init(&ring->tail, 0);
+  ring->cells = cells;
+  ring->mask = ncells - 1;
+  for (size_t i = 0; i < ncells; ++i)
+    atomic_init(&cells[i].sequence, i);
+}
+
+// Inserts the index of a slot into a ring. Fails if the ring is full,
+// or if another thread is still extracting the cell to be used.
+static inline bool mq_ring_tryput(struct mq_ring *ring, size_t slot) {
+  size_t pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  for (;;) {
+    struct mq_ring_cell *cell = &ring->cells[pos & ring->mask];
+    size_t sequence =
+        atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    if (sequence == pos) {
+      if (atomic_compare_exchange_weak_explicit(&ring->tail, &pos, pos + 1,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)) {
+        cell->slot = slot;
+        atomic_store_explicit(&cell->sequence, pos + 1,
+                              memory_order_release);
+        return true;
+      }
+    } else if ((ssize_t)(sequence - pos) < 0) {
+      return false;
+    } else {
+      pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    }
+  }
+}
+
+// Extracts the index of a slot from a ring. Fails if the ring is empty,
+// or if another thread is still inserting into the next cell.
+static inline bool mq_ring_tryget(struct mq_ring *ring, size_t *slot) {
+  size_t pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  for (;;) {
+    struct mq_ring_cell *cell = &ring->cells[pos & ring->mask];
+    size_t sequence =
+        atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    if (sequence == pos + 1) {
+      if (atomic_compare_exchange_weak_explicit(&ring->head, &pos, pos + 1,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)) {
+        *slot = cell->slot;
+        atomic_store_explicit(&cell->sequence, pos + ring->mask + 1,
+                              memory_order_release);
+        return true;
+      }
+    } else if ((ssize_t)(sequence - (pos + 1)) < 0) {
+      return false;
+    } else {
+      pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    }
+  }
+}
+
+// Lets other threads finish accessing a ring. On systems with a single
+// CPU, yield to let these threads make progress.
+static inline void mq_ring_pause(void) {
+  if (__at_ncpus <= 1)
+    cloudabi_sys_thread_yield();
+  else
+    __pthread_spin_pause();
+}
+
+static inline struct message_slot *mq_slot_get(struct __mqd *mqd,
+                                               size_t slot) {
+  return (struct message_slot *)(mqd->slots + slot * mqd->slot_size);
+}
+
+// Decrements one of the semaphores of a lock-free message queue,
+// blocking if needed. Returns an error number if it would block with
+// O_NONBLOCK set or if waiting times out.
+static inline int mq_lockfree_acquire(struct __mqd *mqd, sem_t *sem,
+                                      const struct timespec *abstime) {
+  if (sem_trywait(sem) == 0)
+    return 0;
+  if (atomic_load_explicit(&mqd->nonblock, memory_order_relaxed))
+    return EAGAIN;
+  if ((abstime == NULL ? sem_wait(sem) : sem_timedwait(sem, abstime)) != 0)
+    return errno;
+  return 0;
+}
+
+static inline ssize_t mq_lockfree_receive(struct __mqd *mqd, char *msg_ptr,
+                                          size_t msg_len,
+                                          unsigned int *msg_prio,
+                                          const struct timespec *abstime) {
+  // Fail if the provided buffer size is less than the message size
+  // attribute of the message queue.
+  if (msg_len < (size_t)mqd->attr.mq_msgsize) {
+    errno = EMSGSIZE;
+    return -1;
+  }
+  int error = mq_lockfree_acquire(mqd, &mqd->messages, abstime);
+  if (error != 0) {
+    errno = error;
+    return -1;
+  }
+
+  // Extract a message from the highest priority ring that is non-empty.
+  // As the semaphore has been decremented, such a ring is guaranteed to
+  // exist.
+  size_t slot;
+  unsigned int priority;
+  for (;;) {
+    uint32_t used =
+        atomic_load_explicit(&mqd->priorities_used, memory_order_relaxed);
+    while (used != 0) {
+      priority = 31 - __builtin_clz(used);
+      if (mq_ring_tryget(&mqd->ring_receive[priority], &slot))
+        goto extracted;
+      used &= ~((uint32_t)1 << priority);
+    }
+    mq_ring_pause();
+  }
+
+extracted:;
+  // Copy out the message contents and release the slot.
+  struct message_slot *m = mq_slot_get(mqd, slot);
+  size_t length = m->length;
+  memcpy(msg_ptr, m->contents, length);
+  if (msg_prio != NULL)
+    *msg_prio = priority;
+  while (!mq_ring_tryput(&mqd->free_ring, slot))
+    mq_ring_pause();
+  sem_post(&mqd->free_slots);
+  return length;
+}
+
+static inline int mq_lockfree_send(struct __mqd *mqd, const char *msg_ptr,
+                                   size_t msg_len, unsigned int msg_prio,
+                                   const struct timespec *abstime) {
+  // Fail if the size of the provided message is more than the message
+  // size attribute of the message queue, or if the priority cannot be
+  // represented.
+  if (msg_len > (size_t)mqd->attr.mq_msgsize) {
+    errno = EMSGSIZE;
+    return -1;
+  }
+  if (msg_prio >= MQ_LOCKFREE_PRIO_MAX) {
+    errno = EINVAL;
+    return -1;
+  }
+  int error = mq_lockfree_acquire(mqd, &mqd->free_slots, abstime);
+  if (error != 0) {
+    errno = error;
+    return -1;
+  }
+
+  // Obtain a free slot and copy in the message contents.
+  size_t slot;
+  while (!mq_ring_tryget(&mqd->free_ring, &slot))
+    mq_ring_pause();
+  struct message_slot *m = mq_slot_get(mqd, slot);
+  m->length = msg_len;
+  memcpy(m->contents, msg_ptr, msg_len);
+
+  // Insert the message into the ring of its priority.
+  uint32_t bit = (uint32_t)1 << msg_prio;
+  if ((atomic_load_explicit(&mqd->priorities_used, memory_order_relaxed) &
+       bit) == 0)
+    atomic_fetch_or_explicit(&mqd->priorities_used, bit, memory_order_relaxed);
+  while (!mq_ring_tryput(&mqd->ring_receive[msg_prio], slot))
+    mq_ring_pause();
+  sem_post(&mqd->messages);
   return 0;
 }
 
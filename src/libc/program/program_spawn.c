@@ -9,11 +9,16 @@
 #include <cloudabi_syscalls.h>
 #include <errno.h>
 #include <program.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <uv.h>
 
 int program_spawn(uv_loop_t *loop, uv_process_t *handle, int fd,
                   const argdata_t *ad, uv_exit_cb cb) {
+  // Ensure the process can be added to the loop once spawned.
+  if (!__uv_subscriptions_reserve(loop, 1))
+    return ENOMEM;
+
   // Serialize the argument data.
   size_t datalen;
   size_t fdslen;
@@ -80,7 +85,13 @@ int program_spawn(uv_loop_t *loop, uv_process_t *handle, int fd,
   // Program spawned successfully.
   __uv_handle_init(loop, (uv_handle_t *)handle, UV_PROCESS);
   __uv_handle_start((uv_handle_t *)handle);
-  __uv_active_processes_insert_last(&loop->__active_processes, handle);
+  __uv_subscriptions_insert(
+      loop, &handle->__slot,
+      &(cloudabi_subscription_t){
+          .userdata = (uintptr_t)handle,
+          .type = CLOUDABI_EVENTTYPE_PROC_TERMINATE,
+          .proc_terminate.fd = process_fd,
+      });
   handle->__cb = cb;
   handle->__fd = process_fd;
   return 0;
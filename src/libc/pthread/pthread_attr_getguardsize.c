@@ -0,0 +1,11 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <pthread.h>
+
+int pthread_attr_getguardsize(const pthread_attr_t *restrict attr,
+                              size_t *restrict guardsize) {
+  *guardsize = attr->__guardsize;
+  return 0;
+}
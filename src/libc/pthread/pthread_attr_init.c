@@ -10,5 +10,6 @@ int pthread_attr_init(pthread_attr_t *attr) {
   // Set default values.
   attr->__detachstate = PTHREAD_CREATE_JOINABLE;
   attr->__stacksize = PTHREAD_STACK_DEFAULT;
+  attr->__guardsize = 0;
   return 0;
 }
@@ -17,6 +17,12 @@ TEST(pthread_attr_init, defaults) {
     ASSERT_EQ(PTHREAD_CREATE_JOINABLE, detachstate);
   }
 
+  {
+    size_t guardsize;
+    ASSERT_EQ(0, pthread_attr_getguardsize(&attr, &guardsize));
+    ASSERT_EQ(0, guardsize);
+  }
+
   {
     size_t stacksize;
     ASSERT_EQ(0, pthread_attr_getstacksize(&attr, &stacksize));
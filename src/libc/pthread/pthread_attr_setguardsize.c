@@ -0,0 +1,10 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <pthread.h>
+
+int pthread_attr_setguardsize(pthread_attr_t *attr, size_t guardsize) {
+  attr->__guardsize = guardsize;
+  return 0;
+}
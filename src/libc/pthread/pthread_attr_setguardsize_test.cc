@@ -0,0 +1,42 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <pthread.h>
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+TEST(pthread_attr_setguardsize, get) {
+  pthread_attr_t attr;
+  ASSERT_EQ(0, pthread_attr_init(&attr));
+  ASSERT_EQ(0, pthread_attr_setguardsize(&attr, 12345));
+  size_t guardsize;
+  ASSERT_EQ(0, pthread_attr_getguardsize(&attr, &guardsize));
+  ASSERT_EQ(12345, guardsize);
+  ASSERT_EQ(0, pthread_attr_destroy(&attr));
+}
+
+static void *use_stack(void *arg) {
+  // Make sure the stack is fully usable.
+  char buf[16384];
+  memset(buf, 'a', sizeof(buf));
+  asm volatile("" : : "r"(buf) : "memory");
+  return arg;
+}
+
+TEST(pthread_attr_setguardsize, example) {
+  // Spawn threads with guard pages. Stacks of threads that have been
+  // joined may be reused by subsequent threads.
+  pthread_attr_t attr;
+  ASSERT_EQ(0, pthread_attr_init(&attr));
+  ASSERT_EQ(0, pthread_attr_setguardsize(&attr, 1));
+  for (int i = 0; i < 20; ++i) {
+    pthread_t thread;
+    ASSERT_EQ(0, pthread_create(&thread, &attr, use_stack, &attr));
+    void *ret;
+    ASSERT_EQ(0, pthread_join(thread, &ret));
+    ASSERT_EQ(&attr, ret);
+  }
+  ASSERT_EQ(0, pthread_attr_destroy(&attr));
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "gtest/gtest.h"
+
+// Latency benchmark for barriers. A varying number of threads
+// repeatedly wait on the same barrier without performing any work in
+// between, measuring the time it takes for all threads to get released.
+
+namespace {
+
+constexpr unsigned int kRounds = 1 << 14;
+constexpr unsigned int kMaxThreads = 64;
+
+double now() {
+  struct timespec ts;
+  EXPECT_EQ(0, clock_gettime(CLOCK_MONOTONIC, &ts));
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void *do_wait(void *arg) {
+  pthread_barrier_t *barrier = static_cast<pthread_barrier_t *>(arg);
+  for (unsigned int i = 0; i < kRounds; ++i) {
+    int ret = pthread_barrier_wait(barrier);
+    EXPECT_TRUE(ret == 0 || ret == PTHREAD_BARRIER_SERIAL_THREAD);
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+TEST(pthread_barrier, latency) {
+  for (unsigned int nthreads = 2; nthreads <= kMaxThreads; nthreads *= 2) {
+    pthread_barrier_t barrier;
+    ASSERT_EQ(0, pthread_barrier_init(&barrier, nullptr, nthreads));
+
+    // Let the main thread participate in the barrier as well.
+    pthread_t threads[kMaxThreads];
+    for (unsigned int i = 1; i < nthreads; ++i)
+      ASSERT_EQ(0, pthread_create(&threads[i], nullptr, do_wait, &barrier));
+    double begin = now();
+    do_wait(&barrier);
+    double elapsed = now() - begin;
+    for (unsigned int i = 1; i < nthreads; ++i)
+      ASSERT_EQ(0, pthread_join(threads[i], nullptr));
+
+    ASSERT_EQ(0, pthread_barrier_destroy(&barrier));
+    printf("threads=%2u %10.1f ns/round\n", nthreads,
+           elapsed / kRounds * 1e9);
+  }
+}
@@ -4,9 +4,11 @@
 
 #include <assert.h>
 #include <pthread.h>
+#include <stdatomic.h>
 
 int pthread_barrier_destroy(pthread_barrier_t *barrier) {
-  assert(barrier->__remaining == barrier->__init &&
+  assert(atomic_load_explicit(&barrier->__remaining, memory_order_relaxed) ==
+             barrier->__init &&
          "Barrier destroyed with threads waiting");
 
   pthread_mutex_destroy(&barrier->__lock);
@@ -19,6 +19,7 @@ int pthread_barrier_init(pthread_barrier_t *restrict barrier,
   barrier->__lock.__write_recursion = -1;
   barrier->__lock.__pshared =
       attr != NULL ? attr->__pshared : PTHREAD_PROCESS_PRIVATE;
+  atomic_init(&barrier->__lock.__spin_estimate, 0);
 
   // Initialize condition variable.
   atomic_init(&barrier->__cond.__waiters, CLOUDABI_CONDVAR_HAS_NO_WAITERS);
@@ -27,7 +28,7 @@ int pthread_barrier_init(pthread_barrier_t *restrict barrier,
 
   // Initialize other fields.
   barrier->__init = count - 1;
-  barrier->__remaining = count - 1;
-  barrier->__generation = 0;
+  atomic_init(&barrier->__remaining, count - 1);
+  atomic_init(&barrier->__generation, 0);
   return 0;
 }
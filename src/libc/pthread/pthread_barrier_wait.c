@@ -2,27 +2,93 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <common/crt.h>
+#include <common/pthread.h>
+
 #include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stdint.h>
 
-int pthread_barrier_wait(pthread_barrier_t *barrier) {
+// Barriers.
+//
+// Threads arriving at the barrier decrement an atomic counter of the
+// number of threads remaining. The last thread to arrive resets the
+// counter and advances the barrier's generation, releasing the other
+// threads. This means that arriving at the barrier never requires
+// acquiring the lock.
+//
+// Threads waiting for the generation to advance spin for a while, as
+// barriers are often used to synchronize short phases of computation.
+// Only if spinning fails do they block on the condition variable. The
+// lowest bit of the generation is set by blocked threads, so that the
+// last thread to arrive only needs to acquire the lock and broadcast
+// if threads are actually blocked.
+
+#define GENERATION_BLOCKED 0x1
+#define GENERATION_INCREMENT 0x2
+
+// Returns whether the generation of the barrier has advanced.
+static bool generation_advanced(pthread_barrier_t *barrier,
+                                uint32_t generation) {
+  return (atomic_load_explicit(&barrier->__generation, memory_order_acquire) &
+          ~GENERATION_BLOCKED) != generation;
+}
+
+static void wait_generation(pthread_barrier_t *barrier, uint32_t generation) {
+  // Spin until the generation advances.
+  if (__at_ncpus > 1) {
+    unsigned int backoff = 1;
+    for (unsigned int spent = 0; spent < LOCK_SPIN_MAX; spent += backoff) {
+      for (unsigned int i = 0; i < backoff; ++i)
+        __pthread_spin_pause();
+      if (generation_advanced(barrier, generation))
+        return;
+      if (backoff < LOCK_BACKOFF_MAX)
+        backoff *= 2;
+    }
+  }
+
+  // Block on the condition variable. Announce that we're blocking while
+  // holding the lock, so that the last thread to arrive cannot
+  // broadcast before we've started waiting.
   pthread_mutex_lock(&barrier->__lock);
-  if (barrier->__remaining == 0) {
+  uint32_t old = generation;
+  if (atomic_compare_exchange_strong_explicit(
+          &barrier->__generation, &old, generation | GENERATION_BLOCKED,
+          memory_order_relaxed, memory_order_relaxed) ||
+      old == (generation | GENERATION_BLOCKED)) {
+    do {
+      pthread_cond_wait(&barrier->__cond, &barrier->__lock);
+    } while (!generation_advanced(barrier, generation));
+  }
+  pthread_mutex_unlock(&barrier->__lock);
+}
+
+int pthread_barrier_wait(pthread_barrier_t *barrier) {
+  // Obtain the current generation before arriving, as the last thread
+  // may advance it right after.
+  uint32_t generation =
+      atomic_load_explicit(&barrier->__generation, memory_order_acquire) &
+      ~GENERATION_BLOCKED;
+  if (atomic_fetch_sub_explicit(&barrier->__remaining, 1,
+                                memory_order_acq_rel) == 0) {
     // Last thread on the barrier. Reset the barrier and wake up waiters.
-    barrier->__remaining = barrier->__init;
-    ++barrier->__generation;
-    pthread_mutex_unlock(&barrier->__lock);
-    pthread_cond_broadcast(&barrier->__cond);
+    atomic_store_explicit(&barrier->__remaining, barrier->__init,
+                          memory_order_relaxed);
+    uint32_t old = atomic_exchange_explicit(
+        &barrier->__generation, generation + GENERATION_INCREMENT,
+        memory_order_release);
+    if ((old & GENERATION_BLOCKED) != 0) {
+      pthread_mutex_lock(&barrier->__lock);
+      pthread_cond_broadcast(&barrier->__cond);
+      pthread_mutex_unlock(&barrier->__lock);
+    }
     return PTHREAD_BARRIER_SERIAL_THREAD;
   } else {
-    // We have to wait for more threads. Go to sleep until we've reached
-    // the next generation.
-    --barrier->__remaining;
-    uint32_t generation = barrier->__generation;
-    do {
-      pthread_cond_wait(&barrier->__cond, &barrier->__lock);
-    } while (generation == barrier->__generation);
-    pthread_mutex_unlock(&barrier->__lock);
+    // We have to wait for more threads. Wait until we've reached the
+    // next generation.
+    wait_generation(barrier, generation);
     return 0;
   }
 }
@@ -9,6 +9,11 @@
 #include <pthread.h>
 #include <stdatomic.h>
 
+// Instead of waking up all of the waiting threads, only to let them
+// contend on the lock they were waiting with, the kernel moves them to
+// the queue of the lock. Threads are then woken up one by one as the
+// lock is handed over to them. Callers should broadcast while holding
+// the lock to benefit from this.
 int pthread_cond_broadcast(pthread_cond_t *cond) {
   if (atomic_load_explicit(&cond->__waiters, memory_order_relaxed) !=
       CLOUDABI_CONDVAR_HAS_NO_WAITERS) {
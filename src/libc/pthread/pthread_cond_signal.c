@@ -8,6 +8,8 @@
 #include <pthread.h>
 #include <stdatomic.h>
 
+// Like pthread_cond_broadcast(), the kernel moves the thread to the
+// queue of the lock if the lock is held, instead of waking it up.
 int pthread_cond_signal(pthread_cond_t *cond) {
   if (atomic_load_explicit(&cond->__waiters, memory_order_relaxed) !=
       CLOUDABI_CONDVAR_HAS_NO_WAITERS) {
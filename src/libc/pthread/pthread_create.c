@@ -12,7 +12,6 @@
 #include <pthread.h>
 #include <stdalign.h>
 #include <stdatomic.h>
-#include <stdlib.h>
 #include <stdnoreturn.h>
 #include <string.h>
 
@@ -30,7 +29,7 @@ static noreturn void thread_entry(cloudabi_tid_t tid, void *data) {
   __pthread_self_object = handle;
   __pthread_thread_id = tid;
   __safestack_unsafe_stack_ptr = (void *)__rounddown(
-      (uintptr_t)handle->unsafe_stack + handle->unsafe_stacksize,
+      (uintptr_t)handle->stacks.unsafe_stack + handle->stacks.unsafe_stacksize,
       PTHREAD_UNSAFE_STACK_ALIGNMENT);
 
   // Initialize the the once object used for joining. This is also done
@@ -51,29 +50,24 @@ int pthread_create(pthread_t *restrict thread,
                    const pthread_attr_t *restrict attr,
                    void *(*start_routine)(void *), void *restrict arg) {
   size_t stacksize = attr != NULL ? attr->__stacksize : PTHREAD_STACK_DEFAULT;
-  size_t safe_stacksize =
-      stacksize + __pt_tls_memsz_aligned + sizeof(struct __pthread);
-  char *safe_stack = malloc(safe_stacksize);
-  if (safe_stack == NULL)
-    return EAGAIN;
-  size_t unsafe_stacksize = stacksize;
-  char *unsafe_stack = malloc(unsafe_stacksize);
-  if (unsafe_stack == NULL) {
-    free(safe_stack);
+  struct pthread_stacks stacks = {
+      .safe_stacksize =
+          stacksize + __pt_tls_memsz_aligned + sizeof(struct __pthread),
+      .unsafe_stacksize = stacksize,
+      .guardsize = attr != NULL ? attr->__guardsize : 0,
+  };
+  if (!__pthread_stacks_allocate(&stacks))
     return EAGAIN;
-  }
 
   // Steal a part from the top of the stack to store the thread handle.
+  char *safe_stack = stacks.safe_stack;
   pthread_t handle = (pthread_t)__rounddown(
-      (uintptr_t)safe_stack + safe_stacksize - sizeof(struct __pthread),
+      (uintptr_t)safe_stack + stacks.safe_stacksize - sizeof(struct __pthread),
       alignof(struct __pthread));
-  safe_stacksize = (char *)handle - safe_stack;
   bool detach = attr != NULL && attr->__detachstate == PTHREAD_CREATE_DETACHED;
   *handle = (struct __pthread){
       .join = ATOMIC_VAR_INIT(CLOUDABI_LOCK_BOGUS),
-      .safe_stack = safe_stack,
-      .unsafe_stack = unsafe_stack,
-      .unsafe_stacksize = unsafe_stacksize,
+      .stacks = stacks,
       .refcount = REFCOUNT_INIT(detach ? 1 : 2),
 
       .start_routine = start_routine,
@@ -87,15 +81,14 @@ int pthread_create(pthread_t *restrict thread,
   cloudabi_threadattr_t tdattr = {
       .entry_point = thread_entry,
       .stack = safe_stack,
-      .stack_len = safe_stacksize,
+      .stack_len = (char *)handle - safe_stack,
       .argument = handle,
   };
   cloudabi_tid_t tid;
   cloudabi_errno_t error = cloudabi_sys_thread_create(&tdattr, &tid);
   if (error != 0) {
     refcount_release(&__pthread_num_threads);
-    free(safe_stack);
-    free(unsafe_stack);
+    __pthread_stacks_free(&stacks);
     return error;
   }
 
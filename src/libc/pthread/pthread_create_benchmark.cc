@@ -0,0 +1,59 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "gtest/gtest.h"
+
+// Latency benchmarks for thread creation. Threads are repeatedly
+// created and joined, either one at a time or in batches, so that both
+// the cases where stacks can and cannot be reused are covered.
+
+namespace {
+
+constexpr unsigned int kThreadsPerRun = 1 << 12;
+constexpr unsigned int kMaxBatchSize = 64;
+
+double now() {
+  struct timespec ts;
+  EXPECT_EQ(0, clock_gettime(CLOCK_MONOTONIC, &ts));
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void *do_nothing(void *arg) {
+  return arg;
+}
+
+void benchmark(const char *name, size_t stacksize, size_t guardsize) {
+  pthread_attr_t attr;
+  ASSERT_EQ(0, pthread_attr_init(&attr));
+  ASSERT_EQ(0, pthread_attr_setstacksize(&attr, stacksize));
+  ASSERT_EQ(0, pthread_attr_setguardsize(&attr, guardsize));
+  for (unsigned int batch = 1; batch <= kMaxBatchSize; batch *= 4) {
+    double begin = now();
+    for (unsigned int i = 0; i < kThreadsPerRun; i += batch) {
+      pthread_t threads[kMaxBatchSize];
+      for (unsigned int j = 0; j < batch; ++j)
+        ASSERT_EQ(0, pthread_create(&threads[j], &attr, do_nothing, nullptr));
+      for (unsigned int j = 0; j < batch; ++j)
+        ASSERT_EQ(0, pthread_join(threads[j], nullptr));
+    }
+    double elapsed = now() - begin;
+    printf("%-8s stacksize=%7zu batch=%2u %8.1f us/thread\n", name,
+           stacksize, batch, elapsed / kThreadsPerRun * 1e6);
+  }
+  ASSERT_EQ(0, pthread_attr_destroy(&attr));
+}
+
+}  // namespace
+
+TEST(pthread_create, latency) {
+  benchmark("malloc", PTHREAD_STACK_MIN, 0);
+  benchmark("malloc", 1 << 20, 0);
+  benchmark("mmap", PTHREAD_STACK_MIN, 1);
+  benchmark("mmap", 1 << 20, 1);
+}
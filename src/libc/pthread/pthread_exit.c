@@ -11,11 +11,38 @@
 #include <limits.h>
 #include <pthread.h>
 #include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdlib.h>
 
 // Integration with jemalloc.
 void __malloc_thread_cleanup(void);
 
+// Returns whether a per-thread value is set for a key that still exists.
+static bool has_value(const struct pthread_specific *specific) {
+  return specific->value != NULL &&
+         specific->generation == specific->key->generation;
+}
+
+// Invokes the destructors of all per-thread values, returning whether
+// any destructors have been invoked. Values are cleared right before
+// invoking their destructor.
+static bool run_destructors(void) {
+  // Destructors may set new values, causing the array to be
+  // reallocated. Never hold on to pointers into the array.
+  bool invoked = false;
+  for (size_t i = 0; i < __pthread_specifics_size; ++i) {
+    struct pthread_specific *specific = &__pthread_specifics[i];
+    if (has_value(specific)) {
+      void *value = specific->value;
+      specific->value = NULL;
+      specific->key->destructor(value);
+      invoked = true;
+    }
+  }
+  return invoked;
+}
+
 noreturn void pthread_exit(void *value_ptr) {
   // Invoke cleanup routines registered by __cxa_thread_atexit().
   for (struct thread_atexit *entry =
@@ -33,25 +60,17 @@ noreturn void pthread_exit(void *value_ptr) {
 
   // Invoke destructors for per-thread values. These destructor functions
   // can register new values, so perform this step multiple times.
-  //
-  // TODO(ed): Is it valid to reset all values to NULL at once? This
-  // could be solved more elegantly if we used a splay tree, as we could
-  // just perform lookups while increasing the address.
-  for (int i = 0;
-       i < PTHREAD_DESTRUCTOR_ITERATIONS && !SLIST_EMPTY(&__pthread_specifics);
-       ++i) {
-    struct pthread_specifics list = SLIST_HEAD_INITIALIZER(list);
-    SLIST_SWAP(&__pthread_specifics, &list, pthread_specific);
-    struct pthread_specific *specific, *specific_tmp;
-    SLIST_FOREACH_SAFE(specific, &list, next, specific_tmp) {
-      if (specific->key->generation == specific->generation)
-        specific->key->destructor(specific->value);
-      free(specific);
-    }
+  for (int i = 0; i < PTHREAD_DESTRUCTOR_ITERATIONS; ++i) {
+    if (!run_destructors())
+      break;
   }
-  assert(SLIST_EMPTY(&__pthread_specifics) &&
-         "Failed to destroy all per-thread values within "
-         "PTHREAD_DESTRUCTOR_ITERATIONS iterations");
+  for (size_t i = 0; i < __pthread_specifics_size; ++i)
+    assert(!has_value(&__pthread_specifics[i]) &&
+           "Failed to destroy all per-thread values within "
+           "PTHREAD_DESTRUCTOR_ITERATIONS iterations");
+  free(__pthread_specifics);
+  __pthread_specifics = NULL;
+  __pthread_specifics_size = 0;
 
   // After invoking the cleanup functions and destructors, we should not
   // have picked up any locks.
@@ -5,25 +5,18 @@
 #include <common/pthread.h>
 
 #include <pthread.h>
-#include <stdlib.h>
+#include <stddef.h>
 #include <threads.h>
 
 void *pthread_getspecific(pthread_key_t key) {
-  struct pthread_specific *specific, **specific_prev;
-  SLIST_FOREACH_PREVPTR(specific, specific_prev, &__pthread_specifics, next) {
-    if (specific->generation != specific->key->generation) {
-      // Garbage collect entries whose key has been destroyed in the meantime.
-      SLIST_REMOVE_PREVPTR(specific_prev, next);
-      free(specific);
-    } else if (specific->key == key.__key) {
-      // Found a matching value. Move the entry to the head of the list
-      // to speed up future requests.
-      SLIST_REMOVE_PREVPTR(specific_prev, next);
-      SLIST_INSERT_HEAD(&__pthread_specifics, specific, next);
-      return specific->value;
-    }
-  }
-  return NULL;
+  struct __pthread_key *keyobj = key.__key;
+  if (keyobj->index >= __pthread_specifics_size)
+    return NULL;
+
+  // Ignore values that were set for a key that has been deleted in the
+  // meantime.
+  struct pthread_specific *specific = &__pthread_specifics[keyobj->index];
+  return specific->generation == keyobj->generation ? specific->value : NULL;
 }
 
 __strong_reference(pthread_getspecific, tss_get);
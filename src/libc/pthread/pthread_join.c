@@ -10,7 +10,6 @@
 #include <cloudabi_syscalls.h>
 #include <errno.h>
 #include <pthread.h>
-#include <stdlib.h>
 
 int pthread_join(pthread_t thread, void **value_ptr) {
   assert(thread != __pthread_self_object &&
@@ -45,11 +44,11 @@ int pthread_join(pthread_t thread, void **value_ptr) {
   if (value_ptr != NULL)
     *value_ptr = thread->return_value;
 
-  // Free the stack buffers associated with this thread. The safe stack
-  // buffer also contains the thread's handle.
+  // Release the stack buffers associated with this thread. The safe
+  // stack buffer also contains the thread's handle, so make a copy of
+  // the stack information first.
   refcount_assert_exclusive(&thread->refcount);
-  void *unsafe_stack = thread->unsafe_stack;
-  free(thread->safe_stack);
-  free(unsafe_stack);
+  struct pthread_stacks stacks = thread->stacks;
+  __pthread_stacks_free(&stacks);
   return 0;
 }
@@ -15,11 +15,14 @@ int pthread_key_create(pthread_key_t *key, void (*destructor)(void *)) {
   struct __pthread_key *keyobj;
   pthread_mutex_lock(&__pthread_key_freelist_lock);
   if (SLIST_EMPTY(&__pthread_key_freelist)) {
-    // Freelist is empty. Allocate new key object.
-    pthread_mutex_unlock(&__pthread_key_freelist_lock);
+    // Freelist is empty. Allocate new key object with a new index.
     keyobj = malloc(sizeof(*key->__key));
-    if (keyobj == NULL)
+    if (keyobj == NULL) {
+      pthread_mutex_unlock(&__pthread_key_freelist_lock);
       return ENOMEM;
+    }
+    keyobj->index = __pthread_keys_allocated++;
+    pthread_mutex_unlock(&__pthread_key_freelist_lock);
     keyobj->generation = 0;
   } else {
     // Pick a key object from the freelist.
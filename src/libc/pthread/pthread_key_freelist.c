@@ -5,7 +5,9 @@
 #include <common/pthread.h>
 
 #include <pthread.h>
+#include <stddef.h>
 
 pthread_mutex_t __pthread_key_freelist_lock = PTHREAD_MUTEX_INITIALIZER;
 struct pthread_key_freelist __pthread_key_freelist =
     SLIST_HEAD_INITIALIZER(__pthread_key_freelist);
+size_t __pthread_keys_allocated = 0;
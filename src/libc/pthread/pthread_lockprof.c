@@ -0,0 +1,108 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/pthread.h>
+
+#include <sys/mman.h>
+
+#include <cloudabi_syscalls.h>
+#include <execinfo.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+atomic_bool __pthread_lockprof_enabled;
+_Atomic(struct lockprof_table *) __pthread_lockprof_tables;
+
+static thread_local struct lockprof_table *lockprof_table;
+
+cloudabi_timestamp_t __pthread_lockprof_now(void) {
+  cloudabi_timestamp_t ts;
+  cloudabi_sys_clock_time_get(CLOUDABI_CLOCK_MONOTONIC, 1, &ts);
+  return ts;
+}
+
+// Adds a value to a counter that is only modified by the current
+// thread.
+static void counter_add(_Atomic(uint64_t) *counter, uint64_t value) {
+  atomic_store_explicit(
+      counter, atomic_load_explicit(counter, memory_order_relaxed) + value,
+      memory_order_relaxed);
+}
+
+// Allocates a table for the current thread. Tables are allocated using
+// mmap(), as malloc() may itself acquire locks.
+static struct lockprof_table *table_create(void) {
+  struct lockprof_table *table =
+      mmap(NULL, sizeof(*table), PROT_READ | PROT_WRITE,
+           MAP_ANON | MAP_PRIVATE, -1, 0);
+  if (table == MAP_FAILED)
+    return NULL;
+  table->next =
+      atomic_load_explicit(&__pthread_lockprof_tables, memory_order_relaxed);
+  while (!atomic_compare_exchange_weak_explicit(
+      &__pthread_lockprof_tables, &table->next, table, memory_order_release,
+      memory_order_relaxed))
+    ;
+  return table;
+}
+
+// Looks up the entry of a lock, using Knuth's multiplicative method to
+// hash its address and linear probing.
+static struct lockprof_entry *entry_get(struct lockprof_table *table,
+                                        const void *lock) {
+  uint32_t v = (uintptr_t)lock;
+  size_t index = v * UINT32_C(2654435761) >> (32 - LOCKPROF_NBITS);
+  for (size_t i = 0; i < LOCKPROF_ENTRIES; ++i) {
+    struct lockprof_entry *entry =
+        &table->entries[(index + i) % LOCKPROF_ENTRIES];
+    const void *key = atomic_load_explicit(&entry->lock, memory_order_relaxed);
+    if (key == lock)
+      return entry;
+    if (key == NULL) {
+      atomic_store_explicit(&entry->lock, lock, memory_order_release);
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+void __pthread_lockprof_add(const void *lock, cloudabi_timestamp_t begin,
+                            unsigned int flags) {
+  struct lockprof_table *table = lockprof_table;
+  if (table == NULL) {
+    table = lockprof_table = table_create();
+    if (table == NULL)
+      return;
+  }
+  struct lockprof_entry *entry = entry_get(table, lock);
+  if (entry == NULL) {
+    counter_add(&table->dropped, 1);
+    return;
+  }
+
+  if ((flags & LOCKPROF_TIMEDOUT) == 0)
+    counter_add(&entry->acquisitions, 1);
+  if ((flags & LOCKPROF_CONTENDED) != 0) {
+    counter_add(&entry->contended, 1);
+    if (begin != 0)
+      counter_add(&entry->wait_time, __pthread_lockprof_now() - begin);
+
+    // Store the call site of the first contended acquisition, skipping
+    // the frames of this function and the locking function.
+    if (atomic_load_explicit(&entry->nframes, memory_order_relaxed) == 0) {
+      void *frames[LOCKPROF_FRAMES + 2];
+      size_t nframes = backtrace(frames, LOCKPROF_FRAMES + 2);
+      if (nframes > 2) {
+        for (size_t i = 2; i < nframes; ++i)
+          entry->frames[i - 2] = frames[i];
+        atomic_store_explicit(&entry->nframes, nframes - 2,
+                              memory_order_release);
+      }
+    }
+  }
+  if ((flags & LOCKPROF_KERNEL) != 0)
+    counter_add(&entry->kernel, 1);
+}
@@ -0,0 +1,122 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/pthread.h>
+
+#include <errno.h>
+#include <execinfo.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Statistics of a single lock, merged across all threads.
+struct report_entry {
+  const void *lock;
+  uint64_t acquisitions;
+  uint64_t contended;
+  uint64_t kernel;
+  uint64_t wait_time;
+  size_t nframes;
+  void *frames[LOCKPROF_FRAMES];
+};
+
+static int compare_lock(const void *a, const void *b) {
+  const struct report_entry *ea = a, *eb = b;
+  return ea->lock < eb->lock ? -1 : ea->lock > eb->lock;
+}
+
+// Sorts locks by the time spent waiting on them, followed by the number
+// of contended acquisitions.
+static int compare_contention(const void *a, const void *b) {
+  const struct report_entry *ea = a, *eb = b;
+  if (ea->wait_time != eb->wait_time)
+    return ea->wait_time < eb->wait_time ? 1 : -1;
+  if (ea->contended != eb->contended)
+    return ea->contended < eb->contended ? 1 : -1;
+  return compare_lock(a, b);
+}
+
+int pthread_lockprof_report_np(int fd) {
+  // Count the number of entries in all tables.
+  struct lockprof_table *tables =
+      atomic_load_explicit(&__pthread_lockprof_tables, memory_order_acquire);
+  size_t nentries = 0;
+  uint64_t dropped = 0;
+  for (struct lockprof_table *t = tables; t != NULL; t = t->next) {
+    for (size_t i = 0; i < LOCKPROF_ENTRIES; ++i)
+      if (atomic_load_explicit(&t->entries[i].lock, memory_order_relaxed) !=
+          NULL)
+        ++nentries;
+    dropped += atomic_load_explicit(&t->dropped, memory_order_relaxed);
+  }
+
+  // Copy out the entries. Tables may gain entries in the meantime, so
+  // stop copying once the array is full.
+  struct report_entry *entries = calloc(nentries, sizeof(*entries));
+  if (entries == NULL && nentries > 0)
+    return ENOMEM;
+  size_t ncopied = 0;
+  for (struct lockprof_table *t = tables; t != NULL; t = t->next) {
+    for (size_t i = 0; i < LOCKPROF_ENTRIES && ncopied < nentries; ++i) {
+      struct lockprof_entry *le = &t->entries[i];
+      const void *lock =
+          atomic_load_explicit(&le->lock, memory_order_acquire);
+      if (lock == NULL)
+        continue;
+      struct report_entry *re = &entries[ncopied++];
+      re->lock = lock;
+      re->acquisitions =
+          atomic_load_explicit(&le->acquisitions, memory_order_relaxed);
+      re->contended =
+          atomic_load_explicit(&le->contended, memory_order_relaxed);
+      re->kernel = atomic_load_explicit(&le->kernel, memory_order_relaxed);
+      re->wait_time =
+          atomic_load_explicit(&le->wait_time, memory_order_relaxed);
+      re->nframes = atomic_load_explicit(&le->nframes, memory_order_acquire);
+      for (size_t j = 0; j < re->nframes; ++j)
+        re->frames[j] = le->frames[j];
+    }
+  }
+
+  // Merge the statistics of locks used by multiple threads. Retain the
+  // first call site that is available.
+  qsort(entries, ncopied, sizeof(*entries), compare_lock);
+  size_t nmerged = 0;
+  for (size_t i = 0; i < ncopied; ++i) {
+    struct report_entry *re = &entries[i];
+    if (nmerged > 0 && entries[nmerged - 1].lock == re->lock) {
+      struct report_entry *merged = &entries[nmerged - 1];
+      merged->acquisitions += re->acquisitions;
+      merged->contended += re->contended;
+      merged->kernel += re->kernel;
+      merged->wait_time += re->wait_time;
+      if (merged->nframes == 0) {
+        merged->nframes = re->nframes;
+        memcpy(merged->frames, re->frames, sizeof(re->frames));
+      }
+    } else {
+      entries[nmerged++] = *re;
+    }
+  }
+
+  // Print the locks, starting with the most contended one.
+  qsort(entries, nmerged, sizeof(*entries), compare_contention);
+  for (size_t i = 0; i < nmerged; ++i) {
+    struct report_entry *re = &entries[i];
+    dprintf(fd,
+            "lock %p: acquisitions %" PRIu64 ", contended %" PRIu64
+            ", kernel %" PRIu64 ", wait time %" PRIu64 " ns\n",
+            re->lock, re->acquisitions, re->contended, re->kernel,
+            re->wait_time);
+    backtrace_symbols_fd(re->frames, re->nframes, fd);
+  }
+  if (dropped > 0)
+    dprintf(fd, "%" PRIu64 " acquisitions of locks not recorded\n", dropped);
+  free(entries);
+  return 0;
+}
@@ -0,0 +1,14 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/pthread.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+int pthread_lockprof_stop_np(void) {
+  atomic_store_explicit(&__pthread_lockprof_enabled, false,
+                        memory_order_relaxed);
+  return 0;
+}
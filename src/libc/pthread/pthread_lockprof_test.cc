@@ -0,0 +1,59 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+void *do_lock(void *arg) __no_lock_analysis {
+  pthread_mutex_t *mutex = static_cast<pthread_mutex_t *>(arg);
+  EXPECT_EQ(0, pthread_mutex_lock(mutex));
+  EXPECT_EQ(0, pthread_mutex_unlock(mutex));
+  return nullptr;
+}
+
+}  // namespace
+
+TEST(pthread_lockprof, contended) __no_lock_analysis {
+  static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+  ASSERT_EQ(0, pthread_lockprof_start_np());
+
+  // Let another thread block on a lock that we're holding.
+  ASSERT_EQ(0, pthread_mutex_lock(&mutex));
+  pthread_t thread;
+  ASSERT_EQ(0, pthread_create(&thread, nullptr, do_lock, &mutex));
+  struct timespec ts = {.tv_sec = 0, .tv_nsec = 100000000};
+  ASSERT_EQ(0, clock_nanosleep(CLOCK_MONOTONIC, 0, &ts));
+  ASSERT_EQ(0, pthread_mutex_unlock(&mutex));
+  ASSERT_EQ(0, pthread_join(thread, nullptr));
+
+  // Acquiring the lock after profiling has stopped should not be
+  // recorded.
+  ASSERT_EQ(0, pthread_lockprof_stop_np());
+  ASSERT_EQ(0, pthread_mutex_lock(&mutex));
+  ASSERT_EQ(0, pthread_mutex_unlock(&mutex));
+
+  // Let pthread_lockprof_report_np() write its output into a pipe.
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  ASSERT_EQ(0, pthread_lockprof_report_np(fds[1]));
+  ASSERT_EQ(0, close(fds[1]));
+  char actual[4096];
+  ssize_t len = read(fds[0], actual, sizeof(actual) - 1);
+  ASSERT_LT(0, len);
+  actual[len] = '\0';
+  ASSERT_EQ(0, close(fds[0]));
+
+  // Only the acquisitions while profiling should have been recorded.
+  char expected[64];
+  snprintf(expected, sizeof(expected), "lock %p: acquisitions 2, contended 1,",
+           &mutex);
+  ASSERT_THAT(actual, testing::HasSubstr(expected));
+}
@@ -0,0 +1,99 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "gtest/gtest.h"
+
+// Contention benchmarks for mutexes. A number of threads repeatedly
+// acquire a shared mutex, performing a varying amount of work while
+// holding it and in between acquisitions. These can be used to tune
+// the parameters of adaptive spinning.
+
+namespace {
+
+constexpr unsigned int kMaxThreads = 16;
+constexpr unsigned int kAcquisitionsPerRun = 1 << 18;
+
+double now() {
+  struct timespec ts;
+  EXPECT_EQ(0, clock_gettime(CLOCK_MONOTONIC, &ts));
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Performs an amount of work that cannot be optimized away.
+void work(unsigned int iterations) {
+  for (unsigned int i = 0; i < iterations; ++i)
+    asm volatile("" : : : "memory");
+}
+
+struct state {
+  pthread_mutex_t mutex;
+  pthread_barrier_t barrier;
+  unsigned int acquisitions;
+  unsigned int hold;
+  unsigned int delay;
+  uint64_t counter;
+};
+
+void *hammer(void *arg) __no_lock_analysis {
+  auto s = static_cast<state *>(arg);
+  pthread_barrier_wait(&s->barrier);
+  for (unsigned int i = 0; i < s->acquisitions; ++i) {
+    pthread_mutex_lock(&s->mutex);
+    ++s->counter;
+    work(s->hold);
+    pthread_mutex_unlock(&s->mutex);
+    work(s->delay);
+  }
+  return nullptr;
+}
+
+void benchmark(unsigned int hold, unsigned int delay) {
+  for (unsigned int nthreads = 1; nthreads <= kMaxThreads; nthreads *= 2) {
+    state s;
+    ASSERT_EQ(0, pthread_mutex_init(&s.mutex, nullptr));
+    ASSERT_EQ(0, pthread_barrier_init(&s.barrier, nullptr, nthreads + 1));
+    s.acquisitions = kAcquisitionsPerRun / nthreads;
+    s.hold = hold;
+    s.delay = delay;
+    s.counter = 0;
+
+    pthread_t threads[kMaxThreads];
+    for (unsigned int i = 0; i < nthreads; ++i)
+      ASSERT_EQ(0, pthread_create(&threads[i], nullptr, hammer, &s));
+    double begin = now();
+    pthread_barrier_wait(&s.barrier);
+    for (unsigned int i = 0; i < nthreads; ++i)
+      ASSERT_EQ(0, pthread_join(threads[i], nullptr));
+    double elapsed = now() - begin;
+
+    ASSERT_EQ(uint64_t{s.acquisitions} * nthreads, s.counter);
+    printf("hold=%4u delay=%4u threads=%2u %8.1f ns/acquisition\n", hold,
+           delay, nthreads, elapsed / s.counter * 1e9);
+    ASSERT_EQ(0, pthread_barrier_destroy(&s.barrier));
+    ASSERT_EQ(0, pthread_mutex_destroy(&s.mutex));
+  }
+}
+
+}  // namespace
+
+TEST(pthread_mutex, empty_critical_section) {
+  benchmark(0, 0);
+}
+
+TEST(pthread_mutex, short_critical_section) {
+  benchmark(100, 100);
+}
+
+TEST(pthread_mutex, long_critical_section) {
+  benchmark(2000, 100);
+}
+
+TEST(pthread_mutex, mostly_uncontended) {
+  benchmark(100, 2000);
+}
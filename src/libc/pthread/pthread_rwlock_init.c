@@ -18,6 +18,7 @@ int pthread_rwlock_init(pthread_rwlock_t *restrict rwlock,
   rwlock->__write_recursion =
       attr != NULL && attr->__type == PTHREAD_MUTEX_RECURSIVE ? 0 : -1;
   rwlock->__pshared = attr != NULL ? attr->__pshared : PTHREAD_PROCESS_PRIVATE;
+  atomic_init(&rwlock->__spin_estimate, 0);
   return 0;
 }
 
@@ -0,0 +1,62 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/crt.h>
+#include <common/pthread.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+bool __pthread_rwlock_spin(pthread_rwlock_t *rwlock,
+                           bool write) __no_lock_analysis {
+  // Spinning is pointless on systems with a single CPU, as the thread
+  // holding the lock cannot make any progress in the meantime.
+  if (__at_ncpus <= 1)
+    return false;
+
+  unsigned int estimate =
+      atomic_load_explicit(&rwlock->__spin_estimate, memory_order_relaxed);
+  unsigned int budget = 2 * estimate + LOCK_SPIN_MIN;
+  if (budget > LOCK_SPIN_MAX)
+    budget = LOCK_SPIN_MAX;
+
+  bool acquired = false;
+  unsigned int spent = 0;
+  for (unsigned int backoff = 1; spent < budget && !acquired;) {
+    for (unsigned int i = 0; i < backoff; ++i)
+      __pthread_spin_pause();
+    spent += backoff;
+    if (backoff < LOCK_BACKOFF_MAX)
+      backoff *= 2;
+
+    // Stop spinning as soon as the lock is managed by the kernel. Other
+    // threads are then blocked on the lock, meaning that it will be
+    // handed over to one of them, as opposed to being released.
+    cloudabi_lock_t old =
+        atomic_load_explicit(&rwlock->__state, memory_order_relaxed);
+    if ((old & CLOUDABI_LOCK_KERNEL_MANAGED) != 0)
+      break;
+
+    // Only attempt to acquire the lock if it looks available, so that
+    // the cache line isn't continuously acquired exclusively.
+    if (write) {
+      acquired = old == CLOUDABI_LOCK_UNLOCKED &&
+                 pthread_rwlock_trywrlock(rwlock) == 0;
+    } else {
+      acquired = (old & CLOUDABI_LOCK_WRLOCKED) == 0 &&
+                 pthread_rwlock_tryrdlock(rwlock) == 0;
+    }
+  }
+
+  // Let the estimate converge to the amount of time it took to acquire
+  // the lock. Spinning that didn't acquire the lock counts as zero, so
+  // that the estimate decays for locks that are rarely released in
+  // time. Races between threads updating the estimate are harmless.
+  int sample = acquired ? (int)spent : 0;
+  atomic_store_explicit(&rwlock->__spin_estimate,
+                        (int)estimate + (sample - (int)estimate) / 8,
+                        memory_order_relaxed);
+  return acquired;
+}
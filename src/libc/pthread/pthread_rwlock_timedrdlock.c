@@ -12,11 +12,16 @@
 int pthread_rwlock_timedrdlock(pthread_rwlock_t *restrict rwlock,
                                const struct timespec *restrict abstime)
     __no_lock_analysis {
-  // Attempt to acquire the lock in userspace.
-  for (int i = 0; i < LOCK_RETRY_COUNT; ++i) {
-    int error = pthread_rwlock_tryrdlock(rwlock);
-    if (error != EBUSY)
-      return error;
+  // Attempt to acquire the lock in userspace, spinning for a while if
+  // it is held by another thread.
+  if (pthread_rwlock_tryrdlock(rwlock) == 0) {
+    __pthread_lockprof_record(rwlock, 0, 0);
+    return 0;
+  }
+  cloudabi_timestamp_t begin = __pthread_lockprof_begin();
+  if (__pthread_rwlock_spin(rwlock, false)) {
+    __pthread_lockprof_record(rwlock, begin, LOCKPROF_CONTENDED);
+    return 0;
   }
 
   // Call into the kernel to acquire a read lock.
@@ -47,8 +52,12 @@ int pthread_rwlock_timedrdlock(pthread_rwlock_t *restrict rwlock,
     if (events[i].type == CLOUDABI_EVENTTYPE_LOCK_RDLOCK) {
       // Lock acquired successfully.
       ++__pthread_rdlocks;
+      __pthread_lockprof_record(rwlock, begin,
+                                LOCKPROF_CONTENDED | LOCKPROF_KERNEL);
       return 0;
     }
   }
+  __pthread_lockprof_record(
+      rwlock, begin, LOCKPROF_CONTENDED | LOCKPROF_KERNEL | LOCKPROF_TIMEDOUT);
   return ETIMEDOUT;
 }
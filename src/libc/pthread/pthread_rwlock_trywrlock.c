@@ -35,4 +35,3 @@ int pthread_rwlock_trywrlock(pthread_rwlock_t *rwlock) __no_lock_analysis {
 }
 
 __strong_reference(pthread_rwlock_trywrlock, pthread_mutex_trylock);
-__strong_reference(pthread_rwlock_trywrlock, pthread_spin_trylock);
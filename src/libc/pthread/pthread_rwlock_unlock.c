@@ -89,4 +89,3 @@ int pthread_rwlock_unlock(pthread_rwlock_t *rwlock) __no_lock_analysis {
 }
 
 __strong_reference(pthread_rwlock_unlock, pthread_mutex_unlock);
-__strong_reference(pthread_rwlock_unlock, pthread_spin_unlock);
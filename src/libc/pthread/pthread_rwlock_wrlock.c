@@ -6,15 +6,19 @@
 
 #include <assert.h>
 #include <cloudabi_syscalls.h>
-#include <errno.h>
 #include <pthread.h>
 
 int pthread_rwlock_wrlock(pthread_rwlock_t *rwlock) __no_lock_analysis {
-  // Attempt to acquire the lock in userspace.
-  for (int i = 0; i < LOCK_RETRY_COUNT; ++i) {
-    int error = pthread_rwlock_trywrlock(rwlock);
-    if (error != EBUSY)
-      return error;
+  // Attempt to acquire the lock in userspace, spinning for a while if
+  // it is held by another thread.
+  if (pthread_rwlock_trywrlock(rwlock) == 0) {
+    __pthread_lockprof_record(rwlock, 0, 0);
+    return 0;
+  }
+  cloudabi_timestamp_t begin = __pthread_lockprof_begin();
+  if (__pthread_rwlock_spin(rwlock, true)) {
+    __pthread_lockprof_record(rwlock, begin, LOCKPROF_CONTENDED);
+    return 0;
   }
 
   // Call into the kernel to acquire a write lock.
@@ -34,8 +38,9 @@ int pthread_rwlock_wrlock(pthread_rwlock_t *rwlock) __no_lock_analysis {
   assert(rwlock->__write_recursion <= 0 && "Invalid write recursion count");
 
   // Lock acquired successfully.
+  __pthread_lockprof_record(rwlock, begin,
+                            LOCKPROF_CONTENDED | LOCKPROF_KERNEL);
   return 0;
 }
 
 __strong_reference(pthread_rwlock_wrlock, pthread_mutex_lock);
-__strong_reference(pthread_rwlock_wrlock, pthread_spin_lock);
@@ -6,52 +6,33 @@
 
 #include <errno.h>
 #include <pthread.h>
+#include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 int pthread_setspecific(pthread_key_t key, const void *value) {
   struct __pthread_key *keyobj = key.__key;
-  if (value == NULL) {
-    // Clear value associated with key.
-    struct pthread_specific *specific, **specific_prev;
-    SLIST_FOREACH_PREVPTR(specific, specific_prev, &__pthread_specifics, next) {
-      if (specific->key == keyobj) {
-        // Remove entry.
-        SLIST_REMOVE_PREVPTR(specific_prev, next);
-        free(specific);
-        return 0;
-      } else if (specific->generation != specific->key->generation) {
-        // Garbage collect entries whose key has been destroyed in the meantime.
-        SLIST_REMOVE_PREVPTR(specific_prev, next);
-        free(specific);
-      }
-    }
-  } else {
-    // Set value associated with key.
-    struct pthread_specific *specific, **specific_prev;
-    SLIST_FOREACH_PREVPTR(specific, specific_prev, &__pthread_specifics, next) {
-      if (specific->key == keyobj) {
-        // Update entry. Move the entry to the head of the list to speed
-        // up future requests.
-        specific->generation = keyobj->generation;
-        specific->value = (void *)value;
-        SLIST_REMOVE_PREVPTR(specific_prev, next);
-        SLIST_INSERT_HEAD(&__pthread_specifics, specific, next);
-        return 0;
-      } else if (specific->generation != specific->key->generation) {
-        // Garbage collect entries whose key has been destroyed in the meantime.
-        SLIST_REMOVE_PREVPTR(specific_prev, next);
-        free(specific);
-      }
-    }
+  if (keyobj->index >= __pthread_specifics_size) {
+    // Clearing a value beyond the end of the array is a no-op.
+    if (value == NULL)
+      return 0;
 
-    // No match found. Allocate new entry and place new entry in the list.
-    struct pthread_specific *new = malloc(sizeof(*new));
-    if (new == NULL)
+    // Extend the array to contain the key.
+    size_t new_size = (keyobj->index / PTHREAD_SPECIFICS_CHUNK + 1) *
+                      PTHREAD_SPECIFICS_CHUNK;
+    struct pthread_specific *new_specifics =
+        realloc(__pthread_specifics, new_size * sizeof(*new_specifics));
+    if (new_specifics == NULL)
       return ENOMEM;
-    new->key = keyobj;
-    new->generation = keyobj->generation;
-    new->value = (void *)value;
-    SLIST_INSERT_HEAD(&__pthread_specifics, new, next);
+    memset(new_specifics + __pthread_specifics_size, 0,
+           (new_size - __pthread_specifics_size) * sizeof(*new_specifics));
+    __pthread_specifics = new_specifics;
+    __pthread_specifics_size = new_size;
   }
+
+  struct pthread_specific *specific = &__pthread_specifics[keyobj->index];
+  specific->key = keyobj;
+  specific->value = (void *)value;
+  specific->generation = keyobj->generation;
   return 0;
 }
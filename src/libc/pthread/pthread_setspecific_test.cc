@@ -4,6 +4,8 @@
 
 #include <pthread.h>
 
+#include <iterator>
+
 #include "gtest/gtest.h"
 
 struct params {
@@ -93,3 +95,62 @@ TEST(pthread_setspecific, delete) {
   // Destructor should not have been called.
   ASSERT_EQ(0, params.val);
 }
+
+TEST(pthread_setspecific, many_keys) {
+  // Create a large number of keys, so that the per-thread value array
+  // needs to be extended multiple times.
+  pthread_key_t keys[100];
+  for (pthread_key_t &key : keys)
+    ASSERT_EQ(0, pthread_key_create(&key, NULL));
+  for (size_t i = 0; i < std::size(keys); ++i)
+    ASSERT_EQ(0, pthread_setspecific(keys[i], &keys[i]));
+  for (size_t i = 0; i < std::size(keys); ++i)
+    ASSERT_EQ(&keys[i], pthread_getspecific(keys[i]));
+
+  // Recreating a key should not expose the value of its predecessor.
+  ASSERT_EQ(0, pthread_key_delete(keys[42]));
+  ASSERT_EQ(0, pthread_key_create(&keys[42], NULL));
+  ASSERT_EQ(NULL, pthread_getspecific(keys[42]));
+  ASSERT_EQ(&keys[41], pthread_getspecific(keys[41]));
+  ASSERT_EQ(&keys[43], pthread_getspecific(keys[43]));
+
+  for (pthread_key_t key : keys) {
+    ASSERT_EQ(0, pthread_setspecific(key, NULL));
+    ASSERT_EQ(0, pthread_key_delete(key));
+  }
+}
+
+struct chain {
+  pthread_key_t first;
+  pthread_key_t second;
+  int calls;
+};
+
+static void dtor_chain(void *ptr) {
+  // Let the destructor of the first key set a value for the second key,
+  // which should cause the destructors to be run another time.
+  auto params = static_cast<chain *>(ptr);
+  if (params->calls++ == 0)
+    EXPECT_EQ(0, pthread_setspecific(params->second, params));
+}
+
+static void *do_chain(void *arg) {
+  auto params = static_cast<chain *>(arg);
+  EXPECT_EQ(0, pthread_setspecific(params->first, params));
+  return NULL;
+}
+
+TEST(pthread_setspecific, dtor_sets_value) {
+  chain params = {};
+  ASSERT_EQ(0, pthread_key_create(&params.first, dtor_chain));
+  ASSERT_EQ(0, pthread_key_create(&params.second, dtor_chain));
+
+  pthread_t thread;
+  ASSERT_EQ(0, pthread_create(&thread, NULL, do_chain, &params));
+  ASSERT_EQ(0, pthread_join(thread, NULL));
+
+  // Both destructors should have been called.
+  ASSERT_EQ(2, params.calls);
+  ASSERT_EQ(0, pthread_key_delete(params.first));
+  ASSERT_EQ(0, pthread_key_delete(params.second));
+}
@@ -0,0 +1,42 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+
+#include "gtest/gtest.h"
+
+TEST(pthread_setstackcachesize_np, einval) {
+  ASSERT_EQ(EINVAL, pthread_setstackcachesize_np(SIZE_MAX));
+}
+
+static void *return_arg(void *arg) {
+  return arg;
+}
+
+static void spawn_threads(int nthreads) {
+  pthread_t threads[16];
+  ASSERT_GE(16, nthreads);
+  for (int i = 0; i < nthreads; ++i)
+    ASSERT_EQ(0, pthread_create(&threads[i], NULL, return_arg, &threads[i]));
+  for (int i = 0; i < nthreads; ++i) {
+    void *ret;
+    ASSERT_EQ(0, pthread_join(threads[i], &ret));
+    ASSERT_EQ(&threads[i], ret);
+  }
+}
+
+TEST(pthread_setstackcachesize_np, example) {
+  // Fill the cache, shrink it and disable it entirely. Threads should
+  // still be created successfully.
+  ASSERT_EQ(0, pthread_setstackcachesize_np(16));
+  spawn_threads(16);
+  ASSERT_EQ(0, pthread_setstackcachesize_np(4));
+  spawn_threads(16);
+  ASSERT_EQ(0, pthread_setstackcachesize_np(0));
+  spawn_threads(16);
+  ASSERT_EQ(0, pthread_setstackcachesize_np(8));
+  spawn_threads(16);
+}
@@ -4,5 +4,7 @@
 
 #include <common/pthread.h>
 
-thread_local struct pthread_specifics __pthread_specifics =
-    LIST_HEAD_INITIALIZER(__pthread_specifics);
+#include <stddef.h>
+
+thread_local struct pthread_specific *__pthread_specifics = NULL;
+thread_local size_t __pthread_specifics_size = 0;
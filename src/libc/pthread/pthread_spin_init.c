@@ -10,5 +10,6 @@ int pthread_spin_init(pthread_spinlock_t *lock, int pshared) {
   atomic_init(&lock->__state, CLOUDABI_LOCK_UNLOCKED);
   lock->__write_recursion = -1;
   lock->__pshared = pshared;
+  atomic_init(&lock->__spin_estimate, 0);
   return 0;
 }
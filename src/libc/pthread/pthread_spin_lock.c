@@ -0,0 +1,44 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/crt.h>
+#include <common/pthread.h>
+
+#include <assert.h>
+#include <cloudabi_syscalls.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+int pthread_spin_lock(pthread_spinlock_t *lock) __no_lock_analysis {
+  // Spinlocks use the same representation as write-locked rwlocks, so
+  // that they can be used in combination with condition variables.
+  cloudabi_lock_t locked = __pthread_thread_id | CLOUDABI_LOCK_WRLOCKED;
+  for (unsigned int backoff = 1;;) {
+    cloudabi_lock_t old = CLOUDABI_LOCK_UNLOCKED;
+    if (atomic_compare_exchange_strong_explicit(
+            &lock->__state, &old, locked,
+            memory_order_acquire | __memory_order_hle_acquire,
+            memory_order_relaxed))
+      return 0;
+    assert((old & ~CLOUDABI_LOCK_KERNEL_MANAGED) != locked &&
+           "Attempted to recursively acquire a spinlock");
+
+    // Wait for the lock to be released before attempting to acquire it
+    // again, so that the cache line isn't continuously acquired
+    // exclusively. Back off exponentially to reduce traffic further.
+    // On systems with a single CPU, yield to let the thread holding the
+    // lock make progress.
+    do {
+      if (__at_ncpus <= 1) {
+        cloudabi_sys_thread_yield();
+      } else {
+        for (unsigned int i = 0; i < backoff; ++i)
+          __pthread_spin_pause();
+        if (backoff < LOCK_BACKOFF_MAX)
+          backoff *= 2;
+      }
+    } while (atomic_load_explicit(&lock->__state, memory_order_relaxed) !=
+             CLOUDABI_LOCK_UNLOCKED);
+  }
+}
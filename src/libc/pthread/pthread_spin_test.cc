@@ -47,6 +47,37 @@ TEST(pthread_spin, private) __no_lock_analysis {
   ASSERT_EQ(0, pthread_join(thread, NULL));
 }
 
+// Increments a counter protected by a spinlock many times.
+struct spin_counter {
+  pthread_spinlock_t spin;
+  unsigned int value;
+};
+
+static void *do_increment(void *arg) __no_lock_analysis {
+  auto counter = static_cast<spin_counter *>(arg);
+  for (int i = 0; i < 100000; ++i) {
+    pthread_spin_lock(&counter->spin);
+    ++counter->value;
+    pthread_spin_unlock(&counter->spin);
+  }
+  return NULL;
+}
+
+TEST(pthread_spin, contended) {
+  spin_counter counter = {.value = 0};
+  ASSERT_EQ(0, pthread_spin_init(&counter.spin, PTHREAD_PROCESS_PRIVATE));
+
+  // Let multiple threads increment the counter concurrently.
+  pthread_t threads[4];
+  for (pthread_t &thread : threads)
+    ASSERT_EQ(0, pthread_create(&thread, NULL, do_increment, &counter));
+  for (pthread_t thread : threads)
+    ASSERT_EQ(0, pthread_join(thread, NULL));
+  ASSERT_EQ(400000, counter.value);
+
+  ASSERT_EQ(0, pthread_spin_destroy(&counter.spin));
+}
+
 #if 0  // TODO(ed): How to test this without forking?
 TEST(pthread_spin, shared) __no_lock_analysis {
   // Allocate a piece of shared memory to store the spinlock.
@@ -0,0 +1,20 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/crt.h>
+#include <common/pthread.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+int pthread_spin_trylock(pthread_spinlock_t *lock) __no_lock_analysis {
+  cloudabi_lock_t old = CLOUDABI_LOCK_UNLOCKED;
+  if (atomic_compare_exchange_strong_explicit(
+          &lock->__state, &old, __pthread_thread_id | CLOUDABI_LOCK_WRLOCKED,
+          memory_order_acquire | __memory_order_hle_acquire,
+          memory_order_relaxed))
+    return 0;
+  return EBUSY;
+}
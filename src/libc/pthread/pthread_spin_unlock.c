@@ -0,0 +1,31 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/crt.h>
+#include <common/pthread.h>
+
+#include <assert.h>
+#include <cloudabi_syscalls.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+int pthread_spin_unlock(pthread_spinlock_t *lock) __no_lock_analysis {
+  cloudabi_lock_t old = __pthread_thread_id | CLOUDABI_LOCK_WRLOCKED;
+  if (!atomic_compare_exchange_strong_explicit(
+          &lock->__state, &old, CLOUDABI_LOCK_UNLOCKED,
+          memory_order_release | __memory_order_hle_release,
+          memory_order_relaxed)) {
+    assert((old & ~CLOUDABI_LOCK_KERNEL_MANAGED) ==
+               (__pthread_thread_id | CLOUDABI_LOCK_WRLOCKED) &&
+           "This spinlock is not locked by this thread");
+
+    // Threads waking up from pthread_cond_wait() reacquire the lock
+    // through the kernel. Call into the kernel to unblock them.
+    cloudabi_errno_t error =
+        cloudabi_sys_lock_unlock(&lock->__state, lock->__pshared);
+    if (error != 0)
+      __pthread_terminate(error, "Failed to unlock a spinlock");
+  }
+  return 0;
+}
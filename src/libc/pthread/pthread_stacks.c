@@ -0,0 +1,118 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/crt.h>
+#include <common/pthread.h>
+
+#include <sys/mman.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+static pthread_mutex_t stack_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct pthread_stacks stack_cache[PTHREAD_STACK_CACHE_MAX]
+    __guarded_by(stack_cache_lock);
+static size_t stack_cache_count __guarded_by(stack_cache_lock);
+static size_t stack_cache_size __guarded_by(stack_cache_lock) =
+    PTHREAD_STACK_CACHE_SIZE;
+
+static void *stack_allocate(size_t size, size_t guardsize) {
+  if (guardsize == 0)
+    return malloc(size);
+
+  // Allocate the stack with inaccessible pages below it.
+  size_t guard = __roundup(guardsize, __at_pagesz);
+  char *base = mmap(NULL, guard + __roundup(size, __at_pagesz),
+                    PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE, -1, 0);
+  if (base == MAP_FAILED)
+    return NULL;
+  if (mprotect(base, guard, PROT_NONE) != 0) {
+    munmap(base, guard + __roundup(size, __at_pagesz));
+    return NULL;
+  }
+  return base + guard;
+}
+
+static void stack_free(void *stack, size_t size, size_t guardsize) {
+  if (guardsize == 0) {
+    free(stack);
+  } else {
+    size_t guard = __roundup(guardsize, __at_pagesz);
+    munmap((char *)stack - guard, guard + __roundup(size, __at_pagesz));
+  }
+}
+
+bool __pthread_stacks_allocate(struct pthread_stacks *stacks) {
+  // Attempt to reuse the stacks of a thread that has been joined.
+  pthread_mutex_lock(&stack_cache_lock);
+  for (size_t i = 0; i < stack_cache_count; ++i) {
+    struct pthread_stacks *cached = &stack_cache[i];
+    if (cached->safe_stacksize == stacks->safe_stacksize &&
+        cached->unsafe_stacksize == stacks->unsafe_stacksize &&
+        cached->guardsize == stacks->guardsize) {
+      *stacks = *cached;
+      *cached = stack_cache[--stack_cache_count];
+      pthread_mutex_unlock(&stack_cache_lock);
+      return true;
+    }
+  }
+  pthread_mutex_unlock(&stack_cache_lock);
+
+  // Allocate new stacks.
+  stacks->safe_stack = stack_allocate(stacks->safe_stacksize, stacks->guardsize);
+  if (stacks->safe_stack == NULL)
+    return false;
+  stacks->unsafe_stack =
+      stack_allocate(stacks->unsafe_stacksize, stacks->guardsize);
+  if (stacks->unsafe_stack == NULL) {
+    stack_free(stacks->safe_stack, stacks->safe_stacksize, stacks->guardsize);
+    return false;
+  }
+  return true;
+}
+
+void __pthread_stacks_free(const struct pthread_stacks *stacks) {
+  // pthread_exit() may join a placeholder thread that has no stacks.
+  if (stacks->safe_stack == NULL)
+    return;
+
+  // Place the stacks in the cache if space is available.
+  pthread_mutex_lock(&stack_cache_lock);
+  if (stack_cache_count < stack_cache_size) {
+    stack_cache[stack_cache_count++] = *stacks;
+    pthread_mutex_unlock(&stack_cache_lock);
+    return;
+  }
+  pthread_mutex_unlock(&stack_cache_lock);
+
+  stack_free(stacks->safe_stack, stacks->safe_stacksize, stacks->guardsize);
+  stack_free(stacks->unsafe_stack, stacks->unsafe_stacksize,
+             stacks->guardsize);
+}
+
+int pthread_setstackcachesize_np(size_t size) {
+  if (size > PTHREAD_STACK_CACHE_MAX)
+    return EINVAL;
+
+  // Remove stacks that no longer fit in the cache. Free them after
+  // dropping the lock.
+  struct pthread_stacks evicted[PTHREAD_STACK_CACHE_MAX];
+  size_t nevicted = 0;
+  pthread_mutex_lock(&stack_cache_lock);
+  stack_cache_size = size;
+  while (stack_cache_count > size)
+    evicted[nevicted++] = stack_cache[--stack_cache_count];
+  pthread_mutex_unlock(&stack_cache_lock);
+
+  for (size_t i = 0; i < nevicted; ++i) {
+    stack_free(evicted[i].safe_stack, evicted[i].safe_stacksize,
+               evicted[i].guardsize);
+    stack_free(evicted[i].unsafe_stack, evicted[i].unsafe_stacksize,
+               evicted[i].guardsize);
+  }
+  return 0;
+}
@@ -0,0 +1,94 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <regex.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+int compile(const char *pattern, int cflags) {
+  regex_t re;
+  int error = regcomp(&re, pattern, cflags);
+  if (error == 0)
+    regfree(&re);
+  return error;
+}
+
+}  // namespace
+
+TEST(regcomp, nsub) {
+  regex_t re;
+  ASSERT_EQ(0, regcomp(&re, "a\\(b\\)\\(c\\(d\\)\\)", 0));
+  ASSERT_EQ(3, re.re_nsub);
+  regfree(&re);
+
+  ASSERT_EQ(0, regcomp(&re, "a(b)(c(d))|(e)", REG_EXTENDED));
+  ASSERT_EQ(4, re.re_nsub);
+  regfree(&re);
+
+  ASSERT_EQ(0, regcomp(&re, "(a)", 0));
+  ASSERT_EQ(0, re.re_nsub);
+  regfree(&re);
+}
+
+TEST(regcomp, valid) {
+  ASSERT_EQ(0, compile("", 0));
+  ASSERT_EQ(0, compile("", REG_EXTENDED));
+  ASSERT_EQ(0, compile("*a", 0));
+  ASSERT_EQ(0, compile("^*a", 0));
+  ASSERT_EQ(0, compile("a{", REG_EXTENDED));
+  ASSERT_EQ(0, compile("a\\{1,2\\}", 0));
+  ASSERT_EQ(0, compile("a{1,}b{3}", REG_EXTENDED));
+  ASSERT_EQ(0, compile("[]a-]", 0));
+  ASSERT_EQ(0, compile("[^]a-]", 0));
+  ASSERT_EQ(0, compile("[[:alpha:][:digit:]_]", 0));
+  ASSERT_EQ(0, compile("[[.a.]-[.z.]]", 0));
+  ASSERT_EQ(0, compile("[[=a=]]", 0));
+  ASSERT_EQ(0, compile("\\(a\\)\\1", 0));
+  ASSERT_EQ(0, compile("(a)\\1", REG_EXTENDED));
+}
+
+TEST(regcomp, errors) {
+  ASSERT_EQ(REG_BADBR, compile("a\\{2,1\\}", 0));
+  ASSERT_EQ(REG_BADBR, compile("a{1,256}", REG_EXTENDED));
+  ASSERT_EQ(REG_BADBR, compile("a{1a}", REG_EXTENDED));
+  ASSERT_EQ(REG_BADRPT, compile("*a", REG_EXTENDED));
+  ASSERT_EQ(REG_BADRPT, compile("a|+", REG_EXTENDED));
+  ASSERT_EQ(REG_BADRPT, compile("(?a)", REG_EXTENDED));
+  ASSERT_EQ(REG_BADRPT, compile("{1}", REG_EXTENDED));
+  ASSERT_EQ(REG_BADRPT, compile("\\{1\\}", 0));
+  ASSERT_EQ(REG_EBRACE, compile("a\\{1", 0));
+  ASSERT_EQ(REG_EBRACE, compile("a{1,2", REG_EXTENDED));
+  ASSERT_EQ(REG_EBRACK, compile("[a", 0));
+  ASSERT_EQ(REG_EBRACK, compile("[]", 0));
+  ASSERT_EQ(REG_EBRACK, compile("[[:alpha:]", 0));
+  ASSERT_EQ(REG_ECOLLATE, compile("[[.ab.]]", 0));
+  ASSERT_EQ(REG_ECTYPE, compile("[[:foo:]]", 0));
+  ASSERT_EQ(REG_EESCAPE, compile("a\\", 0));
+  ASSERT_EQ(REG_EESCAPE, compile("a\\", REG_EXTENDED));
+  ASSERT_EQ(REG_EPAREN, compile("\\(a", 0));
+  ASSERT_EQ(REG_EPAREN, compile("a\\)", 0));
+  ASSERT_EQ(REG_EPAREN, compile("(a", REG_EXTENDED));
+  ASSERT_EQ(REG_EPAREN, compile("a)", REG_EXTENDED));
+  ASSERT_EQ(REG_ERANGE, compile("[z-a]", 0));
+  ASSERT_EQ(REG_ERANGE, compile("[[:alpha:]-z]", 0));
+  ASSERT_EQ(REG_ESUBREG, compile("\\1", 0));
+  ASSERT_EQ(REG_ESUBREG, compile("\\(a\\1\\)", 0));
+  ASSERT_EQ(REG_ESUBREG, compile("(a)\\2", REG_EXTENDED));
+}
+
+TEST(regcomp, espace) {
+  // Excessive nesting of subexpressions.
+  std::string pattern(1000, '(');
+  pattern += std::string(1000, ')');
+  ASSERT_EQ(REG_ESPACE, compile(pattern.c_str(), REG_EXTENDED));
+  ASSERT_EQ(REG_ESPACE, compile(("a" + std::string(1000, '*')).c_str(), 0));
+
+  // Excessive program size.
+  ASSERT_EQ(REG_ESPACE, compile("((((a{255}){255}){255}){255})",
+                                REG_EXTENDED));
+}
@@ -0,0 +1,1170 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/byteset.h>
+
+#include <limits.h>
+#include <pthread.h>
+#include <regex.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wctype.h>
+
+#include "regex_impl.h"
+
+// Upper bounds on the size of compiled regular expressions. Patterns
+// exceeding these limits are rejected with REG_ESPACE.
+#define MAX_DEPTH 256        // Nesting of subexpressions and repetitions.
+#define MAX_INSTS (1 << 20)  // Number of instructions.
+
+#define NONE UINT32_MAX
+
+// Nodes of the abstract syntax tree.
+enum node_kind {
+  NODE_EMPTY,      // Matches the empty string.
+  NODE_CHAR,       // Matches character value.
+  NODE_ANYBUT,     // Matches any character, except character value.
+  NODE_SET,        // Matches a character in set value.
+  NODE_CONCAT,     // Matches its children in sequence.
+  NODE_ALTERNATE,  // Matches one of its children.
+  NODE_REPEAT,     // Matches its child min to max times.
+  NODE_GROUP,      // Captures its child as subexpression value.
+  NODE_BACKREF,    // Matches the text of subexpression value.
+  NODE_ASSERT,     // Zero-width assertion value.
+};
+
+struct node {
+  uint8_t kind;
+  uint32_t child;  // First child.
+  uint32_t next;   // Next sibling.
+  uint32_t value;
+  uint32_t min;
+  uint32_t max;    // NONE if unbounded.
+};
+
+struct parser {
+  const char32_t *pattern;
+  size_t len;
+  size_t pos;
+  int cflags;
+  int error;
+
+  struct node *nodes;
+  size_t nodes_count;
+  size_t nodes_size;
+
+  struct regex_set *sets;
+  size_t sets_count;
+  size_t sets_size;
+
+  size_t nsub;
+  uint16_t closed;  // Subexpressions 1 to 9 that can be referenced.
+  bool has_backrefs;
+};
+
+static bool parser_at(const struct parser *p, size_t offset, char32_t c) {
+  return p->pos + offset < p->len && p->pattern[p->pos + offset] == c;
+}
+
+static bool parser_at_digit(const struct parser *p, size_t offset) {
+  return p->pos + offset < p->len && p->pattern[p->pos + offset] >= '0' &&
+         p->pattern[p->pos + offset] <= '9';
+}
+
+static uint32_t new_node(struct parser *p, uint8_t kind, uint32_t value) {
+  if (p->error != 0)
+    return NONE;
+  if (p->nodes_count == p->nodes_size) {
+    if (p->nodes_size >= MAX_INSTS) {
+      p->error = REG_ESPACE;
+      return NONE;
+    }
+    size_t new_size = p->nodes_size < 16 ? 16 : p->nodes_size * 2;
+    struct node *new_nodes =
+        reallocarray(p->nodes, new_size, sizeof(*new_nodes));
+    if (new_nodes == NULL) {
+      p->error = REG_ESPACE;
+      return NONE;
+    }
+    p->nodes = new_nodes;
+    p->nodes_size = new_size;
+  }
+  uint32_t n = p->nodes_count++;
+  p->nodes[n] = (struct node){
+      .kind = kind,
+      .child = NONE,
+      .next = NONE,
+      .value = value,
+  };
+  return n;
+}
+
+// Appends a node to the list of children of a CONCAT or ALTERNATE node.
+static void append_child(struct parser *p, uint32_t parent, uint32_t *tail,
+                         uint32_t child) {
+  if (p->error != 0)
+    return;
+  if (*tail == NONE)
+    p->nodes[parent].child = child;
+  else
+    p->nodes[*tail].next = child;
+  *tail = child;
+}
+
+static uint32_t new_parent(struct parser *p, uint8_t kind, uint32_t child) {
+  uint32_t n = new_node(p, kind, 0);
+  if (n != NONE)
+    p->nodes[n].child = child;
+  return n;
+}
+
+static uint32_t new_repeat(struct parser *p, uint32_t child, uint32_t min,
+                           uint32_t max) {
+  uint32_t n = new_parent(p, NODE_REPEAT, child);
+  if (n != NONE) {
+    p->nodes[n].min = min;
+    p->nodes[n].max = max;
+  }
+  return n;
+}
+
+static uint32_t new_set(struct parser *p) {
+  if (p->error != 0)
+    return NONE;
+  if (p->sets_count == p->sets_size) {
+    size_t new_size = p->sets_size < 4 ? 4 : p->sets_size * 2;
+    struct regex_set *new_sets =
+        reallocarray(p->sets, new_size, sizeof(*new_sets));
+    if (new_sets == NULL) {
+      p->error = REG_ESPACE;
+      return NONE;
+    }
+    p->sets = new_sets;
+    p->sets_size = new_size;
+  }
+  uint32_t n = p->sets_count++;
+  p->sets[n] = (struct regex_set){.icase = (p->cflags & REG_ICASE) != 0};
+  return n;
+}
+
+static void set_add_range(struct parser *p, uint32_t set, char32_t min,
+                          char32_t max) {
+  struct regex_set *s = &p->sets[set];
+  struct regex_range *new_ranges =
+      reallocarray(s->ranges, s->ranges_count + 1, sizeof(*new_ranges));
+  if (new_ranges == NULL) {
+    p->error = REG_ESPACE;
+    return;
+  }
+  s->ranges = new_ranges;
+  s->ranges[s->ranges_count++] = (struct regex_range){.min = min, .max = max};
+}
+
+static void set_add_class(struct parser *p, uint32_t set, wctype_t class) {
+  struct regex_set *s = &p->sets[set];
+  wctype_t *new_classes =
+      reallocarray(s->classes, s->classes_count + 1, sizeof(*new_classes));
+  if (new_classes == NULL) {
+    p->error = REG_ESPACE;
+    return;
+  }
+  s->classes = new_classes;
+  s->classes[s->classes_count++] = class;
+}
+
+// Computes the bitmap of a bracket expression.
+static void set_finalize(struct parser *p, uint32_t set) {
+  struct regex_set *s = &p->sets[set];
+  for (char32_t c = 0; c < 256; ++c) {
+    bool contains = regex_set_describes(s, c);
+    // Non-matching lists should not match newlines when REG_NEWLINE is
+    // set. Slashes can only be matched explicitly when REG_FNMATCH and
+    // REG_FNMATCH_PATHNAME are set.
+    if (c == '\n' && s->negate && (p->cflags & REG_NEWLINE) != 0)
+      contains = false;
+    if (c == '/' && (p->cflags & REG_FNMATCH_PATHNAME) != 0)
+      contains = false;
+    if (contains)
+      s->bitmap[c / 32] |= UINT32_C(1) << (c % 32);
+  }
+}
+
+// Creates a node matching a single character.
+static uint32_t new_char(struct parser *p, char32_t c) {
+  if ((p->cflags & REG_ICASE) != 0 &&
+      (towlower(c) != c || towupper(c) != c)) {
+    // Case insensitive matching of a letter. Convert it to a set, so
+    // that all case variants of the letter match.
+    uint32_t set = new_set(p);
+    if (set == NONE)
+      return NONE;
+    set_add_range(p, set, c, c);
+    if (p->error != 0)
+      return NONE;
+    set_finalize(p, set);
+    return new_node(p, NODE_SET, set);
+  }
+  return new_node(p, NODE_CHAR, c);
+}
+
+// Creates a node matching any character, except the ones that need to
+// be matched explicitly.
+static uint32_t new_any(struct parser *p) {
+  if ((p->cflags & REG_FNMATCH_PATHNAME) != 0)
+    return new_node(p, NODE_ANYBUT, '/');
+  if ((p->cflags & REG_NEWLINE) != 0)
+    return new_node(p, NODE_ANYBUT, '\n');
+  return new_node(p, NODE_ANYBUT, REGEX_CHAR_NONE);
+}
+
+// Parses a single element of a bracket expression. Elements may either
+// be characters, collating symbols or equivalence classes. Collating
+// elements spanning multiple characters are not supported.
+static bool parse_bracket_char(struct parser *p, char32_t *c) {
+  if (p->pos >= p->len)
+    return false;
+  if (p->pattern[p->pos] == '[' &&
+      (parser_at(p, 1, '.') || parser_at(p, 1, '='))) {
+    char32_t delim = p->pattern[p->pos + 1];
+    if (p->pos + 4 < p->len && p->pattern[p->pos + 3] == delim &&
+        p->pattern[p->pos + 4] == ']') {
+      *c = p->pattern[p->pos + 2];
+      p->pos += 5;
+      return true;
+    }
+    // Search for the terminator to distinguish between unsupported
+    // collating elements and unterminated bracket expressions.
+    for (size_t i = p->pos + 2; i + 1 < p->len; ++i) {
+      if (p->pattern[i] == delim && p->pattern[i + 1] == ']') {
+        p->error = REG_ECOLLATE;
+        return false;
+      }
+    }
+    p->error = REG_EBRACK;
+    return false;
+  }
+  if ((p->cflags & (REG_FNMATCH | REG_FNMATCH_NOESCAPE)) == REG_FNMATCH &&
+      p->pattern[p->pos] == '\\') {
+    if (++p->pos >= p->len)
+      return false;
+  }
+  *c = p->pattern[p->pos++];
+  return true;
+}
+
+// Parses a character class of the form [:name:].
+static bool parse_bracket_class(struct parser *p, uint32_t set) {
+  size_t start = p->pos + 2;
+  for (size_t i = start; i + 1 < p->len; ++i) {
+    if (p->pattern[i] == ':' && p->pattern[i + 1] == ']') {
+      char name[16];
+      if (i - start >= sizeof(name)) {
+        p->error = REG_ECTYPE;
+        return false;
+      }
+      for (size_t j = start; j < i; ++j) {
+        if (p->pattern[j] == '\0' || p->pattern[j] >= 0x80) {
+          p->error = REG_ECTYPE;
+          return false;
+        }
+        name[j - start] = p->pattern[j];
+      }
+      name[i - start] = '\0';
+      wctype_t class = wctype(name);
+      if (class == 0) {
+        p->error = REG_ECTYPE;
+        return false;
+      }
+      set_add_class(p, set, class);
+      p->pos = i + 2;
+      return p->error == 0;
+    }
+  }
+  p->error = REG_EBRACK;
+  return false;
+}
+
+// Parses a bracket expression, starting right after the opening '['.
+// For fnmatch(), returns NONE without setting an error if the bracket
+// expression is unterminated, so that the '[' is matched literally.
+static uint32_t parse_bracket(struct parser *p) {
+  bool fnmatch = (p->cflags & REG_FNMATCH) != 0;
+  size_t start = p->pos;
+  uint32_t set = new_set(p);
+  if (set == NONE)
+    return NONE;
+  if (parser_at(p, 0, '^') || (fnmatch && parser_at(p, 0, '!'))) {
+    p->sets[set].negate = true;
+    ++p->pos;
+  }
+
+  for (bool first = true;; first = false) {
+    if (p->pos >= p->len)
+      break;
+    if (p->pattern[p->pos] == ']' && !first) {
+      ++p->pos;
+      set_finalize(p, set);
+      return new_node(p, NODE_SET, set);
+    }
+    if (p->pattern[p->pos] == '[' && parser_at(p, 1, ':')) {
+      if (!parse_bracket_class(p, set))
+        break;
+      if (parser_at(p, 0, '-') && !parser_at(p, 1, ']')) {
+        // Character classes cannot be used as range endpoints.
+        p->error = REG_ERANGE;
+        break;
+      }
+      continue;
+    }
+
+    char32_t min, max;
+    if (!parse_bracket_char(p, &min))
+      break;
+    if (parser_at(p, 0, '-') && p->pos + 1 < p->len && !parser_at(p, 1, ']')) {
+      ++p->pos;
+      if (!parse_bracket_char(p, &max))
+        break;
+      if (max < min) {
+        p->error = REG_ERANGE;
+        break;
+      }
+    } else {
+      max = min;
+    }
+    set_add_range(p, set, min, max);
+  }
+
+  if (p->error == 0)
+    p->error = REG_EBRACK;
+  if (fnmatch && p->error == REG_EBRACK) {
+    // Unterminated bracket expression in a pattern for fnmatch(). Undo
+    // everything and let the caller match '[' literally.
+    struct regex_set *s = &p->sets[--p->sets_count];
+    free(s->ranges);
+    free(s->classes);
+    p->error = 0;
+    p->pos = start;
+  }
+  return NONE;
+}
+
+// Parses a bound of the form {m}, {m,} or {m,n}, starting right after
+// the opening brace.
+static bool parse_bound(struct parser *p, uint32_t *min, uint32_t *max) {
+  uint32_t values[2] = {0, 0};
+  int count = 0;
+  bool comma = false;
+  for (;;) {
+    if (p->pos >= p->len) {
+      p->error = REG_EBRACE;
+      return false;
+    }
+    char32_t c = p->pattern[p->pos];
+    if (c >= '0' && c <= '9') {
+      uint32_t *v = &values[comma ? 1 : 0];
+      *v = *v * 10 + (c - '0');
+      if (*v > RE_DUP_MAX) {
+        p->error = REG_BADBR;
+        return false;
+      }
+      if (count == (comma ? 1 : 0))
+        ++count;
+      ++p->pos;
+    } else if (c == ',' && !comma && count == 1) {
+      comma = true;
+      ++p->pos;
+    } else {
+      break;
+    }
+  }
+  if (count == 0) {
+    p->error = REG_BADBR;
+    return false;
+  }
+
+  // Bounds are terminated by '}' for EREs and by '\}' for BREs.
+  if ((p->cflags & REG_EXTENDED) != 0) {
+    if (!parser_at(p, 0, '}')) {
+      p->error = p->pos >= p->len ? REG_EBRACE : REG_BADBR;
+      return false;
+    }
+    p->pos += 1;
+  } else {
+    if (!parser_at(p, 0, '\\') || !parser_at(p, 1, '}')) {
+      p->error = p->pos + 1 >= p->len ? REG_EBRACE : REG_BADBR;
+      return false;
+    }
+    p->pos += 2;
+  }
+
+  *min = values[0];
+  *max = !comma ? values[0] : count == 2 ? values[1] : NONE;
+  if (*max < *min) {
+    p->error = REG_BADBR;
+    return false;
+  }
+  return true;
+}
+
+// Parses a back-reference of the form \1 to \9.
+static uint32_t parse_backref(struct parser *p, char32_t c) {
+  uint32_t n = c - '0';
+  if (n > p->nsub || (p->closed & (1 << n)) == 0) {
+    p->error = REG_ESUBREG;
+    return NONE;
+  }
+  p->has_backrefs = true;
+  return new_node(p, NODE_BACKREF, n);
+}
+
+static uint32_t parse_ere(struct parser *p, unsigned int depth);
+static uint32_t parse_bre(struct parser *p, unsigned int depth);
+
+// Parses a parenthesized subexpression, starting right after the
+// opening parenthesis.
+static uint32_t parse_group(struct parser *p, unsigned int depth) {
+  if (depth >= MAX_DEPTH) {
+    p->error = REG_ESPACE;
+    return NONE;
+  }
+  uint32_t n = ++p->nsub;
+  uint32_t child = (p->cflags & REG_EXTENDED) != 0 ? parse_ere(p, depth + 1)
+                                                   : parse_bre(p, depth + 1);
+  if (p->error != 0)
+    return NONE;
+  if ((p->cflags & REG_EXTENDED) != 0) {
+    if (!parser_at(p, 0, ')')) {
+      p->error = REG_EPAREN;
+      return NONE;
+    }
+    p->pos += 1;
+  } else {
+    if (!parser_at(p, 0, '\\') || !parser_at(p, 1, ')')) {
+      p->error = REG_EPAREN;
+      return NONE;
+    }
+    p->pos += 2;
+  }
+  if (n <= 9)
+    p->closed |= 1 << n;
+  uint32_t group = new_parent(p, NODE_GROUP, child);
+  if (group != NONE)
+    p->nodes[group].value = n;
+  return group;
+}
+
+// Parses a single atom of an extended regular expression.
+static uint32_t parse_ere_atom(struct parser *p, unsigned int depth) {
+  char32_t c = p->pattern[p->pos++];
+  switch (c) {
+    case '(':
+      return parse_group(p, depth);
+    case ')':
+      p->error = REG_EPAREN;
+      return NONE;
+    case '.':
+      return new_any(p);
+    case '[':
+      return parse_bracket(p);
+    case '^':
+      return new_node(p, NODE_ASSERT, REGEX_ASSERT_BOL);
+    case '$':
+      return new_node(p, NODE_ASSERT, REGEX_ASSERT_EOL);
+    case '*':
+    case '+':
+    case '?':
+      p->error = REG_BADRPT;
+      return NONE;
+    case '{':
+      // A brace is only a bound when followed by a digit.
+      if (parser_at_digit(p, 0)) {
+        p->error = REG_BADRPT;
+        return NONE;
+      }
+      return new_char(p, c);
+    case '\\':
+      if (p->pos >= p->len) {
+        p->error = REG_EESCAPE;
+        return NONE;
+      }
+      c = p->pattern[p->pos++];
+      if (c >= '1' && c <= '9')
+        return parse_backref(p, c);
+      return new_char(p, c);
+    default:
+      return new_char(p, c);
+  }
+}
+
+// Parses an extended regular expression, consisting of one or more
+// branches separated by '|'.
+static uint32_t parse_ere(struct parser *p, unsigned int depth) {
+  uint32_t alternate = new_node(p, NODE_ALTERNATE, 0);
+  uint32_t alternate_tail = NONE;
+  for (;;) {
+    uint32_t branch = new_node(p, NODE_CONCAT, 0);
+    uint32_t branch_tail = NONE;
+    while (p->error == 0 && p->pos < p->len && !parser_at(p, 0, '|') &&
+           !(parser_at(p, 0, ')') && depth > 0)) {
+      uint32_t atom = parse_ere_atom(p, depth);
+      for (unsigned int nesting = depth;; ++nesting) {
+        uint32_t min, max;
+        if (parser_at(p, 0, '*')) {
+          min = 0;
+          max = NONE;
+          ++p->pos;
+        } else if (parser_at(p, 0, '+')) {
+          min = 1;
+          max = NONE;
+          ++p->pos;
+        } else if (parser_at(p, 0, '?')) {
+          min = 0;
+          max = 1;
+          ++p->pos;
+        } else if (parser_at(p, 0, '{') && parser_at_digit(p, 1)) {
+          ++p->pos;
+          if (!parse_bound(p, &min, &max))
+            break;
+        } else {
+          break;
+        }
+        if (nesting >= MAX_DEPTH) {
+          p->error = REG_ESPACE;
+          break;
+        }
+        atom = new_repeat(p, atom, min, max);
+      }
+      append_child(p, branch, &branch_tail, atom);
+    }
+    append_child(p, alternate, &alternate_tail, branch);
+    if (p->error != 0)
+      return NONE;
+    if (!parser_at(p, 0, '|'))
+      break;
+    ++p->pos;
+  }
+
+  // Omit the ALTERNATE node if there is only a single branch.
+  if (p->nodes[alternate].child == alternate_tail)
+    return alternate_tail;
+  return alternate;
+}
+
+// Returns whether the current position is the end of a basic regular
+// expression, meaning that '$' acts as an anchor.
+static bool bre_at_end(const struct parser *p, unsigned int depth) {
+  return p->pos >= p->len ||
+         (depth > 0 && parser_at(p, 0, '\\') && parser_at(p, 1, ')'));
+}
+
+// Parses a basic regular expression.
+static uint32_t parse_bre(struct parser *p, unsigned int depth) {
+  uint32_t branch = new_node(p, NODE_CONCAT, 0);
+  uint32_t branch_tail = NONE;
+
+  // A circumflex is an anchor when placed at the start.
+  if (parser_at(p, 0, '^')) {
+    ++p->pos;
+    append_child(p, branch, &branch_tail,
+                 new_node(p, NODE_ASSERT, REGEX_ASSERT_BOL));
+  }
+
+  for (bool first = true; p->error == 0 && !bre_at_end(p, depth);
+       first = false) {
+    char32_t c = p->pattern[p->pos++];
+    uint32_t atom;
+    switch (c) {
+      case '.':
+        atom = new_any(p);
+        break;
+      case '[':
+        atom = parse_bracket(p);
+        break;
+      case '$':
+        // A dollar sign is an anchor when placed at the end.
+        atom = bre_at_end(p, depth)
+                   ? new_node(p, NODE_ASSERT, REGEX_ASSERT_EOL)
+                   : new_char(p, c);
+        break;
+      case '*':
+        // An asterisk is matched literally when placed at the start.
+        atom = first ? new_char(p, c) : NONE;
+        if (!first)
+          p->error = REG_BADRPT;
+        break;
+      case '\\':
+        if (p->pos >= p->len) {
+          p->error = REG_EESCAPE;
+          return NONE;
+        }
+        c = p->pattern[p->pos++];
+        if (c == '(') {
+          atom = parse_group(p, depth);
+        } else if (c == ')') {
+          p->error = REG_EPAREN;
+          return NONE;
+        } else if (c == '{') {
+          p->error = REG_BADRPT;
+          return NONE;
+        } else if (c >= '1' && c <= '9') {
+          atom = parse_backref(p, c);
+        } else {
+          atom = new_char(p, c);
+        }
+        break;
+      default:
+        atom = new_char(p, c);
+        break;
+    }
+
+    for (unsigned int nesting = depth;; ++nesting) {
+      uint32_t min, max;
+      if (parser_at(p, 0, '*')) {
+        min = 0;
+        max = NONE;
+        ++p->pos;
+      } else if (parser_at(p, 0, '\\') && parser_at(p, 1, '{')) {
+        p->pos += 2;
+        if (!parse_bound(p, &min, &max))
+          break;
+      } else {
+        break;
+      }
+      if (nesting >= MAX_DEPTH) {
+        p->error = REG_ESPACE;
+        break;
+      }
+      atom = new_repeat(p, atom, min, max);
+    }
+    append_child(p, branch, &branch_tail, atom);
+  }
+  return p->error == 0 ? branch : NONE;
+}
+
+// Wraps a node matching characters of a pattern for fnmatch(), so that
+// it does not match a leading period.
+static uint32_t fnmatch_wildcard(struct parser *p, uint32_t atom) {
+  if ((p->cflags & REG_FNMATCH_PERIOD) == 0)
+    return atom;
+  uint32_t concat = new_node(p, NODE_CONCAT, 0);
+  uint32_t tail = NONE;
+  append_child(
+      p, concat, &tail,
+      new_node(p, NODE_ASSERT,
+               (p->cflags & REG_FNMATCH_PATHNAME) != 0
+                   ? REGEX_ASSERT_NOPERIOD_PATH
+                   : REGEX_ASSERT_NOPERIOD));
+  append_child(p, concat, &tail, atom);
+  return concat;
+}
+
+// Parses a pattern for fnmatch().
+static uint32_t parse_fnmatch(struct parser *p) {
+  uint32_t branch = new_node(p, NODE_CONCAT, 0);
+  uint32_t branch_tail = NONE;
+  while (p->error == 0 && p->pos < p->len) {
+    char32_t c = p->pattern[p->pos++];
+    uint32_t atom;
+    switch (c) {
+      case '*':
+        // Consecutive asterisks are equivalent to a single one. The
+        // leading period check is placed in front of the repetition, so
+        // that it also applies when matching zero characters. Later
+        // iterations can never be at the start of a pathname component.
+        while (parser_at(p, 0, '*'))
+          ++p->pos;
+        atom = fnmatch_wildcard(p, new_repeat(p, new_any(p), 0, NONE));
+        break;
+      case '?':
+        atom = fnmatch_wildcard(p, new_any(p));
+        break;
+      case '[':
+        atom = parse_bracket(p);
+        atom = atom == NONE ? new_char(p, c) : fnmatch_wildcard(p, atom);
+        break;
+      case '\\':
+        if ((p->cflags & REG_FNMATCH_NOESCAPE) == 0 && p->pos < p->len)
+          c = p->pattern[p->pos++];
+        atom = new_char(p, c);
+        break;
+      default:
+        atom = new_char(p, c);
+        break;
+    }
+    append_child(p, branch, &branch_tail, atom);
+  }
+  return branch;
+}
+
+struct compiler {
+  const struct parser *p;
+  int error;
+  struct regex_inst *insts;
+  size_t insts_count;
+  size_t insts_size;
+  size_t slots_count;
+};
+
+static uint32_t emit(struct compiler *c, uint8_t opcode, uint32_t x,
+                     uint32_t y) {
+  if (c->error != 0)
+    return NONE;
+  if (c->insts_count == c->insts_size) {
+    if (c->insts_size >= MAX_INSTS) {
+      c->error = REG_ESPACE;
+      return NONE;
+    }
+    size_t new_size = c->insts_size < 16 ? 16 : c->insts_size * 2;
+    struct regex_inst *new_insts =
+        reallocarray(c->insts, new_size, sizeof(*new_insts));
+    if (new_insts == NULL) {
+      c->error = REG_ESPACE;
+      return NONE;
+    }
+    c->insts = new_insts;
+    c->insts_size = new_size;
+  }
+  uint32_t pc = c->insts_count++;
+  c->insts[pc] = (struct regex_inst){.opcode = opcode, .x = x, .y = y};
+  return pc;
+}
+
+// Returns whether a node can match the empty string.
+static bool nullable(const struct parser *p, uint32_t n) {
+  const struct node *node = &p->nodes[n];
+  switch (node->kind) {
+    case NODE_CHAR:
+    case NODE_ANYBUT:
+    case NODE_SET:
+      return false;
+    case NODE_CONCAT:
+      for (uint32_t i = node->child; i != NONE; i = p->nodes[i].next)
+        if (!nullable(p, i))
+          return false;
+      return true;
+    case NODE_ALTERNATE:
+      for (uint32_t i = node->child; i != NONE; i = p->nodes[i].next)
+        if (nullable(p, i))
+          return true;
+      return false;
+    case NODE_REPEAT:
+      return node->min == 0 || nullable(p, node->child);
+    case NODE_GROUP:
+      return nullable(p, node->child);
+    default:
+      return true;
+  }
+}
+
+static void compile(struct compiler *c, uint32_t n) {
+  const struct parser *p = c->p;
+  const struct node *node = &p->nodes[n];
+  switch (node->kind) {
+    case NODE_EMPTY:
+      break;
+    case NODE_CHAR:
+      emit(c, REGEX_OP_CHAR, node->value, 0);
+      break;
+    case NODE_ANYBUT:
+      emit(c, REGEX_OP_ANYBUT, node->value, 0);
+      break;
+    case NODE_SET:
+      emit(c, REGEX_OP_SET, node->value, 0);
+      break;
+    case NODE_CONCAT:
+      for (uint32_t i = node->child; i != NONE; i = p->nodes[i].next)
+        compile(c, i);
+      break;
+    case NODE_ALTERNATE: {
+      // Emit a SPLIT in front of every branch except the last, and a
+      // JMP to the end after it. JMPs are chained through x until the
+      // end is known.
+      uint32_t jmps = NONE;
+      for (uint32_t i = node->child; i != NONE; i = p->nodes[i].next) {
+        if (p->nodes[i].next == NONE) {
+          compile(c, i);
+          break;
+        }
+        uint32_t split = emit(c, REGEX_OP_SPLIT, c->insts_count + 1, NONE);
+        compile(c, i);
+        uint32_t jmp = emit(c, REGEX_OP_JMP, jmps, 0);
+        if (c->error != 0)
+          return;
+        jmps = jmp;
+        c->insts[split].y = c->insts_count;
+      }
+      while (jmps != NONE && c->error == 0) {
+        uint32_t next = c->insts[jmps].x;
+        c->insts[jmps].x = c->insts_count;
+        jmps = next;
+      }
+      break;
+    }
+    case NODE_REPEAT: {
+      uint32_t child = node->child;
+      uint32_t min = node->min, max = node->max;
+
+      // The backtracking matcher needs to prevent loops from repeatedly
+      // matching the empty string.
+      bool progress = p->has_backrefs && max == NONE && nullable(p, child);
+      for (uint32_t i = 0; i < min && c->error == 0; ++i) {
+        if (max == NONE && !progress && i == min - 1) {
+          // x+: Loop back to the last mandatory copy.
+          uint32_t loop = c->insts_count;
+          compile(c, child);
+          emit(c, REGEX_OP_SPLIT, loop, c->insts_count + 1);
+          return;
+        }
+        compile(c, child);
+      }
+
+      if (max == NONE) {
+        // x*: SPLIT over the loop body, followed by a JMP back.
+        uint32_t split = emit(c, REGEX_OP_SPLIT, c->insts_count + 1, NONE);
+        uint32_t slot = c->slots_count;
+        if (progress) {
+          ++c->slots_count;
+          emit(c, REGEX_OP_SAVE, slot, 0);
+        }
+        compile(c, child);
+        uint32_t check = progress ? emit(c, REGEX_OP_PROGRESS, slot, 0) : NONE;
+        emit(c, REGEX_OP_JMP, split, 0);
+        if (c->error == 0) {
+          c->insts[split].y = c->insts_count;
+          if (progress)
+            c->insts[check].y = c->insts_count;
+        }
+      } else {
+        // x{0,n}: n nested optional copies, all skipping to the end.
+        // SPLITs are chained through y until the end is known.
+        uint32_t splits = NONE;
+        for (uint32_t i = min; i < max && c->error == 0; ++i) {
+          uint32_t split = emit(c, REGEX_OP_SPLIT, c->insts_count + 1, splits);
+          compile(c, child);
+          splits = split;
+        }
+        while (splits != NONE && c->error == 0) {
+          uint32_t next = c->insts[splits].y;
+          c->insts[splits].y = c->insts_count;
+          splits = next;
+        }
+      }
+      break;
+    }
+    case NODE_GROUP:
+      // Don't emit SAVE instructions if no submatches are ever needed.
+      if ((p->cflags & REG_NOSUB) != 0 && !p->has_backrefs) {
+        compile(c, node->child);
+      } else {
+        emit(c, REGEX_OP_SAVE, node->value * 2, 0);
+        compile(c, node->child);
+        emit(c, REGEX_OP_SAVE, node->value * 2 + 1, 0);
+      }
+      break;
+    case NODE_BACKREF:
+      emit(c, REGEX_OP_BACKREF, node->value, 0);
+      break;
+    case NODE_ASSERT:
+      emit(c, REGEX_OP_ASSERT, node->value, 0);
+      break;
+  }
+}
+
+// Splits the characters below 256 into classes, so that characters in
+// the same class are accepted by the same instructions. Every bitmap
+// passed in refines the existing partitioning.
+static void refine_classes(uint8_t *classmap, size_t *classes_count,
+                           const uint32_t *bitmap) {
+  int16_t remap[256][2];
+  for (size_t i = 0; i < *classes_count; ++i)
+    remap[i][0] = remap[i][1] = -1;
+  size_t count = 0;
+  for (size_t c = 0; c < 256; ++c) {
+    int16_t *r = &remap[classmap[c]][(bitmap[c / 32] >> (c % 32)) & 1];
+    if (*r < 0)
+      *r = count++;
+    classmap[c] = *r;
+  }
+  *classes_count = count;
+}
+
+static void compute_classes(struct __regex *regex) {
+  // Characters affecting assertions and context flags are always
+  // placed in classes of their own.
+  uint32_t singletons[256 / 32] = {};
+  singletons['\n' / 32] |= UINT32_C(1) << ('\n' % 32);
+  singletons['.' / 32] |= UINT32_C(1) << ('.' % 32);
+  singletons['/' / 32] |= UINT32_C(1) << ('/' % 32);
+  for (size_t i = 0; i < regex->insts_count; ++i) {
+    const struct regex_inst *inst = &regex->insts[i];
+    if ((inst->opcode == REGEX_OP_CHAR || inst->opcode == REGEX_OP_ANYBUT) &&
+        inst->x < 256)
+      singletons[inst->x / 32] |= UINT32_C(1) << (inst->x % 32);
+  }
+
+  memset(regex->classmap, 0, sizeof(regex->classmap));
+  regex->classes_count = 1;
+  for (size_t c = 0; c < 256; ++c) {
+    if ((singletons[c / 32] & (UINT32_C(1) << (c % 32))) != 0) {
+      uint32_t bitmap[256 / 32] = {};
+      bitmap[c / 32] = UINT32_C(1) << (c % 32);
+      refine_classes(regex->classmap, &regex->classes_count, bitmap);
+    }
+  }
+  for (size_t i = 0; i < regex->sets_count; ++i)
+    refine_classes(regex->classmap, &regex->classes_count,
+                   regex->sets[i].bitmap);
+}
+
+// Appends a character to a literal string. Characters beyond the
+// maximum length are discarded, as literals are only used to skip
+// ahead in the input.
+static void literal_append(struct regex_literal *lit, char32_t c) {
+  if (lit->wlen < REGEX_LITERAL_MAX) {
+    if (lit->nlen == lit->wlen && c < 0x80)
+      lit->nstring[lit->nlen++] = c;
+    lit->wstring[lit->wlen++] = c;
+  }
+}
+
+// Computes the literal string that every match starts with. Returns
+// whether the node consists of literal characters exclusively, meaning
+// that the prefix may continue after it.
+static bool literal_prefix(const struct parser *p, uint32_t n,
+                           struct regex_literal *prefix) {
+  const struct node *node = &p->nodes[n];
+  switch (node->kind) {
+    case NODE_EMPTY:
+    case NODE_ASSERT:
+      return true;
+    case NODE_CHAR:
+      literal_append(prefix, node->value);
+      return prefix->wlen < REGEX_LITERAL_MAX;
+    case NODE_CONCAT:
+      for (uint32_t i = node->child; i != NONE; i = p->nodes[i].next)
+        if (!literal_prefix(p, i, prefix))
+          return false;
+      return true;
+    case NODE_ALTERNATE:
+      // Extended regular expressions without '|' have a single branch.
+      return p->nodes[node->child].next == NONE &&
+             literal_prefix(p, node->child, prefix);
+    case NODE_GROUP:
+      return literal_prefix(p, node->child, prefix);
+    case NODE_REPEAT:
+      if (node->min == 0)
+        return false;
+      return literal_prefix(p, node->child, prefix) && node->max == 1;
+    default:
+      return false;
+  }
+}
+
+// Computes the longest run of literal characters that every match
+// contains.
+static void literal_required(const struct parser *p, uint32_t n,
+                             struct regex_literal *run,
+                             struct regex_literal *best) {
+  const struct node *node = &p->nodes[n];
+  switch (node->kind) {
+    case NODE_EMPTY:
+    case NODE_ASSERT:
+      return;
+    case NODE_CHAR:
+      literal_append(run, node->value);
+      if (run->wlen > best->wlen)
+        *best = *run;
+      return;
+    case NODE_CONCAT:
+      for (uint32_t i = node->child; i != NONE; i = p->nodes[i].next)
+        literal_required(p, i, run, best);
+      return;
+    case NODE_ALTERNATE:
+      if (p->nodes[node->child].next == NONE) {
+        literal_required(p, node->child, run, best);
+      } else {
+        *run = (struct regex_literal){};
+      }
+      return;
+    case NODE_GROUP:
+      literal_required(p, node->child, run, best);
+      return;
+    case NODE_REPEAT:
+      if (node->min == 1 && node->max == 1) {
+        literal_required(p, node->child, run, best);
+        return;
+      }
+      // Characters of mandatory repetitions are required, but not
+      // adjacent to the characters surrounding them.
+      *run = (struct regex_literal){};
+      if (node->min > 0)
+        literal_required(p, node->child, run, best);
+      *run = (struct regex_literal){};
+      return;
+    default:
+      *run = (struct regex_literal){};
+      return;
+  }
+}
+
+// Computes the set of ASCII characters that can start a match. Sets
+// *complete to false if matches may also start with other characters.
+// Returns whether the node can match the empty string.
+static bool first_chars(const struct parser *p, uint32_t n, byteset_t *set,
+                        bool *complete) {
+  const struct node *node = &p->nodes[n];
+  switch (node->kind) {
+    case NODE_EMPTY:
+    case NODE_ASSERT:
+      return true;
+    case NODE_CHAR:
+      if (node->value < 0x80)
+        byteaddset(set, node->value);
+      else
+        *complete = false;
+      return false;
+    case NODE_SET: {
+      // Case insensitive sets may match characters outside of ASCII,
+      // such as U+212A KELVIN SIGN for 'k'.
+      const struct regex_set *s = &p->sets[node->value];
+      if (s->negate || s->icase || s->classes_count > 0)
+        *complete = false;
+      for (size_t i = 0; i < s->ranges_count; ++i)
+        if (s->ranges[i].max >= 0x80)
+          *complete = false;
+      for (unsigned int c = 0; c < 256; ++c) {
+        if ((s->bitmap[c / 32] & (UINT32_C(1) << (c % 32))) != 0) {
+          if (c < 0x80)
+            byteaddset(set, c);
+          else
+            *complete = false;
+        }
+      }
+      return false;
+    }
+    case NODE_CONCAT:
+      for (uint32_t i = node->child; i != NONE; i = p->nodes[i].next)
+        if (!first_chars(p, i, set, complete))
+          return false;
+      return true;
+    case NODE_ALTERNATE: {
+      bool empty = false;
+      for (uint32_t i = node->child; i != NONE; i = p->nodes[i].next)
+        if (first_chars(p, i, set, complete))
+          empty = true;
+      return empty;
+    }
+    case NODE_REPEAT:
+      return first_chars(p, node->child, set, complete) || node->min == 0;
+    case NODE_GROUP:
+      return first_chars(p, node->child, set, complete);
+    default:
+      *complete = false;
+      return true;
+  }
+}
+
+// Extracts literals from the pattern that can be used to skip over
+// input that cannot match, without running the automaton.
+static void compute_literals(const struct parser *p, uint32_t root,
+                             struct __regex *regex) {
+  literal_prefix(p, root, &regex->prefix);
+
+  // The required string is only of use if it is longer than the prefix,
+  // as the prefix is searched for anyway.
+  struct regex_literal run = {};
+  literal_required(p, root, &run, &regex->required);
+  if (regex->required.wlen <= regex->prefix.wlen)
+    regex->required = (struct regex_literal){};
+
+  byteset_t set;
+  byteemptyset(&set);
+  bool complete = true;
+  if (!first_chars(p, root, &set, &complete) && complete) {
+    regex->firstbytes = set;
+    for (unsigned int c = 0; c < 0x80; ++c) {
+      if (byteismember(&set, c)) {
+        regex->firstbyte = c;
+        ++regex->firstbytes_count;
+      }
+    }
+  }
+}
+
+static void free_sets(struct regex_set *sets, size_t sets_count) {
+  for (size_t i = 0; i < sets_count; ++i) {
+    free(sets[i].ranges);
+    free(sets[i].classes);
+  }
+  free(sets);
+}
+
+int __regex_compile(regex_t *preg, const char32_t *pattern, size_t len,
+                    int cflags) {
+  // Characters outside of the Unicode range cannot be matched.
+  for (size_t i = 0; i < len; ++i)
+    if (pattern[i] > 0x10ffff)
+      return REG_BADPAT;
+
+  // Parse the pattern.
+  struct parser p = {
+      .pattern = pattern,
+      .len = len,
+      .cflags = cflags,
+  };
+  uint32_t root;
+  if ((cflags & REG_FNMATCH) != 0) {
+    root = parse_fnmatch(&p);
+  } else if ((cflags & REG_EXTENDED) != 0) {
+    root = parse_ere(&p, 0);
+  } else {
+    root = parse_bre(&p, 0);
+  }
+  if (p.error != 0) {
+    free(p.nodes);
+    free_sets(p.sets, p.sets_count);
+    return p.error;
+  }
+
+  // Generate code. The match as a whole is stored in slots 0 and 1.
+  // Patterns for fnmatch() must match the entire string.
+  struct compiler c = {
+      .p = &p,
+      .slots_count = (p.nsub + 1) * 2,
+  };
+  emit(&c, REGEX_OP_SAVE, 0, 0);
+  compile(&c, root);
+  if ((cflags & REG_FNMATCH) != 0)
+    emit(&c, REGEX_OP_ASSERT, REGEX_ASSERT_EOS, 0);
+  emit(&c, REGEX_OP_SAVE, 1, 0);
+  emit(&c, REGEX_OP_MATCH, 0, 0);
+
+  struct __regex *regex;
+  if (c.error != 0 || (regex = malloc(sizeof(*regex))) == NULL) {
+    free(p.nodes);
+    free(c.insts);
+    free_sets(p.sets, p.sets_count);
+    return c.error != 0 ? c.error : REG_ESPACE;
+  }
+  *regex = (struct __regex){
+      .cflags = cflags,
+      .insts = c.insts,
+      .insts_count = c.insts_count,
+      .sets = p.sets,
+      .sets_count = p.sets_count,
+      .slots_count = c.slots_count,
+      .anchored = (cflags & REG_FNMATCH) != 0,
+      .has_backrefs = p.has_backrefs,
+  };
+  compute_classes(regex);
+  compute_literals(&p, root, regex);
+  free(p.nodes);
+  pthread_mutex_init(&regex->dfa.lock, NULL);
+
+  preg->__regex = regex;
+  preg->re_nsub = p.nsub;
+  return 0;
+}
@@ -1,11 +0,0 @@
-// Copyright (c) 2015 Nuxi, https://nuxi.nl/
-//
-// SPDX-License-Identifier: BSD-2-Clause
-
-#include <locale.h>
-#include <regex.h>
-
-static int regex_compile(regex_t *restrict preg, struct inputbuf *pattern,
-                         int cflags, locale_t locale) {
-  return 0;
-}
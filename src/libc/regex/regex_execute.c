@@ -0,0 +1,804 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <pthread.h>
+#include <regex.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#include <wctype.h>
+
+#include "regex_impl.h"
+
+#define NONE UINT32_MAX
+
+// Sparse set of instruction indices, allowing constant time insertion,
+// membership tests and clearing.
+struct sparse_set {
+  uint32_t *dense;
+  uint32_t *sparse;
+  size_t count;
+};
+
+static bool sparse_set_insert(struct sparse_set *s, uint32_t v) {
+  uint32_t i = s->sparse[v];
+  if (i < s->count && s->dense[i] == v)
+    return false;
+  s->sparse[v] = s->count;
+  s->dense[s->count++] = v;
+  return true;
+}
+
+// Computes the set of character matching instructions that can be
+// reached from a set of instructions without consuming any input,
+// given the character that follows. Returns whether a match can be
+// reached. The stack needs to provide space for 3 * insts_count + 1
+// entries.
+static bool nfa_closure(const struct __regex *regex, const uint32_t *kernel,
+                        size_t kernel_count, uint8_t flags, char32_t next,
+                        bool at_end, int eflags, uint32_t *stack,
+                        struct sparse_set *visited, uint32_t *pcs,
+                        size_t *pcs_count) {
+  size_t sp = 0;
+  for (size_t i = kernel_count; i-- > 0;)
+    stack[sp++] = kernel[i];
+  // Unanchored matches may also start at the current position.
+  if (!regex->anchored)
+    stack[sp++] = 0;
+
+  visited->count = 0;
+  size_t count = 0;
+  bool matched = false;
+  while (sp > 0) {
+    uint32_t pc = stack[--sp];
+    if (!sparse_set_insert(visited, pc))
+      continue;
+    const struct regex_inst *inst = &regex->insts[pc];
+    switch (inst->opcode) {
+      case REGEX_OP_CHAR:
+      case REGEX_OP_ANYBUT:
+      case REGEX_OP_SET:
+        pcs[count++] = pc;
+        break;
+      case REGEX_OP_SPLIT:
+        stack[sp++] = inst->y;
+        stack[sp++] = inst->x;
+        break;
+      case REGEX_OP_JMP:
+        stack[sp++] = inst->x;
+        break;
+      case REGEX_OP_PROGRESS:
+        stack[sp++] = inst->y;
+        stack[sp++] = pc + 1;
+        break;
+      case REGEX_OP_SAVE:
+        stack[sp++] = pc + 1;
+        break;
+      case REGEX_OP_ASSERT:
+        if (regex_assert(regex, inst->x, flags, next, at_end, eflags))
+          stack[sp++] = pc + 1;
+        break;
+      case REGEX_OP_MATCH:
+        matched = true;
+        break;
+    }
+  }
+  *pcs_count = count;
+  return matched;
+}
+
+// Computes the set of instructions reached after consuming a character.
+static size_t nfa_step(const struct __regex *regex, const uint32_t *pcs,
+                       size_t pcs_count, char32_t c,
+                       struct sparse_set *visited, uint32_t *kernel) {
+  visited->count = 0;
+  size_t count = 0;
+  for (size_t i = 0; i < pcs_count; ++i) {
+    uint32_t pc = pcs[i];
+    if (regex_inst_accepts(regex, &regex->insts[pc], c) &&
+        sparse_set_insert(visited, pc + 1))
+      kernel[count++] = pc + 1;
+  }
+  return count;
+}
+
+// Skips over input that cannot be the start of a match, using the
+// literals extracted from the pattern. Returns the position of the next
+// candidate, updating the context flags accordingly, or SIZE_MAX if no
+// match can start at or after the given position.
+static size_t skip_ahead(const struct __regex *regex,
+                         const struct regex_input *input, size_t pos,
+                         uint8_t *flags) {
+  if (regex->anchored)
+    return pos;
+  size_t next = pos;
+  if (input->wstring != NULL) {
+    const wchar_t *ws = input->wstring;
+    if (regex->prefix.wlen > 0) {
+      const wchar_t *match =
+          wmemmem(ws + pos, input->len - pos, regex->prefix.wstring,
+                  regex->prefix.wlen);
+      if (match == NULL)
+        return SIZE_MAX;
+      next = match - ws;
+    } else if (regex->firstbytes_count > 0) {
+      byteset_t firstbytes = regex->firstbytes;
+      while (next < input->len &&
+             (ws[next] < 0 || ws[next] >= 0x80 ||
+              !byteismember(&firstbytes, ws[next])))
+        ++next;
+      if (next == input->len)
+        return SIZE_MAX;
+    }
+    if (next > pos)
+      *flags = regex_ctx_next(regex, ws[next - 1]);
+  } else if (input->ascii) {
+    // Bytes below 0x80 always represent ASCII characters, meaning that
+    // they can be searched for without decoding the input.
+    const char *s = input->nstring;
+    const char *match;
+    if (regex->prefix.nlen > 0) {
+      match = memmem(s + pos, input->len - pos, regex->prefix.nstring,
+                     regex->prefix.nlen);
+    } else if (regex->firstbytes_count == 1) {
+      match = memchr(s + pos, regex->firstbyte, input->len - pos);
+    } else if (regex->firstbytes_count > 1) {
+      byteset_t firstbytes = regex->firstbytes;
+      match = s + pos;
+      while (match < s + input->len && !byteismember(&firstbytes, *match))
+        ++match;
+      if (match == s + input->len)
+        match = NULL;
+    } else {
+      return pos;
+    }
+    if (match == NULL)
+      return SIZE_MAX;
+    next = match - s;
+    if (next > pos) {
+      unsigned char c = s[next - 1];
+      *flags = regex_ctx_next(regex, c < 0x80 ? c : REGEX_CHAR_NONE);
+    }
+  }
+  return next;
+}
+
+// Scratch space used for NFA simulation.
+struct nfa_scratch {
+  uint32_t *stack;
+  struct sparse_set visited;
+  uint32_t *pcs;
+  uint32_t *kernel;
+};
+
+static bool nfa_scratch_init(struct nfa_scratch *ns, size_t insts_count) {
+  uint32_t *buf = reallocarray(NULL, insts_count * 7 + 1, sizeof(uint32_t));
+  if (buf == NULL)
+    return false;
+  *ns = (struct nfa_scratch){
+      .stack = buf,
+      .visited = {.dense = buf + insts_count * 3 + 1,
+                  .sparse = buf + insts_count * 4 + 1},
+      .pcs = buf + insts_count * 5 + 1,
+      .kernel = buf + insts_count * 6 + 1,
+  };
+  return true;
+}
+
+// Determines whether the input matches by simulating the NFA directly.
+// This is used when the DFA is in use by another thread.
+static int nfa_search(const struct __regex *regex,
+                      const struct regex_input *input, int eflags) {
+  struct nfa_scratch ns;
+  if (!nfa_scratch_init(&ns, regex->insts_count))
+    return REG_ESPACE;
+
+  size_t kernel_count = 1;
+  ns.kernel[0] = 0;
+  uint8_t flags = regex_ctx_start(eflags);
+  int result = REG_NOMATCH;
+  for (size_t pos = skip_ahead(regex, input, 0, &flags); pos != SIZE_MAX;) {
+    char32_t c = REGEX_CHAR_NONE;
+    size_t width = 0;
+    bool at_end = pos == input->len;
+    if (!at_end)
+      width = regex_input_get(input, pos, &c);
+    size_t pcs_count;
+    if (nfa_closure(regex, ns.kernel, kernel_count, flags, c, at_end, eflags,
+                    ns.stack, &ns.visited, ns.pcs, &pcs_count)) {
+      result = 0;
+      break;
+    }
+    if (at_end)
+      break;
+    kernel_count = nfa_step(regex, ns.pcs, pcs_count, c, &ns.visited,
+                            ns.kernel);
+    if (kernel_count == 0 && regex->anchored)
+      break;
+    flags = regex_ctx_next(regex, c);
+    pos += width;
+    if (kernel_count == 0)
+      pos = skip_ahead(regex, input, pos, &flags);
+  }
+  free(ns.stack);
+  return result;
+}
+
+// Sentinel DFA state, indicating that a match has been found.
+static struct regex_dfa_state dfa_match;
+
+static void dfa_flush(struct regex_dfa *dfa) {
+  for (size_t i = 0; i < REGEX_DFA_BUCKETS; ++i) {
+    struct regex_dfa_state *state = dfa->buckets[i];
+    while (state != NULL) {
+      struct regex_dfa_state *next = state->bucket_next;
+      free(state);
+      state = next;
+    }
+    dfa->buckets[i] = NULL;
+  }
+  dfa->memory = 0;
+}
+
+static int compare_pcs(const void *a, const void *b) {
+  uint32_t pca = *(const uint32_t *)a, pcb = *(const uint32_t *)b;
+  return pca < pcb ? -1 : pca > pcb;
+}
+
+// Looks up the DFA state corresponding to a set of instructions,
+// creating it if it does not exist yet. Sets *flushed if existing
+// states had to be discarded to make room.
+static struct regex_dfa_state *dfa_intern(struct __regex *regex,
+                                          uint8_t flags, uint32_t *kernel,
+                                          size_t kernel_count,
+                                          bool *flushed) {
+  struct regex_dfa *dfa = &regex->dfa;
+  qsort(kernel, kernel_count, sizeof(*kernel), compare_pcs);
+  uint32_t hash = 2166136261 ^ flags;
+  for (size_t i = 0; i < kernel_count; ++i)
+    hash = (hash ^ kernel[i]) * 16777619;
+
+  struct regex_dfa_state **bucket = &dfa->buckets[hash % REGEX_DFA_BUCKETS];
+  for (struct regex_dfa_state *state = *bucket; state != NULL;
+       state = state->bucket_next) {
+    if (state->hash == hash && state->flags == flags &&
+        state->pcs_count == kernel_count &&
+        memcmp(state->pcs, kernel, kernel_count * sizeof(*kernel)) == 0)
+      return state;
+  }
+
+  // Transitions are stored right after the instructions.
+  size_t next_offset = sizeof(struct regex_dfa_state) +
+                       kernel_count * sizeof(*kernel) +
+                       alignof(struct regex_dfa_state *) - 1;
+  next_offset -= next_offset % alignof(struct regex_dfa_state *);
+  size_t size =
+      next_offset + regex->classes_count * sizeof(struct regex_dfa_state *);
+  if (dfa->memory + size > REGEX_DFA_MEMORY && dfa->memory > 0) {
+    dfa_flush(dfa);
+    *flushed = true;
+  }
+  struct regex_dfa_state *state = malloc(size);
+  if (state == NULL)
+    return NULL;
+  state->hash = hash;
+  state->flags = flags;
+  state->pcs_count = kernel_count;
+  state->next = (struct regex_dfa_state **)((char *)state + next_offset);
+  for (size_t i = 0; i < regex->classes_count; ++i)
+    state->next[i] = NULL;
+  memcpy(state->pcs, kernel, kernel_count * sizeof(*kernel));
+  state->bucket_next = *bucket;
+  *bucket = state;
+  dfa->memory += size;
+  return state;
+}
+
+// Computes the DFA state reached after consuming a character.
+static struct regex_dfa_state *dfa_transition(struct __regex *regex,
+                                              struct regex_dfa_state *state,
+                                              char32_t c, int eflags,
+                                              bool *flushed) {
+  struct regex_dfa *dfa = &regex->dfa;
+  struct sparse_set visited = {.dense = dfa->dense, .sparse = dfa->sparse};
+  size_t pcs_count;
+  if (nfa_closure(regex, state->pcs, state->pcs_count, state->flags, c, false,
+                  eflags, dfa->stack, &visited, dfa->pcs, &pcs_count))
+    return &dfa_match;
+  size_t kernel_count =
+      nfa_step(regex, dfa->pcs, pcs_count, c, &visited, dfa->kernel);
+  return dfa_intern(regex, regex_ctx_next(regex, c), dfa->kernel,
+                    kernel_count, flushed);
+}
+
+// Determines whether the input matches using the lazily constructed
+// DFA. The DFA lock must be held.
+static int dfa_search(struct __regex *regex, const struct regex_input *input,
+                      int eflags) {
+  struct regex_dfa *dfa = &regex->dfa;
+  if (dfa->buckets == NULL) {
+    struct nfa_scratch ns;
+    if (!nfa_scratch_init(&ns, regex->insts_count))
+      return REG_ESPACE;
+    dfa->buckets = calloc(REGEX_DFA_BUCKETS, sizeof(*dfa->buckets));
+    if (dfa->buckets == NULL) {
+      free(ns.stack);
+      return REG_ESPACE;
+    }
+    dfa->stack = ns.stack;
+    dfa->dense = ns.visited.dense;
+    dfa->sparse = ns.visited.sparse;
+    dfa->pcs = ns.pcs;
+    dfa->kernel = ns.kernel;
+  }
+
+  uint8_t flags = regex_ctx_start(eflags);
+  size_t pos = skip_ahead(regex, input, 0, &flags);
+  if (pos == SIZE_MAX)
+    return REG_NOMATCH;
+  bool flushed = false;
+  dfa->kernel[0] = 0;
+  struct regex_dfa_state *state =
+      dfa_intern(regex, flags, dfa->kernel, 1, &flushed);
+  if (state == NULL)
+    return REG_ESPACE;
+  while (pos < input->len) {
+    char32_t c;
+    size_t width = regex_input_get(input, pos, &c);
+    struct regex_dfa_state *next;
+    if (c < 256) {
+      // Transition can be cached.
+      struct regex_dfa_state **slot = &state->next[regex->classmap[c]];
+      next = *slot;
+      if (next == NULL) {
+        flushed = false;
+        next = dfa_transition(regex, state, c, eflags, &flushed);
+        if (next == NULL)
+          return REG_ESPACE;
+        if (!flushed)
+          *slot = next;
+      }
+    } else {
+      next = dfa_transition(regex, state, c, eflags, &flushed);
+      if (next == NULL)
+        return REG_ESPACE;
+    }
+    if (next == &dfa_match)
+      return 0;
+    state = next;
+    pos += width;
+    if (state->pcs_count == 0) {
+      // No match in progress. Skip to the next position at which a
+      // match may start.
+      if (regex->anchored)
+        return REG_NOMATCH;
+      size_t skipped = skip_ahead(regex, input, pos, &flags);
+      if (skipped == SIZE_MAX)
+        return REG_NOMATCH;
+      if (skipped != pos) {
+        pos = skipped;
+        state = dfa_intern(regex, flags, dfa->kernel, 0, &flushed);
+        if (state == NULL)
+          return REG_ESPACE;
+      }
+    }
+  }
+
+  // End of input. Whether assertions hold depends on REG_NOTEOL, so
+  // don't cache this transition.
+  struct sparse_set visited = {.dense = dfa->dense, .sparse = dfa->sparse};
+  size_t pcs_count;
+  return nfa_closure(regex, state->pcs, state->pcs_count, state->flags,
+                     REGEX_CHAR_NONE, true, eflags, dfa->stack, &visited,
+                     dfa->pcs, &pcs_count)
+             ? 0
+             : REG_NOMATCH;
+}
+
+// Stores submatch offsets in the output array.
+static void store_submatches(const regex_t *preg, const regoff_t *slots,
+                             size_t nmatch, regmatch_t *pmatch) {
+  for (size_t i = 0; i < nmatch; ++i) {
+    if (i <= preg->re_nsub && slots[i * 2] >= 0 && slots[i * 2 + 1] >= 0) {
+      pmatch[i].rm_so = slots[i * 2];
+      pmatch[i].rm_eo = slots[i * 2 + 1];
+    } else {
+      pmatch[i].rm_so = -1;
+      pmatch[i].rm_eo = -1;
+    }
+  }
+}
+
+// Thread list of the Pike VM. Every thread consists of an instruction
+// and a set of capture slots.
+struct pike_list {
+  struct sparse_set visited;
+  uint32_t *pcs;
+  regoff_t *slots;
+  size_t count;
+};
+
+// Entry of the stack used to compute closures. Entries either explore
+// an instruction or restore a slot when unwinding.
+struct pike_entry {
+  uint32_t pc;
+  uint32_t slot;
+  regoff_t value;
+};
+
+// Adds the closure of an instruction to a thread list, in priority
+// order. Slots are modified while exploring, but restored afterwards.
+static void pike_add(const struct __regex *regex, struct pike_list *list,
+                     struct pike_entry *stack, uint32_t pc, regoff_t *slots,
+                     size_t pos, uint8_t flags, char32_t next, bool at_end,
+                     int eflags) {
+  size_t sp = 0;
+  stack[sp++] = (struct pike_entry){.pc = pc, .slot = NONE};
+  while (sp > 0) {
+    struct pike_entry e = stack[--sp];
+    if (e.slot != NONE) {
+      slots[e.slot] = e.value;
+      continue;
+    }
+    if (!sparse_set_insert(&list->visited, e.pc))
+      continue;
+    const struct regex_inst *inst = &regex->insts[e.pc];
+    switch (inst->opcode) {
+      case REGEX_OP_CHAR:
+      case REGEX_OP_ANYBUT:
+      case REGEX_OP_SET:
+      case REGEX_OP_MATCH:
+        list->pcs[list->count] = e.pc;
+        memcpy(list->slots + list->count * regex->slots_count, slots,
+               regex->slots_count * sizeof(*slots));
+        ++list->count;
+        break;
+      case REGEX_OP_SPLIT:
+        stack[sp++] = (struct pike_entry){.pc = inst->y, .slot = NONE};
+        stack[sp++] = (struct pike_entry){.pc = inst->x, .slot = NONE};
+        break;
+      case REGEX_OP_JMP:
+        stack[sp++] = (struct pike_entry){.pc = inst->x, .slot = NONE};
+        break;
+      case REGEX_OP_SAVE:
+        stack[sp++] =
+            (struct pike_entry){.slot = inst->x, .value = slots[inst->x]};
+        stack[sp++] = (struct pike_entry){.pc = e.pc + 1, .slot = NONE};
+        slots[inst->x] = pos;
+        break;
+      case REGEX_OP_PROGRESS:
+        stack[sp++] = (struct pike_entry){.pc = inst->y, .slot = NONE};
+        stack[sp++] = (struct pike_entry){.pc = e.pc + 1, .slot = NONE};
+        break;
+      case REGEX_OP_ASSERT:
+        if (regex_assert(regex, inst->x, flags, next, at_end, eflags))
+          stack[sp++] = (struct pike_entry){.pc = e.pc + 1, .slot = NONE};
+        break;
+    }
+  }
+}
+
+// Computes the leftmost-longest match and its submatches by simulating
+// the NFA in lockstep, keeping track of capture slots per thread.
+static int pike_search(const regex_t *preg, const struct regex_input *input,
+                       size_t nmatch, regmatch_t *pmatch, int eflags) {
+  const struct __regex *regex = preg->__regex;
+  size_t insts_count = regex->insts_count;
+  size_t slots_count = regex->slots_count;
+
+  // Allocate all scratch space at once.
+  size_t pcs_size = insts_count * 6 * sizeof(uint32_t);
+  size_t slots_size = (insts_count * 2 + 2) * slots_count * sizeof(regoff_t);
+  size_t stack_size = (insts_count * 2 + 1) * sizeof(struct pike_entry);
+  char *buf = malloc(stack_size + slots_size + pcs_size);
+  if (buf == NULL)
+    return REG_ESPACE;
+  struct pike_entry *stack = (struct pike_entry *)buf;
+  regoff_t *slots = (regoff_t *)(buf + stack_size);
+  uint32_t *pcs = (uint32_t *)(buf + stack_size + slots_size);
+  struct pike_list closure = {
+      .visited = {.dense = pcs, .sparse = pcs + insts_count},
+      .pcs = pcs + insts_count * 4,
+      .slots = slots,
+  };
+  struct pike_list kernel = {
+      .visited = {.dense = pcs + insts_count * 2,
+                  .sparse = pcs + insts_count * 3},
+      .pcs = pcs + insts_count * 5,
+      .slots = slots + insts_count * slots_count,
+  };
+  regoff_t *work = slots + insts_count * 2 * slots_count;
+  regoff_t *best = work + slots_count;
+
+  bool matched = false;
+  uint8_t flags = regex_ctx_start(eflags);
+  for (size_t pos = skip_ahead(regex, input, 0, &flags); pos != SIZE_MAX;) {
+    char32_t c = REGEX_CHAR_NONE;
+    size_t width = 0;
+    bool at_end = pos == input->len;
+    if (!at_end)
+      width = regex_input_get(input, pos, &c);
+
+    // Compute the closure of all threads, in priority order. Start a
+    // new thread with the lowest priority until a match is found.
+    closure.visited.count = 0;
+    closure.count = 0;
+    for (size_t i = 0; i < kernel.count; ++i) {
+      memcpy(work, kernel.slots + i * slots_count,
+             slots_count * sizeof(*work));
+      pike_add(regex, &closure, stack, kernel.pcs[i], work, pos, flags, c,
+               at_end, eflags);
+    }
+    if (!matched && (pos == 0 || !regex->anchored)) {
+      for (size_t i = 0; i < slots_count; ++i)
+        work[i] = -1;
+      pike_add(regex, &closure, stack, 0, work, pos, flags, c, at_end,
+               eflags);
+    }
+
+    // Advance all threads by one character. Threads that started after
+    // the current best match can be discarded.
+    kernel.visited.count = 0;
+    kernel.count = 0;
+    for (size_t i = 0; i < closure.count; ++i) {
+      uint32_t pc = closure.pcs[i];
+      const regoff_t *s = closure.slots + i * slots_count;
+      if (matched && s[0] > best[0])
+        continue;
+      const struct regex_inst *inst = &regex->insts[pc];
+      if (inst->opcode == REGEX_OP_MATCH) {
+        if (!matched || s[0] < best[0] || s[1] > best[1]) {
+          memcpy(best, s, slots_count * sizeof(*best));
+          matched = true;
+        }
+      } else if (!at_end && regex_inst_accepts(regex, inst, c) &&
+                 sparse_set_insert(&kernel.visited, pc + 1)) {
+        kernel.pcs[kernel.count] = pc + 1;
+        memcpy(kernel.slots + kernel.count * slots_count, s,
+               slots_count * sizeof(*s));
+        ++kernel.count;
+      }
+    }
+    if (at_end || (kernel.count == 0 && (matched || regex->anchored)))
+      break;
+    flags = regex_ctx_next(regex, c);
+    pos += width;
+    if (kernel.count == 0)
+      pos = skip_ahead(regex, input, pos, &flags);
+  }
+
+  if (matched)
+    store_submatches(preg, best, nmatch, pmatch);
+  free(buf);
+  return matched ? 0 : REG_NOMATCH;
+}
+
+// Frame of the backtracking matcher. Frames either describe an
+// alternative to try, or a slot to restore when unwinding.
+struct backtrack_frame {
+  uint32_t pc;
+  uint32_t slot;
+  size_t pos;
+  regoff_t value;
+  uint8_t flags;
+};
+
+struct backtrack_stack {
+  struct backtrack_frame *frames;
+  size_t count;
+  size_t size;
+};
+
+static bool backtrack_push(struct backtrack_stack *bs,
+                           struct backtrack_frame frame) {
+  if (bs->count == bs->size) {
+    size_t new_size = bs->size < 64 ? 64 : bs->size * 2;
+    struct backtrack_frame *new_frames =
+        reallocarray(bs->frames, new_size, sizeof(*new_frames));
+    if (new_frames == NULL)
+      return false;
+    bs->frames = new_frames;
+    bs->size = new_size;
+  }
+  bs->frames[bs->count++] = frame;
+  return true;
+}
+
+// Matches the text of a subexpression at a given position, returning
+// the position after it or SIZE_MAX on mismatch.
+static size_t backtrack_backref(const struct __regex *regex,
+                                const struct regex_input *input, size_t pos,
+                                regoff_t so, regoff_t eo) {
+  if (so < 0 || eo < 0)
+    return SIZE_MAX;
+  bool icase = (regex->cflags & REG_ICASE) != 0;
+  for (size_t ref = so; ref < (size_t)eo;) {
+    if (pos >= input->len)
+      return SIZE_MAX;
+    char32_t c1, c2;
+    ref += regex_input_get(input, ref, &c1);
+    pos += regex_input_get(input, pos, &c2);
+    if (c1 != c2 && (!icase || c1 == REGEX_CHAR_INVALID ||
+                     c2 == REGEX_CHAR_INVALID || towlower(c1) != towlower(c2)))
+      return SIZE_MAX;
+  }
+  return pos;
+}
+
+// Computes the leftmost-longest match using backtracking. Only used for
+// regular expressions containing back-references, as the running time
+// of this matcher may be exponential.
+static int backtrack_search(const regex_t *preg,
+                            const struct regex_input *input, size_t nmatch,
+                            regmatch_t *pmatch, int eflags) {
+  const struct __regex *regex = preg->__regex;
+  size_t slots_count = regex->slots_count;
+  regoff_t *slots = reallocarray(NULL, slots_count * 2, sizeof(*slots));
+  if (slots == NULL)
+    return REG_ESPACE;
+  regoff_t *best = slots + slots_count;
+  struct backtrack_stack bs = {};
+
+  int result = REG_NOMATCH;
+  uint8_t start_flags = regex_ctx_start(eflags);
+  for (size_t start = 0;;) {
+    start = skip_ahead(regex, input, start, &start_flags);
+    if (start == SIZE_MAX)
+      break;
+    for (size_t i = 0; i < slots_count; ++i)
+      slots[i] = -1;
+    bool matched = false;
+    bs.count = 0;
+    if (!backtrack_push(&bs, (struct backtrack_frame){.pc = 0,
+                                                      .slot = NONE,
+                                                      .pos = start,
+                                                      .flags = start_flags})) {
+      result = REG_ESPACE;
+      break;
+    }
+    while (bs.count > 0) {
+      struct backtrack_frame f = bs.frames[--bs.count];
+      if (f.slot != NONE) {
+        slots[f.slot] = f.value;
+        continue;
+      }
+
+      // Run the thread until it fails or matches.
+      uint32_t pc = f.pc;
+      size_t pos = f.pos;
+      uint8_t flags = f.flags;
+      for (;;) {
+        const struct regex_inst *inst = &regex->insts[pc];
+        char32_t c = REGEX_CHAR_NONE;
+        if (inst->opcode == REGEX_OP_MATCH) {
+          if (!matched || (regoff_t)pos > best[1]) {
+            memcpy(best, slots, slots_count * sizeof(*best));
+            matched = true;
+          }
+          break;
+        } else if (inst->opcode == REGEX_OP_SPLIT) {
+          if (!backtrack_push(&bs, (struct backtrack_frame){.pc = inst->y,
+                                                            .slot = NONE,
+                                                            .pos = pos,
+                                                            .flags = flags})) {
+            result = REG_ESPACE;
+            goto done;
+          }
+          pc = inst->x;
+        } else if (inst->opcode == REGEX_OP_JMP) {
+          pc = inst->x;
+        } else if (inst->opcode == REGEX_OP_SAVE) {
+          if (!backtrack_push(&bs,
+                              (struct backtrack_frame){
+                                  .slot = inst->x, .value = slots[inst->x]})) {
+            result = REG_ESPACE;
+            goto done;
+          }
+          slots[inst->x] = pos;
+          ++pc;
+        } else if (inst->opcode == REGEX_OP_PROGRESS) {
+          // Leave loops once an iteration matches the empty string.
+          pc = slots[inst->x] == (regoff_t)pos ? inst->y : pc + 1;
+        } else if (inst->opcode == REGEX_OP_ASSERT) {
+          if (pos < input->len)
+            regex_input_get(input, pos, &c);
+          if (!regex_assert(regex, inst->x, flags, c, pos == input->len,
+                            eflags))
+            break;
+          ++pc;
+        } else if (inst->opcode == REGEX_OP_BACKREF) {
+          regoff_t so = slots[inst->x * 2], eo = slots[inst->x * 2 + 1];
+          size_t end = backtrack_backref(regex, input, pos, so, eo);
+          if (end == SIZE_MAX)
+            break;
+          if (end > pos) {
+            regex_input_get(input, eo - 1, &c);
+            flags = regex_ctx_next(regex, c);
+          }
+          pos = end;
+          ++pc;
+        } else {
+          if (pos == input->len)
+            break;
+          size_t width = regex_input_get(input, pos, &c);
+          if (!regex_inst_accepts(regex, inst, c))
+            break;
+          flags = regex_ctx_next(regex, c);
+          pos += width;
+          ++pc;
+        }
+      }
+
+      // Longer matches starting at the same position are impossible.
+      if (matched && (size_t)best[1] == input->len)
+        break;
+    }
+
+    if (matched) {
+      store_submatches(preg, best, nmatch, pmatch);
+      result = 0;
+      break;
+    }
+    if (regex->anchored || start == input->len)
+      break;
+    char32_t c;
+    start += regex_input_get(input, start, &c);
+    start_flags = regex_ctx_next(regex, c);
+  }
+
+done:
+  free(bs.frames);
+  free(slots);
+  return result;
+}
+
+int __regex_execute(const regex_t *preg, const struct regex_input *input,
+                    size_t nmatch, regmatch_t *pmatch, int eflags) {
+  struct __regex *regex = preg->__regex;
+  if ((regex->cflags & REG_NOSUB) != 0)
+    nmatch = 0;
+
+  // Reject the input without running the matcher if it does not
+  // contain the literals that every match contains.
+  if (input->wstring != NULL) {
+    const wchar_t *ws = input->wstring;
+    if (regex->required.wlen > 0 &&
+        wmemmem(ws, input->len, regex->required.wstring,
+                regex->required.wlen) == NULL)
+      return REG_NOMATCH;
+    if (regex->anchored &&
+        (input->len < regex->prefix.wlen ||
+         wmemcmp(ws, regex->prefix.wstring, regex->prefix.wlen) != 0))
+      return REG_NOMATCH;
+  } else if (input->ascii) {
+    const char *s = input->nstring;
+    if (regex->required.nlen > 0 &&
+        memmem(s, input->len, regex->required.nstring,
+               regex->required.nlen) == NULL)
+      return REG_NOMATCH;
+    if (regex->anchored &&
+        (input->len < regex->prefix.nlen ||
+         memcmp(s, regex->prefix.nstring, regex->prefix.nlen) != 0))
+      return REG_NOMATCH;
+  }
+
+  if (regex->has_backrefs)
+    return backtrack_search(preg, input, nmatch, pmatch, eflags);
+
+  // Determine whether the input matches at all. Use the DFA if it is
+  // not being used by another thread. Otherwise, simulate the NFA.
+  int error;
+  if (pthread_mutex_trylock(&regex->dfa.lock) == 0) {
+    error = dfa_search(regex, input, eflags);
+    pthread_mutex_unlock(&regex->dfa.lock);
+  } else {
+    error = nfa_search(regex, input, eflags);
+  }
+  if (error != 0 || nmatch == 0)
+    return error;
+  return pike_search(preg, input, nmatch, pmatch, eflags);
+}
@@ -2,9 +2,13 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <common/locale.h>
+
 #include <locale.h>
 #include <regex.h>
 
+#include "regex_impl.h"
+
 #if WIDE
 #include <wchar.h>
 typedef wchar_t char_t;
@@ -15,10 +19,20 @@ typedef char char_t;
 #if WIDE
 int NAME(const regex_t *restrict preg, const char_t *restrict string,
          size_t len, size_t nmatch, regmatch_t *restrict pmatch, int eflags) {
+  struct regex_input input = {
+      .wstring = string,
+      .len = len,
+  };
 #else
 int NAME(const regex_t *restrict preg, const char_t *restrict string,
          size_t len, size_t nmatch, regmatch_t *restrict pmatch, int eflags,
          locale_t locale) {
+  struct regex_input input = {
+      .nstring = string,
+      .len = len,
+      .ctype = locale->ctype,
+      .ascii = regex_ctype_is_ascii(locale->ctype),
+  };
 #endif
-  return REG_NOMATCH;
+  return __regex_execute(preg, &input, nmatch, pmatch, eflags);
 }
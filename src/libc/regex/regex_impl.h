@@ -0,0 +1,305 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef REGEX_REGEX_IMPL_H
+#define REGEX_REGEX_IMPL_H
+
+#include <common/byteset.h>
+#include <common/locale.h>
+#include <common/mbstate.h>
+
+#include <sys/types.h>
+
+#include <limits.h>
+#include <pthread.h>
+#include <regex.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <uchar.h>
+#include <wchar.h>
+#include <wctype.h>
+
+// Compiled regular expressions.
+//
+// Regular expressions are parsed into a compact program for a Thompson
+// NFA. Both the narrow and wide character matching functions operate on
+// the same program, as the program matches Unicode code points.
+//
+// Programs without back-references are executed by simulating the NFA
+// without backtracking, so that matching runs in linear time. If no
+// submatches need to be returned, a DFA is constructed lazily from the
+// NFA and cached as part of the compiled regular expression. The Pike
+// VM is only used when submatches are requested. Programs containing
+// back-references are executed using a backtracking matcher.
+
+// Special character values. These are never part of a pattern.
+#define REGEX_CHAR_NONE 0xfffffffe     // No character.
+#define REGEX_CHAR_INVALID 0xffffffff  // Invalid input sequence.
+
+// Instructions of the NFA program.
+enum regex_opcode {
+  REGEX_OP_CHAR,      // Matches character x.
+  REGEX_OP_ANYBUT,    // Matches any character, except character x.
+  REGEX_OP_SET,       // Matches a character in set x.
+  REGEX_OP_SPLIT,     // Continues at both x and y, preferring x.
+  REGEX_OP_JMP,       // Continues at x.
+  REGEX_OP_SAVE,      // Stores the current position in slot x.
+  REGEX_OP_ASSERT,    // Continues if assertion x holds.
+  REGEX_OP_BACKREF,   // Matches the text captured by subexpression x.
+  REGEX_OP_PROGRESS,  // Continues at y if the position equals slot x.
+  REGEX_OP_MATCH,     // Match found.
+};
+
+// Zero-width assertions.
+enum regex_assertion {
+  REGEX_ASSERT_BOL,          // Beginning of line.
+  REGEX_ASSERT_EOL,          // End of line.
+  REGEX_ASSERT_EOS,          // End of string.
+  REGEX_ASSERT_NOPERIOD,     // No period at the start of the string.
+  REGEX_ASSERT_NOPERIOD_PATH,  // No period at the start of a pathname
+                               // component.
+};
+
+struct regex_inst {
+  uint8_t opcode;
+  uint32_t x;
+  uint32_t y;
+};
+
+// Bracket expressions.
+struct regex_range {
+  char32_t min;
+  char32_t max;
+};
+
+struct regex_set {
+  // Precomputed membership of the first 256 characters, taking
+  // negation, case insensitivity and exclusions into account.
+  uint32_t bitmap[256 / 32];
+
+  // Description of the set for characters outside the bitmap.
+  bool negate;
+  bool icase;
+  struct regex_range *ranges;
+  size_t ranges_count;
+  wctype_t *classes;
+  size_t classes_count;
+};
+
+// Lazily constructed DFA.
+//
+// Every DFA state corresponds with a set of NFA instructions that are
+// reached after consuming a character, combined with flags describing
+// the character that was consumed. Transitions are indexed by
+// character class, where characters below 256 that are treated
+// identically by the program share the same class. Transitions for
+// other characters are computed on the fly.
+//
+// The number of states is bounded. When the memory limit is reached,
+// all states are discarded and construction starts all over.
+
+#define REGEX_DFA_MEMORY (128 * 1024)
+#define REGEX_DFA_BUCKETS 256
+
+struct regex_dfa_state {
+  struct regex_dfa_state *bucket_next;
+  uint32_t hash;
+  uint8_t flags;
+  uint32_t pcs_count;
+  struct regex_dfa_state **next;
+  uint32_t pcs[];
+};
+
+// Flags describing the character preceding the current position.
+#define REGEX_CTX_START 0x1  // At the start of the string.
+#define REGEX_CTX_BOL 0x2    // Beginning of line assertion holds.
+#define REGEX_CTX_SLASH 0x4  // Preceded by a slash.
+
+struct regex_dfa {
+  pthread_mutex_t lock;
+  struct regex_dfa_state **buckets;
+  size_t memory;
+
+  // Scratch space for computing transitions.
+  uint32_t *stack;
+  uint32_t *dense;
+  uint32_t *sparse;
+  uint32_t *pcs;
+  uint32_t *kernel;
+};
+
+// Literal strings extracted from the pattern.
+#define REGEX_LITERAL_MAX 32
+
+struct regex_literal {
+  wchar_t wstring[REGEX_LITERAL_MAX];
+  size_t wlen;
+  char nstring[REGEX_LITERAL_MAX];  // Leading ASCII characters only.
+  size_t nlen;
+};
+
+struct __regex {
+  int cflags;
+
+  // NFA program.
+  struct regex_inst *insts;
+  size_t insts_count;
+  struct regex_set *sets;
+  size_t sets_count;
+
+  // Number of slots used by SAVE and PROGRESS.
+  size_t slots_count;
+
+  bool anchored;       // Match may only start at the start of the string.
+  bool has_backrefs;   // Program contains BACKREF instructions.
+
+  // Literals used to skip over input that cannot match. Every match
+  // starts with the prefix and contains the required string. If
+  // firstbytes_count is non-zero, every match starts with one of the
+  // ASCII characters in firstbytes.
+  struct regex_literal prefix;
+  struct regex_literal required;
+  byteset_t firstbytes;
+  size_t firstbytes_count;
+  unsigned char firstbyte;
+
+  // Mapping of characters below 256 to DFA transition classes.
+  uint8_t classmap[256];
+  size_t classes_count;
+
+  struct regex_dfa dfa;
+};
+
+// Input string.
+struct regex_input {
+  const char *nstring;     // Narrow string.
+  const wchar_t *wstring;  // Wide string.
+  size_t len;
+  const struct lc_ctype *ctype;
+  bool ascii;  // Character set is a superset of ASCII.
+};
+
+int __regex_compile(regex_t *, const char32_t *, size_t, int);
+int __regex_execute(const regex_t *, const struct regex_input *, size_t,
+                    regmatch_t *, int);
+
+// Returns whether the character set of a locale is ASCII compatible,
+// meaning that bytes below 0x80 don't need to be decoded.
+static inline bool regex_ctype_is_ascii(const struct lc_ctype *ctype) {
+  return ctype == &__ctype_us_ascii || ctype == &__ctype_utf_8;
+}
+
+// Extracts the character at a given position of the input string,
+// returning the number of code units it spans.
+static inline size_t regex_input_get(const struct regex_input *input,
+                                     size_t pos, char32_t *c) {
+  if (input->wstring != NULL) {
+    wchar_t wc = input->wstring[pos];
+    *c = wc < 0 ? REGEX_CHAR_INVALID : (char32_t)wc;
+    return 1;
+  }
+
+  unsigned char ch = input->nstring[pos];
+  if (ch < 0x80 && input->ascii) {
+    *c = ch;
+    return 1;
+  }
+  mbstate_t mbs;
+  mbstate_set_init(&mbs);
+  ssize_t l = input->ctype->mbtoc32(c, input->nstring + pos,
+                                    input->len - pos, &mbs,
+                                    input->ctype->data);
+  if (l < 0) {
+    // Treat invalid and incomplete sequences as a single byte that only
+    // matches wildcards and non-matching lists.
+    *c = REGEX_CHAR_INVALID;
+    return 1;
+  }
+  return l > 0 ? l : 1;
+}
+
+// Tests whether a character is part of a bracket expression, solely
+// based on its ranges and character classes.
+static inline bool regex_set_describes(const struct regex_set *set,
+                                       char32_t c) {
+  if (c > 0x10ffff)
+    return set->negate;
+  for (int pass = 0; pass < (set->icase ? 3 : 1); ++pass) {
+    char32_t cc = pass == 0 ? c : pass == 1 ? towlower(c) : towupper(c);
+    for (size_t i = 0; i < set->ranges_count; ++i)
+      if (cc >= set->ranges[i].min && cc <= set->ranges[i].max)
+        return !set->negate;
+    for (size_t i = 0; i < set->classes_count; ++i)
+      if (iswctype(cc, set->classes[i]))
+        return !set->negate;
+  }
+  return set->negate;
+}
+
+// Tests whether a character is part of a bracket expression.
+static inline bool regex_set_contains(const struct regex_set *set,
+                                      char32_t c) {
+  if (c < 256)
+    return (set->bitmap[c / 32] & (UINT32_C(1) << (c % 32))) != 0;
+  return regex_set_describes(set, c);
+}
+
+// Tests whether a character matching instruction accepts a character.
+static inline bool regex_inst_accepts(const struct __regex *regex,
+                                      const struct regex_inst *inst,
+                                      char32_t c) {
+  switch (inst->opcode) {
+    case REGEX_OP_CHAR:
+      return c == inst->x;
+    case REGEX_OP_ANYBUT:
+      return c != inst->x;
+    case REGEX_OP_SET:
+      return regex_set_contains(&regex->sets[inst->x], c);
+    default:
+      return false;
+  }
+}
+
+// Computes the context flags after consuming a character.
+static inline uint8_t regex_ctx_next(const struct __regex *regex,
+                                     char32_t c) {
+  uint8_t flags = 0;
+  if (c == '\n' && (regex->cflags & REG_NEWLINE) != 0)
+    flags |= REGEX_CTX_BOL;
+  if (c == '/')
+    flags |= REGEX_CTX_SLASH;
+  return flags;
+}
+
+// Computes the context flags at the start of the string.
+static inline uint8_t regex_ctx_start(int eflags) {
+  return (eflags & REG_NOTBOL) != 0 ? REGEX_CTX_START
+                                    : REGEX_CTX_START | REGEX_CTX_BOL;
+}
+
+// Evaluates a zero-width assertion, given the flags describing the
+// preceding character and the next character, if any.
+static inline bool regex_assert(const struct __regex *regex,
+                                uint32_t assertion, uint8_t flags,
+                                char32_t next, bool at_end, int eflags) {
+  switch (assertion) {
+    case REGEX_ASSERT_BOL:
+      return (flags & REGEX_CTX_BOL) != 0;
+    case REGEX_ASSERT_EOL:
+      return at_end ? (eflags & REG_NOTEOL) == 0
+                    : next == '\n' && (regex->cflags & REG_NEWLINE) != 0;
+    case REGEX_ASSERT_EOS:
+      return at_end;
+    case REGEX_ASSERT_NOPERIOD:
+      return at_end || next != '.' || (flags & REGEX_CTX_START) == 0;
+    case REGEX_ASSERT_NOPERIOD_PATH:
+      return at_end || next != '.' ||
+             (flags & (REGEX_CTX_START | REGEX_CTX_SLASH)) == 0;
+    default:
+      return false;
+  }
+}
+
+#endif
@@ -0,0 +1,267 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <locale.h>
+#include <regex.h>
+#include <stddef.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+// Returns the leftmost-longest match of a pattern in a string, or "NO"
+// if there is no match.
+std::string match(const char *pattern, const char *string, int cflags = 0,
+                  int eflags = 0) {
+  regex_t re;
+  EXPECT_EQ(0, regcomp(&re, pattern, cflags)) << pattern;
+  regmatch_t pmatch;
+  int error = regexec(&re, string, 1, &pmatch, eflags);
+  // The result should be identical when no submatches are requested.
+  EXPECT_EQ(error, regexec(&re, string, 0, NULL, eflags)) << pattern;
+  regfree(&re);
+  if (error != 0) {
+    EXPECT_EQ(REG_NOMATCH, error);
+    return "NO";
+  }
+  return std::string(string + pmatch.rm_so, pmatch.rm_eo - pmatch.rm_so);
+}
+
+}  // namespace
+
+TEST(regexec, bre) {
+  ASSERT_EQ("", match("", "abc"));
+  ASSERT_EQ("abc", match("abc", "xabcx"));
+  ASSERT_EQ("NO", match("abd", "xabcx"));
+  ASSERT_EQ("xabcxc", match("x.*c", "xabcxc-"));
+  ASSERT_EQ("*a", match("*a", "x*a"));
+  ASSERT_EQ("a+?", match("a+?", "aa+?"));
+  ASSERT_EQ("a{1}", match("a{1}", "a{1}"));
+  ASSERT_EQ("aa", match("a\\{2\\}", "aaa"));
+  ASSERT_EQ("aaa", match("a\\{2,\\}", "aaa"));
+  ASSERT_EQ("ababab", match("\\(ab\\)*", "abababa"));
+  ASSERT_EQ("a$b", match("a$b", "a$b"));
+  ASSERT_EQ("b^", match("b^", "ab^"));
+}
+
+TEST(regexec, ere) {
+  ASSERT_EQ("abcd", match("a(b|bc)d", "abcd", REG_EXTENDED));
+  ASSERT_EQ("xyz", match("x(y|yz)?", "xyz", REG_EXTENDED));
+  ASSERT_EQ("aaa", match("a+", "baaab", REG_EXTENDED));
+  ASSERT_EQ("", match("a*", "baaab", REG_EXTENDED));
+  ASSERT_EQ("b", match("a?b", "cbab", REG_EXTENDED));
+  ASSERT_EQ("a{", match("a{", "a{", REG_EXTENDED));
+  ASSERT_EQ("aaa", match("a{2,3}", "aaaa", REG_EXTENDED));
+  ASSERT_EQ("NO", match("a{2,3}", "abab", REG_EXTENDED));
+  ASSERT_EQ("abcabc", match("(abc){0,2}", "abcabcabc", REG_EXTENDED));
+  ASSERT_EQ("foobar", match("foo|foobar", "xfoobarx", REG_EXTENDED));
+  ASSERT_EQ("ab", match("(a|ab)(c|bcd)?", "abx", REG_EXTENDED));
+  ASSERT_EQ("abcd", match("(a|ab)(c|bcd)", "abcd", REG_EXTENDED));
+  ASSERT_EQ("", match("()", "abc", REG_EXTENDED));
+  ASSERT_EQ("a.b", match("a\\.b", "axb a.b", REG_EXTENDED));
+}
+
+TEST(regexec, anchors) {
+  ASSERT_EQ("abc", match("^abc$", "abc"));
+  ASSERT_EQ("NO", match("^abc$", "abcd"));
+  ASSERT_EQ("NO", match("^abc", "xabc"));
+  ASSERT_EQ("NO", match("^abc", "abc", 0, REG_NOTBOL));
+  ASSERT_EQ("NO", match("abc$", "abc", 0, REG_NOTEOL));
+  ASSERT_EQ("", match("^$", ""));
+  ASSERT_EQ("x", match("b|^x", "xb", REG_EXTENDED));
+
+  // Anchors match around newlines when REG_NEWLINE is set.
+  ASSERT_EQ("NO", match("^b$", "a\nb\nc"));
+  ASSERT_EQ("b", match("^b$", "a\nb\nc", REG_NEWLINE));
+  ASSERT_EQ("b", match("^b", "a\nb", REG_NEWLINE, REG_NOTBOL));
+  ASSERT_EQ("a", match("a$", "a\nb", REG_NEWLINE, REG_NOTEOL));
+}
+
+TEST(regexec, newline) {
+  ASSERT_EQ("a\nb", match("a.b", "a\nb"));
+  ASSERT_EQ("NO", match("a.b", "a\nb", REG_NEWLINE));
+  ASSERT_EQ("a\nb", match("a[^x]b", "a\nb"));
+  ASSERT_EQ("NO", match("a[^x]b", "a\nb", REG_NEWLINE));
+  ASSERT_EQ("a\nb", match("a[\n]b", "a\nb", REG_NEWLINE));
+}
+
+TEST(regexec, bracket) {
+  ASSERT_EQ("]", match("[]a]", "x]"));
+  ASSERT_EQ("x", match("[^]a]", "]x"));
+  ASSERT_EQ("-", match("[a-]", "x-"));
+  ASSERT_EQ("\\", match("[\\]", "a\\"));
+  ASSERT_EQ("q", match("[p-r]", "aqb"));
+  ASSERT_EQ("a1_", match("[[:alpha:][:digit:]_]*", "a1_-"));
+  ASSERT_EQ("NO", match("[[:upper:]]", "abc"));
+  ASSERT_EQ("c", match("[[.a.]-[.c.]]", "xc"));
+  ASSERT_EQ("b", match("[[=b=]]", "ab"));
+}
+
+TEST(regexec, icase) {
+  ASSERT_EQ("AbC", match("abc", "xAbC", REG_ICASE));
+  ASSERT_EQ("Q", match("[p-r]", "aQb", REG_ICASE));
+  ASSERT_EQ("NO", match("[^p-r]", "Qq", REG_ICASE));
+  ASSERT_EQ("aB", match("[[:lower:]]*", "aB", REG_ICASE));
+  ASSERT_EQ("abAB", match("\\(ab\\)\\1", "abAB", REG_ICASE));
+}
+
+TEST(regexec, backref) {
+  ASSERT_EQ("abab", match("\\(ab\\)\\1", "xabab"));
+  ASSERT_EQ("NO", match("\\(ab\\)\\1", "abac"));
+  ASSERT_EQ("aa", match("\\(a*\\)\\1", "aaa"));
+  ASSERT_EQ("xyzxyz", match("(x(y)z)\\1", "xyzxyz", REG_EXTENDED));
+  ASSERT_EQ("abcbc", match("a(b(c)|d)*\\1", "abcbc", REG_EXTENDED));
+  ASSERT_EQ("", match("\\(a*\\)*\\1", "b"));
+  ASSERT_EQ("NO", match("(a)|b\\1", "b", REG_EXTENDED));
+}
+
+TEST(regexec, submatches) {
+  regex_t re;
+  ASSERT_EQ(0, regcomp(&re, "(a|ab)(c|bcd)(d*)", REG_EXTENDED));
+  regmatch_t pmatch[5];
+  ASSERT_EQ(0, regexec(&re, "xabcd", 5, pmatch, 0));
+  ASSERT_EQ(1, pmatch[0].rm_so);
+  ASSERT_EQ(5, pmatch[0].rm_eo);
+  ASSERT_LE(1, pmatch[1].rm_so);
+  ASSERT_EQ(pmatch[1].rm_eo, pmatch[2].rm_so);
+  ASSERT_EQ(pmatch[2].rm_eo, pmatch[3].rm_so);
+  ASSERT_EQ(5, pmatch[3].rm_eo);
+  ASSERT_EQ(-1, pmatch[4].rm_so);
+  ASSERT_EQ(-1, pmatch[4].rm_eo);
+  regfree(&re);
+
+  // Unmatched subexpressions.
+  ASSERT_EQ(0, regcomp(&re, "(a)|(b)", REG_EXTENDED));
+  ASSERT_EQ(0, regexec(&re, "b", 3, pmatch, 0));
+  ASSERT_EQ(0, pmatch[0].rm_so);
+  ASSERT_EQ(1, pmatch[0].rm_eo);
+  ASSERT_EQ(-1, pmatch[1].rm_so);
+  ASSERT_EQ(-1, pmatch[1].rm_eo);
+  ASSERT_EQ(0, pmatch[2].rm_so);
+  ASSERT_EQ(1, pmatch[2].rm_eo);
+  regfree(&re);
+
+  // Subexpressions in loops report their last iteration.
+  ASSERT_EQ(0, regcomp(&re, "\\(a\\(b\\)*\\)*", 0));
+  ASSERT_EQ(0, regexec(&re, "abbab", 3, pmatch, 0));
+  ASSERT_EQ(0, pmatch[0].rm_so);
+  ASSERT_EQ(5, pmatch[0].rm_eo);
+  ASSERT_EQ(3, pmatch[1].rm_so);
+  ASSERT_EQ(5, pmatch[1].rm_eo);
+  ASSERT_EQ(4, pmatch[2].rm_so);
+  ASSERT_EQ(5, pmatch[2].rm_eo);
+  regfree(&re);
+}
+
+TEST(regexec, nosub) {
+  regex_t re;
+  ASSERT_EQ(0, regcomp(&re, "b(c)", REG_EXTENDED | REG_NOSUB));
+  regmatch_t pmatch = {123, 456};
+  ASSERT_EQ(0, regexec(&re, "abcd", 1, &pmatch, 0));
+  ASSERT_EQ(123, pmatch.rm_so);
+  ASSERT_EQ(456, pmatch.rm_eo);
+  ASSERT_EQ(REG_NOMATCH, regexec(&re, "abd", 1, &pmatch, 0));
+  regfree(&re);
+}
+
+TEST(regexec, pathological) {
+  // Patterns that take exponential time with naive backtracking.
+  std::string pattern, string(30, 'a');
+  for (int i = 0; i < 30; ++i)
+    pattern += "a?";
+  pattern += string;
+  ASSERT_EQ(string, match(pattern.c_str(), string.c_str(), REG_EXTENDED));
+  ASSERT_EQ("NO", match("(a*)*b", std::string(10000, 'a').c_str(),
+                        REG_EXTENDED));
+}
+
+TEST(regexec, dfa_cache) {
+  // Patterns whose DFA has an exponential number of states, causing the
+  // cache to be flushed repeatedly.
+  std::string string;
+  for (unsigned int i = 0; i < 20000; ++i)
+    string += (i * 2654435761) >> 31 ? 'a' : 'b';
+  for (int i = 0; i < 2; ++i) {
+    string[string.size() - 13] = "ab"[i];
+    ASSERT_EQ(i == 0 ? string.substr(string.size() - 13) : "NO",
+              match("a[ab]{12}$", string.c_str(), REG_EXTENDED));
+  }
+}
+
+TEST(regexec, literals) {
+  // Literal prefixes and required strings are used to skip over input.
+  ASSERT_EQ("hello", match("hello", "xxhelhellxhello"));
+  ASSERT_EQ("NO", match("hello", "xxhelhellxhell"));
+  ASSERT_EQ("abbcd", match("ab*cd", "xxaxdxxabbcd"));
+  ASSERT_EQ("xabcx", match("x(abc)+x", "xabxabcxabcx", REG_EXTENDED));
+  ASSERT_EQ("NO", match("[0-9]+needle", "123needl 456needl", REG_EXTENDED));
+  ASSERT_EQ("456needle",
+            match("[0-9]+needle", "123needl 456needle", REG_EXTENDED));
+  ASSERT_EQ("NO", match("(ab)?needle", "abneedl", REG_EXTENDED));
+
+  // Patterns starting with one of a small set of characters.
+  ASSERT_EQ("b1", match("[ab][0-9]", "xxa-b1"));
+  ASSERT_EQ("y", match("x|y", "----y", REG_EXTENDED));
+  ASSERT_EQ("NO", match("x|y", "----z", REG_EXTENDED));
+
+  // Assertions still hold after skipping.
+  ASSERT_EQ("NO", match("^abc", "xabcabc"));
+  ASSERT_EQ("abc", match("^abc", "x\nabc", REG_NEWLINE));
+  ASSERT_EQ("abc", match("^abc", "x\nabc", REG_NEWLINE, REG_NOTBOL));
+  ASSERT_EQ("NO", match("abc$", "abcabcx"));
+  ASSERT_EQ("xy", match("\\(x\\)\\1*y", "xaxxbxy"));
+}
+
+TEST(regexec, utf8) {
+  locale_t locale = newlocale(LC_CTYPE_MASK, ".UTF-8", 0);
+  regex_t re;
+  ASSERT_EQ(0, regcomp_l(&re, "^.é[α-ω]$", REG_EXTENDED, locale));
+  ASSERT_EQ(0, regexec_l(&re, "€éβ", 0, NULL, 0, locale));
+  ASSERT_EQ(REG_NOMATCH, regexec_l(&re, "€eβ", 0, NULL, 0, locale));
+  ASSERT_EQ(REG_NOMATCH, regexec_l(&re, "€éβx", 0, NULL, 0, locale));
+  regfree(&re);
+
+  ASSERT_EQ(0, regcomp_l(&re, "Ä+", REG_EXTENDED | REG_ICASE, locale));
+  regmatch_t pmatch;
+  ASSERT_EQ(0, regexec_l(&re, "xäÄä", 1, &pmatch, 0, locale));
+  ASSERT_EQ(1, pmatch.rm_so);
+  ASSERT_EQ(7, pmatch.rm_eo);
+  regfree(&re);
+
+  // Literals are found in between multibyte characters.
+  ASSERT_EQ(0, regcomp_l(&re, "aé", 0, locale));
+  ASSERT_EQ(0, regexec_l(&re, "ééaéé", 1, &pmatch, 0, locale));
+  ASSERT_EQ(4, pmatch.rm_so);
+  ASSERT_EQ(7, pmatch.rm_eo);
+  ASSERT_EQ(REG_NOMATCH, regexec_l(&re, "ééaeé", 0, NULL, 0, locale));
+  regfree(&re);
+
+  // Invalid sequences only match wildcards.
+  ASSERT_EQ(0, regcomp_l(&re, "a.b", 0, locale));
+  ASSERT_EQ(0, regexec_l(&re, "a\xff" "b", 0, NULL, 0, locale));
+  regfree(&re);
+  freelocale(locale);
+}
+
+TEST(regexec, threads) {
+  // Concurrent use of the same regular expression.
+  regex_t re;
+  ASSERT_EQ(0, regcomp(&re, "(ab|cd)+e", REG_EXTENDED));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&re]() {
+      for (int j = 0; j < 1000; ++j) {
+        ASSERT_EQ(0, regexec(&re, "xxabcdabe", 0, NULL, 0));
+        ASSERT_EQ(REG_NOMATCH, regexec(&re, "xxabcdab", 0, NULL, 0));
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  regfree(&re);
+}
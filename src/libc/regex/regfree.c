@@ -2,8 +2,35 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <pthread.h>
 #include <regex.h>
+#include <stdlib.h>
+
+#include "regex_impl.h"
 
 void regfree(regex_t *preg) {
-  // TODO(ed): Implement.
+  struct __regex *regex = preg->__regex;
+  for (size_t i = 0; i < regex->sets_count; ++i) {
+    free(regex->sets[i].ranges);
+    free(regex->sets[i].classes);
+  }
+  free(regex->sets);
+  free(regex->insts);
+
+  // Discard the lazily constructed DFA.
+  struct regex_dfa *dfa = &regex->dfa;
+  if (dfa->buckets != NULL) {
+    for (size_t i = 0; i < REGEX_DFA_BUCKETS; ++i) {
+      struct regex_dfa_state *state = dfa->buckets[i];
+      while (state != NULL) {
+        struct regex_dfa_state *next = state->bucket_next;
+        free(state);
+        state = next;
+      }
+    }
+    free(dfa->buckets);
+    free(dfa->stack);
+  }
+  pthread_mutex_destroy(&dfa->lock);
+  free(regex);
 }
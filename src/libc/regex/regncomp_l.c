@@ -3,25 +3,42 @@
 // SPDX-License-Identifier: BSD-2-Clause
 
 #include <common/locale.h>
+#include <common/mbstate.h>
+
+#include <sys/types.h>
 
 #include <locale.h>
 #include <regex.h>
+#include <stdlib.h>
+#include <uchar.h>
 
-struct inputbuf {
-  const struct lc_ctype *ctype;
-  mbstate_t mbs;
-  const char *buf;
-  size_t len;
-};
-
-#include "regex_compile.h"
+#include "regex_impl.h"
 
 int regncomp_l(regex_t *restrict preg, const char *restrict pattern, size_t len,
                int cflags, locale_t locale) {
-  struct inputbuf buf = {
-      .ctype = locale->ctype,
-      .buf = pattern,
-      .len = len,
-  };
-  return regex_compile(preg, &buf, cflags, locale);
+  // Convert the pattern to Unicode, so that it can be matched against
+  // both narrow and wide character strings.
+  char32_t *upattern = reallocarray(NULL, len + 1, sizeof(*upattern));
+  if (upattern == NULL)
+    return REG_ESPACE;
+  const struct lc_ctype *ctype = locale->ctype;
+  mbstate_t mbs;
+  mbstate_set_init(&mbs);
+  size_t ulen = 0;
+  while (len > 0) {
+    ssize_t l = ctype->mbtoc32(&upattern[ulen++], pattern, len, &mbs,
+                               ctype->data);
+    if (l < 0) {
+      free(upattern);
+      return REG_BADPAT;
+    }
+    if (l == 0)
+      l = 1;
+    pattern += l;
+    len -= l;
+  }
+
+  int error = __regex_compile(preg, upattern, ulen, cflags);
+  free(upattern);
+  return error;
 }
@@ -0,0 +1,42 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <regex.h>
+#include <stddef.h>
+
+#include "gtest/gtest.h"
+
+TEST(regwexec, example) {
+  regex_t re;
+  ASSERT_EQ(0, regwcomp(&re, L"([α-ω]+)(€|\\$)$", REG_EXTENDED));
+  ASSERT_EQ(2, re.re_nsub);
+  regmatch_t pmatch[3];
+  ASSERT_EQ(0, regwexec(&re, L"Price: αβγ€", 3, pmatch, 0));
+  ASSERT_EQ(7, pmatch[0].rm_so);
+  ASSERT_EQ(11, pmatch[0].rm_eo);
+  ASSERT_EQ(7, pmatch[1].rm_so);
+  ASSERT_EQ(10, pmatch[1].rm_eo);
+  ASSERT_EQ(10, pmatch[2].rm_so);
+  ASSERT_EQ(11, pmatch[2].rm_eo);
+  ASSERT_EQ(REG_NOMATCH, regwexec(&re, L"Price: αβγ£", 3, pmatch, 0));
+  regfree(&re);
+
+  // Wide strings may contain null characters.
+  ASSERT_EQ(0, regwncomp(&re, L"a\0b", 3, REG_NOSUB));
+  ASSERT_EQ(0, regwnexec(&re, L"xa\0b", 4, 0, NULL, 0));
+  ASSERT_EQ(REG_NOMATCH, regwnexec(&re, L"xa\0c", 4, 0, NULL, 0));
+  regfree(&re);
+
+  // Literals are searched for in wide strings directly.
+  ASSERT_EQ(0, regwcomp(&re, L"βγ+δ", REG_EXTENDED));
+  ASSERT_EQ(0, regwexec(&re, L"αβγαβγγδ", 1, pmatch, 0));
+  ASSERT_EQ(4, pmatch[0].rm_so);
+  ASSERT_EQ(8, pmatch[0].rm_eo);
+  ASSERT_EQ(REG_NOMATCH, regwexec(&re, L"αβγαβγγ", 1, pmatch, 0));
+  regfree(&re);
+  ASSERT_EQ(0, regwcomp(&re, L"[xy]z", 0));
+  ASSERT_EQ(0, regwexec(&re, L"€x€yz", 1, pmatch, 0));
+  ASSERT_EQ(3, pmatch[0].rm_so);
+  regfree(&re);
+}
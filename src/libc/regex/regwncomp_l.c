@@ -2,22 +2,17 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <assert.h>
 #include <locale.h>
 #include <regex.h>
+#include <uchar.h>
 #include <wchar.h>
 
-struct inputbuf {
-  const wchar_t *buf;
-  size_t len;
-};
+#include "regex_impl.h"
 
-#include "regex_compile.h"
+static_assert(sizeof(wchar_t) == sizeof(char32_t), "Size mismatch");
 
 int regwncomp_l(regex_t *restrict preg, const wchar_t *restrict pattern,
                 size_t len, int cflags, locale_t locale) {
-  struct inputbuf buf = {
-      .buf = pattern,
-      .len = len,
-  };
-  return regex_compile(preg, &buf, cflags, locale);
+  return __regex_compile(preg, (const char32_t *)pattern, len, cflags);
 }
@@ -2,19 +2,13 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
-#include <limits.h>
-#include <pthread.h>
 #include <semaphore.h>
-#include <stdint.h>
+#include <stdatomic.h>
 
-int sem_getvalue(sem_t *restrict sem, int *restrict sval) {
-  // Extract value from semaphore.
-  pthread_mutex_lock(&sem->__lock);
-  uint32_t value = sem->__value;
-  pthread_mutex_unlock(&sem->__lock);
+#include "semaphore_impl.h"
 
-  // Return value is a signed integer type. Return INT_MAX in case the
-  // semaphore value won't fit.
-  *sval = value > INT_MAX ? INT_MAX : value;
+int sem_getvalue(sem_t *restrict sem, int *restrict sval) {
+  *sval = atomic_load_explicit(&sem->__value, memory_order_relaxed) &
+          SEM_VALUE_MASK;
   return 0;
 }
@@ -3,16 +3,24 @@
 // SPDX-License-Identifier: BSD-2-Clause
 
 #include <cloudabi_types.h>
+#include <errno.h>
+#include <limits.h>
 #include <pthread.h>
 #include <semaphore.h>
 #include <stdatomic.h>
 
 int sem_init(sem_t *sem, int pshared, unsigned int value) {
+  if (value > SEM_VALUE_MAX) {
+    errno = EINVAL;
+    return -1;
+  }
+
   // Initialize lock.
   atomic_init(&sem->__lock.__state, CLOUDABI_LOCK_UNLOCKED);
   sem->__lock.__write_recursion = -1;
   sem->__lock.__pshared =
       pshared ? PTHREAD_PROCESS_SHARED : PTHREAD_PROCESS_PRIVATE;
+  atomic_init(&sem->__lock.__spin_estimate, 0);
 
   // Initialize condition variable.
   atomic_init(&sem->__cond.__waiters, CLOUDABI_CONDVAR_HAS_NO_WAITERS);
@@ -21,6 +29,6 @@ int sem_init(sem_t *sem, int pshared, unsigned int value) {
       pshared ? PTHREAD_PROCESS_SHARED : PTHREAD_PROCESS_PRIVATE;
 
   // Initialize other fields.
-  sem->__value = value;
+  atomic_init(&sem->__value, value);
   return 0;
 }
@@ -3,20 +3,33 @@
 // SPDX-License-Identifier: BSD-2-Clause
 
 #include <errno.h>
-#include <limits.h>
 #include <pthread.h>
 #include <semaphore.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "semaphore_impl.h"
 
 int sem_post(sem_t *sem) {
-  pthread_mutex_lock(&sem->__lock);
-  if (sem->__value == UINT_MAX) {
-    // Incremeing the semaphore would cause an overflow.
+  // Increment the value, clearing the waiters flag.
+  uint32_t old = atomic_load_explicit(&sem->__value, memory_order_relaxed);
+  do {
+    if ((old & SEM_VALUE_MASK) == SEM_VALUE_MAX) {
+      // Incrementing the semaphore would cause an overflow.
+      errno = EINVAL;
+      return -1;
+    }
+  } while (!atomic_compare_exchange_weak_explicit(
+      &sem->__value, &old, (old & SEM_VALUE_MASK) + 1, memory_order_release,
+      memory_order_relaxed));
+
+  // Wake up a blocked thread. Acquire the lock to ensure that the
+  // thread that set the flag has started waiting. Signal while holding
+  // the lock, so that the thread is handed the lock when we release it.
+  if ((old & SEM_WAITERS) != 0) {
+    pthread_mutex_lock(&sem->__lock);
+    pthread_cond_signal(&sem->__cond);
     pthread_mutex_unlock(&sem->__lock);
-    errno = EINVAL;
-    return -1;
   }
-  ++sem->__value;
-  pthread_mutex_unlock(&sem->__lock);
-  pthread_cond_signal(&sem->__cond);
   return 0;
 }
@@ -0,0 +1,59 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#include "gtest/gtest.h"
+
+TEST(sem_post, overflow) {
+  sem_t sem;
+  ASSERT_EQ(-1, sem_init(&sem, 0, (unsigned int)SEM_VALUE_MAX + 1));
+  ASSERT_EQ(EINVAL, errno);
+
+  ASSERT_EQ(0, sem_init(&sem, 0, SEM_VALUE_MAX));
+  ASSERT_EQ(-1, sem_post(&sem));
+  ASSERT_EQ(EINVAL, errno);
+  int value;
+  ASSERT_EQ(0, sem_getvalue(&sem, &value));
+  ASSERT_EQ(SEM_VALUE_MAX, value);
+  ASSERT_EQ(0, sem_destroy(&sem));
+}
+
+static void *do_post(void *arg) {
+  auto sem = static_cast<sem_t *>(arg);
+  for (int i = 0; i < 10000; ++i)
+    EXPECT_EQ(0, sem_post(sem));
+  return NULL;
+}
+
+static void *do_wait(void *arg) {
+  auto sem = static_cast<sem_t *>(arg);
+  for (int i = 0; i < 10000; ++i)
+    EXPECT_EQ(0, sem_wait(sem));
+  return NULL;
+}
+
+TEST(sem_post, producers_consumers) {
+  // Let multiple threads block on the semaphore while others post it.
+  // Every post should eventually wake up a blocked thread.
+  sem_t sem;
+  ASSERT_EQ(0, sem_init(&sem, 0, 0));
+  pthread_t consumers[4], producers[4];
+  for (pthread_t &thread : consumers)
+    ASSERT_EQ(0, pthread_create(&thread, NULL, do_wait, &sem));
+  for (pthread_t &thread : producers)
+    ASSERT_EQ(0, pthread_create(&thread, NULL, do_post, &sem));
+  for (pthread_t thread : producers)
+    ASSERT_EQ(0, pthread_join(thread, NULL));
+  for (pthread_t thread : consumers)
+    ASSERT_EQ(0, pthread_join(thread, NULL));
+
+  int value;
+  ASSERT_EQ(0, sem_getvalue(&sem, &value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ(0, sem_destroy(&sem));
+}
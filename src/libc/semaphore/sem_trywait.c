@@ -3,17 +3,14 @@
 // SPDX-License-Identifier: BSD-2-Clause
 
 #include <errno.h>
-#include <pthread.h>
 #include <semaphore.h>
 
+#include "semaphore_impl.h"
+
 int sem_trywait(sem_t *sem) {
-  pthread_mutex_lock(&sem->__lock);
-  if (sem->__value == 0) {
-    pthread_mutex_unlock(&sem->__lock);
+  if (!sem_trydecrement(sem)) {
     errno = EAGAIN;
     return -1;
   }
-  --sem->__value;
-  pthread_mutex_unlock(&sem->__lock);
   return 0;
 }
@@ -2,16 +2,13 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
-#include <pthread.h>
 #include <semaphore.h>
+#include <stddef.h>
+
+#include "semaphore_impl.h"
 
 int sem_wait(sem_t *sem) {
-  pthread_mutex_lock(&sem->__lock);
-  while (sem->__value == 0) {
-    // Wait until the semaphore becomes greater than zero.
-    pthread_cond_wait(&sem->__cond, &sem->__lock);
-  }
-  --sem->__value;
-  pthread_mutex_unlock(&sem->__lock);
+  if (!sem_trydecrement(sem))
+    sem_block(sem, NULL);
   return 0;
 }
@@ -0,0 +1,112 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef SEMAPHORE_SEMAPHORE_IMPL_H
+#define SEMAPHORE_SEMAPHORE_IMPL_H
+
+#include <assert.h>
+#include <cloudabi_types.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Semaphores.
+//
+// The value of a semaphore is stored in an atomic integer, so that
+// sem_post() and sem_trywait() only need to perform a single atomic
+// operation when no threads are blocked. The semaphore's lock and
+// condition variable are only used by threads that need to block.
+//
+// Before blocking, threads set the SEM_WAITERS flag in the semaphore
+// value, while holding the lock. sem_post() clears the flag while
+// incrementing the value. Only if the flag was set, it signals the
+// condition variable. As the flag is set while holding the lock,
+// sem_post() acquires the lock before signalling, so that it cannot
+// signal before the waiting thread has started waiting.
+//
+// A thread that returns from waiting sets the flag again if other
+// threads are still blocked. If the value of the semaphore permits,
+// it wakes up another thread instead, as multiple calls to sem_post()
+// may have happened while only a single thread was signalled.
+
+#define SEM_WAITERS 0x80000000
+#define SEM_VALUE_MASK 0x7fffffff
+
+static_assert(SEM_VALUE_MAX == SEM_VALUE_MASK, "Value mismatch");
+
+// Attempts to decrement the value of the semaphore.
+static inline bool sem_trydecrement(sem_t *sem) {
+  uint32_t old = atomic_load_explicit(&sem->__value, memory_order_relaxed);
+  do {
+    if ((old & SEM_VALUE_MASK) == 0)
+      return false;
+  } while (!atomic_compare_exchange_weak_explicit(
+      &sem->__value, &old, old - 1, memory_order_acquire,
+      memory_order_relaxed));
+  return true;
+}
+
+// Passes on wakeups to other blocked threads after returning from
+// waiting. Called with the lock held.
+static inline void sem_wakeup_next(sem_t *sem)
+    __requires_exclusive(sem->__lock) {
+  if (atomic_load_explicit(&sem->__cond.__waiters, memory_order_relaxed) ==
+      CLOUDABI_CONDVAR_HAS_NO_WAITERS)
+    return;
+  uint32_t old = atomic_load_explicit(&sem->__value, memory_order_relaxed);
+  for (;;) {
+    if ((old & SEM_VALUE_MASK) != 0) {
+      pthread_cond_signal(&sem->__cond);
+      return;
+    }
+    if ((old & SEM_WAITERS) != 0 ||
+        atomic_compare_exchange_weak_explicit(&sem->__value, &old,
+                                              old | SEM_WAITERS,
+                                              memory_order_relaxed,
+                                              memory_order_relaxed))
+      return;
+  }
+}
+
+// Decrements the value of the semaphore, blocking until it is greater
+// than zero. Called by sem_wait() and sem_timedwait(). Returns an error
+// number if waiting times out.
+static inline int sem_block(sem_t *sem, const struct timespec *abstime) {
+  pthread_mutex_lock(&sem->__lock);
+  int error = 0;
+  for (;;) {
+    if (sem_trydecrement(sem))
+      break;
+
+    // Announce that we're going to block.
+    uint32_t old = atomic_load_explicit(&sem->__value, memory_order_relaxed);
+    if ((old & SEM_VALUE_MASK) != 0 ||
+        ((old & SEM_WAITERS) == 0 &&
+         !atomic_compare_exchange_strong_explicit(
+             &sem->__value, &old, old | SEM_WAITERS, memory_order_relaxed,
+             memory_order_relaxed)))
+      continue;
+
+    error = abstime == NULL
+                ? pthread_cond_wait(&sem->__cond, &sem->__lock)
+                : pthread_cond_timedwait(&sem->__cond, &sem->__lock, abstime);
+    if (error != 0) {
+      // Still allow the semaphore to be decremented if it has been
+      // incremented right before timing out.
+      if (sem_trydecrement(sem))
+        error = 0;
+      break;
+    }
+  }
+  sem_wakeup_next(sem);
+  pthread_mutex_unlock(&sem->__lock);
+  return error;
+}
+
+#endif
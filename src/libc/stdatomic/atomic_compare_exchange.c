@@ -10,15 +10,33 @@
 bool __atomic_compare_exchange(size_t len, void *object, void *expected,
                                void *desired, memory_order success,
                                memory_order failure) {
-  pthread_rwlock_t *lock = atomic_fallback_getlock(object);
-  pthread_rwlock_wrlock(lock);
+#ifdef ATOMIC_FALLBACK_WIDE
+  if (atomic_fallback_is_wide(len, object)) {
+    atomic_fallback_wide_t e, d;
+    memcpy(&e, expected, sizeof(e));
+    memcpy(&d, desired, sizeof(d));
+    atomic_fallback_wide_t v =
+        __sync_val_compare_and_swap((atomic_fallback_wide_t *)object, e, d);
+    if (v == e)
+      return true;
+    memcpy(expected, &v, sizeof(v));
+    return false;
+  }
+#endif
+
+  // Only mark the object as being modified if the comparison succeeds,
+  // so that failing calls don't cause concurrent loads to retry.
+  struct atomic_fallback_lock *l = atomic_fallback_getlock(object);
+  pthread_mutex_lock(&l->lock);
   if (memcmp(object, expected, len) == 0) {
+    atomic_fallback_write_begin(l);
     memcpy(object, desired, len);
-    pthread_rwlock_unlock(lock);
+    atomic_fallback_write_end(l);
+    pthread_mutex_unlock(&l->lock);
     return true;
   } else {
     memcpy(expected, object, len);
-    pthread_rwlock_unlock(lock);
+    pthread_mutex_unlock(&l->lock);
     return false;
   }
 }
@@ -9,9 +9,21 @@
 
 void __atomic_exchange(size_t len, void *object, void *new, void *old,
                        memory_order order) {
-  pthread_rwlock_t *lock = atomic_fallback_getlock(object);
-  pthread_rwlock_wrlock(lock);
+#ifdef ATOMIC_FALLBACK_WIDE
+  if (atomic_fallback_is_wide(len, object)) {
+    atomic_fallback_wide_t v;
+    memcpy(&v, new, sizeof(v));
+    v = atomic_fallback_wide_exchange(object, v);
+    memcpy(old, &v, sizeof(v));
+    return;
+  }
+#endif
+
+  struct atomic_fallback_lock *l = atomic_fallback_getlock(object);
+  pthread_mutex_lock(&l->lock);
+  atomic_fallback_write_begin(l);
   memcpy(old, object, len);
   memcpy(object, new, len);
-  pthread_rwlock_unlock(lock);
+  atomic_fallback_write_end(l);
+  pthread_mutex_unlock(&l->lock);
 }
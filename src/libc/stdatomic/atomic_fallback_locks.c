@@ -7,15 +7,15 @@
 
 #include "stdatomic_impl.h"
 
-pthread_rwlock_t __atomic_fallback_locks[] = {
-    PTHREAD_RWLOCK_INITIALIZER, PTHREAD_RWLOCK_INITIALIZER,
-    PTHREAD_RWLOCK_INITIALIZER, PTHREAD_RWLOCK_INITIALIZER,
-    PTHREAD_RWLOCK_INITIALIZER, PTHREAD_RWLOCK_INITIALIZER,
-    PTHREAD_RWLOCK_INITIALIZER, PTHREAD_RWLOCK_INITIALIZER,
-    PTHREAD_RWLOCK_INITIALIZER, PTHREAD_RWLOCK_INITIALIZER,
-    PTHREAD_RWLOCK_INITIALIZER, PTHREAD_RWLOCK_INITIALIZER,
-    PTHREAD_RWLOCK_INITIALIZER, PTHREAD_RWLOCK_INITIALIZER,
-    PTHREAD_RWLOCK_INITIALIZER, PTHREAD_RWLOCK_INITIALIZER,
+#define LOCK1 {.lock = PTHREAD_MUTEX_INITIALIZER}
+#define LOCK4 LOCK1, LOCK1, LOCK1, LOCK1
+#define LOCK16 LOCK4, LOCK4, LOCK4, LOCK4
+
+struct atomic_fallback_lock __atomic_fallback_locks[] = {
+    LOCK16,
+    LOCK16,
+    LOCK16,
+    LOCK16,
 };
 static_assert(__arraycount(__atomic_fallback_locks) ==
                   1 << ATOMIC_FALLBACK_NBITS,
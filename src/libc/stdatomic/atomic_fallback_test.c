@@ -0,0 +1,84 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <assert.h>
+#include <program.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define ASSERT_EQ(a, b) assert((a) == (b))
+
+// Test the atomicity of operations on objects that are too large to be
+// lock-free. Threads concurrently increment all of the bytes of objects
+// of different sizes using compare-and-exchange. Every value observed
+// should have identical bytes, as loads may never observe an object
+// that is only partially modified.
+
+#define NTHREADS 4
+#define NITERATIONS 10000
+
+#define TEST_SIZE(size)                                                 \
+  struct object##size {                                                 \
+    uint8_t bytes[size];                                                \
+  };                                                                    \
+                                                                        \
+  static _Atomic(struct object##size) object##size;                     \
+                                                                        \
+  static void check##size(const struct object##size *o) {               \
+    for (size_t i = 1; i < size; ++i)                                   \
+      ASSERT_EQ(o->bytes[0], o->bytes[i]);                              \
+  }                                                                     \
+                                                                        \
+  static void increment##size(void) {                                   \
+    struct object##size old = atomic_load(&object##size), new;          \
+    do {                                                                \
+      check##size(&old);                                                \
+      for (size_t i = 0; i < size; ++i)                                 \
+        new.bytes[i] = old.bytes[0] + 1;                                \
+    } while (!atomic_compare_exchange_weak(&object##size, &old, new));  \
+  }                                                                     \
+                                                                        \
+  static void verify##size(void) {                                      \
+    struct object##size o = atomic_load(&object##size);                 \
+    check##size(&o);                                                    \
+    ASSERT_EQ((uint8_t)(NTHREADS * NITERATIONS), o.bytes[0]);           \
+  }
+
+TEST_SIZE(3)
+TEST_SIZE(16)
+TEST_SIZE(24)
+TEST_SIZE(48)
+TEST_SIZE(256)
+
+static void *do_increment(void *arg) {
+  for (int i = 0; i < NITERATIONS; ++i) {
+    increment3();
+    increment16();
+    increment24();
+    increment48();
+    increment256();
+  }
+  return NULL;
+}
+
+void program_main(const argdata_t *ad) {
+  pthread_t threads[NTHREADS];
+  for (int i = 0; i < NTHREADS; ++i) {
+    int error = pthread_create(&threads[i], NULL, do_increment, NULL);
+    ASSERT_EQ(0, error);
+  }
+  for (int i = 0; i < NTHREADS; ++i) {
+    int error = pthread_join(threads[i], NULL);
+    ASSERT_EQ(0, error);
+  }
+
+  verify3();
+  verify16();
+  verify24();
+  verify48();
+  verify256();
+  exit(0);
+}
@@ -3,13 +3,41 @@
 // SPDX-License-Identifier: BSD-2-Clause
 
 #include <pthread.h>
+#include <stdatomic.h>
 #include <string.h>
 
 #include "stdatomic_impl.h"
 
+// Number of times the object is copied without acquiring the lock,
+// before giving up and acquiring the lock. This ensures progress when
+// the thread modifying the object is not running.
+#define LOAD_RETRY_COUNT 16
+
 void __atomic_load(size_t len, void *object, void *value, memory_order order) {
-  pthread_rwlock_t *lock = atomic_fallback_getlock(object);
-  pthread_rwlock_rdlock(lock);
+#ifdef ATOMIC_FALLBACK_WIDE
+  if (atomic_fallback_is_wide(len, object)) {
+    atomic_fallback_wide_t v =
+        __sync_val_compare_and_swap((atomic_fallback_wide_t *)object, 0, 0);
+    memcpy(value, &v, sizeof(v));
+    return;
+  }
+#endif
+
+  // Copy the object while it's not being modified.
+  struct atomic_fallback_lock *l = atomic_fallback_getlock(object);
+  for (int i = 0; i < LOAD_RETRY_COUNT; ++i) {
+    unsigned int sequence =
+        atomic_load_explicit(&l->sequence, memory_order_acquire);
+    if (sequence % 2 == 0) {
+      memcpy(value, object, len);
+      atomic_thread_fence(memory_order_acquire);
+      if (atomic_load_explicit(&l->sequence, memory_order_relaxed) ==
+          sequence)
+        return;
+    }
+  }
+
+  pthread_mutex_lock(&l->lock);
   memcpy(value, object, len);
-  pthread_rwlock_unlock(lock);
+  pthread_mutex_unlock(&l->lock);
 }
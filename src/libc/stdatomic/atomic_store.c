@@ -8,8 +8,19 @@
 #include "stdatomic_impl.h"
 
 void __atomic_store(size_t len, void *object, void *value, memory_order order) {
-  pthread_rwlock_t *lock = atomic_fallback_getlock(object);
-  pthread_rwlock_wrlock(lock);
+#ifdef ATOMIC_FALLBACK_WIDE
+  if (atomic_fallback_is_wide(len, object)) {
+    atomic_fallback_wide_t v;
+    memcpy(&v, value, sizeof(v));
+    atomic_fallback_wide_exchange(object, v);
+    return;
+  }
+#endif
+
+  struct atomic_fallback_lock *l = atomic_fallback_getlock(object);
+  pthread_mutex_lock(&l->lock);
+  atomic_fallback_write_begin(l);
   memcpy(object, value, len);
-  pthread_rwlock_unlock(lock);
+  atomic_fallback_write_end(l);
+  pthread_mutex_unlock(&l->lock);
 }
@@ -7,6 +7,8 @@
 
 #include <sys/types.h>
 
+#include <pthread.h>
+#include <stdalign.h>
 #include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -36,14 +38,28 @@ void __atomic_store(size_t, void *, void *, memory_order);
 
 // Exponent of the size of the table of locks that should be used for
 // atomic objects that are not lock-free.
-#define ATOMIC_FALLBACK_NBITS 4
+#define ATOMIC_FALLBACK_NBITS 6
+
+// Lock for atomic objects that are not lock-free.
+//
+// Every lock has a sequence number that is incremented by writers
+// before and after modifying an object, making it odd while the object
+// is being modified. This allows __atomic_load() to copy objects
+// without acquiring the lock, retrying if the sequence number was odd
+// or has changed while copying. Locks are aligned to the size of a
+// cache line, so that threads using different locks don't contend.
+struct atomic_fallback_lock {
+  alignas(64) pthread_mutex_t lock;
+  atomic_uint sequence;
+};
 
 // Table of locks.
-extern pthread_rwlock_t __atomic_fallback_locks[];
+extern struct atomic_fallback_lock __atomic_fallback_locks[];
 
 // Fetches a lock for an atomic object that is not lock-free, based on
 // the address of the object.
-static inline pthread_rwlock_t *atomic_fallback_getlock(void *object) {
+static inline struct atomic_fallback_lock *atomic_fallback_getlock(
+    void *object) {
   if (ATOMIC_FALLBACK_NBITS == 0) {
     // Table consists of a single lock. Return lock without performing
     // any arithmetic.
@@ -56,4 +72,55 @@ static inline pthread_rwlock_t *atomic_fallback_getlock(void *object) {
   }
 }
 
+// Marks an object as being modified. Called with the lock held.
+static inline void atomic_fallback_write_begin(struct atomic_fallback_lock *l)
+    __requires_exclusive(l->lock) {
+  atomic_store_explicit(
+      &l->sequence,
+      atomic_load_explicit(&l->sequence, memory_order_relaxed) + 1,
+      memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+}
+
+// Marks an object as no longer being modified. Called with the lock
+// held.
+static inline void atomic_fallback_write_end(struct atomic_fallback_lock *l)
+    __requires_exclusive(l->lock) {
+  atomic_store_explicit(
+      &l->sequence,
+      atomic_load_explicit(&l->sequence, memory_order_relaxed) + 1,
+      memory_order_release);
+}
+
+// Objects of 16 bytes can be accessed using double-width
+// compare-and-swap instructions if they are properly aligned and the
+// compiler advertises support for them. This is only the case if the
+// target is known to have such instructions. On x86-64 it requires
+// building with -mcx16, as early CPUs lack CMPXCHG16B. Without it, the
+// locks below are used for objects of all sizes. All operations are
+// implemented on top of compare-and-swap, as that is the only operation
+// that is guaranteed to be inlined.
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_16
+#define ATOMIC_FALLBACK_WIDE 1
+
+typedef unsigned __int128 atomic_fallback_wide_t;
+
+static inline bool atomic_fallback_is_wide(size_t len, void *object) {
+  return len == sizeof(atomic_fallback_wide_t) &&
+         (uintptr_t)object % sizeof(atomic_fallback_wide_t) == 0;
+}
+
+static inline atomic_fallback_wide_t atomic_fallback_wide_exchange(
+    void *object, atomic_fallback_wide_t new) {
+  atomic_fallback_wide_t *p = object;
+  atomic_fallback_wide_t old = __sync_val_compare_and_swap(p, 0, 0);
+  for (;;) {
+    atomic_fallback_wide_t prev = __sync_val_compare_and_swap(p, old, new);
+    if (prev == old)
+      return old;
+    old = prev;
+  }
+}
+#endif
+
 #endif
@@ -0,0 +1,85 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+// Throughput benchmark for the printf() family of functions. Every
+// format string is printed repeatedly to a pipe through a buffered
+// stream, into a fixed size buffer and into an allocated buffer. The
+// format strings range from mostly literal text to mostly conversions,
+// so that the costs of both can be observed.
+
+namespace {
+
+constexpr unsigned int kIterations = 1 << 18;
+
+double now() {
+  struct timespec ts;
+  EXPECT_EQ(0, clock_gettime(CLOCK_MONOTONIC, &ts));
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Discards all data written into the pipe.
+void *do_drain(void *arg) {
+  int fd = *static_cast<int *>(arg);
+  char buf[4096];
+  while (read(fd, buf, sizeof(buf)) > 0) {
+  }
+  return nullptr;
+}
+
+void report(const char *function, const char *name, double elapsed) {
+  printf("%-8s %-10s %8.1f ns/call\n", function, name,
+         elapsed / kIterations * 1e9);
+}
+
+#define BENCHMARK(name, ...)                                            \
+  do {                                                                  \
+    int fds[2];                                                         \
+    ASSERT_EQ(0, pipe(fds));                                            \
+    pthread_t drainer;                                                  \
+    ASSERT_EQ(0, pthread_create(&drainer, nullptr, do_drain, &fds[0])); \
+    FILE *stream = fdopen(fds[1], "w");                                 \
+    ASSERT_NE(nullptr, stream);                                         \
+    double begin = now();                                               \
+    for (unsigned int i = 0; i < kIterations; ++i)                      \
+      ASSERT_LT(0, fprintf(stream, __VA_ARGS__));                       \
+    ASSERT_EQ(0, fclose(stream));                                       \
+    report("fprintf", name, now() - begin);                             \
+    ASSERT_EQ(0, pthread_join(drainer, nullptr));                       \
+    ASSERT_EQ(0, close(fds[0]));                                        \
+                                                                        \
+    char buf[256];                                                      \
+    begin = now();                                                      \
+    for (unsigned int i = 0; i < kIterations; ++i)                      \
+      ASSERT_LT(0, snprintf(buf, sizeof(buf), __VA_ARGS__));            \
+    report("snprintf", name, now() - begin);                            \
+                                                                        \
+    begin = now();                                                      \
+    for (unsigned int i = 0; i < kIterations; ++i) {                    \
+      char *str;                                                        \
+      ASSERT_LT(0, asprintf(&str, __VA_ARGS__));                        \
+      free(str);                                                        \
+    }                                                                   \
+    report("asprintf", name, now() - begin);                            \
+  } while (0)
+
+}  // namespace
+
+TEST(printf, throughput) {
+  BENCHMARK("literal",
+            "The quick brown fox jumps over the lazy dog, many times.\n");
+  BENCHMARK("string", "GET %s HTTP/1.1\r\nHost: %s\r\n\r\n",
+            "/index.html?query=string", "www.example.com");
+  BENCHMARK("padded", "[%-20s] [%20s] [%08x]\n", "left", "right", 0xdead);
+  BENCHMARK("integers", "%d %u %x %ld %lld\n", -123456, 4000000000U,
+            0xcafebabe, 1234567890L, -1234567890123LL);
+  BENCHMARK("floats", "%f %e %g\n", 3.14159265, 2.71828e10, 1.41421e-7);
+}
@@ -0,0 +1,80 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/crt.h>
+#include <common/stdio.h>
+
+#include <elf.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Cache of compiled printf() format strings.
+//
+// Programs typically call the printf() family of functions with a small
+// set of string literals as their format strings. Instead of parsing
+// these on every call, they are compiled once and stored in a hash
+// table keyed by their address. This is only safe for format strings
+// that reside in read-only memory, as their contents cannot change.
+//
+// The table is shared by all threads. Entries are only ever added, so
+// that lookups can be performed without any locking. Once the table has
+// filled up, any other format strings are interpreted directly.
+
+#define CACHE_NBITS 9
+#define CACHE_ENTRIES (1 << CACHE_NBITS)
+#define CACHE_PROBES 8
+
+static _Atomic(const char *) cache_keys[CACHE_ENTRIES];
+static _Atomic(const void *) cache_values[CACHE_ENTRIES];
+
+// Returns whether a format string is part of one of the read-only
+// segments of the executable.
+static bool is_readonly(const char *format) {
+  uintptr_t address = (uintptr_t)format;
+  for (size_t i = 0; i < __at_phnum; ++i) {
+    const ElfW(Phdr) *phdr = &__at_phdr[i];
+    if (phdr->p_type == PT_LOAD && (phdr->p_flags & PF_W) == 0) {
+      uintptr_t start = (uintptr_t)__at_base + phdr->p_vaddr;
+      if (address >= start && address - start < phdr->p_memsz)
+        return true;
+    }
+  }
+  return false;
+}
+
+const void *__printf_cache_get(const char *format,
+                               const void *(*compile)(const char *)) {
+  size_t hash = (uint32_t)((uintptr_t)format * UINT32_C(2654435761)) >>
+                (32 - CACHE_NBITS);
+  bool readonly = false;
+  for (size_t i = 0; i < CACHE_PROBES; ++i) {
+    size_t slot = (hash + i) % CACHE_ENTRIES;
+    const char *key =
+        atomic_load_explicit(&cache_keys[slot], memory_order_acquire);
+    if (key == NULL) {
+      // Free slot. Claim it and store the compiled format string, if
+      // the format string may be cached in the first place.
+      if (!readonly && !is_readonly(format))
+        return NULL;
+      readonly = true;
+      if (atomic_compare_exchange_strong_explicit(
+              &cache_keys[slot], &key, format, memory_order_acq_rel,
+              memory_order_acquire)) {
+        const void *value = compile(format);
+        atomic_store_explicit(&cache_values[slot], value,
+                              memory_order_release);
+        return value;
+      }
+      // Slot got claimed by another thread in the meantime.
+    }
+    if (key == format) {
+      // Entry found. The value may still be NULL if another thread is
+      // in the process of compiling the format string.
+      return atomic_load_explicit(&cache_values[slot], memory_order_acquire);
+    }
+  }
+  return NULL;
+}
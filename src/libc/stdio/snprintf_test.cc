@@ -7,6 +7,7 @@
 #include <locale.h>
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "gtest/gtest.h"
 
@@ -62,6 +63,32 @@ TEST(snprintf, numbered_arguments) {
   TEST_OUTPUT("7 5", "%2$d %1$d", 5, 7);
 }
 
+TEST(snprintf, format_cache) {
+  // Format strings stored in read-only memory are only parsed once.
+  // Repeated calls should yield the same results.
+  for (int i = 0; i < 3; ++i) {
+    TEST_OUTPUT("a 1 b 2 c", "a %d b %d c", 1, 2);
+    TEST_OUTPUT("7 5 7", "%2$d %1$d %2$d", 5, 7);
+    TEST_OUTPUT("%[   42]%", "%%[%*d]%%", 5, 42);
+  }
+
+  // Format strings stored in writable memory may change between calls.
+  char format[16];
+  char buf[16];
+  strcpy(format, "%d-%s");
+  ASSERT_EQ(5, snprintf(buf, sizeof(buf), format, 12, "ab"));
+  ASSERT_STREQ("12-ab", buf);
+  strcpy(format, "<%s|%x>");
+  ASSERT_EQ(7, snprintf(buf, sizeof(buf), format, "ab", 0x12));
+  ASSERT_STREQ("<ab|12>", buf);
+}
+
+TEST(snprintf, trailing_percent) {
+  // Don't read past the end of the format string.
+  const char *format = "Hello%";
+  TEST_OUTPUT("Hello", format);
+}
+
 TEST(snprintf, hex_left) {
   TEST_OUTPUT("0x0000001337        ", "%-#20.10x", 0x1337);
 }
@@ -142,11 +169,11 @@ TEST(snprintf, float10_e_pi) {
   TEST_OUTPUT("3.14159265e+00", "%.8e", M_PI);
 
 #if DBL_MANT_DIG == 53
-  // This implementation already starts to return zeroes as soon as the
-  // digits uniquely correspond with the floating point value.
+  // Digits are printed until the exact value of the floating point
+  // number is reached.
   TEST_OUTPUT(
       "3."
-      "141592653589793000000000000000000000000000000000000000000000000000000000"
+      "141592653589793115997963468544185161590576171875000000000000000000000000"
       "0000000000000000000000000000e+00",
       "%.100e", M_PI);
 #else
@@ -154,6 +181,57 @@ TEST(snprintf, float10_e_pi) {
 #endif
 }
 
+TEST(snprintf, float10_g_exponential) {
+  // Trailing zeroes are removed, unless the alternative form is used.
+  TEST_OUTPUT("1e-05", "%g", 1e-5);
+  TEST_OUTPUT("1E+20", "%G", 1e20);
+  TEST_OUTPUT("1.5e+10", "%g", 1.5e10);
+  TEST_OUTPUT("1.00000e-05", "%#g", 1e-5);
+  TEST_OUTPUT("1.23457e+08", "%g", 123456789.0);
+}
+
+TEST(snprintf, float10_exact) {
+  // Digits are rounded based on the exact value of the floating point
+  // number, as opposed to its shortest representation.
+  TEST_OUTPUT("2.67", "%.2f", 2.675);
+  TEST_OUTPUT("0.1000000000000000055511151231257827021181583404541015625",
+              "%.55f", 0.1);
+  TEST_OUTPUT("5e-324", "%.0e", 5e-324);
+  TEST_OUTPUT("4.9406564584124654e-324", "%.16e", 5e-324);
+  TEST_OUTPUT(
+      "179769313486231570814527423731704356798070567525844996598917476803"
+      "157260780028538760589558632766878171540458953514382464234321326889"
+      "464182768467546703537516986049910576551282076245490090389328944075"
+      "868508455133942304583236903222948165808559332123348274797826204144"
+      "723168738177180919299881250404026184124858368",
+      "%.0f", DBL_MAX);
+
+  // Ties are rounded to even.
+  TEST_OUTPUT("0 2 2 4", "%.0f %.0f %.0f %.0f", 0.5, 1.5, 2.5, 3.5);
+  TEST_OUTPUT("0.12 0.38", "%.2f %.2f", 0.125, 0.375);
+}
+
+TEST(snprintf, float10_round) {
+  ASSERT_EQ(0, fesetround(FE_DOWNWARD));
+  TEST_OUTPUT("0.1 -0.2 2 -3", "%.1f %.1f %.0f %.0f", 0.15, -0.15, 2.5,
+              -2.5);
+  TEST_OUTPUT("0.0 -0.1", "%.1f %.1f", 1e-300, -1e-300);
+  ASSERT_EQ(0, fesetround(FE_TONEAREST));
+  TEST_OUTPUT("0.1 -0.1 2 -2", "%.1f %.1f %.0f %.0f", 0.15, -0.15, 2.5,
+              -2.5);
+  TEST_OUTPUT("0.0 -0.0", "%.1f %.1f", 1e-300, -1e-300);
+  ASSERT_EQ(0, fesetround(FE_TOWARDZERO));
+  TEST_OUTPUT("0.1 -0.1 2 -2", "%.1f %.1f %.0f %.0f", 0.15, -0.15, 2.5,
+              -2.5);
+  TEST_OUTPUT("0.0 -0.0", "%.1f %.1f", 1e-300, -1e-300);
+  ASSERT_EQ(0, fesetround(FE_UPWARD));
+  TEST_OUTPUT("0.2 -0.1 3 -2", "%.1f %.1f %.0f %.0f", 0.15, -0.15, 2.5,
+              -2.5);
+  TEST_OUTPUT("0.1 -0.0", "%.1f %.1f", 1e-300, -1e-300);
+  TEST_OUTPUT("1.00000000000000003e-300", "%.17e", 1e-300);
+  ASSERT_EQ(0, fesetround(FE_TONEAREST));
+}
+
 TEST(snprintf, float16_nan) {
   TEST_OUTPUT("-nan      ", "%-10a", -NAN);
   TEST_OUTPUT("       NAN", "%10A", NAN);
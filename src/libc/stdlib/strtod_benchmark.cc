@@ -0,0 +1,145 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+// Throughput benchmark for strtod() and strtoll(). Every dataset is a
+// comma separated list of numbers, resembling the contents of CSV and
+// JSON files, which is parsed repeatedly by following the end pointer
+// returned by the previous call.
+
+namespace {
+
+constexpr unsigned int kNumbers = 1 << 12;
+constexpr unsigned int kIterations = 1 << 6;
+
+double now() {
+  struct timespec ts;
+  EXPECT_EQ(0, clock_gettime(CLOCK_MONOTONIC, &ts));
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Deterministic pseudo-random number generator, so that every run of
+// the benchmark parses the same numbers.
+uint32_t next(uint64_t *state) {
+  *state = *state * 6364136223846793005 + 1442695040888963407;
+  return *state >> 33;
+}
+
+// Builds a dataset by formatting numbers obtained from a generator.
+std::string make_dataset(void (*generator)(char *, size_t, uint64_t *)) {
+  uint64_t state = 0;
+  std::string dataset;
+  for (unsigned int i = 0; i < kNumbers; ++i) {
+    char buf[64];
+    generator(buf, sizeof(buf), &state);
+    dataset += buf;
+    dataset += ',';
+  }
+  return dataset;
+}
+
+// Prices with two digits after the radix character.
+void make_price(char *buf, size_t len, uint64_t *state) {
+  unsigned int units = next(state) % 1000;
+  snprintf(buf, len, "%u.%02u", units, next(state) % 100);
+}
+
+// Geographic coordinates, as found in GeoJSON files.
+void make_coordinate(char *buf, size_t len, uint64_t *state) {
+  snprintf(buf, len, "%.7f", next(state) / 2147483648.0 * 360.0 - 180.0);
+}
+
+// Measurements in scientific notation.
+void make_measurement(char *buf, size_t len, uint64_t *state) {
+  double scale = next(state) % 2 == 0 ? 1e30 : 1e-30;
+  snprintf(buf, len, "%.9e", next(state) / 2147483648.0 * scale);
+}
+
+// Values printed with enough digits to be reproduced exactly.
+void make_roundtrip(char *buf, size_t len, uint64_t *state) {
+  double divisor = next(state) | 1;
+  snprintf(buf, len, "%.17g", next(state) / divisor);
+}
+
+// Values having more significant digits than fit in a 64-bit integer.
+void make_long(char *buf, size_t len, uint64_t *state) {
+  snprintf(buf, len, "%.25f", next(state) / 2147483648.0);
+}
+
+// Small counters.
+void make_counter(char *buf, size_t len, uint64_t *state) {
+  snprintf(buf, len, "%u", next(state) % 1000);
+}
+
+// UNIX timestamps.
+void make_timestamp(char *buf, size_t len, uint64_t *state) {
+  snprintf(buf, len, "%u", 1500000000 + next(state) % 100000000);
+}
+
+// 64-bit identifiers.
+void make_identifier(char *buf, size_t len, uint64_t *state) {
+  long long upper = next(state);
+  snprintf(buf, len, "%lld", upper << 31 | next(state));
+}
+
+void report(const char *function, const char *name, const std::string &dataset,
+            double elapsed) {
+  printf("%-8s %-12s %8.1f ns/number %8.1f MB/s\n", function, name,
+         elapsed / kIterations / kNumbers * 1e9,
+         dataset.size() * kIterations / elapsed * 1e-6);
+}
+
+template <typename Function>
+void benchmark(const char *function, const char *name,
+               const std::string &dataset, Function function_call) {
+  double begin = now();
+  for (unsigned int i = 0; i < kIterations; ++i) {
+    const char *str = dataset.c_str();
+    for (unsigned int j = 0; j < kNumbers; ++j) {
+      char *endptr;
+      function_call(str, &endptr);
+      ASSERT_EQ(',', *endptr);
+      str = endptr + 1;
+    }
+  }
+  report(function, name, dataset, now() - begin);
+}
+
+void benchmark_strtod(const char *name, const std::string &dataset) {
+  benchmark("strtod", name, dataset, [](const char *str, char **endptr) {
+    volatile double value = strtod(str, endptr);
+    (void)value;
+  });
+}
+
+void benchmark_strtoll(const char *name, const std::string &dataset) {
+  benchmark("strtoll", name, dataset, [](const char *str, char **endptr) {
+    volatile long long value = strtoll(str, endptr, 10);
+    (void)value;
+  });
+}
+
+}  // namespace
+
+TEST(strtod, throughput) {
+  benchmark_strtod("prices", make_dataset(make_price));
+  benchmark_strtod("coordinates", make_dataset(make_coordinate));
+  benchmark_strtod("measurements", make_dataset(make_measurement));
+  benchmark_strtod("roundtrip", make_dataset(make_roundtrip));
+  benchmark_strtod("long", make_dataset(make_long));
+}
+
+TEST(strtoll, throughput) {
+  benchmark_strtoll("counters", make_dataset(make_counter));
+  benchmark_strtoll("timestamps", make_dataset(make_timestamp));
+  benchmark_strtoll("identifiers", make_dataset(make_identifier));
+}
@@ -5,10 +5,66 @@
 #include <errno.h>
 #include <fenv.h>
 #include <float.h>
+#include <math.h>
 #include <stdlib.h>
 
 #include "gtest/gtest.h"
 
+TEST(strtod, dec1) {
+  // Numbers with few significant digits.
+  const char *str = "-122.4194155,";
+  char *endptr;
+  ASSERT_EQ(-122.4194155, strtod(str, &endptr));
+  ASSERT_EQ(str + 12, endptr);
+  ASSERT_EQ(0.1, strtod("0.1", NULL));
+  ASSERT_EQ(0.1, strtod("0.10000000", NULL));
+  ASSERT_EQ(0.1, strtod("00000.000001e5", NULL));
+  ASSERT_EQ(1e22, strtod("1e22", NULL));
+  ASSERT_EQ(1e23, strtod("1e23", NULL));
+  ASSERT_EQ(6.02214076e23, strtod("6.02214076e23", NULL));
+  ASSERT_EQ(1.602176634e-19, strtod("1.602176634e-19", NULL));
+  ASSERT_EQ(123456789012345678.0, strtod("123456789012345678", NULL));
+
+  // Numbers with nineteen and twenty significant digits.
+  ASSERT_EQ(9223372036854775807.0, strtod("9223372036854775807", NULL));
+  ASSERT_EQ(18446744073709551615.0, strtod("18446744073709551615", NULL));
+}
+
+TEST(strtod, dec2) {
+#if DBL_MANT_DIG == 53
+  // Values halfway between two floating point numbers round to even.
+  ASSERT_EQ(9007199254740992.0, strtod("9007199254740993", NULL));
+  ASSERT_EQ(9007199254740996.0, strtod("9007199254740995", NULL));
+  ASSERT_EQ(0x1.0000000000001p+0, strtod("1.0000000000000002220446", NULL));
+
+  // Largest finite value and overflows.
+  errno = 0;
+  ASSERT_EQ(DBL_MAX, strtod("1.7976931348623157e308", NULL));
+  ASSERT_EQ(DBL_MAX, strtod("1.7976931348623158e308", NULL));
+  ASSERT_EQ(0, errno);
+  ASSERT_EQ(HUGE_VAL, strtod("1.7976931348623159e308", NULL));
+  ASSERT_EQ(ERANGE, errno);
+  errno = 0;
+  ASSERT_EQ(HUGE_VAL, strtod("1e309", NULL));
+  ASSERT_EQ(ERANGE, errno);
+
+  // Smallest subnormal value and underflows.
+  errno = 0;
+  ASSERT_EQ(DBL_MIN, strtod("2.2250738585072014e-308", NULL));
+  ASSERT_EQ(0x0.fffffffffffffp-1022, strtod("2.225073858507201e-308", NULL));
+  ASSERT_EQ(DBL_TRUE_MIN, strtod("4.9406564584124654e-324", NULL));
+  ASSERT_EQ(DBL_TRUE_MIN, strtod("2.4703282292062328e-324", NULL));
+  ASSERT_EQ(0, errno);
+  ASSERT_EQ(0.0, strtod("2.4703282292062327e-324", NULL));
+  ASSERT_EQ(ERANGE, errno);
+  errno = 0;
+  ASSERT_EQ(0.0, strtod("1e-400", NULL));
+  ASSERT_EQ(ERANGE, errno);
+#else
+#error "Unknown floating point type"
+#endif
+}
+
 TEST(strtod, hex1) {
   const char *below = "-0x0.ffffffffffffffffffffffffffffffffffffffffffffffffff";
   const char *exact = "-0x1.0";
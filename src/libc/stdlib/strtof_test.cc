@@ -50,6 +50,32 @@ TEST(strtof, dec3) {
   freelocale(locale);
 }
 
+TEST(strtof, dec4) {
+#if FLT_MANT_DIG == 24
+  // Values halfway between two floating point numbers round to even.
+  ASSERT_EQ(16777216.0f, strtof("16777217", NULL));
+  ASSERT_EQ(16777220.0f, strtof("16777219", NULL));
+  ASSERT_EQ(0.1f, strtof("0.1", NULL));
+  ASSERT_EQ(3.14159265f, strtof("3.14159265", NULL));
+
+  // Largest finite value and overflows.
+  errno = 0;
+  ASSERT_EQ(FLT_MAX, strtof("3.4028235e38", NULL));
+  ASSERT_EQ(0, errno);
+  ASSERT_EQ(HUGE_VALF, strtof("3.4028236e38", NULL));
+  ASSERT_EQ(ERANGE, errno);
+
+  // Smallest subnormal value.
+  errno = 0;
+  ASSERT_EQ(FLT_TRUE_MIN, strtof("1.40129846e-45", NULL));
+  ASSERT_EQ(0, errno);
+  ASSERT_EQ(0.0f, strtof("7.0064923e-46", NULL));
+  ASSERT_EQ(ERANGE, errno);
+#else
+#error "Unknown floating point type"
+#endif
+}
+
 TEST(strtof, hex1) {
   // We should preserve all 24 bits of the significand.
   const char *str = "  0xcaf.eff";
@@ -49,3 +49,41 @@ TEST(strtoll, negative) {
   ASSERT_EQ(str + 19, endptr);
   ASSERT_EQ(ERANGE, errno);
 }
+
+TEST(strtoll, decimal) {
+  const char *str;
+  char *endptr;
+
+  // Long runs of decimal digits, which are converted in groups.
+  str = "1234567890123456789x";
+  errno = 0;
+  ASSERT_EQ(1234567890123456789, strtoll(str, &endptr, 10));
+  ASSERT_EQ(str + 19, endptr);
+  ASSERT_EQ(0, errno);
+
+  str = "-000000000000000000000000000000042";
+  ASSERT_EQ(-42, strtoll(str, &endptr, 10));
+  ASSERT_EQ(str + 34, endptr);
+  ASSERT_EQ(0, errno);
+
+  str = "9223372036854775807";
+  ASSERT_EQ(LLONG_MAX, strtoll(str, &endptr, 10));
+  ASSERT_EQ(str + 19, endptr);
+  ASSERT_EQ(0, errno);
+
+  str = "-9223372036854775808";
+  ASSERT_EQ(LLONG_MIN, strtoll(str, &endptr, 10));
+  ASSERT_EQ(str + 20, endptr);
+  ASSERT_EQ(0, errno);
+
+  str = "9223372036854775808";
+  ASSERT_EQ(LLONG_MAX, strtoll(str, &endptr, 10));
+  ASSERT_EQ(str + 19, endptr);
+  ASSERT_EQ(ERANGE, errno);
+
+  str = "-12345678901234567890123456789";
+  errno = 0;
+  ASSERT_EQ(LLONG_MIN, strtoll(str, &endptr, 10));
+  ASSERT_EQ(str + 30, endptr);
+  ASSERT_EQ(ERANGE, errno);
+}
@@ -55,3 +55,32 @@ TEST(strtoull, negative) {
   ASSERT_EQ(str + 2, endptr);
   ASSERT_EQ(ERANGE, errno);
 }
+
+TEST(strtoull, decimal) {
+  const char *str;
+  char *endptr;
+
+  // Long runs of decimal digits, which are converted in groups.
+  str = "18446744073709551615";
+  errno = 0;
+  ASSERT_EQ(ULLONG_MAX, strtoull(str, &endptr, 10));
+  ASSERT_EQ(str + 20, endptr);
+  ASSERT_EQ(0, errno);
+
+  str = "18446744073709551616";
+  ASSERT_EQ(ULLONG_MAX, strtoull(str, &endptr, 10));
+  ASSERT_EQ(str + 20, endptr);
+  ASSERT_EQ(ERANGE, errno);
+
+  str = "-12345678";
+  errno = 0;
+  ASSERT_EQ(ULLONG_MAX, strtoull(str, &endptr, 10));
+  ASSERT_EQ(str + 9, endptr);
+  ASSERT_EQ(ERANGE, errno);
+
+  str = "1234567812345678:";
+  errno = 0;
+  ASSERT_EQ(1234567812345678, strtoull(str, &endptr, 10));
+  ASSERT_EQ(str + 16, endptr);
+  ASSERT_EQ(0, errno);
+}
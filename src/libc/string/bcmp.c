@@ -0,0 +1,58 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <stdint.h>
+#include <string.h>
+
+#include "string_impl.h"
+
+// bcmp() has been removed from POSIX and is therefore not declared.
+// Compilers may still emit calls to it when the result of memcmp() is
+// only compared against zero. As it only needs to test for equality, it
+// can be implemented without locating the differing byte.
+int bcmp(const void *, const void *, size_t);
+
+int bcmp(const void *s1, const void *s2, size_t n) {
+  const unsigned char *sb1 = (const unsigned char *)s1;
+  const unsigned char *sb2 = (const unsigned char *)s2;
+
+  if (n >= BYTEVEC_SIZE) {
+    // Compare using vectors. The last vector may overlap with the one
+    // before it, so that there is no need to process a remainder.
+    const unsigned char *lb1 = sb1 + n - BYTEVEC_SIZE;
+    const unsigned char *lb2 = sb2 + n - BYTEVEC_SIZE;
+    while (sb1 < lb1) {
+      if (bytevec_mask(bytevec_eq(bytevec_loadu(sb1), bytevec_loadu(sb2))) !=
+          bytemask_all())
+        return 1;
+      sb1 += BYTEVEC_SIZE;
+      sb2 += BYTEVEC_SIZE;
+    }
+    return bytevec_mask(bytevec_eq(bytevec_loadu(lb1), bytevec_loadu(lb2))) !=
+           bytemask_all();
+  } else if (n >= 2 * sizeof(uint64_t)) {
+    return ((load_u64(sb1) ^ load_u64(sb2)) |
+            (load_u64(sb1 + sizeof(uint64_t)) ^
+             load_u64(sb2 + sizeof(uint64_t))) |
+            (load_u64(sb1 + n - 2 * sizeof(uint64_t)) ^
+             load_u64(sb2 + n - 2 * sizeof(uint64_t))) |
+            (load_u64(sb1 + n - sizeof(uint64_t)) ^
+             load_u64(sb2 + n - sizeof(uint64_t)))) != 0;
+  } else if (n >= sizeof(uint64_t)) {
+    return ((load_u64(sb1) ^ load_u64(sb2)) |
+            (load_u64(sb1 + n - sizeof(uint64_t)) ^
+             load_u64(sb2 + n - sizeof(uint64_t)))) != 0;
+  } else if (n >= sizeof(uint32_t)) {
+    return ((load_u32(sb1) ^ load_u32(sb2)) |
+            (load_u32(sb1 + n - sizeof(uint32_t)) ^
+             load_u32(sb2 + n - sizeof(uint32_t)))) != 0;
+  } else if (n >= sizeof(uint16_t)) {
+    return ((load_u16(sb1) ^ load_u16(sb2)) |
+            (load_u16(sb1 + n - sizeof(uint16_t)) ^
+             load_u16(sb2 + n - sizeof(uint16_t)))) != 0;
+  } else if (n > 0) {
+    return *sb1 != *sb2;
+  }
+  return 0;
+}
@@ -0,0 +1,35 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <stddef.h>
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+// Not declared in any header.
+extern "C" int bcmp(const void *, const void *, size_t);
+
+TEST(bcmp, null) {
+  ASSERT_EQ(0, bcmp(NULL, NULL, 0));
+}
+
+TEST(bcmp, alignments) {
+  alignas(64) unsigned char buf1[192];
+  alignas(64) unsigned char buf2[192];
+  for (size_t start1 = 0; start1 < 32; start1 += 3) {
+    for (size_t start2 = 0; start2 < 32; start2 += 5) {
+      for (size_t len = 0; len < 128; ++len) {
+        memset(buf1, 'A', sizeof(buf1));
+        memset(buf2, 'A', sizeof(buf2));
+        buf1[start1 + len] = 'B';
+        ASSERT_EQ(0, bcmp(buf1 + start1, buf2 + start2, len));
+        for (size_t i = 0; i < len; ++i) {
+          buf1[start1 + i] = 'B';
+          ASSERT_NE(0, bcmp(buf1 + start1, buf2 + start2, len));
+          buf1[start1 + i] = 'A';
+        }
+      }
+    }
+  }
+}
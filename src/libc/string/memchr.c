@@ -4,12 +4,30 @@
 
 #include <string.h>
 
+#include "string_impl.h"
+
 void *(memchr)(const void *s, int c, size_t n) {
+  if (n == 0)
+    return NULL;
+
+  // Start off with the vector containing the first byte, ignoring any
+  // bytes in front of the buffer.
   const unsigned char *sb = s;
-  while (n-- > 0) {
-    if (*sb == (unsigned char)c)
-      return (void *)sb;
-    ++sb;
+  const unsigned char *block = bytevec_align(sb);
+  bytevec_t needle = bytevec_splat(c);
+  bytemask_t m = bytevec_mask(bytevec_eq(bytevec_load(block), needle)) &
+                 bytemask_from(sb - block);
+  size_t scanned = BYTEVEC_SIZE - (sb - block);
+  for (;;) {
+    if (m != 0) {
+      // Matches past the end of the buffer should be discarded.
+      const unsigned char *match = block + bytemask_first(m);
+      return (size_t)(match - sb) < n ? (void *)match : NULL;
+    }
+    if (scanned >= n)
+      return NULL;
+    block += BYTEVEC_SIZE;
+    m = bytevec_mask(bytevec_eq(bytevec_load(block), needle));
+    scanned += BYTEVEC_SIZE;
   }
-  return NULL;
 }
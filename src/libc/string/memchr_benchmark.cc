@@ -0,0 +1,84 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <functional>
+
+#include "gtest/gtest.h"
+
+// Throughput benchmarks for the byte searching functions. Every
+// function is invoked on buffers of varying sizes and alignments, where
+// the character being searched for is only present at the very end.
+
+namespace {
+
+constexpr size_t kBufferSize = 1 << 16;
+constexpr size_t kBytesPerRun = 1 << 26;
+
+double now() {
+  struct timespec ts;
+  EXPECT_EQ(0, clock_gettime(CLOCK_MONOTONIC, &ts));
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void benchmark(const char *name,
+               const std::function<const void *(const char *, size_t)> &fn,
+               bool match_at_start) {
+  char *buf = static_cast<char *>(aligned_alloc(64, kBufferSize + 64));
+  ASSERT_NE(nullptr, buf);
+  for (size_t size = 1; size <= kBufferSize; size *= 4) {
+    for (size_t align = 0; align < 64; align += 17) {
+      char *start = buf + align;
+      memset(buf, 'a', kBufferSize + 64);
+      start[match_at_start ? 0 : size - 1] = 'b';
+      start[size] = '\0';
+
+      size_t iterations = kBytesPerRun / size;
+      double begin = now();
+      for (size_t i = 0; i < iterations; ++i) {
+        const void *match = fn(start, size);
+        asm volatile("" : : "r"(match) : "memory");
+      }
+      double elapsed = now() - begin;
+      printf("%-10s size=%6zu align=%2zu %10.1f MB/s\n", name, size, align,
+             iterations * size / elapsed / 1e6);
+    }
+  }
+  free(buf);
+}
+
+}  // namespace
+
+TEST(memchr, throughput) {
+  benchmark("memchr",
+            [](const char *s, size_t n) { return memchr(s, 'b', n); },
+            false);
+}
+
+TEST(memrchr, throughput) {
+  benchmark("memrchr",
+            [](const char *s, size_t n) { return memrchr(s, 'b', n); },
+            true);
+}
+
+TEST(rawmemchr, throughput) {
+  benchmark("rawmemchr",
+            [](const char *s, size_t n) { return rawmemchr(s, 'b'); },
+            false);
+}
+
+TEST(strchr, throughput) {
+  benchmark("strchr",
+            [](const char *s, size_t n) { return strchr(s, 'b'); }, false);
+}
+
+TEST(strrchr, throughput) {
+  benchmark("strrchr",
+            [](const char *s, size_t n) { return strrchr(s, 'b'); }, true);
+}
@@ -19,3 +19,26 @@ TEST(memchr, nomatch) {
   char buf[] = "Foo bar baz";
   ASSERT_EQ(NULL, memchr(buf, 'x', sizeof(buf)));
 }
+
+TEST(memchr, alignments) {
+  // Test all combinations of starting alignments, buffer lengths and
+  // positions of the character, including positions right past the
+  // end of the buffer that must be ignored.
+  alignas(64) char buf[192];
+  for (size_t start = 0; start < 64; ++start) {
+    for (size_t len = 0; len < 96; ++len) {
+      memset(buf, 'a', sizeof(buf));
+      buf[start + len] = 'b';
+      ASSERT_EQ(NULL, memchr(buf + start, 'b', len));
+      if (start > 0) {
+        buf[start - 1] = 'b';
+        ASSERT_EQ(NULL, memchr(buf + start, 'b', len));
+      }
+      for (size_t i = 0; i < len; ++i) {
+        buf[start + i] = 'b';
+        ASSERT_EQ(buf + start + i, memchr(buf + start, 'b', len));
+        buf[start + i] = 'a';
+      }
+    }
+  }
+}
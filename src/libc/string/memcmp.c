@@ -2,6 +2,7 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <stdint.h>
 #include <string.h>
 
 #include "string_impl.h"
@@ -10,31 +11,54 @@ int memcmp(const void *s1, const void *s2, size_t n) {
   const unsigned char *sb1 = (const unsigned char *)s1;
   const unsigned char *sb2 = (const unsigned char *)s2;
 
-  // Special case: both buffers start within the same byte of a long.
-  // This allows us to compare multiple characters at a time.
-  if (n >= LONG_STRING_SIZE && is_long_aligned_equally(sb1, sb2)) {
-    // Do bytewise comparison until the buffers are aligned to long.
-    while (!is_long_aligned(sb1)) {
-      unsigned char c1 = *sb1++;
-      unsigned char c2 = *sb2++;
-      if (c1 != c2)
-        return (int)c1 - (int)c2;
-      --n;
+  if (n >= BYTEVEC_SIZE) {
+    // Compare using vectors. The last vector may overlap with the one
+    // before it, so that there is no need to process a remainder.
+    const unsigned char *lb1 = sb1 + n - BYTEVEC_SIZE;
+    const unsigned char *lb2 = sb2 + n - BYTEVEC_SIZE;
+    bytemask_t m;
+    for (;;) {
+      if (sb1 >= lb1) {
+        sb1 = lb1;
+        sb2 = lb2;
+      }
+      m = bytevec_mask(bytevec_eq(bytevec_loadu(sb1), bytevec_loadu(sb2))) ^
+          bytemask_all();
+      if (m != 0)
+        break;
+      if (sb1 == lb1)
+        return 0;
+      sb1 += BYTEVEC_SIZE;
+      sb2 += BYTEVEC_SIZE;
     }
+    size_t i = bytemask_first(m);
+    return (int)sb1[i] - (int)sb2[i];
+  }
 
-    // Compare using longs.
-    const unsigned long *sl1 = (const unsigned long *)sb1;
-    const unsigned long *sl2 = (const unsigned long *)sb2;
-    while (n >= sizeof(unsigned long) && *sl1 == *sl2) {
-      ++sl1;
-      ++sl2;
-      n -= sizeof(unsigned long);
+  if (n >= sizeof(uint64_t)) {
+    // Compare eight bytes at a time. The last eight bytes may overlap
+    // with the ones before them.
+    const unsigned char *lb1 = sb1 + n - sizeof(uint64_t);
+    const unsigned char *lb2 = sb2 + n - sizeof(uint64_t);
+    while (sb1 < lb1 && load_u64(sb1) == load_u64(sb2)) {
+      sb1 += sizeof(uint64_t);
+      sb2 += sizeof(uint64_t);
+    }
+    if (sb1 >= lb1) {
+      if (load_u64(lb1) == load_u64(lb2))
+        return 0;
+      sb1 = lb1;
+      sb2 = lb2;
+    }
+    // Locate the differing byte.
+    while (*sb1 == *sb2) {
+      ++sb1;
+      ++sb2;
     }
-    sb1 = (const unsigned char *)sl1;
-    sb2 = (const unsigned char *)sl2;
+    return (int)*sb1 - (int)*sb2;
   }
 
-  // Do bytewise comparison for remainder or unaligned buffers.
+  // Do bytewise comparison for tiny buffers.
   while (n-- > 0) {
     unsigned char c1 = *sb1++;
     unsigned char c2 = *sb2++;
@@ -17,3 +17,27 @@ TEST(memcmp, example) {
   ASSERT_GT(0, memcmp(buf1, buf2, sizeof(buf1)));
   ASSERT_LT(0, memcmp(buf2, buf1, sizeof(buf1)));
 }
+
+TEST(memcmp, alignments) {
+  // Buffers that are not aligned equally, differing at every possible
+  // position. The byte following the buffers differs as well, which
+  // should be ignored.
+  alignas(64) unsigned char buf1[192];
+  alignas(64) unsigned char buf2[192];
+  for (size_t start1 = 0; start1 < 32; start1 += 3) {
+    for (size_t start2 = 0; start2 < 32; start2 += 5) {
+      for (size_t len = 0; len < 128; ++len) {
+        memset(buf1, 'A', sizeof(buf1));
+        memset(buf2, 'A', sizeof(buf2));
+        buf1[start1 + len] = 'B';
+        ASSERT_EQ(0, memcmp(buf1 + start1, buf2 + start2, len));
+        for (size_t i = 0; i < len; ++i) {
+          buf1[start1 + i] = 0x80;
+          ASSERT_LT(0, memcmp(buf1 + start1, buf2 + start2, len));
+          ASSERT_GT(0, memcmp(buf2 + start2, buf1 + start1, len));
+          buf1[start1 + i] = 'A';
+        }
+      }
+    }
+  }
+}
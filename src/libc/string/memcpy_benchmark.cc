@@ -0,0 +1,188 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <functional>
+
+#include "gtest/gtest.h"
+
+// Throughput benchmarks for memcpy(), memmove(), memset() and memcmp(),
+// comparing them against the word-at-a-time implementations that were
+// used previously.
+
+namespace {
+
+namespace reference {
+
+bool is_long_aligned(const void *p) {
+  return (uintptr_t)p % sizeof(unsigned long) == 0;
+}
+
+bool is_long_aligned_equally(const void *a, const void *b) {
+  return (uintptr_t)a % sizeof(unsigned long) ==
+         (uintptr_t)b % sizeof(unsigned long);
+}
+
+void *memmove(void *s1, const void *s2, size_t n) {
+  unsigned char *sb1 = static_cast<unsigned char *>(s1);
+  const unsigned char *sb2 = static_cast<const unsigned char *>(s2);
+  if (sb1 < sb2) {
+    if (n >= 4 * sizeof(unsigned long) && is_long_aligned_equally(sb1, sb2)) {
+      while (!is_long_aligned(sb1)) {
+        *sb1++ = *sb2++;
+        --n;
+      }
+      unsigned long *sl1 = reinterpret_cast<unsigned long *>(sb1);
+      const unsigned long *sl2 = reinterpret_cast<const unsigned long *>(sb2);
+      do {
+        *sl1++ = *sl2++;
+        n -= sizeof(unsigned long);
+      } while (n >= sizeof(unsigned long));
+      sb1 = reinterpret_cast<unsigned char *>(sl1);
+      sb2 = reinterpret_cast<const unsigned char *>(sl2);
+    }
+    while (n-- > 0)
+      *sb1++ = *sb2++;
+  } else if (sb1 > sb2) {
+    // Not exercised by the benchmarks below.
+    sb1 += n;
+    sb2 += n;
+    while (n-- > 0)
+      *--sb1 = *--sb2;
+  }
+  return s1;
+}
+
+void *memset(void *s, int c, size_t n) {
+  char *sb = static_cast<char *>(s);
+  if (n >= 4 * sizeof(unsigned long)) {
+    while (!is_long_aligned(sb)) {
+      *sb++ = c;
+      --n;
+    }
+    unsigned long cl = (unsigned char)c * (~0UL / 0xff);
+    unsigned long *sl = reinterpret_cast<unsigned long *>(sb);
+    do {
+      *sl++ = cl;
+      n -= sizeof(unsigned long);
+    } while (n >= sizeof(unsigned long));
+    sb = reinterpret_cast<char *>(sl);
+  }
+  while (n-- > 0)
+    *sb++ = c;
+  return s;
+}
+
+int memcmp(const void *s1, const void *s2, size_t n) {
+  const unsigned char *sb1 = static_cast<const unsigned char *>(s1);
+  const unsigned char *sb2 = static_cast<const unsigned char *>(s2);
+  if (n >= 4 * sizeof(unsigned long) && is_long_aligned_equally(sb1, sb2)) {
+    while (!is_long_aligned(sb1)) {
+      unsigned char c1 = *sb1++;
+      unsigned char c2 = *sb2++;
+      if (c1 != c2)
+        return (int)c1 - (int)c2;
+      --n;
+    }
+    const unsigned long *sl1 = reinterpret_cast<const unsigned long *>(sb1);
+    const unsigned long *sl2 = reinterpret_cast<const unsigned long *>(sb2);
+    while (n >= sizeof(unsigned long) && *sl1 == *sl2) {
+      ++sl1;
+      ++sl2;
+      n -= sizeof(unsigned long);
+    }
+    sb1 = reinterpret_cast<const unsigned char *>(sl1);
+    sb2 = reinterpret_cast<const unsigned char *>(sl2);
+  }
+  while (n-- > 0) {
+    unsigned char c1 = *sb1++;
+    unsigned char c2 = *sb2++;
+    if (c1 != c2)
+      return (int)c1 - (int)c2;
+  }
+  return 0;
+}
+
+}  // namespace reference
+
+constexpr size_t kMaxSize = 1 << 23;
+constexpr size_t kBytesPerRun = 1 << 26;
+
+double now() {
+  struct timespec ts;
+  EXPECT_EQ(0, clock_gettime(CLOCK_MONOTONIC, &ts));
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Invokes a function on buffers of varying sizes, where the source and
+// destination buffers are either aligned equally or not.
+void benchmark(const char *name,
+               const std::function<void(char *, const char *, size_t)> &fn) {
+  char *dst = static_cast<char *>(aligned_alloc(64, kMaxSize + 64));
+  char *src = static_cast<char *>(aligned_alloc(64, kMaxSize + 64));
+  ASSERT_NE(nullptr, dst);
+  ASSERT_NE(nullptr, src);
+  memset(dst, 'A', kMaxSize + 64);
+  memset(src, 'A', kMaxSize + 64);
+  for (size_t size = 1; size <= kMaxSize; size *= 2) {
+    for (size_t skew : {0, 3}) {
+      size_t iterations = kBytesPerRun / size;
+      if (iterations > 1 << 20)
+        iterations = 1 << 20;
+      double begin = now();
+      for (size_t i = 0; i < iterations; ++i) {
+        fn(dst + skew, src, size);
+        asm volatile("" : : "r"(dst) : "memory");
+      }
+      double elapsed = now() - begin;
+      printf("%-18s size=%8zu skew=%zu %10.1f MB/s\n", name, size, skew,
+             iterations * size / elapsed / 1e6);
+    }
+  }
+  free(dst);
+  free(src);
+}
+
+}  // namespace
+
+TEST(memcpy, throughput) {
+  benchmark("memcpy", [](char *dst, const char *src, size_t n) {
+    memcpy(dst, src, n);
+  });
+  benchmark("reference::memcpy", [](char *dst, const char *src, size_t n) {
+    reference::memmove(dst, src, n);
+  });
+}
+
+TEST(memmove, throughput) {
+  benchmark("memmove", [](char *dst, const char *src, size_t n) {
+    memmove(dst, dst + 1, n);
+  });
+  benchmark("reference::memmove", [](char *dst, const char *src, size_t n) {
+    reference::memmove(dst, dst + 1, n);
+  });
+}
+
+TEST(memset, throughput) {
+  benchmark("memset", [](char *dst, const char *src, size_t n) {
+    memset(dst, 'A', n);
+  });
+  benchmark("reference::memset", [](char *dst, const char *src, size_t n) {
+    reference::memset(dst, 'A', n);
+  });
+}
+
+TEST(memcmp, throughput) {
+  benchmark("memcmp", [](char *dst, const char *src, size_t n) {
+    ASSERT_EQ(0, memcmp(dst, src, n));
+  });
+  benchmark("reference::memcmp", [](char *dst, const char *src, size_t n) {
+    ASSERT_EQ(0, reference::memcmp(dst, src, n));
+  });
+}
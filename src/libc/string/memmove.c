@@ -2,6 +2,7 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <stdint.h>
 #include <string.h>
 
 #include "string_impl.h"
@@ -9,58 +10,88 @@
 void *memmove(void *s1, const void *s2, size_t n) {
   unsigned char *sb1 = s1;
   const unsigned char *sb2 = s2;
-  if (sb1 < sb2) {
-    // Special case: both buffers start within the same byte of a long.
-    // This allows us to copy multiple bytes at a time.
-    if (n >= LONG_STRING_SIZE && is_long_aligned_equally(sb1, sb2)) {
-      // Do bytewise copying until the buffers are aligned to long.
-      while (!is_long_aligned(sb1)) {
-        *sb1++ = *sb2++;
-        --n;
-      }
 
-      // Copy using longs.
-      unsigned long *sl1 = (unsigned long *)sb1;
-      const unsigned long *sl2 = (const unsigned long *)sb2;
-      do {
-        *sl1++ = *sl2++;
-        n -= sizeof(unsigned long);
-      } while (n >= sizeof(unsigned long));
-      sb1 = (unsigned char *)sl1;
-      sb2 = (const unsigned char *)sl2;
+  // Small buffers: copy the buffer using two overlapping loads and
+  // stores. As all loads are performed before the stores, this is safe
+  // to use for overlapping buffers.
+  if (n <= 2 * BYTEVEC_SIZE) {
+    if (n >= BYTEVEC_SIZE) {
+      bytevec_t head = bytevec_loadu(sb2);
+      bytevec_t tail = bytevec_loadu(sb2 + n - BYTEVEC_SIZE);
+      bytevec_storeu(sb1, head);
+      bytevec_storeu(sb1 + n - BYTEVEC_SIZE, tail);
+    } else if (n >= 2 * sizeof(uint64_t)) {
+      uint64_t head1 = load_u64(sb2);
+      uint64_t head2 = load_u64(sb2 + sizeof(uint64_t));
+      uint64_t tail1 = load_u64(sb2 + n - 2 * sizeof(uint64_t));
+      uint64_t tail2 = load_u64(sb2 + n - sizeof(uint64_t));
+      store_u64(sb1, head1);
+      store_u64(sb1 + sizeof(uint64_t), head2);
+      store_u64(sb1 + n - 2 * sizeof(uint64_t), tail1);
+      store_u64(sb1 + n - sizeof(uint64_t), tail2);
+    } else if (n >= sizeof(uint64_t)) {
+      uint64_t head = load_u64(sb2);
+      uint64_t tail = load_u64(sb2 + n - sizeof(uint64_t));
+      store_u64(sb1, head);
+      store_u64(sb1 + n - sizeof(uint64_t), tail);
+    } else if (n >= sizeof(uint32_t)) {
+      uint32_t head = load_u32(sb2);
+      uint32_t tail = load_u32(sb2 + n - sizeof(uint32_t));
+      store_u32(sb1, head);
+      store_u32(sb1 + n - sizeof(uint32_t), tail);
+    } else if (n >= sizeof(uint16_t)) {
+      uint16_t head = load_u16(sb2);
+      uint16_t tail = load_u16(sb2 + n - sizeof(uint16_t));
+      store_u16(sb1, head);
+      store_u16(sb1 + n - sizeof(uint16_t), tail);
+    } else if (n > 0) {
+      *sb1 = *sb2;
     }
+    return s1;
+  }
 
-    // Do bytewise copying for remainder or unaligned buffers.
-    while (n-- > 0)
-      *sb1++ = *sb2++;
-  } else if (sb1 > sb2) {
-    sb1 += n;
-    sb2 += n;
-
-    // Special case: both buffers start within the same byte of a long.
-    // This allows us to copy multiple bytes at a time.
-    if (n >= LONG_STRING_SIZE && is_long_aligned_equally(sb1, sb2)) {
-      // Do bytewise copying until the buffers are aligned to long.
-      while (!is_long_aligned(sb1)) {
-        *--sb1 = *--sb2;
-        --n;
+  // Larger buffers: copy the buffer using a loop that performs aligned
+  // stores. The first and last vector are loaded up front and stored
+  // afterwards, as they are unaligned.
+  bytevec_t head = bytevec_loadu(sb2);
+  bytevec_t tail = bytevec_loadu(sb2 + n - BYTEVEC_SIZE);
+  unsigned char *eb1 = sb1 + n;
+  if ((uintptr_t)sb1 - (uintptr_t)sb2 >= n) {
+    // Destination lies in front of the source or does not overlap with
+    // it. Copy forward.
+    size_t skew = BYTEVEC_SIZE - (uintptr_t)sb1 % BYTEVEC_SIZE;
+    unsigned char *ab1 = sb1 + skew;
+    const unsigned char *ab2 = sb2 + skew;
+    if (n >= NONTEMPORAL_SIZE && (uintptr_t)sb2 - (uintptr_t)sb1 >= n) {
+      // Very large buffers that do not overlap. Prevent the copy from
+      // evicting the entire cache.
+      while ((size_t)(eb1 - ab1) > BYTEVEC_SIZE) {
+        bytevec_stream(ab1, bytevec_loadu(ab2));
+        ab1 += BYTEVEC_SIZE;
+        ab2 += BYTEVEC_SIZE;
+      }
+      bytevec_stream_fence();
+    } else {
+      while ((size_t)(eb1 - ab1) > BYTEVEC_SIZE) {
+        bytevec_store(ab1, bytevec_loadu(ab2));
+        ab1 += BYTEVEC_SIZE;
+        ab2 += BYTEVEC_SIZE;
       }
-
-      // Copy using longs.
-      unsigned long *sl1 = (unsigned long *)sb1;
-      const unsigned long *sl2 = (const unsigned long *)sb2;
-      do {
-        *--sl1 = *--sl2;
-        n -= sizeof(unsigned long);
-      } while (n >= sizeof(unsigned long));
-      sb1 = (unsigned char *)sl1;
-      sb2 = (const unsigned char *)sl2;
     }
-
-    // Do bytewise copying for remainder or unaligned buffers.
-    while (n-- > 0)
-      *--sb1 = *--sb2;
+  } else {
+    // Destination lies behind the source and overlaps with it. Copy
+    // backward.
+    size_t skew = (uintptr_t)eb1 % BYTEVEC_SIZE;
+    unsigned char *ab1 = eb1 - skew;
+    const unsigned char *ab2 = sb2 + n - skew;
+    while ((size_t)(ab1 - sb1) > BYTEVEC_SIZE) {
+      ab1 -= BYTEVEC_SIZE;
+      ab2 -= BYTEVEC_SIZE;
+      bytevec_store(ab1, bytevec_loadu(ab2));
+    }
   }
+  bytevec_storeu(sb1, head);
+  bytevec_storeu(eb1 - BYTEVEC_SIZE, tail);
   return s1;
 }
 
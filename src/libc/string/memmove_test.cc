@@ -21,3 +21,40 @@ TEST(memmove, example2) {
   ASSERT_EQ(buf + 4, memmove(buf + 4, buf, 8));
   ASSERT_STREQ("abcdabcdefgh", buf);
 }
+
+TEST(memmove, overlap) {
+  // Move buffers of all sizes up to a couple of vectors back and forth
+  // by small distances, which causes them to overlap.
+  alignas(64) unsigned char buf[256];
+  for (size_t len = 0; len < 160; ++len) {
+    for (size_t src = 32; src < 64; src += 3) {
+      for (size_t dst = 0; dst < 96; dst += 5) {
+        for (size_t i = 0; i < sizeof(buf); ++i)
+          buf[i] = i;
+        ASSERT_EQ(buf + dst, memmove(buf + dst, buf + src, len));
+        for (size_t i = 0; i < sizeof(buf); ++i) {
+          if (i >= dst && i < dst + len)
+            ASSERT_EQ((unsigned char)(i - dst + src), buf[i]);
+          else
+            ASSERT_EQ((unsigned char)i, buf[i]);
+        }
+      }
+    }
+  }
+}
+
+TEST(memmove, large) {
+  // Buffers large enough to make use of non-temporal stores.
+  size_t len = 5 * 1024 * 1024;
+  unsigned char *buf1 = new unsigned char[len + 1];
+  unsigned char *buf2 = new unsigned char[len + 1];
+  for (size_t i = 0; i < len; ++i)
+    buf1[i] = i % 251;
+  buf2[len] = 42;
+  ASSERT_EQ(buf2, memmove(buf2, buf1 + 1, len - 1));
+  for (size_t i = 0; i < len - 1; ++i)
+    ASSERT_EQ((i + 1) % 251, buf2[i]);
+  ASSERT_EQ(42, buf2[len]);
+  delete[] buf1;
+  delete[] buf2;
+}
@@ -4,13 +4,29 @@
 
 #include <string.h>
 
+#include "string_impl.h"
+
 void *(memrchr)(const void *s, int c, size_t n) {
+  if (n == 0)
+    return NULL;
+
+  // Start off with the vector containing the last byte, ignoring any
+  // bytes past the end of the buffer.
   const unsigned char *sb = s;
-  sb += n;
-  while (n-- > 0) {
-    --sb;
-    if (*sb == (unsigned char)c)
-      return (void *)sb;
+  const unsigned char *last = sb + n - 1;
+  const unsigned char *block = bytevec_align(last);
+  bytevec_t needle = bytevec_splat(c);
+  bytemask_t m = bytevec_mask(bytevec_eq(bytevec_load(block), needle)) &
+                 bytemask_below(last - block + 1);
+  while (block > sb) {
+    if (m != 0)
+      return (void *)(block + bytemask_last(m));
+    block -= BYTEVEC_SIZE;
+    m = bytevec_mask(bytevec_eq(bytevec_load(block), needle));
   }
-  return NULL;
+
+  // Vector containing the first byte. Ignore bytes in front of the
+  // buffer.
+  m &= bytemask_from(sb - block);
+  return m != 0 ? (void *)(block + bytemask_last(m)) : NULL;
 }
@@ -2,33 +2,62 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
-#include <limits.h>
+#include <stdint.h>
 #include <string.h>
 
 #include "string_impl.h"
 
 void *memset(void *s, int c, size_t n) {
-  char *sb = s;
-  if (n >= LONG_STRING_SIZE) {
-    // Set first bytes until buffer is aligned to unsigned long.
-    while (!is_long_aligned(sb)) {
-      *sb++ = c;
-      --n;
-    }
+  unsigned char *sb = s;
 
-    // Set multiple characters per iteration.
-    unsigned long cl = construct_chars(c);
-    unsigned long *sl = (unsigned long *)sb;
-    do {
-      *sl++ = cl;
-      n -= sizeof(unsigned long);
-    } while (n >= sizeof(unsigned long));
-    sb = (char *)sl;
+  // Small buffers: fill the buffer using two overlapping stores.
+  if (n <= 2 * BYTEVEC_SIZE) {
+    if (n >= BYTEVEC_SIZE) {
+      bytevec_t v = bytevec_splat(c);
+      bytevec_storeu(sb, v);
+      bytevec_storeu(sb + n - BYTEVEC_SIZE, v);
+    } else if (n >= sizeof(uint64_t)) {
+      uint64_t v = (unsigned char)c * UINT64_C(0x0101010101010101);
+      store_u64(sb, v);
+      if (n > 2 * sizeof(uint64_t)) {
+        store_u64(sb + sizeof(uint64_t), v);
+        store_u64(sb + n - 2 * sizeof(uint64_t), v);
+      }
+      store_u64(sb + n - sizeof(uint64_t), v);
+    } else if (n >= sizeof(uint32_t)) {
+      uint32_t v = (unsigned char)c * UINT32_C(0x01010101);
+      store_u32(sb, v);
+      store_u32(sb + n - sizeof(uint32_t), v);
+    } else if (n >= sizeof(uint16_t)) {
+      uint16_t v = (unsigned char)c * UINT16_C(0x0101);
+      store_u16(sb, v);
+      store_u16(sb + n - sizeof(uint16_t), v);
+    } else if (n > 0) {
+      *sb = c;
+    }
+    return s;
   }
 
-  // Switch back to setting individual characters for the last couple of
-  // bytes.
-  while (n-- > 0)
-    *sb++ = c;
+  // Larger buffers: fill the first and last vector using unaligned
+  // stores and everything in between using aligned stores.
+  bytevec_t v = bytevec_splat(c);
+  unsigned char *eb = sb + n;
+  unsigned char *ab = (unsigned char *)bytevec_align(sb) + BYTEVEC_SIZE;
+  bytevec_storeu(sb, v);
+  if (n >= NONTEMPORAL_SIZE) {
+    // Very large buffers. Prevent the stores from evicting the entire
+    // cache.
+    while ((size_t)(eb - ab) > BYTEVEC_SIZE) {
+      bytevec_stream(ab, v);
+      ab += BYTEVEC_SIZE;
+    }
+    bytevec_stream_fence();
+  } else {
+    while ((size_t)(eb - ab) > BYTEVEC_SIZE) {
+      bytevec_store(ab, v);
+      ab += BYTEVEC_SIZE;
+    }
+  }
+  bytevec_storeu(eb - BYTEVEC_SIZE, v);
   return s;
 }
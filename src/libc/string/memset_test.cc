@@ -27,3 +27,15 @@ TEST(memset, example_large) {
                                         "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!"
                                         "!!!!!!!!!!!!!!!!!!!!!!!!"));
 }
+
+TEST(memset, alignments) {
+  alignas(64) unsigned char buf[256];
+  for (size_t start = 0; start < 64; ++start) {
+    for (size_t len = 0; len < 160; ++len) {
+      memset(buf, 'A', sizeof(buf));
+      ASSERT_EQ(buf + start, memset(buf + start, 0xff, len));
+      for (size_t i = 0; i < sizeof(buf); ++i)
+        ASSERT_EQ(i >= start && i < start + len ? 0xff : 'A', buf[i]);
+    }
+  }
+}
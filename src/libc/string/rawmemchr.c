@@ -0,0 +1,23 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <string.h>
+
+#include "string_impl.h"
+
+void *(rawmemchr)(const void *s, int c) {
+  // Start off with the vector containing the first byte, ignoring any
+  // bytes in front of the buffer.
+  const unsigned char *block = bytevec_align(s);
+  bytevec_t needle = bytevec_splat(c);
+  bytemask_t m = bytevec_mask(bytevec_eq(bytevec_load(block), needle)) &
+                 bytemask_from((const unsigned char *)s - block);
+
+  // The caller guarantees that the character is present.
+  while (m == 0) {
+    block += BYTEVEC_SIZE;
+    m = bytevec_mask(bytevec_eq(bytevec_load(block), needle));
+  }
+  return (void *)(block + bytemask_first(m));
+}
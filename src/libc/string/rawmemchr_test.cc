@@ -0,0 +1,25 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+TEST(rawmemchr, examples) {
+  char buf[] = "Foo bar baz";
+  ASSERT_EQ(buf, rawmemchr(buf, 'F'));
+  ASSERT_EQ(buf + 5, rawmemchr(buf, 'a'));
+  ASSERT_EQ(buf + 11, rawmemchr(buf, '\0'));
+}
+
+TEST(rawmemchr, alignments) {
+  alignas(64) char buf[192];
+  for (size_t start = 0; start < 64; ++start) {
+    for (size_t len = 0; len < 128; ++len) {
+      memset(buf, 'a', sizeof(buf));
+      buf[start + len] = 'b';
+      ASSERT_EQ(buf + start + len, rawmemchr(buf + start, 'b'));
+    }
+  }
+}
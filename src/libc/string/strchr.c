@@ -5,10 +5,6 @@
 #include <string.h>
 
 char *(strchr)(const char *s, int c) {
-  for (;;) {
-    if (*s == (char)c)
-      return (char *)s;
-    if (*s++ == '\0')
-      return NULL;
-  }
+  char *match = (strchrnul)(s, c);
+  return *match == (char)c ? match : NULL;
 }
@@ -0,0 +1,27 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <string.h>
+
+#include "string_impl.h"
+
+char *(strchrnul)(const char *s, int c) {
+  // Start off with the vector containing the first byte, ignoring any
+  // bytes in front of the string.
+  const unsigned char *block = bytevec_align(s);
+  bytevec_t needle = bytevec_splat(c);
+  bytevec_t zero = bytevec_splat('\0');
+  bytevec_t v = bytevec_load(block);
+  bytemask_t m =
+      bytevec_mask(bytevec_or(bytevec_eq(v, needle), bytevec_eq(v, zero))) &
+      bytemask_from((const unsigned char *)s - block);
+
+  // Stop at the first vector containing the character or a null byte.
+  while (m == 0) {
+    block += BYTEVEC_SIZE;
+    v = bytevec_load(block);
+    m = bytevec_mask(bytevec_or(bytevec_eq(v, needle), bytevec_eq(v, zero)));
+  }
+  return (char *)block + bytemask_first(m);
+}
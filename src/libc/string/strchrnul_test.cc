@@ -0,0 +1,31 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+TEST(strchrnul, examples) {
+  const char *str = "Hello, world";
+  ASSERT_EQ(str + 12, strchrnul(str, 'A'));
+  ASSERT_EQ(str + 4, strchrnul(str, 'o'));
+  ASSERT_EQ(str + 12, strchrnul(str, '\0'));
+}
+
+TEST(strchrnul, alignments) {
+  // Place the character and the null byte at all offsets within a
+  // vector, relative to all possible starting alignments.
+  alignas(64) char buf[192];
+  for (size_t start = 0; start < 64; ++start) {
+    for (size_t len = 0; len < 128; ++len) {
+      memset(buf, 'a', sizeof(buf));
+      buf[start + len] = '\0';
+      ASSERT_EQ(buf + start + len, strchrnul(buf + start, 'b'));
+      if (len > 0) {
+        buf[start + len - 1] = 'b';
+        ASSERT_EQ(buf + start + len - 1, strchrnul(buf + start, 'b'));
+      }
+    }
+  }
+}
@@ -7,12 +7,26 @@
 
 #include <limits.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 // Cutoff for when we consider a string to be long enough that it makes
 // sense to optimize.
 #define LONG_STRING_SIZE (4 * sizeof(unsigned long))
 
+// Cutoff for when we consider a buffer to be so large that it would
+// only evict useful data from the caches when written. Buffers of this
+// size are written using non-temporal stores.
+#define NONTEMPORAL_SIZE (4 * 1024 * 1024)
+
 // Tests whether a pointer is aligned to unsigned long.
 static inline bool is_long_aligned(const void *p) {
   return ((uintptr_t)p % sizeof(unsigned long)) == 0;
@@ -42,4 +56,306 @@ static inline bool contains_nullbyte(unsigned long v) {
   return ((v - construct_chars(0x01)) & ~v & construct_chars(0x80)) != 0;
 }
 
+// Unaligned scalar loads and stores, used to handle buffers that are
+// too small to be processed using vectors.
+typedef uint16_t __attribute__((__aligned__(1), __may_alias__)) unaligned_u16;
+typedef uint32_t __attribute__((__aligned__(1), __may_alias__)) unaligned_u32;
+typedef uint64_t __attribute__((__aligned__(1), __may_alias__)) unaligned_u64;
+
+static inline uint16_t load_u16(const void *p) {
+  return *(const unaligned_u16 *)p;
+}
+
+static inline uint32_t load_u32(const void *p) {
+  return *(const unaligned_u32 *)p;
+}
+
+static inline uint64_t load_u64(const void *p) {
+  return *(const unaligned_u64 *)p;
+}
+
+static inline void store_u16(void *p, uint16_t v) {
+  *(unaligned_u16 *)p = v;
+}
+
+static inline void store_u32(void *p, uint32_t v) {
+  *(unaligned_u32 *)p = v;
+}
+
+static inline void store_u64(void *p, uint64_t v) {
+  *(unaligned_u64 *)p = v;
+}
+
+// Byte vectors.
+//
+// The functions below provide a small abstraction on top of the vector
+// instructions offered by the target, so that functions like memchr(),
+// memcmp(), memmove() and memset() can be implemented once. The
+// kernel is picked at compile time: AVX2 or SSE2 on x86, NEON on
+// aarch64. On other targets an unsigned long is used as a vector of
+// bytes.
+//
+// Comparisons return a vector with a marker in every byte position
+// that compared equal. These can be converted to a bitmask using
+// bytevec_mask(), which uses (1 << BYTEVEC_MASK_SHIFT) bits per byte.
+// The lowest bits of the mask correspond with the lowest addresses.
+//
+// Aligned loads never cross a page boundary, meaning it is safe to
+// load an entire vector, as long as at least one byte within it is part
+// of the buffer. This is the same assumption strlen() already makes.
+
+typedef uint64_t bytemask_t;
+
+#if defined(__AVX2__)
+
+typedef __m256i bytevec_t;
+#define BYTEVEC_SIZE 32
+#define BYTEVEC_MASK_SHIFT 0
+
+static inline bytevec_t bytevec_load(const void *p) {
+  return _mm256_load_si256((const bytevec_t *)p);
+}
+
+static inline bytevec_t bytevec_loadu(const void *p) {
+  return _mm256_loadu_si256((const bytevec_t *)p);
+}
+
+static inline void bytevec_store(void *p, bytevec_t v) {
+  _mm256_store_si256((bytevec_t *)p, v);
+}
+
+static inline void bytevec_storeu(void *p, bytevec_t v) {
+  _mm256_storeu_si256((bytevec_t *)p, v);
+}
+
+static inline void bytevec_stream(void *p, bytevec_t v) {
+  _mm256_stream_si256((bytevec_t *)p, v);
+}
+
+static inline void bytevec_stream_fence(void) {
+  _mm_sfence();
+}
+
+static inline bytevec_t bytevec_splat(unsigned char c) {
+  return _mm256_set1_epi8((char)c);
+}
+
+static inline bytevec_t bytevec_eq(bytevec_t a, bytevec_t b) {
+  return _mm256_cmpeq_epi8(a, b);
+}
+
+static inline bytevec_t bytevec_or(bytevec_t a, bytevec_t b) {
+  return _mm256_or_si256(a, b);
+}
+
+static inline bytemask_t bytevec_mask(bytevec_t v) {
+  return (uint32_t)_mm256_movemask_epi8(v);
+}
+
+static inline bytemask_t bytemask_all(void) {
+  return UINT32_MAX;
+}
+
+#elif defined(__SSE2__)
+
+typedef __m128i bytevec_t;
+#define BYTEVEC_SIZE 16
+#define BYTEVEC_MASK_SHIFT 0
+
+static inline bytevec_t bytevec_load(const void *p) {
+  return _mm_load_si128((const bytevec_t *)p);
+}
+
+static inline bytevec_t bytevec_loadu(const void *p) {
+  return _mm_loadu_si128((const bytevec_t *)p);
+}
+
+static inline void bytevec_store(void *p, bytevec_t v) {
+  _mm_store_si128((bytevec_t *)p, v);
+}
+
+static inline void bytevec_storeu(void *p, bytevec_t v) {
+  _mm_storeu_si128((bytevec_t *)p, v);
+}
+
+static inline void bytevec_stream(void *p, bytevec_t v) {
+  _mm_stream_si128((bytevec_t *)p, v);
+}
+
+static inline void bytevec_stream_fence(void) {
+  _mm_sfence();
+}
+
+static inline bytevec_t bytevec_splat(unsigned char c) {
+  return _mm_set1_epi8((char)c);
+}
+
+static inline bytevec_t bytevec_eq(bytevec_t a, bytevec_t b) {
+  return _mm_cmpeq_epi8(a, b);
+}
+
+static inline bytevec_t bytevec_or(bytevec_t a, bytevec_t b) {
+  return _mm_or_si128(a, b);
+}
+
+static inline bytemask_t bytevec_mask(bytevec_t v) {
+  return (uint16_t)_mm_movemask_epi8(v);
+}
+
+static inline bytemask_t bytemask_all(void) {
+  return UINT16_MAX;
+}
+
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+
+typedef uint8x16_t bytevec_t;
+#define BYTEVEC_SIZE 16
+#define BYTEVEC_MASK_SHIFT 2
+
+static inline bytevec_t bytevec_load(const void *p) {
+  return vld1q_u8(p);
+}
+
+static inline bytevec_t bytevec_loadu(const void *p) {
+  return vld1q_u8(p);
+}
+
+static inline void bytevec_store(void *p, bytevec_t v) {
+  vst1q_u8(p, v);
+}
+
+static inline void bytevec_storeu(void *p, bytevec_t v) {
+  vst1q_u8(p, v);
+}
+
+// NEON has no intrinsic for non-temporal stores. Use STNP to store
+// both halves of the vector as a pair of 64-bit registers.
+static inline void bytevec_stream(void *p, bytevec_t v) {
+  __asm__ volatile("stnp %d0, %d1, [%2]"
+                   :
+                   : "w"(vget_low_u8(v)), "w"(vget_high_u8(v)), "r"(p)
+                   : "memory");
+}
+
+// Unlike non-temporal stores on x86, STNP does not weaken the ordering
+// with respect to barriers, so no additional fence is needed before
+// other threads may observe the data.
+static inline void bytevec_stream_fence(void) {
+}
+
+static inline bytevec_t bytevec_splat(unsigned char c) {
+  return vdupq_n_u8(c);
+}
+
+static inline bytevec_t bytevec_eq(bytevec_t a, bytevec_t b) {
+  return vceqq_u8(a, b);
+}
+
+static inline bytevec_t bytevec_or(bytevec_t a, bytevec_t b) {
+  return vorrq_u8(a, b);
+}
+
+// NEON has no equivalent of PMOVMSKB. Narrow every byte to a nibble
+// instead, yielding a 64-bit mask with four bits per byte.
+static inline bytemask_t bytevec_mask(bytevec_t v) {
+  return vget_lane_u64(
+      vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(v), 4)), 0);
+}
+
+static inline bytemask_t bytemask_all(void) {
+  return UINT64_MAX;
+}
+
+#else
+
+typedef unsigned long bytevec_t;
+#define BYTEVEC_SIZE sizeof(unsigned long)
+#define BYTEVEC_MASK_SHIFT 3
+
+typedef unsigned long __attribute__((__aligned__(1), __may_alias__))
+unaligned_long;
+
+static inline bytevec_t bytevec_load(const void *p) {
+  return *(const unsigned long *)p;
+}
+
+static inline bytevec_t bytevec_loadu(const void *p) {
+  return *(const unaligned_long *)p;
+}
+
+static inline void bytevec_store(void *p, bytevec_t v) {
+  *(unsigned long *)p = v;
+}
+
+static inline void bytevec_storeu(void *p, bytevec_t v) {
+  *(unaligned_long *)p = v;
+}
+
+static inline void bytevec_stream(void *p, bytevec_t v) {
+  *(unsigned long *)p = v;
+}
+
+static inline void bytevec_stream_fence(void) {
+}
+
+static inline bytevec_t bytevec_splat(unsigned char c) {
+  return construct_chars(c);
+}
+
+// Unlike contains_nullbyte(), this computation is exact: it cannot
+// yield false positives in bytes following a null byte. It leaves the
+// top bit set in every byte that is equal.
+static inline bytevec_t bytevec_eq(bytevec_t a, bytevec_t b) {
+  unsigned long v = a ^ b;
+  unsigned long lo = construct_chars(0x7f);
+  return ~(((v & lo) + lo) | v | lo);
+}
+
+static inline bytevec_t bytevec_or(bytevec_t a, bytevec_t b) {
+  return a | b;
+}
+
+static inline bytemask_t bytevec_mask(bytevec_t v) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = LONG_BIT == 64 ? __builtin_bswap64(v) : __builtin_bswap32(v);
+#endif
+  return v;
+}
+
+static inline bytemask_t bytemask_all(void) {
+  return bytevec_mask(construct_chars(0x80));
+}
+
+#endif
+
+// Rounds a pointer down to the start of the vector containing it.
+static inline const unsigned char *bytevec_align(const void *p) {
+  return (const unsigned char *)((uintptr_t)p &
+                                 ~(uintptr_t)(BYTEVEC_SIZE - 1));
+}
+
+// Returns the index of the first and last byte set in a nonzero mask.
+static inline size_t bytemask_first(bytemask_t m) {
+  return (size_t)__builtin_ctzll(m) >> BYTEVEC_MASK_SHIFT;
+}
+
+static inline size_t bytemask_last(bytemask_t m) {
+  return (size_t)(63 - __builtin_clzll(m)) >> BYTEVEC_MASK_SHIFT;
+}
+
+// Returns a mask with all bytes set, starting at a given index.
+static inline bytemask_t bytemask_from(size_t idx) {
+  return ~(bytemask_t)0 << (idx << BYTEVEC_MASK_SHIFT);
+}
+
+// Returns a mask with all bytes set, up to but not including an index.
+static inline bytemask_t bytemask_below(size_t idx) {
+  return idx < BYTEVEC_SIZE ? ~bytemask_from(idx) : ~(bytemask_t)0;
+}
+
+// Returns the mask up to and including the first byte set in a mask.
+static inline bytemask_t bytemask_upto_first(bytemask_t m) {
+  return m ^ (m - 1);
+}
+
 #endif
@@ -4,12 +4,41 @@
 
 #include <string.h>
 
+#include "string_impl.h"
+
 char *(strrchr)(const char *s, int c) {
-  char *last = NULL;
-  for (;;) {
-    if (*s == (char)c)
-      last = (char *)s;
-    if (*s++ == '\0')
-      return last;
+  if ((char)c == '\0')
+    return (strchrnul)(s, c);
+
+  // Start off with the vector containing the first byte, ignoring any
+  // bytes in front of the string.
+  const unsigned char *block = bytevec_align(s);
+  bytevec_t needle = bytevec_splat(c);
+  bytevec_t zero = bytevec_splat('\0');
+  bytevec_t v = bytevec_load(block);
+  bytemask_t skip = bytemask_from((const unsigned char *)s - block);
+  bytemask_t m = bytevec_mask(bytevec_eq(v, needle)) & skip;
+  bytemask_t z = bytevec_mask(bytevec_eq(v, zero)) & skip;
+
+  // Keep track of the last vector containing a match until we reach
+  // the vector containing the null byte.
+  const unsigned char *last_block = NULL;
+  bytemask_t last_m = 0;
+  while (z == 0) {
+    if (m != 0) {
+      last_block = block;
+      last_m = m;
+    }
+    block += BYTEVEC_SIZE;
+    v = bytevec_load(block);
+    m = bytevec_mask(bytevec_eq(v, needle));
+    z = bytevec_mask(bytevec_eq(v, zero));
   }
+
+  // Discard matches following the null byte.
+  m &= bytemask_upto_first(z);
+  if (m != 0)
+    return (char *)block + bytemask_last(m);
+  return last_block != NULL ? (char *)last_block + bytemask_last(last_m)
+                            : NULL;
 }
@@ -12,3 +12,21 @@ TEST(strrchr, examples) {
   ASSERT_EQ(str + 8, strrchr(str, 'o'));
   ASSERT_EQ(str + 12, strrchr(str, '\0'));
 }
+
+TEST(strrchr, alignments) {
+  // Matches following the null byte should be ignored, even if they
+  // are part of the same vector.
+  alignas(64) char buf[192];
+  for (size_t start = 0; start < 64; ++start) {
+    for (size_t len = 0; len < 96; ++len) {
+      memset(buf, 'b', sizeof(buf));
+      memset(buf + start, 'a', len);
+      buf[start + len] = '\0';
+      ASSERT_EQ(NULL, strrchr(buf + start, 'b'));
+      for (size_t i = 0; i < len; ++i) {
+        buf[start + i] = 'b';
+        ASSERT_EQ(buf + start + i, strrchr(buf + start, 'b'));
+      }
+    }
+  }
+}
@@ -2,6 +2,8 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <common/itoa.h>
+
 #include <assert.h>
 #include <errno.h>
 #include <locale.h>
@@ -45,6 +47,12 @@ static const char messages[][10] = {
     [LOG_NOTICE] = "NOTICE   \0", [LOG_WARNING] = "WARNING  \0",
 };
 
+// Writes a number with a fixed number of digits.
+static char *append_number(char *buf, unsigned int value, size_t ndigits) {
+  itoa10_padded(buf + ndigits, value, ndigits);
+  return buf + ndigits;
+}
+
 void vsyslog_l(int priority, locale_t locale, const char *message, va_list ap) {
   // Save errno value, so vfprintf_l() uses the right value.
   int saved_errno = errno;
@@ -64,11 +72,37 @@ void vsyslog_l(int priority, locale_t locale, const char *message, va_list ap) {
   if (gmtime_r(&ts.tv_sec, &tm) == NULL)
     return;
 
-  // Print time of day, followed by the priority.
+  // Print time of day, followed by the priority. Timestamps with
+  // four-digit years are formatted directly, as this is done for every
+  // message logged.
   flockfile(stderr);
-  fprintf_l(stderr, locale, "%04d-%02d-%02dT%02d:%02d:%02d.%09ldZ %s ",
-            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min,
-            tm.tm_sec, ts.tv_nsec, messages[priority]);
+  if (tm.tm_year >= -1900 && tm.tm_year <= 9999 - 1900) {
+    char buf[sizeof("YYYY-MM-DDTHH:MM:SS.NNNNNNNNNZ ") + sizeof(messages[0])];
+    char *bufend = buf;
+    bufend = append_number(bufend, tm.tm_year + 1900, 4);
+    *bufend++ = '-';
+    bufend = append_number(bufend, tm.tm_mon + 1, 2);
+    *bufend++ = '-';
+    bufend = append_number(bufend, tm.tm_mday, 2);
+    *bufend++ = 'T';
+    bufend = append_number(bufend, tm.tm_hour, 2);
+    *bufend++ = ':';
+    bufend = append_number(bufend, tm.tm_min, 2);
+    *bufend++ = ':';
+    bufend = append_number(bufend, tm.tm_sec, 2);
+    *bufend++ = '.';
+    bufend = append_number(bufend, ts.tv_nsec, 9);
+    *bufend++ = 'Z';
+    *bufend++ = ' ';
+    memcpy(bufend, messages[priority], sizeof(messages[0]) - 1);
+    bufend += sizeof(messages[0]) - 1;
+    *bufend++ = ' ';
+    fwrite(buf, 1, bufend - buf, stderr);
+  } else {
+    fprintf_l(stderr, locale, "%04d-%02d-%02dT%02d:%02d:%02d.%09ldZ %s ",
+              tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour,
+              tm.tm_min, tm.tm_sec, ts.tv_nsec, messages[priority]);
+  }
 
   // Print the error message.
   errno = saved_errno;
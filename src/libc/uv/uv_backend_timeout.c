@@ -21,6 +21,12 @@ int uv_backend_timeout(const uv_loop_t *loop) {
   if (loop->__active_ref_handles_reqs == 0)
     return 0;
 
+  // Pending callbacks of writes and sends that completed without
+  // blocking need to be invoked without delay.
+  if (!__uv_writes_empty(&loop->__pending_writes) ||
+      !__uv_udp_sends_empty(&loop->__pending_udp_sends))
+    return 0;
+
   // "If there are any idle handles active, the timeout is 0."
   if (!__uv_active_idles_empty(&loop->__active_idles))
     return 0;
@@ -2,9 +2,18 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <common/uv.h>
+
 #include <uv.h>
 
 int uv_cancel(uv_req_t *req) {
-  // TODO(ed): Implement!
-  return UV_ENOSYS;
+  switch (req->type) {
+    case UV_FS:
+    case UV_GETADDRINFO:
+    case UV_GETNAMEINFO:
+    case UV_WORK:
+      return __uv_work_cancel((uv_work_t *)req);
+    default:
+      return UV_EINVAL;
+  }
 }
@@ -0,0 +1,117 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <unistd.h>
+#include <uv.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(uv_cancel, einval) {
+  uv_write_t req;
+  req.type = UV_WRITE;
+  ASSERT_EQ(UV_EINVAL, uv_cancel((uv_req_t *)&req));
+}
+
+// Writes a byte to a pipe synchronously and attempts to cancel the
+// request afterwards.
+static void cancel_fs_sync(uv_loop_t *loop) {
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  char c = 'x';
+  uv_buf_t buf = uv_buf_init(&c, 1);
+  uv_fs_t req;
+  ASSERT_EQ(1, uv_fs_write(loop, &req, fds[1], &buf, 1, -1, nullptr));
+  ASSERT_EQ(UV_EBUSY, uv_cancel((uv_req_t *)&req));
+  uv_fs_req_cleanup(&req);
+  ASSERT_EQ(0, close(fds[0]));
+  ASSERT_EQ(0, close(fds[1]));
+}
+
+TEST(uv_cancel, fs_sync) {
+  // Synchronous file system requests are never submitted to the thread
+  // pool. Canceling them should not access the thread pool, even if no
+  // work has been queued yet.
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+  cancel_fs_sync(&loop);
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
+
+namespace {
+
+struct blocker {
+  uv_sem_t started;
+  uv_sem_t release;
+};
+
+}  // namespace
+
+static void blocking_work_cb(uv_work_t *req) {
+  blocker *b = static_cast<blocker *>(req->data);
+  uv_sem_post(&b->started);
+  uv_sem_wait(&b->release);
+}
+
+static void blocking_after_work_cb(uv_work_t *req, int status) {
+  ASSERT_EQ(0, status);
+}
+
+static void canceled_work_cb(uv_work_t *req) {
+  FAIL() << "Canceled request should not be executed";
+}
+
+static void canceled_after_work_cb(uv_work_t *req, int status) {
+  ASSERT_EQ(UV_ECANCELED, status);
+  ++*static_cast<int *>(req->data);
+}
+
+TEST(uv_cancel, work) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+
+  // Keep all of the worker threads busy.
+  blocker b;
+  ASSERT_EQ(0, uv_sem_init(&b.started, 0));
+  ASSERT_EQ(0, uv_sem_init(&b.release, 0));
+  long nworkers = sysconf(_SC_NPROCESSORS_ONLN);
+  ASSERT_LT(0, nworkers);
+  std::vector<uv_work_t> blocking(nworkers);
+  for (uv_work_t &req : blocking) {
+    req.data = &b;
+    ASSERT_EQ(0, uv_queue_work(&loop, &req, blocking_work_cb,
+                               blocking_after_work_cb));
+  }
+  for (long i = 0; i < nworkers; ++i)
+    uv_sem_wait(&b.started);
+
+  // Requests that have not been picked up yet can be canceled. The
+  // after work function is then called with UV_ECANCELED.
+  int canceled = 0;
+  uv_work_t req;
+  req.data = &canceled;
+  ASSERT_EQ(0, uv_queue_work(&loop, &req, canceled_work_cb,
+                             canceled_after_work_cb));
+  ASSERT_EQ(0, uv_cancel((uv_req_t *)&req));
+  ASSERT_EQ(UV_EBUSY, uv_cancel((uv_req_t *)&req));
+
+  // Requests that are running cannot be canceled.
+  ASSERT_EQ(UV_EBUSY, uv_cancel((uv_req_t *)&blocking[0]));
+
+  for (long i = 0; i < nworkers; ++i)
+    uv_sem_post(&b.release);
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(1, canceled);
+
+  // Completed requests cannot be canceled.
+  ASSERT_EQ(UV_EBUSY, uv_cancel((uv_req_t *)&blocking[0]));
+
+  // Synchronous file system requests cannot be canceled either, now
+  // that the thread pool has been started.
+  cancel_fs_sync(&loop);
+
+  ASSERT_EQ(0, uv_loop_close(&loop));
+  uv_sem_destroy(&b.started);
+  uv_sem_destroy(&b.release);
+}
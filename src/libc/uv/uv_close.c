@@ -16,7 +16,7 @@ static void __uv_async_stop(uv_async_t *handle) {
   cloudabi_sys_fd_close(handle->__readfd);
   cloudabi_sys_fd_close(handle->__writefd);
   __uv_handle_stop((uv_handle_t *)handle);
-  __uv_active_asyncs_remove(handle);
+  __uv_subscriptions_remove(handle->loop, handle->__slot);
 }
 
 static void __uv_stream_stop(uv_stream_t *handle) {
@@ -27,7 +27,7 @@ static void __uv_stream_stop(uv_stream_t *handle) {
   if (!__uv_shutdowns_empty(&handle->__shutdown_queue) ||
       !__uv_writes_empty(&handle->__write_queue)) {
     __uv_handle_stop((uv_handle_t *)handle);
-    __uv_writing_streams_remove(handle);
+    __uv_subscriptions_remove(handle->loop, handle->__write_slot);
   }
 
   // Close the file descriptor and set it to -2, as opposed to -1. This
@@ -43,6 +43,22 @@ static void __uv_stream_stop(uv_stream_t *handle) {
   }
 }
 
+static void __uv_udp_stop(uv_udp_t *handle) {
+  // Stop the handle for receiving.
+  uv_udp_recv_stop(handle);
+
+  // Stop the handle for sending. Queued datagrams are canceled once
+  // the handle is closed.
+  if (!__uv_udp_sends_empty(&handle->__send_queue)) {
+    __uv_handle_stop((uv_handle_t *)handle);
+    __uv_subscriptions_remove(handle->loop, handle->__write_slot);
+  }
+
+  if (handle->__fd >= 0)
+    cloudabi_sys_fd_close(handle->__fd);
+  handle->__fd = -2;
+}
+
 void uv_close(uv_handle_t *handle, uv_close_cb close_cb) {
   assert(!uv_is_closing(handle) && "Attempted to double close handle");
 
@@ -74,6 +90,9 @@ void uv_close(uv_handle_t *handle, uv_close_cb close_cb) {
     case UV_TIMER:
       uv_timer_stop((uv_timer_t *)handle);
       break;
+    case UV_UDP:
+      __uv_udp_stop((uv_udp_t *)handle);
+      break;
     default:
       assert(0 && "Attempted to close handle of an unsupported type");
   }
@@ -0,0 +1,42 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/uv.h>
+
+#include <uv.h>
+
+static void fs_work(uv_work_t *work) {
+  uv_fs_t *req = (uv_fs_t *)work;
+  req->result = req->__work(req);
+}
+
+static void fs_after_work(uv_work_t *work, int status) {
+  uv_fs_t *req = (uv_fs_t *)work;
+  if (status != 0)
+    req->result = status;
+  __uv_fs_free_bufs(req);
+  req->__cb(req);
+}
+
+int __uv_fs_execute(uv_loop_t *loop, uv_fs_t *req, uv_fs_type type,
+                    ssize_t (*work_cb)(uv_fs_t *), uv_fs_cb after_work_cb) {
+  __uv_work_req_init((uv_work_t *)req, UV_FS);
+  req->loop = loop;
+  req->fs_type = type;
+  req->result = 0;
+  req->__work = work_cb;
+  req->__cb = after_work_cb;
+
+  if (after_work_cb == NULL) {
+    // No callback provided. Perform the operation synchronously.
+    req->result = work_cb(req);
+    __uv_fs_free_bufs(req);
+    return req->result;
+  }
+
+  int error = __uv_work_submit(loop, (uv_work_t *)req, fs_work, fs_after_work);
+  if (error != 0)
+    __uv_fs_free_bufs(req);
+  return error;
+}
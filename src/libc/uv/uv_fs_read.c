@@ -2,11 +2,51 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <common/uv.h>
+
+#include <assert.h>
+#include <cloudabi_syscalls.h>
+#include <limits.h>
+#include <stddef.h>
 #include <uv.h>
 
+// This code assumes uv_buf_t and cloudabi_iovec_t are identical.
+static_assert(offsetof(cloudabi_iovec_t, buf) == offsetof(uv_buf_t, base),
+              "Offset mismatch");
+static_assert(offsetof(cloudabi_iovec_t, buf_len) == offsetof(uv_buf_t, len),
+              "Offset mismatch");
+static_assert(sizeof(cloudabi_iovec_t) == sizeof(uv_buf_t), "Size mismatch");
+
+static ssize_t do_read(uv_fs_t *req) {
+  const cloudabi_iovec_t *iov =
+      (const cloudabi_iovec_t *)req->__arguments.__read.__bufs;
+  size_t niov = req->__arguments.__read.__nbufs;
+  if (niov > _XOPEN_IOV_MAX)
+    niov = _XOPEN_IOV_MAX;
+
+  // Negative offsets cause reads to start at the current position.
+  size_t nread;
+  cloudabi_errno_t error =
+      req->__arguments.__read.__offset < 0
+          ? cloudabi_sys_fd_read(req->__arguments.__read.__file, iov, niov,
+                                 &nread)
+          : cloudabi_sys_fd_pread(req->__arguments.__read.__file, iov, niov,
+                                  req->__arguments.__read.__offset, &nread);
+  return error == 0 ? (ssize_t)nread : -error;
+}
+
 int uv_fs_read(uv_loop_t *loop, uv_fs_t *req, uv_file file,
                const uv_buf_t *bufs, unsigned int nbufs, int64_t offset,
                uv_fs_cb cb) {
-  // TODO(ed): Implement!
-  return UV_ENOSYS;
+  if (bufs == NULL || nbufs == 0)
+    return UV_EINVAL;
+  req->__arguments.__read.__file = file;
+  if (!__uv_fs_copy_bufs(&req->__arguments.__read.__bufs,
+                         req->__arguments.__read.__bufsml,
+                         __arraycount(req->__arguments.__read.__bufsml), bufs,
+                         nbufs))
+    return UV_ENOMEM;
+  req->__arguments.__read.__nbufs = nbufs;
+  req->__arguments.__read.__offset = offset;
+  return __uv_fs_execute(loop, req, UV_FS_READ, do_read, cb);
 }
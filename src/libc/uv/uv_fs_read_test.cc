@@ -0,0 +1,101 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <uv.h>
+
+#include "gtest/gtest.h"
+#include "src/gtest_with_tmpdir/gtest_with_tmpdir.h"
+
+static int create_file(const char *contents) {
+  int fd_tmp = gtest_with_tmpdir::CreateTemporaryDirectory();
+  int fd = openat(fd_tmp, "file", O_CREAT | O_RDWR);
+  EXPECT_LE(0, fd);
+  EXPECT_EQ(0, close(fd_tmp));
+  size_t len = strlen(contents);
+  EXPECT_EQ(len, write(fd, contents, len));
+  EXPECT_EQ(0, lseek(fd, 0, SEEK_SET));
+  return fd;
+}
+
+TEST(uv_fs_read, einval) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+  uv_fs_t req;
+  char buf[1];
+  uv_buf_t iov = uv_buf_init(buf, sizeof(buf));
+  ASSERT_EQ(UV_EINVAL, uv_fs_read(&loop, &req, 0, &iov, 0, 0, nullptr));
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
+
+TEST(uv_fs_read, sync) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+  int fd = create_file("Hello, world");
+
+  // Read data at an explicit offset into multiple buffers.
+  uv_fs_t req;
+  char buf1[3], buf2[4];
+  uv_buf_t bufs[2] = {uv_buf_init(buf1, sizeof(buf1)),
+                      uv_buf_init(buf2, sizeof(buf2))};
+  ASSERT_EQ(7, uv_fs_read(&loop, &req, fd, bufs, 2, 2, nullptr));
+  ASSERT_EQ(UV_FS, req.type);
+  ASSERT_EQ(UV_FS_READ, req.fs_type);
+  ASSERT_EQ(7, req.result);
+  ASSERT_EQ(0, memcmp(buf1, "llo", 3));
+  ASSERT_EQ(0, memcmp(buf2, ", wo", 4));
+  uv_fs_req_cleanup(&req);
+
+  // Read data at the current position, which should be updated.
+  ASSERT_EQ(3, uv_fs_read(&loop, &req, fd, bufs, 1, -1, nullptr));
+  ASSERT_EQ(0, memcmp(buf1, "Hel", 3));
+  ASSERT_EQ(3, uv_fs_read(&loop, &req, fd, bufs, 1, -1, nullptr));
+  ASSERT_EQ(0, memcmp(buf1, "lo,", 3));
+  uv_fs_req_cleanup(&req);
+
+  // Reading past the end of the file.
+  ASSERT_EQ(0, uv_fs_read(&loop, &req, fd, bufs, 2, 100, nullptr));
+  uv_fs_req_cleanup(&req);
+
+  // Bad file descriptor.
+  ASSERT_EQ(UV_EBADF, uv_fs_read(&loop, &req, -1, bufs, 2, 0, nullptr));
+  uv_fs_req_cleanup(&req);
+
+  ASSERT_EQ(0, close(fd));
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
+
+static void read_cb(uv_fs_t *req) {
+  ASSERT_EQ(UV_FS_READ, req->fs_type);
+  ASSERT_EQ(12, req->result);
+  ++*static_cast<int *>(req->data);
+  uv_fs_req_cleanup(req);
+}
+
+TEST(uv_fs_read, async) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+  int fd = create_file("Hello, world");
+
+  // Perform reads using more buffers than can be stored in the request
+  // inline. The array of buffers does not need to remain valid.
+  char buf[12];
+  uv_fs_t reqs[10];
+  int calls = 0;
+  for (uv_fs_t &req : reqs) {
+    uv_buf_t bufs[12];
+    for (size_t i = 0; i < 12; ++i)
+      bufs[i] = uv_buf_init(&buf[i], 1);
+    req.data = &calls;
+    ASSERT_EQ(0, uv_fs_read(&loop, &req, fd, bufs, 12, 0, read_cb));
+  }
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(10, calls);
+  ASSERT_EQ(0, memcmp(buf, "Hello, world", 12));
+
+  ASSERT_EQ(0, close(fd));
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
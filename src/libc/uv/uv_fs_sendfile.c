@@ -2,10 +2,87 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <common/uv.h>
+
+#include <cloudabi_syscalls.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <uv.h>
 
+// Size of the buffer used to copy data between file descriptors.
+#define SENDFILE_BUFFER_SIZE (256 * 1024)
+
+// Blocks until a file descriptor becomes writable.
+static cloudabi_errno_t wait_writable(cloudabi_fd_t fd) {
+  cloudabi_subscription_t sub = {
+      .type = CLOUDABI_EVENTTYPE_FD_WRITE,
+      .fd_readwrite.fd = fd,
+      .fd_readwrite.flags = CLOUDABI_SUBSCRIPTION_FD_READWRITE_POLL,
+  };
+  cloudabi_event_t ev;
+  size_t nevents;
+  cloudabi_errno_t error = cloudabi_sys_poll(&sub, &ev, 1, &nevents);
+  return error != 0 ? error : ev.error;
+}
+
+static ssize_t do_sendfile(uv_fs_t *req) {
+  uv_file out_fd = req->__arguments.__sendfile.__out_fd;
+  uv_file in_fd = req->__arguments.__sendfile.__in_fd;
+  int64_t in_offset = req->__arguments.__sendfile.__in_offset;
+  size_t length = req->__arguments.__sendfile.__length;
+  if (length == 0)
+    return 0;
+
+  // There is no system call for copying data between file descriptors
+  // directly. Copy the data through a buffer that is private to the
+  // request, using large chunks to keep the number of system calls low.
+  size_t bufsize =
+      length < SENDFILE_BUFFER_SIZE ? length : SENDFILE_BUFFER_SIZE;
+  char *buf = malloc(bufsize);
+  if (buf == NULL)
+    return UV_ENOMEM;
+
+  size_t total = 0;
+  cloudabi_errno_t error = 0;
+  while (total < length) {
+    cloudabi_iovec_t iov = {
+        .buf = buf,
+        .buf_len = length - total < bufsize ? length - total : bufsize,
+    };
+    size_t nread;
+    error = cloudabi_sys_fd_pread(in_fd, &iov, 1, in_offset + total, &nread);
+    if (error != 0 || nread == 0)
+      break;
+
+    // Write the chunk in its entirety. Sockets used by the event loop
+    // are non-blocking, meaning we may need to wait for them to become
+    // writable.
+    size_t written = 0;
+    while (written < nread) {
+      cloudabi_ciovec_t ciov = {.buf = buf + written,
+                                .buf_len = nread - written};
+      size_t nwritten;
+      error = cloudabi_sys_fd_write(out_fd, &ciov, 1, &nwritten);
+      if (error == CLOUDABI_EAGAIN)
+        error = wait_writable(out_fd);
+      else if (error == 0)
+        written += nwritten;
+      if (error != 0)
+        break;
+    }
+    total += written;
+    if (error != 0)
+      break;
+  }
+  free(buf);
+  return total > 0 || error == 0 ? (ssize_t)total : -error;
+}
+
 int uv_fs_sendfile(uv_loop_t *loop, uv_fs_t *req, uv_file out_fd, uv_file in_fd,
                    int64_t in_offset, size_t length, uv_fs_cb cb) {
-  // TODO(ed): Implement!
-  return UV_ENOSYS;
+  req->__arguments.__sendfile.__out_fd = out_fd;
+  req->__arguments.__sendfile.__in_fd = in_fd;
+  req->__arguments.__sendfile.__in_offset = in_offset;
+  req->__arguments.__sendfile.__length = length;
+  return __uv_fs_execute(loop, req, UV_FS_SENDFILE, do_sendfile, cb);
 }
@@ -0,0 +1,90 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <sys/socket.h>
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <uv.h>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/gtest_with_tmpdir/gtest_with_tmpdir.h"
+
+TEST(uv_fs_sendfile, sync) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+  int fd_tmp = gtest_with_tmpdir::CreateTemporaryDirectory();
+  int in = openat(fd_tmp, "in", O_CREAT | O_RDWR);
+  ASSERT_LE(0, in);
+  int out = openat(fd_tmp, "out", O_CREAT | O_RDWR);
+  ASSERT_LE(0, out);
+  ASSERT_EQ(12, write(in, "Hello, world", 12));
+
+  // Copy a part of the input file.
+  uv_fs_t req;
+  ASSERT_EQ(5, uv_fs_sendfile(&loop, &req, out, in, 7, 100, nullptr));
+  ASSERT_EQ(UV_FS_SENDFILE, req.fs_type);
+  uv_fs_req_cleanup(&req);
+  char buf[6];
+  ASSERT_EQ(5, pread(out, buf, sizeof(buf), 0));
+  ASSERT_EQ(0, memcmp(buf, "world", 5));
+
+  ASSERT_EQ(0, close(in));
+  ASSERT_EQ(0, close(out));
+  ASSERT_EQ(0, close(fd_tmp));
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
+
+static void sendfile_cb(uv_fs_t *req) {
+  ASSERT_EQ(UV_FS_SENDFILE, req->fs_type);
+  ASSERT_EQ(1000000, req->result);
+  ++*static_cast<int *>(req->data);
+  uv_fs_req_cleanup(req);
+}
+
+TEST(uv_fs_sendfile, socket) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+  int fd_tmp = gtest_with_tmpdir::CreateTemporaryDirectory();
+  int in = openat(fd_tmp, "in", O_CREAT | O_RDWR);
+  ASSERT_LE(0, in);
+  std::vector<char> data(1000000);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = i * 7;
+  ASSERT_EQ(data.size(), write(in, data.data(), data.size()));
+
+  // Send the file over a non-blocking socket that is drained by another
+  // thread, so that sending needs to wait for the socket to become
+  // writable.
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  ASSERT_EQ(0, fcntl(fds[0], F_SETFL, O_NONBLOCK));
+  std::vector<char> received;
+  std::thread reader([&]() {
+    char buf[4096];
+    ssize_t len;
+    while ((len = read(fds[1], buf, sizeof(buf))) > 0)
+      received.insert(received.end(), buf, buf + len);
+  });
+
+  uv_fs_t req;
+  int calls = 0;
+  req.data = &calls;
+  ASSERT_EQ(0, uv_fs_sendfile(&loop, &req, fds[0], in, 0, 2000000,
+                              sendfile_cb));
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(1, calls);
+
+  ASSERT_EQ(0, close(fds[0]));
+  reader.join();
+  ASSERT_EQ(data, received);
+
+  ASSERT_EQ(0, close(fds[1]));
+  ASSERT_EQ(0, close(in));
+  ASSERT_EQ(0, close(fd_tmp));
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
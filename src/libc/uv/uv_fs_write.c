@@ -2,11 +2,78 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <common/uv.h>
+
+#include <assert.h>
+#include <cloudabi_syscalls.h>
+#include <limits.h>
+#include <stddef.h>
 #include <uv.h>
 
+// This code assumes uv_buf_t and cloudabi_ciovec_t are identical.
+static_assert(offsetof(cloudabi_ciovec_t, buf) == offsetof(uv_buf_t, base),
+              "Offset mismatch");
+static_assert(offsetof(cloudabi_ciovec_t, buf_len) == offsetof(uv_buf_t, len),
+              "Offset mismatch");
+static_assert(sizeof(cloudabi_ciovec_t) == sizeof(uv_buf_t), "Size mismatch");
+
+static ssize_t do_write(uv_fs_t *req) {
+  uv_file file = req->__arguments.__write.__file;
+  uv_buf_t *bufs = req->__arguments.__write.__bufs;
+  unsigned int nbufs = req->__arguments.__write.__nbufs;
+  int64_t offset = req->__arguments.__write.__offset;
+
+  // Keep on writing until all buffers have been written, as the number
+  // of buffers may exceed _XOPEN_IOV_MAX.
+  size_t total = 0;
+  for (;;) {
+    // Skip buffers that have been written in full.
+    while (nbufs > 0 && bufs->len == 0) {
+      ++bufs;
+      --nbufs;
+    }
+    if (nbufs == 0)
+      return total;
+
+    // Negative offsets cause writes to start at the current position.
+    const cloudabi_ciovec_t *iov = (const cloudabi_ciovec_t *)bufs;
+    size_t niov = nbufs > _XOPEN_IOV_MAX ? _XOPEN_IOV_MAX : nbufs;
+    size_t nwritten;
+    cloudabi_errno_t error =
+        offset < 0 ? cloudabi_sys_fd_write(file, iov, niov, &nwritten)
+                   : cloudabi_sys_fd_pwrite(file, iov, niov, offset + total,
+                                            &nwritten);
+    if (error != 0)
+      return total > 0 ? (ssize_t)total : -error;
+    if (nwritten == 0)
+      return total;
+    total += nwritten;
+
+    // Trim the data that has been written.
+    while (nwritten >= bufs->len) {
+      nwritten -= bufs->len;
+      ++bufs;
+      --nbufs;
+      if (nbufs == 0)
+        return total;
+    }
+    bufs->base += nwritten;
+    bufs->len -= nwritten;
+  }
+}
+
 int uv_fs_write(uv_loop_t *loop, uv_fs_t *req, uv_file file,
                 const uv_buf_t *bufs, unsigned int nbufs, int64_t offset,
                 uv_fs_cb cb) {
-  // TODO(ed): Implement!
-  return UV_ENOSYS;
+  if (bufs == NULL || nbufs == 0)
+    return UV_EINVAL;
+  req->__arguments.__write.__file = file;
+  if (!__uv_fs_copy_bufs(&req->__arguments.__write.__bufs,
+                         req->__arguments.__write.__bufsml,
+                         __arraycount(req->__arguments.__write.__bufsml), bufs,
+                         nbufs))
+    return UV_ENOMEM;
+  req->__arguments.__write.__nbufs = nbufs;
+  req->__arguments.__write.__offset = offset;
+  return __uv_fs_execute(loop, req, UV_FS_WRITE, do_write, cb);
 }
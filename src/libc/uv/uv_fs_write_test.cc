@@ -0,0 +1,86 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <uv.h>
+
+#include "gtest/gtest.h"
+#include "src/gtest_with_tmpdir/gtest_with_tmpdir.h"
+
+TEST(uv_fs_write, sync) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+  int fd_tmp = gtest_with_tmpdir::CreateTemporaryDirectory();
+  int fd = openat(fd_tmp, "file", O_CREAT | O_RDWR);
+  ASSERT_LE(0, fd);
+
+  // Write data at the current position.
+  uv_fs_t req;
+  uv_buf_t bufs[2] = {uv_buf_init((char *)"Hello", 5),
+                      uv_buf_init((char *)", world", 7)};
+  ASSERT_EQ(12, uv_fs_write(&loop, &req, fd, bufs, 2, -1, nullptr));
+  ASSERT_EQ(UV_FS, req.type);
+  ASSERT_EQ(UV_FS_WRITE, req.fs_type);
+  ASSERT_EQ(12, req.result);
+  uv_fs_req_cleanup(&req);
+  ASSERT_EQ(12, lseek(fd, 0, SEEK_CUR));
+
+  // Overwrite data at an explicit offset. This should not affect the
+  // current position.
+  ASSERT_EQ(5, uv_fs_write(&loop, &req, fd, bufs, 1, 7, nullptr));
+  uv_fs_req_cleanup(&req);
+  ASSERT_EQ(12, lseek(fd, 0, SEEK_CUR));
+
+  char buf[13];
+  ASSERT_EQ(12, pread(fd, buf, sizeof(buf), 0));
+  ASSERT_EQ(0, memcmp(buf, "Hello, Hello", 12));
+
+  ASSERT_EQ(0, close(fd));
+  ASSERT_EQ(0, close(fd_tmp));
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
+
+static void write_cb(uv_fs_t *req) {
+  ASSERT_EQ(UV_FS_WRITE, req->fs_type);
+  ASSERT_EQ(2000, req->result);
+  ++*static_cast<int *>(req->data);
+  uv_fs_req_cleanup(req);
+}
+
+TEST(uv_fs_write, async) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+  int fd_tmp = gtest_with_tmpdir::CreateTemporaryDirectory();
+  int fd = openat(fd_tmp, "file", O_CREAT | O_RDWR);
+  ASSERT_LE(0, fd);
+
+  // Write a large number of small buffers at different offsets.
+  static char data[2000];
+  for (size_t i = 0; i < sizeof(data); ++i)
+    data[i] = i;
+  uv_fs_t reqs[4];
+  int calls = 0;
+  for (size_t i = 0; i < 4; ++i) {
+    uv_buf_t bufs[2000];
+    for (size_t j = 0; j < 2000; ++j)
+      bufs[j] = uv_buf_init(&data[j], 1);
+    reqs[i].data = &calls;
+    ASSERT_EQ(0, uv_fs_write(&loop, &reqs[i], fd, bufs, 2000, i * 2000,
+                             write_cb));
+  }
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(4, calls);
+
+  for (size_t i = 0; i < 4; ++i) {
+    char buf[2000];
+    ASSERT_EQ(2000, pread(fd, buf, sizeof(buf), i * 2000));
+    ASSERT_EQ(0, memcmp(buf, data, sizeof(data)));
+  }
+
+  ASSERT_EQ(0, close(fd));
+  ASSERT_EQ(0, close(fd_tmp));
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
@@ -4,15 +4,23 @@
 
 #include <common/uv.h>
 
+#include <cloudabi_syscalls.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <uv.h>
 
 int uv_loop_close(uv_loop_t *loop) {
-  if (!__uv_handles_empty(&loop->__handles))
+  if (!__uv_handles_empty(&loop->__handles) || loop->__active_works > 0)
     return UV_EBUSY;
 
   __uv_active_timers_destroy(&loop->__active_timers);
   free(loop->__subscriptions_buffer);
+  free(loop->__subscriptions_slots);
   free(loop->__events_buffer);
+  if (loop->__work_readfd >= 0) {
+    cloudabi_sys_fd_close(loop->__work_readfd);
+    cloudabi_sys_fd_close(loop->__work_writefd);
+  }
+  pthread_mutex_destroy(&loop->__work_lock);
   return 0;
 }
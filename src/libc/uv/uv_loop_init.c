@@ -4,6 +4,7 @@
 
 #include <common/uv.h>
 
+#include <pthread.h>
 #include <stdbool.h>
 #include <uv.h>
 
@@ -13,22 +14,31 @@ int uv_loop_init(uv_loop_t *loop) {
 
   __uv_handles_init(&loop->__handles);
 
-  __uv_active_asyncs_init(&loop->__active_asyncs);
   __uv_active_checks_init(&loop->__active_checks);
   __uv_active_idles_init(&loop->__active_idles);
   __uv_active_prepares_init(&loop->__active_prepares);
-  __uv_active_processes_init(&loop->__active_processes);
   __uv_active_timers_init(&loop->__active_timers);
   __uv_closing_handles_init(&loop->__closing_handles);
-  __uv_reading_polls_init(&loop->__reading_polls);
-  __uv_reading_streams_init(&loop->__reading_streams);
-  __uv_writing_polls_init(&loop->__writing_polls);
-  __uv_writing_streams_init(&loop->__writing_streams);
 
   loop->__active_ref_handles_reqs = 0;
+  __uv_writes_init(&loop->__pending_writes);
+  __uv_udp_sends_init(&loop->__pending_udp_sends);
+
+  int error = pthread_mutex_init(&loop->__work_lock, NULL);
+  if (error != 0)
+    return -error;
+  __uv_works_init(&loop->__completed_works);
+  loop->__active_works = 0;
+  loop->__work_readfd = -1;
+  loop->__work_writefd = -1;
 
   loop->__subscriptions_buffer = NULL;
+  loop->__subscriptions_slots = NULL;
+  loop->__subscriptions_count = 0;
   loop->__subscriptions_capacity = 0;
+  loop->__subscriptions_modified = 0;
+  loop->__subscriptions_reused = 0;
+  loop->__subscriptions_rebuilt = 0;
   loop->__events_buffer = NULL;
   loop->__events_capacity = 0;
   return 0;
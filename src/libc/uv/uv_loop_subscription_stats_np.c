@@ -0,0 +1,11 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <uv.h>
+
+void uv_loop_subscription_stats_np(const uv_loop_t *loop, uint64_t *reused,
+                                   uint64_t *rebuilt) {
+  *reused = loop->__subscriptions_reused;
+  *rebuilt = loop->__subscriptions_rebuilt;
+}
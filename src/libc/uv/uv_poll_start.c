@@ -10,17 +10,22 @@
 int uv_poll_start(uv_poll_t *handle, int events, uv_poll_cb cb) {
   uv_poll_stop(handle);
 
+  uv_loop_t *loop = handle->loop;
+  if (!__uv_subscriptions_reserve(loop, 2))
+    return UV_ENOMEM;
+
   handle->__events = events;
   handle->__cb = cb;
 
-  uv_loop_t *loop = handle->loop;
   bool enabled = false;
   if ((events & UV_READABLE) != 0) {
-    __uv_reading_polls_insert_last(&loop->__reading_polls, handle);
+    __uv_subscriptions_insert_fd(loop, &handle->__read_slot, handle,
+                                 CLOUDABI_EVENTTYPE_FD_READ, handle->__fd);
     enabled = true;
   }
   if ((events & UV_WRITABLE) != 0) {
-    __uv_writing_polls_insert_last(&loop->__writing_polls, handle);
+    __uv_subscriptions_insert_fd(loop, &handle->__write_slot, handle,
+                                 CLOUDABI_EVENTTYPE_FD_WRITE, handle->__fd);
     enabled = true;
   }
   if (enabled)
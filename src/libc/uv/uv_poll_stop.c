@@ -13,11 +13,11 @@ int uv_poll_stop(uv_poll_t *poll) {
 
   bool disabled = false;
   if ((poll->__events & UV_READABLE) != 0) {
-    __uv_reading_polls_remove(poll);
+    __uv_subscriptions_remove(poll->loop, poll->__read_slot);
     disabled = true;
   }
   if ((poll->__events & UV_WRITABLE) != 0) {
-    __uv_writing_polls_remove(poll);
+    __uv_subscriptions_remove(poll->loop, poll->__write_slot);
     disabled = true;
   }
   poll->__events = 0;
@@ -2,10 +2,14 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <common/uv.h>
+
 #include <uv.h>
 
 int uv_queue_work(uv_loop_t *loop, uv_work_t *req, uv_work_cb work_cb,
                   uv_after_work_cb after_work_cb) {
-  // TODO(ed): Implement!
-  return UV_ENOSYS;
+  if (work_cb == NULL)
+    return UV_EINVAL;
+  __uv_work_req_init(req, UV_WORK);
+  return __uv_work_submit(loop, req, work_cb, after_work_cb);
 }
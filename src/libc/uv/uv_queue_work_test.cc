@@ -0,0 +1,76 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <uv.h>
+#include <atomic>
+
+#include "gtest/gtest.h"
+
+TEST(uv_queue_work, einval) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+  uv_work_t req;
+  ASSERT_EQ(UV_EINVAL, uv_queue_work(&loop, &req, nullptr, nullptr));
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
+
+namespace {
+
+struct state {
+  uv_thread_t loop_thread;
+  std::atomic<int> work_calls;
+  int after_work_calls;
+};
+
+}  // namespace
+
+static void work_cb(uv_work_t *req) {
+  // Work should be performed on one of the worker threads.
+  state *s = static_cast<state *>(req->data);
+  uv_thread_t self = uv_thread_self();
+  ASSERT_FALSE(uv_thread_equal(&s->loop_thread, &self));
+  ++s->work_calls;
+}
+
+static void after_work_cb(uv_work_t *req, int status) {
+  // Completion should be reported on the thread running the loop.
+  ASSERT_EQ(0, status);
+  state *s = static_cast<state *>(req->data);
+  uv_thread_t self = uv_thread_self();
+  ASSERT_TRUE(uv_thread_equal(&s->loop_thread, &self));
+  ++s->after_work_calls;
+}
+
+TEST(uv_queue_work, example) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+
+  // Submit a large number of requests.
+  state s;
+  std::atomic_init(&s.work_calls, 0);
+  s.after_work_calls = 0;
+  s.loop_thread = uv_thread_self();
+  uv_work_t reqs[1000];
+  for (uv_work_t &req : reqs) {
+    req.data = &s;
+    ASSERT_EQ(0, uv_queue_work(&loop, &req, work_cb, after_work_cb));
+    ASSERT_EQ(UV_WORK, req.type);
+    ASSERT_EQ(&loop, req.loop);
+  }
+
+  // Pending requests should keep the loop alive.
+  ASSERT_EQ(UV_EBUSY, uv_loop_close(&loop));
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(1000, s.work_calls.load());
+  ASSERT_EQ(1000, s.after_work_calls);
+
+  // Requests may be resubmitted once completed.
+  for (uv_work_t &req : reqs)
+    ASSERT_EQ(0, uv_queue_work(&loop, &req, work_cb, nullptr));
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(2000, s.work_calls.load());
+  ASSERT_EQ(1000, s.after_work_calls);
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
@@ -11,7 +11,9 @@ int uv_read_start(uv_stream_t *stream, uv_alloc_cb alloc_cb,
                   uv_read_cb read_cb) {
   if (stream->__fd < 0)
     return UV_EBADF;
-  __uv_stream_start_reading(stream);
+  int error = __uv_stream_start_reading(stream);
+  if (error != 0)
+    return error;
   stream->__alloc_cb = alloc_cb;
   assert(read_cb != NULL && "Missing required argument alloc_cb");
   stream->__read_cb = read_cb;
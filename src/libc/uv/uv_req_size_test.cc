@@ -11,6 +11,7 @@ TEST(uv_req_size, example) {
   ASSERT_EQ(sizeof(uv_req_t), uv_req_size(UV_REQ));
   ASSERT_EQ(sizeof(uv_write_t), uv_req_size(UV_WRITE));
   ASSERT_EQ(sizeof(uv_shutdown_t), uv_req_size(UV_SHUTDOWN));
+  ASSERT_EQ(sizeof(uv_udp_send_t), uv_req_size(UV_UDP_SEND));
   ASSERT_EQ(sizeof(uv_fs_t), uv_req_size(UV_FS));
   ASSERT_EQ(sizeof(uv_work_t), uv_req_size(UV_WORK));
   ASSERT_EQ(sizeof(uv_getaddrinfo_t), uv_req_size(UV_GETADDRINFO));
@@ -4,9 +4,12 @@
 
 #include <common/uv.h>
 
+#include <sys/socket.h>
+
 #include <assert.h>
 #include <cloudabi_syscalls.h>
 #include <limits.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -51,14 +54,7 @@ GENERATE_RUN_HANDLES(check);
 
 static void __uv_async_fd_read(uv_async_t *handle,
                                const cloudabi_event_t *event) {
-  // Discard any data present in the pipe used for notification.
-  char discard[1024];
-  cloudabi_iovec_t iov = {.buf = discard, .buf_len = sizeof(discard)};
-  size_t nread;
-  while (cloudabi_sys_fd_read(handle->__readfd, &iov, 1, &nread) == 0 &&
-         nread == sizeof(discard)) {
-  }
-
+  __uv_wakeup_pipe_drain(handle->__readfd);
   handle->__cb(handle);
 }
 
@@ -100,8 +96,14 @@ static void __uv_poll_trigger(uv_poll_t *handle) {
 static void __uv_process_proc_terminate(uv_process_t *handle,
                                         const cloudabi_event_t *event) {
   __uv_process_stop(handle);
-  handle->__cb(handle, event->proc_terminate.exitcode,
-               event->proc_terminate.signal);
+  if (event->type == CLOUDABI_EVENTTYPE_CLOCK) {
+    // Process has been killed using uv_process_kill(). Generate a
+    // fictive SIGKILL event.
+    handle->__cb(handle, 0, SIGKILL);
+  } else {
+    handle->__cb(handle, event->proc_terminate.exitcode,
+                 event->proc_terminate.signal);
+  }
 }
 
 static void __uv_stream_fd_read(uv_stream_t *handle,
@@ -198,52 +200,16 @@ static void __uv_stream_fd_read(uv_stream_t *handle,
 
 static void __uv_stream_fd_write(uv_stream_t *handle,
                                  const cloudabi_event_t *event) {
-  // This code assumes uv_buf_t and cloudabi_ciovec_t are identical.
-  static_assert(offsetof(cloudabi_ciovec_t, buf) == offsetof(uv_buf_t, base),
-                "Offset mismatch");
-  static_assert(
-      sizeof(((cloudabi_ciovec_t *)0)->buf) == sizeof(((uv_buf_t *)0)->base),
-      "Size mismatch");
-  static_assert(offsetof(cloudabi_ciovec_t, buf_len) == offsetof(uv_buf_t, len),
-                "Offset mismatch");
-  static_assert(
-      sizeof(((cloudabi_ciovec_t *)0)->buf_len) == sizeof(((uv_buf_t *)0)->len),
-      "Size mismatch");
-  static_assert(sizeof(cloudabi_ciovec_t) == sizeof(uv_buf_t), "Size mismatch");
-
   // Process write requests.
   while (!__uv_writes_empty(&handle->__write_queue)) {
-    // Determine the number of iovecs to write. Be conservative by
-    // limiting the number to _XOPEN_IOV_MAX, as more may cause the
-    // write call to fail.
     uv_write_t *write = __uv_writes_first(&handle->__write_queue);
-    const cloudabi_ciovec_t *iov =
-        (const cloudabi_ciovec_t *)write->__bufs + write->__nbufs_done;
-    size_t niov = write->__nbufs_total - write->__nbufs_done;
-    if (niov > _XOPEN_IOV_MAX)
-      niov = _XOPEN_IOV_MAX;
-    assert(niov > 0 && "Request must have buffers");
-
-    // Write data.
+    assert(write->__nbufs_done < write->__nbufs_total &&
+           "Request must have buffers");
     size_t nwritten;
-    cloudabi_errno_t error;
-    if (write->send_handle != NULL) {
-      // Initial write: send file descriptor across.
-      assert(write->send_handle->__fd >= 0 && "Invalid stream");
-      cloudabi_fd_t send_handle = write->send_handle->__fd;
-      cloudabi_send_in_t si = {
-          .si_data = iov,
-          .si_data_len = niov,
-          .si_fds = &send_handle,
-          .si_fds_len = 1,
-      };
-      cloudabi_send_out_t so;
-      error = cloudabi_sys_sock_send(handle->__fd, &si, &so);
-      nwritten = so.so_datalen;
-    } else {
-      error = cloudabi_sys_fd_write(handle->__fd, iov, niov, &nwritten);
-    }
-
+    cloudabi_errno_t error = __uv_stream_write(
+        handle, write->__bufs + write->__nbufs_done,
+        write->__nbufs_total - write->__nbufs_done, write->send_handle,
+        &nwritten);
     if (error == 0) {
       // Managed to write data.
       write->send_handle = NULL;
@@ -265,15 +231,16 @@ static void __uv_stream_fd_write(uv_stream_t *handle,
       // Write finished. Complete it.
       assert(nwritten == 0 && "Wrote more bytes than in the request");
     } else if (error == CLOUDABI_EAGAIN) {
-      // File descriptor is now blocking again. Stop writing.
-      break;
+      // File descriptor is now blocking again. Stop writing. Any
+      // shutdown requests need to wait for the writes to complete.
+      return;
     } else {
       // Write failed. Discard the request.
       for (unsigned int i = write->__nbufs_done; i < write->__nbufs_total; ++i)
         handle->write_queue_size -= write->__bufs[i].len;
     }
 
-    free(write->__bufs);
+    __uv_write_free_bufs(write);
     __uv_writes_remove(write);
     __uv_stream_stop_writing(handle);
     write->__cb(write, -error);
@@ -293,6 +260,179 @@ static void __uv_stream_fd_write(uv_stream_t *handle,
   }
 }
 
+// Receives a single datagram into a buffer.
+static cloudabi_errno_t udp_recv(uv_udp_t *handle, uv_buf_t *buf,
+                                 size_t *nread, unsigned int *flags) {
+  cloudabi_recv_in_t ri = {
+      .ri_data = (cloudabi_iovec_t *)buf,
+      .ri_data_len = 1,
+  };
+  cloudabi_recv_out_t ro;
+  cloudabi_errno_t error = cloudabi_sys_sock_recv(handle->__fd, &ri, &ro);
+  if (error != 0)
+    return error;
+  *nread = ro.ro_datalen;
+  *flags = (ro.ro_flags & CLOUDABI_SOCK_RECV_DATA_TRUNCATED) != 0
+               ? UV_UDP_PARTIAL
+               : 0;
+  return 0;
+}
+
+// Datagrams received over connected sockets are not annotated with the
+// address of the sender. Pass in a placeholder, as a null address is
+// used to indicate that no datagram was received.
+static const struct sockaddr udp_unspecified_addr = {.sa_family = AF_UNSPEC};
+
+// Number of datagrams that may be received per event, to prevent
+// starvation of other handles.
+#define UDP_RECV_BATCH 20
+
+static void __uv_udp_fd_read(uv_udp_t *handle, const cloudabi_event_t *event) {
+  // Obtain a separate buffer from the allocator for every datagram.
+  // Take into account that the handle may have been stopped for
+  // receiving in the meantime.
+  for (int recv_iteration = 0;
+       handle->__recv_cb != NULL && recv_iteration < UDP_RECV_BATCH;
+       ++recv_iteration) {
+    uv_buf_t buf = uv_buf_init(NULL, 0);
+    handle->__alloc_cb((uv_handle_t *)handle, UV_UDP_DGRAM_MAXSIZE, &buf);
+    if (buf.base == NULL || buf.len == 0) {
+      // Allocator ran out of memory.
+      handle->__recv_cb(handle, UV_ENOBUFS, &buf, NULL, 0);
+      break;
+    }
+
+    size_t nread;
+    unsigned int flags;
+    cloudabi_errno_t error = udp_recv(handle, &buf, &nread, &flags);
+    if (error == CLOUDABI_EAGAIN) {
+      // No more datagrams available.
+      handle->__recv_cb(handle, 0, &buf, NULL, 0);
+      break;
+    } else if (error != 0) {
+      handle->__recv_cb(handle, -error, &buf, NULL, 0);
+      break;
+    }
+    handle->__recv_cb(handle, nread, &buf, &udp_unspecified_addr, flags);
+  }
+}
+
+static void __uv_udp_fd_read_chunked(uv_udp_t *handle,
+                                     const cloudabi_event_t *event) {
+  // Receive multiple datagrams into a single buffer obtained from the
+  // allocator. Datagrams are passed to the callback as chunks of this
+  // buffer, followed by a final call that allows the buffer to be
+  // freed. The callback is saved, as the handle may be stopped for
+  // receiving while processing the chunks.
+  uv_udp_recv_cb recv_cb = handle->__recv_cb;
+  uv_buf_t slab = uv_buf_init(NULL, 0);
+  handle->__alloc_cb((uv_handle_t *)handle,
+                     UV_UDP_DGRAM_MAXSIZE * UDP_RECV_BATCH, &slab);
+  if (slab.base == NULL || slab.len == 0) {
+    // Allocator ran out of memory.
+    recv_cb(handle, UV_ENOBUFS, &slab, NULL, 0);
+    return;
+  }
+
+  size_t offset = 0;
+  int nchunks = 0;
+  cloudabi_errno_t error = 0;
+  while (handle->__recv_cb != NULL && nchunks < UDP_RECV_BATCH) {
+    // Only receive additional datagrams if they are guaranteed to fit
+    // in the remaining space.
+    if (nchunks > 0 && slab.len - offset < UV_UDP_DGRAM_MAXSIZE)
+      break;
+    uv_buf_t chunk = uv_buf_init(slab.base + offset, slab.len - offset);
+    size_t nread;
+    unsigned int flags;
+    error = udp_recv(handle, &chunk, &nread, &flags);
+    if (error != 0)
+      break;
+    chunk.len = nread;
+    offset += nread;
+    ++nchunks;
+    recv_cb(handle, nread, &chunk, &udp_unspecified_addr,
+            flags | UV_UDP_MMSG_CHUNK);
+  }
+
+  if (nchunks > 0) {
+    // Let the callback free the buffer. Errors that occurred after
+    // receiving datagrams are reported on the next event.
+    recv_cb(handle, 0, &slab, NULL, UV_UDP_MMSG_FREE);
+  } else {
+    recv_cb(handle, error == CLOUDABI_EAGAIN ? 0 : -error, &slab, NULL, 0);
+  }
+}
+
+static void __uv_udp_fd_write(uv_udp_t *handle, const cloudabi_event_t *event) {
+  // Send queued datagrams until the socket would block.
+  while (!__uv_udp_sends_empty(&handle->__send_queue)) {
+    uv_udp_send_t *req = __uv_udp_sends_first(&handle->__send_queue);
+    cloudabi_errno_t error =
+        __uv_udp_send_datagram(handle, req->__bufs, req->__nbufs);
+    if (error == CLOUDABI_EAGAIN)
+      break;
+
+    __uv_udp_sends_remove(req);
+    for (unsigned int i = 0; i < req->__nbufs; ++i)
+      handle->send_queue_size -= req->__bufs[i].len;
+    --handle->send_queue_count;
+    if (__uv_udp_sends_empty(&handle->__send_queue))
+      __uv_udp_stop_sending(handle);
+    __uv_udp_send_free_bufs(req);
+    if (req->__cb != NULL)
+      req->__cb(req, -error);
+  }
+}
+
+static void run_completed_works(uv_loop_t *loop) {
+  // Extract the requests completed by the thread pool. The pipe needs
+  // to be drained first, as worker threads only write into it when the
+  // list of completed requests is empty.
+  __uv_wakeup_pipe_drain(loop->__work_readfd);
+  struct __uv_works_head works;
+  pthread_mutex_lock(&loop->__work_lock);
+  __uv_works_move(&loop->__completed_works, &works);
+  pthread_mutex_unlock(&loop->__work_lock);
+
+  while (!__uv_works_empty(&works)) {
+    uv_work_t *req = __uv_works_first(&works);
+    __uv_works_remove(req);
+    req->__work_state = UV_WORK_DONE;
+    assert(loop->__active_works > 0 && loop->__active_ref_handles_reqs > 0 &&
+           "Alive count cannot go negative");
+    --loop->__active_works;
+    --loop->__active_ref_handles_reqs;
+    if (req->__after_work_cb != NULL)
+      req->__after_work_cb(req, req->__work_status);
+  }
+}
+
+static void run_pending_callbacks(uv_loop_t *loop) {
+  struct __uv_writes_head writes;
+  __uv_writes_move(&loop->__pending_writes, &writes);
+  while (!__uv_writes_empty(&writes)) {
+    uv_write_t *req = __uv_writes_first(&writes);
+    __uv_writes_remove(req);
+    assert(loop->__active_ref_handles_reqs > 0 &&
+           "Alive count cannot go negative");
+    --loop->__active_ref_handles_reqs;
+    req->__cb(req, req->__status);
+  }
+
+  struct __uv_udp_sends_head sends;
+  __uv_udp_sends_move(&loop->__pending_udp_sends, &sends);
+  while (!__uv_udp_sends_empty(&sends)) {
+    uv_udp_send_t *req = __uv_udp_sends_first(&sends);
+    __uv_udp_sends_remove(req);
+    assert(loop->__active_ref_handles_reqs > 0 &&
+           "Alive count cannot go negative");
+    --loop->__active_ref_handles_reqs;
+    if (req->__cb != NULL)
+      req->__cb(req, req->__status);
+  }
+}
+
 static void run_closing_handles(uv_loop_t *loop) {
   struct __uv_closing_handles_head closing_handles;
   __uv_closing_handles_move(&loop->__closing_handles, &closing_handles);
@@ -312,161 +452,63 @@ static void run_closing_handles(uv_loop_t *loop) {
       }
       while (!__uv_writes_empty(&stream->__write_queue)) {
         uv_write_t *req = __uv_writes_first(&stream->__write_queue);
-        free(req->__bufs);
+        __uv_write_free_bufs(req);
         __uv_writes_remove(req);
         req->__cb(req, UV_ECANCELED);
       }
       __uv_pending_fds_destroy(&stream->__pending_fds);
+    } else if (handle->type == UV_UDP) {
+      // Cancel all of the queued datagrams.
+      uv_udp_t *udp = (uv_udp_t *)handle;
+      while (!__uv_udp_sends_empty(&udp->__send_queue)) {
+        uv_udp_send_t *req = __uv_udp_sends_first(&udp->__send_queue);
+        __uv_udp_send_free_bufs(req);
+        __uv_udp_sends_remove(req);
+        if (req->__cb != NULL)
+          req->__cb(req, UV_ECANCELED);
+      }
+      udp->send_queue_size = 0;
+      udp->send_queue_count = 0;
     }
 
     handle->__close_cb(handle);
   }
 }
 
-static bool allocate_subscription(uv_loop_t *loop, size_t *nsubscriptions,
-                                  cloudabi_subscription_t **sub) {
-  if (*nsubscriptions == loop->__subscriptions_capacity) {
-    size_t capacity = 4;
-    while (capacity <= *nsubscriptions)
-      capacity *= 2;
-    cloudabi_subscription_t *subscriptions =
-        reallocarray(loop->__subscriptions_buffer,
-                     sizeof(cloudabi_subscription_t), capacity);
-    if (subscriptions == NULL)
-      return false;
-    loop->__subscriptions_buffer = subscriptions;
-    loop->__subscriptions_capacity = capacity;
-  }
-  cloudabi_subscription_t *subscriptions = loop->__subscriptions_buffer;
-  *sub = &subscriptions[(*nsubscriptions)++];
-  return true;
-}
-
-static bool allocate_event(uv_loop_t *loop, size_t *nevents,
-                           cloudabi_event_t **ev) {
-  if (*nevents == loop->__events_capacity) {
-    size_t capacity = 4;
-    while (capacity <= *nevents)
-      capacity *= 2;
-    cloudabi_event_t *events =
-        reallocarray(loop->__events_buffer, sizeof(cloudabi_event_t), capacity);
-    if (events == NULL)
-      return false;
-    loop->__events_buffer = events;
-    loop->__events_capacity = capacity;
-  }
-  cloudabi_event_t *events = loop->__events_buffer;
-  *ev = &events[(*nevents)++];
-  return true;
-}
-
 static int do_poll(uv_loop_t *loop, int timeout) {
-#define FOREACH(vartype, var, headtype, head)                                 \
-  for (vartype *var = headtype##_empty(head) ? NULL : headtype##_first(head); \
-       var != NULL;                                                           \
-       var = var == headtype##_last(head) ? NULL : headtype##_next(var))
-  // Create subscription for all of the active handles.
-  size_t nsubscriptions = 0;
-  size_t nevents = 0;
-  FOREACH(uv_async_t, async, __uv_active_asyncs, &loop->__active_asyncs) {
-    cloudabi_subscription_t *sub;
-    if (!allocate_subscription(loop, &nsubscriptions, &sub))
-      return UV_ENOMEM;
-    *sub = (cloudabi_subscription_t){
-        .userdata = (uintptr_t)async,
-        .type = CLOUDABI_EVENTTYPE_FD_READ,
-        .fd_readwrite.fd = async->__readfd,
-        .fd_readwrite.flags = CLOUDABI_SUBSCRIPTION_FD_READWRITE_POLL,
-    };
-  }
-  FOREACH(uv_poll_t, poll, __uv_reading_polls, &loop->__reading_polls) {
-    assert(poll->__status == 0 && poll->__revents == 0 &&
-           "Poll object still has pending events from a previous run");
-    cloudabi_subscription_t *sub;
-    if (!allocate_subscription(loop, &nsubscriptions, &sub))
-      return UV_ENOMEM;
-    *sub = (cloudabi_subscription_t){
-        .userdata = (uintptr_t)poll,
-        .type = CLOUDABI_EVENTTYPE_FD_READ,
-        .fd_readwrite.fd = poll->__fd,
-        .fd_readwrite.flags = CLOUDABI_SUBSCRIPTION_FD_READWRITE_POLL,
-    };
-  }
-  FOREACH(uv_poll_t, poll, __uv_writing_polls, &loop->__writing_polls) {
-    assert(poll->__status == 0 && poll->__revents == 0 &&
-           "Poll object still has pending events from a previous run");
-    cloudabi_subscription_t *sub;
-    if (!allocate_subscription(loop, &nsubscriptions, &sub))
-      return UV_ENOMEM;
-    *sub = (cloudabi_subscription_t){
-        .userdata = (uintptr_t)poll,
-        .type = CLOUDABI_EVENTTYPE_FD_WRITE,
-        .fd_readwrite.fd = poll->__fd,
-        .fd_readwrite.flags = CLOUDABI_SUBSCRIPTION_FD_READWRITE_POLL,
-    };
-  }
-  FOREACH(uv_process_t, process, __uv_active_processes,
-          &loop->__active_processes) {
-    if (process->__fd >= 0) {
-      // Process descriptor is still open. Ask the kernel whether the
-      // process is still running.
-      cloudabi_subscription_t *sub;
-      if (!allocate_subscription(loop, &nsubscriptions, &sub))
-        return UV_ENOMEM;
-      *sub = (cloudabi_subscription_t){
-          .userdata = (uintptr_t)process,
-          .type = CLOUDABI_EVENTTYPE_PROC_TERMINATE,
-          .proc_terminate.fd = process->__fd,
-      };
-    } else {
-      // Process has been killed using uv_process_kill(). We can no
-      // longer poll on it, so generate a fictive SIGKILL event.
-      cloudabi_event_t *ev;
-      if (!allocate_event(loop, &nevents, &ev))
-        return UV_ENOMEM;
-      *ev = (cloudabi_event_t){
-          .userdata = (uintptr_t)process,
-          .type = CLOUDABI_EVENTTYPE_PROC_TERMINATE,
-          .proc_terminate.signal = SIGKILL,
-      };
-    }
-  }
-  FOREACH(uv_stream_t, stream, __uv_reading_streams, &loop->__reading_streams) {
-    cloudabi_subscription_t *sub;
-    if (!allocate_subscription(loop, &nsubscriptions, &sub))
-      return UV_ENOMEM;
-    *sub = (cloudabi_subscription_t){
-        .userdata = (uintptr_t)stream,
+  // Reserve space for the subscriptions that are only added for the
+  // duration of this call.
+  if (!__uv_subscriptions_reserve(loop, 2))
+    return UV_ENOMEM;
+
+  // Subscriptions for all of the active handles are already present.
+  // Keep track of how many of them have been modified since the
+  // previous call.
+  size_t nsubscriptions = loop->__subscriptions_count;
+  size_t rebuilt = loop->__subscriptions_modified < nsubscriptions
+                       ? loop->__subscriptions_modified
+                       : nsubscriptions;
+  loop->__subscriptions_rebuilt += rebuilt;
+  loop->__subscriptions_reused += nsubscriptions - rebuilt;
+  loop->__subscriptions_modified = 0;
+
+  cloudabi_subscription_t *subscriptions = loop->__subscriptions_buffer;
+  if (loop->__active_works > 0) {
+    // Requests are being processed by the thread pool. Wait for them to
+    // complete. As the pipe is not associated with a handle, the loop
+    // itself is used as the userdata.
+    subscriptions[nsubscriptions++] = (cloudabi_subscription_t){
+        .userdata = (uintptr_t)loop,
         .type = CLOUDABI_EVENTTYPE_FD_READ,
-        .fd_readwrite.fd = stream->__fd,
+        .fd_readwrite.fd = loop->__work_readfd,
         .fd_readwrite.flags = CLOUDABI_SUBSCRIPTION_FD_READWRITE_POLL,
     };
   }
-  FOREACH(uv_stream_t, stream, __uv_writing_streams, &loop->__writing_streams) {
-    cloudabi_subscription_t *sub;
-    if (!allocate_subscription(loop, &nsubscriptions, &sub))
-      return UV_ENOMEM;
-    *sub = (cloudabi_subscription_t){
-        .userdata = (uintptr_t)stream,
-        .type = CLOUDABI_EVENTTYPE_FD_WRITE,
-        .fd_readwrite.fd = stream->__fd,
-        .fd_readwrite.flags = CLOUDABI_SUBSCRIPTION_FD_READWRITE_POLL,
-    };
-  }
-#undef FOREACH
-
-  // If the loop above has already yielded events, then we should do a
-  // non-blocking poll to extend the results.
-  if (nevents > 0)
-    timeout = 0;
 
   // Add one extra subscription for the timeout, if any.
   if (timeout >= 0) {
-    cloudabi_subscription_t *sub;
-    if (!allocate_subscription(loop, &nsubscriptions, &sub))
-      return UV_ENOMEM;
     static const uv_handle_t inactive_handle = {};
-    *sub = (cloudabi_subscription_t){
+    subscriptions[nsubscriptions++] = (cloudabi_subscription_t){
         .userdata = (uintptr_t)&inactive_handle,
         .type = CLOUDABI_EVENTTYPE_CLOCK,
         .clock.clock_id = CLOUDABI_CLOCK_MONOTONIC,
@@ -477,9 +519,9 @@ static int do_poll(uv_loop_t *loop, int timeout) {
 
   // Grow the events buffer to match the number of subscriptions.
   // Otherwise we wouldn't be able to extract all triggering events.
-  if (loop->__events_capacity < nevents + nsubscriptions) {
+  if (loop->__events_capacity < nsubscriptions) {
     size_t capacity = 4;
-    while (capacity < nevents + nsubscriptions)
+    while (capacity < nsubscriptions)
       capacity *= 2;
     cloudabi_event_t *events =
         reallocarray(loop->__events_buffer, sizeof(cloudabi_event_t), capacity);
@@ -491,21 +533,24 @@ static int do_poll(uv_loop_t *loop, int timeout) {
 
   // Go to sleep.
   cloudabi_event_t *events = loop->__events_buffer;
+  size_t nevents;
   {
-    size_t ntriggered;
     cloudabi_errno_t error =
-        cloudabi_sys_poll(loop->__subscriptions_buffer, events + nevents,
-                          nsubscriptions, &ntriggered);
+        cloudabi_sys_poll(subscriptions, events, nsubscriptions, &nevents);
     if (error != 0)
       return -error;
-    nevents += ntriggered;
   }
 
   // uv_poll_t is implemented by registering multiple events. First
   // iterate over all of the triggered events to recombine multiple
   // events for the same poll object.
+  bool completed_works = false;
   for (size_t i = 0; i < nevents; ++i) {
     const cloudabi_event_t *event = &events[i];
+    if (event->userdata == (uintptr_t)loop) {
+      completed_works = true;
+      continue;
+    }
     uv_handle_t *handle = (uv_handle_t *)event->userdata;
     if (handle->type == UV_POLL) {
       switch (event->type) {
@@ -526,6 +571,8 @@ static int do_poll(uv_loop_t *loop, int timeout) {
   // callbacks in the same iteration.
   for (size_t i = 0; i < nevents; ++i) {
     const cloudabi_event_t *event = &events[i];
+    if (event->userdata == (uintptr_t)loop)
+      continue;
     uv_handle_t *handle = (uv_handle_t *)event->userdata;
     if (!uv_is_active(handle))
       continue;
@@ -540,7 +587,8 @@ static int do_poll(uv_loop_t *loop, int timeout) {
         __uv_poll_trigger((uv_poll_t *)handle);
         break;
       case UV_PROCESS: {
-        assert(event->type == CLOUDABI_EVENTTYPE_PROC_TERMINATE &&
+        assert((event->type == CLOUDABI_EVENTTYPE_PROC_TERMINATE ||
+                event->type == CLOUDABI_EVENTTYPE_CLOCK) &&
                "Unexpected event type");
         __uv_process_proc_terminate((uv_process_t *)handle, event);
         break;
@@ -560,10 +608,30 @@ static int do_poll(uv_loop_t *loop, int timeout) {
         }
         break;
       }
+      case UV_UDP: {
+        switch (event->type) {
+          case CLOUDABI_EVENTTYPE_FD_READ:
+            if (uv_udp_using_recvmmsg((uv_udp_t *)handle))
+              __uv_udp_fd_read_chunked((uv_udp_t *)handle, event);
+            else
+              __uv_udp_fd_read((uv_udp_t *)handle, event);
+            break;
+          case CLOUDABI_EVENTTYPE_FD_WRITE:
+            __uv_udp_fd_write((uv_udp_t *)handle, event);
+            break;
+          default:
+            assert(0 && "Unexpected event type");
+        }
+        break;
+      }
       default:
         assert(0 && "Unexpected handle type");
     }
   }
+
+  // Invoke callbacks of requests completed by the thread pool.
+  if (completed_works)
+    run_completed_works(loop);
   return 0;
 }
 
@@ -587,7 +655,9 @@ int uv_run(uv_loop_t *loop, uv_run_mode mode) {
       break;
 
     // "4. Pending callbacks are called."
-    // This implementation does not have any pending callbacks.
+    // The only pending callbacks are those of write and send requests
+    // that have completed without blocking.
+    run_pending_callbacks(loop);
 
     // "5. Idle handle callbacks are called."
     run_idles(loop);
@@ -607,6 +677,10 @@ int uv_run(uv_loop_t *loop, uv_run_mode mode) {
     run_checks(loop);
 
     // "10. Close callbacks are called."
+    // Invoke callbacks of requests that completed in the meantime
+    // first, so that they are called before the handle's close
+    // callback.
+    run_pending_callbacks(loop);
     run_closing_handles(loop);
 
     first_iteration = false;
@@ -0,0 +1,85 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <sys/socket.h>
+
+#include <unistd.h>
+#include <uv.h>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct Connection {
+  int fds[2];
+  uv_poll_t poll;
+  int calls;
+};
+
+void poll_cb(uv_poll_t *handle, int status, int events) {
+  ASSERT_EQ(0, status);
+  ASSERT_EQ(UV_READABLE, events);
+  ++static_cast<Connection *>(handle->data)->calls;
+}
+
+}  // namespace
+
+TEST(uv_run, subscriptions) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+
+  // Create a large number of idle connections.
+  Connection connections[64];
+  for (Connection &c : connections) {
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, c.fds));
+    ASSERT_EQ(0, uv_poll_init(&loop, &c.poll, c.fds[0]));
+    c.poll.data = &c;
+    c.calls = 0;
+    ASSERT_EQ(0, uv_poll_start(&c.poll, UV_READABLE, poll_cb));
+  }
+
+  // The first iteration needs to pick up all subscriptions. The second
+  // iteration should be able to reuse all of them.
+  uint64_t reused, rebuilt;
+  ASSERT_EQ(1, uv_run(&loop, UV_RUN_NOWAIT));
+  uv_loop_subscription_stats_np(&loop, &reused, &rebuilt);
+  ASSERT_EQ(0, reused);
+  ASSERT_EQ(64, rebuilt);
+  ASSERT_EQ(1, uv_run(&loop, UV_RUN_NOWAIT));
+  uv_loop_subscription_stats_np(&loop, &reused, &rebuilt);
+  ASSERT_EQ(64, reused);
+  ASSERT_EQ(64, rebuilt);
+
+  // Stopping a single connection should only cause the subscription of
+  // the last connection to be moved.
+  ASSERT_EQ(0, uv_poll_stop(&connections[10].poll));
+  ASSERT_EQ(1, uv_run(&loop, UV_RUN_NOWAIT));
+  uv_loop_subscription_stats_np(&loop, &reused, &rebuilt);
+  ASSERT_EQ(126, reused);
+  ASSERT_EQ(65, rebuilt);
+
+  // Events should be delivered to the right handles, even if their
+  // subscriptions have been moved.
+  for (int i : {0, 10, 30, 63})
+    ASSERT_EQ(1, write(connections[i].fds[1], "x", 1));
+  ASSERT_EQ(1, uv_run(&loop, UV_RUN_NOWAIT));
+  for (int i = 0; i < 64; ++i)
+    ASSERT_EQ(i == 0 || i == 30 || i == 63 ? 1 : 0, connections[i].calls);
+
+  // Restarting the connection should make it receive the pending event.
+  ASSERT_EQ(0, uv_poll_start(&connections[10].poll, UV_READABLE, poll_cb));
+  for (int i : {0, 30, 63})
+    ASSERT_EQ(0, uv_poll_stop(&connections[i].poll));
+  ASSERT_EQ(1, uv_run(&loop, UV_RUN_NOWAIT));
+  ASSERT_EQ(1, connections[10].calls);
+
+  for (Connection &c : connections)
+    uv_close(reinterpret_cast<uv_handle_t *>(&c.poll), [](uv_handle_t *) {});
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  for (Connection &c : connections) {
+    ASSERT_EQ(0, close(c.fds[0]));
+    ASSERT_EQ(0, close(c.fds[1]));
+  }
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
@@ -16,7 +16,9 @@ int uv_shutdown(uv_shutdown_t *req, uv_stream_t *handle, uv_shutdown_cb cb) {
   __uv_req_init((uv_req_t *)req, UV_SHUTDOWN);
 
   // Enqueue the shutdown request.
-  __uv_stream_start_writing(handle);
+  int error = __uv_stream_start_writing(handle);
+  if (error != 0)
+    return error;
   __uv_shutdowns_insert_last(&handle->__shutdown_queue, req);
   return 0;
 }
@@ -0,0 +1,49 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/uv.h>
+
+#include <assert.h>
+#include <cloudabi_syscalls.h>
+#include <limits.h>
+#include <stddef.h>
+#include <uv.h>
+
+cloudabi_errno_t __uv_stream_write(uv_stream_t *handle, const uv_buf_t *bufs,
+                                   size_t nbufs, uv_stream_t *send_handle,
+                                   size_t *nwritten) {
+  // This code assumes uv_buf_t and cloudabi_ciovec_t are identical.
+  static_assert(offsetof(cloudabi_ciovec_t, buf) == offsetof(uv_buf_t, base),
+                "Offset mismatch");
+  static_assert(
+      sizeof(((cloudabi_ciovec_t *)0)->buf) == sizeof(((uv_buf_t *)0)->base),
+      "Size mismatch");
+  static_assert(offsetof(cloudabi_ciovec_t, buf_len) == offsetof(uv_buf_t, len),
+                "Offset mismatch");
+  static_assert(
+      sizeof(((cloudabi_ciovec_t *)0)->buf_len) == sizeof(((uv_buf_t *)0)->len),
+      "Size mismatch");
+  static_assert(sizeof(cloudabi_ciovec_t) == sizeof(uv_buf_t), "Size mismatch");
+
+  // Be conservative by limiting the number of iovecs to _XOPEN_IOV_MAX,
+  // as more may cause the write call to fail.
+  const cloudabi_ciovec_t *iov = (const cloudabi_ciovec_t *)bufs;
+  size_t niov = nbufs < _XOPEN_IOV_MAX ? nbufs : _XOPEN_IOV_MAX;
+  if (send_handle == NULL)
+    return cloudabi_sys_fd_write(handle->__fd, iov, niov, nwritten);
+
+  // Send file descriptor across.
+  assert(send_handle->__fd >= 0 && "Invalid stream");
+  cloudabi_fd_t fd = send_handle->__fd;
+  cloudabi_send_in_t si = {
+      .si_data = iov,
+      .si_data_len = niov,
+      .si_fds = &fd,
+      .si_fds_len = 1,
+  };
+  cloudabi_send_out_t so;
+  cloudabi_errno_t error = cloudabi_sys_sock_send(handle->__fd, &si, &so);
+  *nwritten = so.so_datalen;
+  return error;
+}
@@ -0,0 +1,254 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/crt.h>
+#include <common/uv.h>
+
+#include <cloudabi_types.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <uv.h>
+
+// Thread pool for work requests.
+//
+// The thread pool is shared by all event loops in the process and is
+// only started when the first request is submitted. Every worker
+// thread owns a queue of requests. Requests are distributed over these
+// queues in a round-robin fashion. Workers process requests from the
+// front of their own queue and steal requests from the back of the
+// queues of other workers once their own queue runs dry.
+//
+// Requests remain in the queue in which they have been placed until
+// they are picked up, meaning that uv_cancel() only needs to acquire
+// the lock of a single queue.
+//
+// The number of worker threads is equal to the number of CPUs. It can
+// be overridden by calling uv_threadpool_set_size_np() before the
+// thread pool is started.
+
+#define MAX_THREADPOOL_SIZE 128
+
+struct worker {
+  pthread_mutex_t lock;
+  struct __uv_works_head queue;
+};
+
+// Worker threads and their queues.
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct worker *workers;
+static size_t workers_capacity;
+static atomic_size_t workers_count;
+
+// Number of worker threads to start. Zero if it should be equal to the
+// number of CPUs.
+static size_t threadpool_size __guarded_by(pool_lock);
+
+// Queue selection for new requests.
+static atomic_size_t next_worker;
+
+// Number of requests stored in queues and the number of workers that
+// are sleeping until new requests arrive.
+static atomic_size_t pending_works;
+static atomic_size_t idle_workers;
+static pthread_cond_t idle_cond = PTHREAD_COND_INITIALIZER;
+
+// Reports completion of a request to the loop that submitted it.
+static void complete_work(uv_work_t *req, int status) {
+  uv_loop_t *loop = req->loop;
+  req->__work_status = status;
+
+  // Only wake up the loop if no other requests have completed since
+  // the loop last looked at the queue. The write to the pipe is
+  // performed while holding the lock, as the loop may otherwise
+  // already be closed by the time the write takes place.
+  pthread_mutex_lock(&loop->__work_lock);
+  if (__uv_works_empty(&loop->__completed_works))
+    __uv_wakeup_pipe_send(loop->__work_writefd);
+  __uv_works_insert_last(&loop->__completed_works, req);
+  pthread_mutex_unlock(&loop->__work_lock);
+}
+
+// Extracts a request from the front of the worker's own queue or from
+// the back of the queue of another worker.
+static uv_work_t *take_work(size_t self) {
+  size_t count = atomic_load_explicit(&workers_count, memory_order_acquire);
+  if (count <= self)
+    count = self + 1;
+  for (size_t i = 0; i < count; ++i) {
+    struct worker *worker = &workers[(self + i) % count];
+    pthread_mutex_lock(&worker->lock);
+    if (!__uv_works_empty(&worker->queue)) {
+      uv_work_t *req = i == 0 ? __uv_works_first(&worker->queue)
+                              : __uv_works_last(&worker->queue);
+      __uv_works_remove(req);
+      req->__work_state = UV_WORK_RUNNING;
+      atomic_fetch_sub(&pending_works, 1);
+      pthread_mutex_unlock(&worker->lock);
+      return req;
+    }
+    pthread_mutex_unlock(&worker->lock);
+  }
+  return NULL;
+}
+
+static void *worker_main(void *arg) {
+  size_t self = (struct worker *)arg - workers;
+  for (;;) {
+    uv_work_t *req = take_work(self);
+    if (req != NULL) {
+      req->__work_cb(req);
+      complete_work(req, 0);
+    } else {
+      // No requests available. Go to sleep until new requests are
+      // submitted. The idle counter is incremented before inspecting
+      // the number of pending requests, so that a request submitted in
+      // the meantime either gets observed here or causes a wakeup.
+      pthread_mutex_lock(&pool_lock);
+      atomic_fetch_add(&idle_workers, 1);
+      while (atomic_load(&pending_works) == 0)
+        pthread_cond_wait(&idle_cond, &pool_lock);
+      atomic_fetch_sub(&idle_workers, 1);
+      pthread_mutex_unlock(&pool_lock);
+    }
+  }
+}
+
+static size_t get_threadpool_size(void) __requires_exclusive(pool_lock) {
+  if (threadpool_size > 0)
+    return threadpool_size;
+  if (__at_ncpus < 1)
+    return 1;
+  if (__at_ncpus > MAX_THREADPOOL_SIZE)
+    return MAX_THREADPOOL_SIZE;
+  return __at_ncpus;
+}
+
+int uv_threadpool_set_size_np(size_t size) {
+  if (size < 1 || size > MAX_THREADPOOL_SIZE)
+    return UV_EINVAL;
+
+  // The size can no longer be adjusted once the thread pool is started.
+  pthread_mutex_lock(&pool_lock);
+  if (workers != NULL) {
+    pthread_mutex_unlock(&pool_lock);
+    return UV_EBUSY;
+  }
+  threadpool_size = size;
+  pthread_mutex_unlock(&pool_lock);
+  return 0;
+}
+
+// Starts the worker threads, returning the number of threads running.
+static int start_threadpool(size_t *count) {
+  pthread_mutex_lock(&pool_lock);
+  if (workers == NULL) {
+    size_t capacity = get_threadpool_size();
+    struct worker *new_workers = calloc(capacity, sizeof(*new_workers));
+    if (new_workers == NULL) {
+      pthread_mutex_unlock(&pool_lock);
+      return UV_ENOMEM;
+    }
+    for (size_t i = 0; i < capacity; ++i) {
+      pthread_mutex_init(&new_workers[i].lock, NULL);
+      __uv_works_init(&new_workers[i].queue);
+    }
+    workers = new_workers;
+    workers_capacity = capacity;
+  }
+
+  // Spawn the threads. If we fail to spawn all of them, continue with
+  // the threads that we have. Workers already running may use their
+  // own queue before the count is updated.
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  size_t started = atomic_load_explicit(&workers_count, memory_order_relaxed);
+  int error = 0;
+  while (started < workers_capacity) {
+    pthread_t thread;
+    error = pthread_create(&thread, &attr, worker_main, &workers[started]);
+    if (error != 0)
+      break;
+    atomic_store_explicit(&workers_count, ++started, memory_order_release);
+  }
+  pthread_attr_destroy(&attr);
+  pthread_mutex_unlock(&pool_lock);
+
+  *count = started;
+  return started > 0 ? 0 : -error;
+}
+
+int __uv_work_submit(uv_loop_t *loop, uv_work_t *req,
+                     void (*work_cb)(uv_work_t *),
+                     void (*after_work_cb)(uv_work_t *, int)) {
+  // Lazily create the pipe used to report completion to the loop.
+  if (loop->__work_readfd < 0) {
+    cloudabi_fd_t readfd, writefd;
+    int error = __uv_wakeup_pipe_create(&readfd, &writefd);
+    if (error != 0)
+      return error;
+    loop->__work_readfd = readfd;
+    loop->__work_writefd = writefd;
+  }
+
+  // Lazily start the thread pool.
+  size_t count = atomic_load_explicit(&workers_count, memory_order_acquire);
+  if (count == 0) {
+    int error = start_threadpool(&count);
+    if (error != 0)
+      return error;
+  }
+
+  req->loop = loop;
+  req->__work_cb = work_cb;
+  req->__after_work_cb = after_work_cb;
+  ++loop->__active_works;
+  ++loop->__active_ref_handles_reqs;
+
+  // Place the request in the queue of one of the workers.
+  size_t index = atomic_fetch_add_explicit(&next_worker, 1,
+                                           memory_order_relaxed) %
+                 count;
+  struct worker *worker = &workers[index];
+  req->__work_queue = index;
+  pthread_mutex_lock(&worker->lock);
+  req->__work_state = UV_WORK_QUEUED;
+  __uv_works_insert_last(&worker->queue, req);
+  atomic_fetch_add(&pending_works, 1);
+  pthread_mutex_unlock(&worker->lock);
+
+  // Wake up one of the workers if any of them are sleeping.
+  if (atomic_load(&idle_workers) > 0) {
+    pthread_mutex_lock(&pool_lock);
+    pthread_cond_signal(&idle_cond);
+    pthread_mutex_unlock(&pool_lock);
+  }
+  return 0;
+}
+
+int __uv_work_cancel(uv_work_t *req) {
+  // Requests can only be canceled if they haven't been picked up by a
+  // worker yet. Requests that have never been queued, such as
+  // synchronous file system requests, do not refer to a queue. The
+  // state is checked again while holding the lock of the queue, as a
+  // worker may pick up the request in the meantime.
+  if (workers == NULL || req->__work_state != UV_WORK_QUEUED)
+    return UV_EBUSY;
+  struct worker *worker = &workers[req->__work_queue];
+  pthread_mutex_lock(&worker->lock);
+  if (req->__work_state != UV_WORK_QUEUED) {
+    pthread_mutex_unlock(&worker->lock);
+    return UV_EBUSY;
+  }
+  __uv_works_remove(req);
+  req->__work_state = UV_WORK_CANCELED;
+  atomic_fetch_sub(&pending_works, 1);
+  pthread_mutex_unlock(&worker->lock);
+
+  complete_work(req, UV_ECANCELED);
+  return 0;
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <stdint.h>
+#include <uv.h>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct state {
+  uv_sem_t started;
+  uv_sem_t release;
+  bool second_ran;
+};
+
+}  // namespace
+
+static void first_work_cb(uv_work_t *req) {
+  state *s = static_cast<state *>(req->data);
+  uv_sem_post(&s->started);
+  uv_sem_wait(&s->release);
+}
+
+static void second_work_cb(uv_work_t *req) {
+  static_cast<state *>(req->data)->second_ran = true;
+}
+
+static void after_work_cb(uv_work_t *req, int status) {
+  ASSERT_EQ(0, status);
+}
+
+TEST(uv_threadpool_set_size_np, example) {
+  ASSERT_EQ(UV_EINVAL, uv_threadpool_set_size_np(0));
+  ASSERT_EQ(UV_EINVAL, uv_threadpool_set_size_np(SIZE_MAX));
+  ASSERT_EQ(0, uv_threadpool_set_size_np(1));
+
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+  state s;
+  ASSERT_EQ(0, uv_sem_init(&s.started, 0));
+  ASSERT_EQ(0, uv_sem_init(&s.release, 0));
+  s.second_ran = false;
+
+  // With a single worker thread, the second request cannot be
+  // processed while the first one is blocked.
+  uv_work_t first, second;
+  first.data = &s;
+  second.data = &s;
+  ASSERT_EQ(0, uv_queue_work(&loop, &first, first_work_cb, after_work_cb));
+  ASSERT_EQ(0, uv_queue_work(&loop, &second, second_work_cb, after_work_cb));
+  uv_sem_wait(&s.started);
+  ASSERT_FALSE(s.second_ran);
+
+  // The size can no longer be adjusted after the thread pool is started.
+  ASSERT_EQ(UV_EBUSY, uv_threadpool_set_size_np(2));
+
+  uv_sem_post(&s.release);
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_TRUE(s.second_ran);
+  ASSERT_EQ(0, uv_loop_close(&loop));
+  uv_sem_destroy(&s.started);
+  uv_sem_destroy(&s.release);
+}
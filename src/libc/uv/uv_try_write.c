@@ -2,10 +2,32 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <common/uv.h>
+
+#include <cloudabi_syscalls.h>
 #include <uv.h>
 
 int uv_try_write(uv_stream_t *handle, const uv_buf_t *bufs,
                  unsigned int nbufs) {
-  // TODO(ed): Implement!
-  return UV_ENOSYS;
+  if (handle->__fd < 0)
+    return UV_EBADF;
+
+  // Writing data now would cause it to be reordered with respect to
+  // data that is still queued.
+  if (!__uv_shutdowns_empty(&handle->__shutdown_queue) ||
+      !__uv_writes_empty(&handle->__write_queue))
+    return UV_EAGAIN;
+
+  size_t nwritten;
+  cloudabi_errno_t error =
+      __uv_stream_write(handle, bufs, nbufs, NULL, &nwritten);
+  if (error != 0)
+    return -error;
+  if (nwritten == 0) {
+    // Nothing could be written without blocking.
+    for (unsigned int i = 0; i < nbufs; ++i)
+      if (bufs[i].len > 0)
+        return UV_EAGAIN;
+  }
+  return nwritten;
 }
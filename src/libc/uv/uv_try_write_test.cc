@@ -0,0 +1,69 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <uv.h>
+
+#include "gtest/gtest.h"
+
+static void write_cb(uv_write_t *req, int status) {
+  ASSERT_EQ(0, status);
+  ++*static_cast<int *>(req->data);
+}
+
+TEST(uv_try_write, example) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+
+  // Stream that isn't opened.
+  uv_pipe_t out;
+  ASSERT_EQ(0, uv_pipe_init(&loop, &out, 0));
+  uv_buf_t buf = uv_buf_init((char *)"Hello", 5);
+  ASSERT_EQ(UV_EBADF, uv_try_write((uv_stream_t *)&out, &buf, 1));
+
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  ASSERT_EQ(0, uv_pipe_open(&out, fds[1]));
+
+  // Data should be written immediately.
+  uv_buf_t bufs[2] = {
+      uv_buf_init((char *)"Hello, ", 7),
+      uv_buf_init((char *)"world", 5),
+  };
+  ASSERT_EQ(12, uv_try_write((uv_stream_t *)&out, bufs, 2));
+  char data[13];
+  ASSERT_EQ(12, read(fds[0], data, sizeof(data)));
+  ASSERT_EQ(0, memcmp(data, "Hello, world", 12));
+  ASSERT_EQ(0, uv_try_write((uv_stream_t *)&out, nullptr, 0));
+
+  // Fill up the pipe. Writes should fail with EAGAIN once full.
+  static char large[65536];
+  buf = uv_buf_init(large, sizeof(large));
+  int written;
+  while ((written = uv_try_write((uv_stream_t *)&out, &buf, 1)) > 0) {
+  }
+  ASSERT_EQ(UV_EAGAIN, written);
+
+  // Queue a write request. uv_try_write() may not cause data to be
+  // reordered, even if the pipe becomes writable again.
+  uv_write_t req;
+  int calls = 0;
+  req.data = &calls;
+  buf = uv_buf_init((char *)"Hello", 5);
+  ASSERT_EQ(0, uv_write(&req, (uv_stream_t *)&out, &buf, 1, write_cb));
+  ASSERT_EQ(0, fcntl(fds[0], F_SETFL, O_NONBLOCK));
+  while (read(fds[0], large, sizeof(large)) > 0) {
+  }
+  ASSERT_EQ(UV_EAGAIN, uv_try_write((uv_stream_t *)&out, &buf, 1));
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(1, calls);
+  ASSERT_EQ(5, uv_try_write((uv_stream_t *)&out, &buf, 1));
+
+  uv_close((uv_handle_t *)&out, [](uv_handle_t *) {});
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(0, close(fds[0]));
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
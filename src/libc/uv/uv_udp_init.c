@@ -2,9 +2,10 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <sys/socket.h>
+
 #include <uv.h>
 
 int uv_udp_init(uv_loop_t *loop, uv_udp_t *handle) {
-  // TODO(ed): Implement.
-  return UV_ENOSYS;
+  return uv_udp_init_ex(loop, handle, AF_UNSPEC);
 }
@@ -2,9 +2,25 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <common/uv.h>
+
+#include <stddef.h>
 #include <uv.h>
 
 int uv_udp_init_ex(uv_loop_t *loop, uv_udp_t *handle, unsigned int flags) {
-  // TODO(ed): Implement.
-  return UV_ENOSYS;
+  // The lower eight bits contain the address family of the socket to
+  // create. Sockets cannot be created in this environment, so it is
+  // ignored, like uv_tcp_init_ex() does.
+  if ((flags & ~0xff & ~UV_UDP_RECVMMSG) != 0)
+    return UV_EINVAL;
+
+  __uv_handle_init(loop, (uv_handle_t *)handle, UV_UDP);
+  handle->send_queue_size = 0;
+  handle->send_queue_count = 0;
+
+  handle->__fd = -1;
+  handle->__flags = flags & UV_UDP_RECVMMSG;
+  handle->__recv_cb = NULL;
+  __uv_udp_sends_init(&handle->__send_queue);
+  return 0;
 }
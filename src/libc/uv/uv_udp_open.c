@@ -2,9 +2,16 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <common/uv.h>
+
 #include <uv.h>
 
 int uv_udp_open(uv_udp_t *handle, uv_os_sock_t sock) {
-  // TODO(ed): Implement.
-  return UV_ENOSYS;
+  if (handle->__fd >= 0)
+    return UV_EBUSY;
+  int error = __uv_set_nonblocking(sock);
+  if (error != 0)
+    return error;
+  handle->__fd = sock;
+  return 0;
 }
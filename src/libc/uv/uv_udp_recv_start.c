@@ -2,10 +2,23 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <common/uv.h>
+
+#include <stddef.h>
 #include <uv.h>
 
 int uv_udp_recv_start(uv_udp_t *handle, uv_alloc_cb alloc_cb,
                       uv_udp_recv_cb recv_cb) {
-  // TODO(ed): Implement.
-  return UV_ENOSYS;
+  if (alloc_cb == NULL || recv_cb == NULL)
+    return UV_EINVAL;
+  if (handle->__fd < 0)
+    return UV_EBADF;
+  if (handle->__recv_cb != NULL)
+    return UV_EALREADY;
+  int error = __uv_udp_start_receiving(handle);
+  if (error != 0)
+    return error;
+  handle->__alloc_cb = alloc_cb;
+  handle->__recv_cb = recv_cb;
+  return 0;
 }
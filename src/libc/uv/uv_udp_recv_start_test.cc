@@ -0,0 +1,141 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <sys/socket.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <uv.h>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct State {
+  std::vector<std::string> datagrams;
+  int empty;
+  int allocs;
+  int frees;
+};
+
+void alloc_cb(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
+  ++static_cast<State *>(handle->data)->allocs;
+  *buf = uv_buf_init(static_cast<char *>(malloc(suggested_size)),
+                     suggested_size);
+}
+
+void recv_cb(uv_udp_t *handle, ssize_t nread, const uv_buf_t *buf,
+             const struct sockaddr *addr, unsigned int flags) {
+  auto state = static_cast<State *>(handle->data);
+  ASSERT_LE(0, nread);
+  if (addr == nullptr) {
+    ASSERT_EQ(0, nread);
+    ++state->empty;
+  } else {
+    ASSERT_EQ(AF_UNSPEC, addr->sa_family);
+    state->datagrams.emplace_back(buf->base, nread);
+  }
+  if ((flags & UV_UDP_MMSG_CHUNK) == 0) {
+    ++state->frees;
+    free(buf->base);
+  }
+}
+
+void close_cb(uv_handle_t *handle) {
+}
+
+}  // namespace
+
+TEST(uv_udp_recv_start, bad) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+  uv_udp_t udp;
+  ASSERT_EQ(0, uv_udp_init(&loop, &udp));
+  ASSERT_EQ(UV_EBADF, uv_udp_recv_start(&udp, alloc_cb, recv_cb));
+  ASSERT_EQ(UV_EINVAL, uv_udp_recv_start(&udp, nullptr, recv_cb));
+  uv_close((uv_handle_t *)&udp, close_cb);
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
+
+TEST(uv_udp_recv_start, example) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM, 0, fds));
+  uv_udp_t udp;
+  ASSERT_EQ(0, uv_udp_init(&loop, &udp));
+  ASSERT_EQ(0, uv_udp_open(&udp, fds[0]));
+  ASSERT_FALSE(uv_udp_using_recvmmsg(&udp));
+  State state = {};
+  udp.data = &state;
+  ASSERT_EQ(0, uv_udp_recv_start(&udp, alloc_cb, recv_cb));
+  ASSERT_EQ(UV_EALREADY, uv_udp_recv_start(&udp, alloc_cb, recv_cb));
+
+  // Send more datagrams than can be processed in a single iteration.
+  for (int i = 0; i < 25; ++i) {
+    std::string datagram = "Datagram " + std::to_string(i);
+    ASSERT_EQ(datagram.size(), write(fds[1], datagram.data(), datagram.size()));
+  }
+  ASSERT_EQ(0, write(fds[1], "", 0));
+
+  // The first iteration should receive twenty datagrams.
+  ASSERT_EQ(1, uv_run(&loop, UV_RUN_NOWAIT));
+  ASSERT_EQ(20, state.datagrams.size());
+  ASSERT_EQ(0, state.empty);
+  ASSERT_EQ(1, uv_run(&loop, UV_RUN_NOWAIT));
+  ASSERT_EQ(26, state.datagrams.size());
+  ASSERT_EQ(1, state.empty);
+  for (int i = 0; i < 25; ++i)
+    ASSERT_EQ("Datagram " + std::to_string(i), state.datagrams[i]);
+  ASSERT_EQ("", state.datagrams[25]);
+  ASSERT_EQ(state.allocs, state.frees);
+
+  ASSERT_EQ(0, uv_udp_recv_stop(&udp));
+  uv_close((uv_handle_t *)&udp, close_cb);
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(0, close(fds[1]));
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
+
+TEST(uv_udp_recv_start, recvmmsg) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM, 0, fds));
+  uv_udp_t udp;
+  ASSERT_EQ(0, uv_udp_init_ex(&loop, &udp, AF_UNSPEC | UV_UDP_RECVMMSG));
+  ASSERT_EQ(0, uv_udp_open(&udp, fds[0]));
+  ASSERT_TRUE(uv_udp_using_recvmmsg(&udp));
+  State state = {};
+  udp.data = &state;
+  ASSERT_EQ(0, uv_udp_recv_start(&udp, alloc_cb, recv_cb));
+
+  for (int i = 0; i < 25; ++i) {
+    std::string datagram = "Datagram " + std::to_string(i);
+    ASSERT_EQ(datagram.size(), write(fds[1], datagram.data(), datagram.size()));
+  }
+
+  // Datagrams should be received into a single buffer.
+  ASSERT_EQ(1, uv_run(&loop, UV_RUN_NOWAIT));
+  ASSERT_EQ(20, state.datagrams.size());
+  ASSERT_EQ(1, state.allocs);
+  ASSERT_EQ(1, state.frees);
+  ASSERT_EQ(1, state.empty);
+  ASSERT_EQ(1, uv_run(&loop, UV_RUN_NOWAIT));
+  ASSERT_EQ(25, state.datagrams.size());
+  for (int i = 0; i < 25; ++i)
+    ASSERT_EQ("Datagram " + std::to_string(i), state.datagrams[i]);
+  ASSERT_EQ(state.allocs, state.frees);
+
+  uv_close((uv_handle_t *)&udp, close_cb);
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(0, close(fds[1]));
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
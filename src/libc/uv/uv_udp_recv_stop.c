@@ -2,9 +2,15 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include <common/uv.h>
+
+#include <stddef.h>
 #include <uv.h>
 
 int uv_udp_recv_stop(uv_udp_t *handle) {
-  // TODO(ed): Implement.
-  return UV_ENOSYS;
+  if (handle->__recv_cb != NULL) {
+    handle->__recv_cb = NULL;
+    __uv_udp_stop_receiving(handle);
+  }
+  return 0;
 }
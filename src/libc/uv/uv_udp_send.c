@@ -0,0 +1,67 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/uv.h>
+
+#include <cloudabi_syscalls.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uv.h>
+
+int uv_udp_send(uv_udp_send_t *req, uv_udp_t *handle, const uv_buf_t *bufs,
+                unsigned int nbufs, const struct sockaddr *addr,
+                uv_udp_send_cb cb) {
+  // Sockets cannot be bound or connected to addresses in this
+  // environment. Datagrams can only be sent over connected sockets.
+  if (handle->__fd < 0)
+    return UV_EBADF;
+  if (addr != NULL)
+    return UV_EISCONN;
+  if (nbufs > _XOPEN_IOV_MAX)
+    return UV_EMSGSIZE;
+
+  // Initialize the send request.
+  req->handle = handle;
+  req->__cb = cb;
+  __uv_req_init((uv_req_t *)req, UV_UDP_SEND);
+
+  // Allocate storage for the buffers upfront, so that no errors can
+  // occur after the datagram has been sent. Small numbers of buffers
+  // fit in the request itself.
+  if (nbufs <= __arraycount(req->__bufsml)) {
+    req->__bufs = req->__bufsml;
+  } else {
+    req->__bufs = reallocarray(NULL, sizeof(uv_buf_t), nbufs);
+    if (req->__bufs == NULL)
+      return UV_ENOMEM;
+  }
+  if (!__uv_subscriptions_reserve(handle->loop, 1)) {
+    __uv_udp_send_free_bufs(req);
+    return UV_ENOMEM;
+  }
+
+  // If no other datagrams are queued, attempt to send the datagram
+  // immediately. The callback is still invoked from within the loop.
+  if (__uv_udp_sends_empty(&handle->__send_queue)) {
+    cloudabi_errno_t error = __uv_udp_send_datagram(handle, bufs, nbufs);
+    if (error != CLOUDABI_EAGAIN) {
+      __uv_udp_send_free_bufs(req);
+      req->__bufs = NULL;
+      req->__nbufs = 0;
+      __uv_udp_send_complete(req, -error);
+      return 0;
+    }
+    __uv_udp_start_sending(handle);
+  }
+
+  // Enqueue the send request.
+  memcpy(req->__bufs, bufs, sizeof(uv_buf_t) * nbufs);
+  req->__nbufs = nbufs;
+  __uv_udp_sends_insert_last(&handle->__send_queue, req);
+  for (unsigned int i = 0; i < nbufs; ++i)
+    handle->send_queue_size += bufs[i].len;
+  ++handle->send_queue_count;
+  return 0;
+}
@@ -0,0 +1,115 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <sys/socket.h>
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <uv.h>
+
+#include "gtest/gtest.h"
+
+static void send_cb(uv_udp_send_t *req, int status) {
+  ASSERT_EQ(0, status);
+  ++*static_cast<int *>(req->data);
+}
+
+static void send_cb_canceled(uv_udp_send_t *req, int status) {
+  ASSERT_EQ(UV_ECANCELED, status);
+  ++*static_cast<int *>(req->data);
+}
+
+static void close_cb(uv_handle_t *handle) {
+}
+
+TEST(uv_udp_send, immediate) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM, 0, fds));
+  uv_udp_t udp;
+  ASSERT_EQ(0, uv_udp_init(&loop, &udp));
+  ASSERT_EQ(0, uv_udp_open(&udp, fds[0]));
+
+  // Datagrams should be sent immediately, but the callback should only
+  // be invoked by the loop.
+  uv_buf_t bufs[2] = {
+      uv_buf_init((char *)"Hello, ", 7),
+      uv_buf_init((char *)"world", 5),
+  };
+  uv_udp_send_t req;
+  int calls = 0;
+  req.data = &calls;
+  ASSERT_EQ(0, uv_udp_send(&req, &udp, bufs, 2, nullptr, send_cb));
+  ASSERT_EQ(UV_UDP_SEND, req.type);
+  ASSERT_EQ(0, udp.send_queue_count);
+  char buf[13];
+  ASSERT_EQ(12, read(fds[1], buf, sizeof(buf)));
+  ASSERT_EQ(0, memcmp(buf, "Hello, world", 12));
+  ASSERT_EQ(0, calls);
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(1, calls);
+
+  uv_close((uv_handle_t *)&udp, close_cb);
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(0, close(fds[1]));
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
+
+TEST(uv_udp_send, queued) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM, 0, fds));
+  uv_udp_t udp;
+  ASSERT_EQ(0, uv_udp_init(&loop, &udp));
+  ASSERT_EQ(0, uv_udp_open(&udp, fds[0]));
+
+  // Fill up the socket buffer.
+  static char large[1024];
+  uv_buf_t buf = uv_buf_init(large, sizeof(large));
+  int sent;
+  while ((sent = uv_udp_try_send(&udp, &buf, 1, nullptr)) > 0) {
+  }
+  ASSERT_EQ(UV_EAGAIN, sent);
+
+  // Datagrams should now be queued.
+  uv_udp_send_t reqs[10];
+  int calls = 0;
+  for (uv_udp_send_t &req : reqs) {
+    req.data = &calls;
+    ASSERT_EQ(0, uv_udp_send(&req, &udp, &buf, 1, nullptr, send_cb));
+  }
+  ASSERT_EQ(10, udp.send_queue_count);
+  ASSERT_EQ(10 * sizeof(large), udp.send_queue_size);
+  ASSERT_EQ(1, uv_run(&loop, UV_RUN_NOWAIT));
+  ASSERT_EQ(0, calls);
+
+  // Draining the socket should allow the datagrams to be sent.
+  ASSERT_EQ(0, fcntl(fds[1], F_SETFL, O_NONBLOCK));
+  while (calls < 10) {
+    while (read(fds[1], large, sizeof(large)) > 0) {
+    }
+    uv_run(&loop, UV_RUN_NOWAIT);
+  }
+  ASSERT_EQ(0, udp.send_queue_count);
+  ASSERT_EQ(0, udp.send_queue_size);
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+
+  // Datagrams that are still queued when closing should be canceled.
+  while (uv_udp_try_send(&udp, &buf, 1, nullptr) > 0) {
+  }
+  uv_udp_send_t req;
+  req.data = &calls;
+  ASSERT_EQ(0, uv_udp_send(&req, &udp, &buf, 1, nullptr, send_cb_canceled));
+  uv_close((uv_handle_t *)&udp, close_cb);
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(11, calls);
+
+  ASSERT_EQ(0, close(fds[1]));
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
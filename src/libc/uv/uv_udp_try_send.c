@@ -0,0 +1,31 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <common/uv.h>
+
+#include <cloudabi_syscalls.h>
+#include <limits.h>
+#include <uv.h>
+
+int uv_udp_try_send(uv_udp_t *handle, const uv_buf_t *bufs,
+                    unsigned int nbufs, const struct sockaddr *addr) {
+  if (handle->__fd < 0)
+    return UV_EBADF;
+  if (addr != NULL)
+    return UV_EISCONN;
+  if (nbufs > _XOPEN_IOV_MAX)
+    return UV_EMSGSIZE;
+
+  // Datagrams may not be reordered with respect to queued datagrams.
+  if (!__uv_udp_sends_empty(&handle->__send_queue))
+    return UV_EAGAIN;
+
+  cloudabi_errno_t error = __uv_udp_send_datagram(handle, bufs, nbufs);
+  if (error != 0)
+    return -error;
+  size_t size = 0;
+  for (unsigned int i = 0; i < nbufs; ++i)
+    size += bufs[i].len;
+  return size;
+}
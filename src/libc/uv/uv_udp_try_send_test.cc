@@ -0,0 +1,50 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <sys/socket.h>
+
+#include <netinet/in.h>
+
+#include <string.h>
+#include <unistd.h>
+#include <uv.h>
+
+#include "gtest/gtest.h"
+
+static void close_cb(uv_handle_t *handle) {
+}
+
+TEST(uv_udp_try_send, example) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+  uv_udp_t udp;
+  ASSERT_EQ(0, uv_udp_init(&loop, &udp));
+
+  uv_buf_t bufs[2] = {
+      uv_buf_init((char *)"Hello, ", 7),
+      uv_buf_init((char *)"world", 5),
+  };
+  ASSERT_EQ(UV_EBADF, uv_udp_try_send(&udp, bufs, 2, nullptr));
+
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM, 0, fds));
+  ASSERT_EQ(0, uv_udp_open(&udp, fds[0]));
+
+  // Addresses cannot be used.
+  struct sockaddr_in sin;
+  ASSERT_EQ(0, uv_ip4_addr("127.0.0.1", 1234, &sin));
+  ASSERT_EQ(UV_EISCONN,
+            uv_udp_try_send(&udp, bufs, 2, (struct sockaddr *)&sin));
+
+  // Buffers should be combined into a single datagram.
+  ASSERT_EQ(12, uv_udp_try_send(&udp, bufs, 2, nullptr));
+  char buf[13];
+  ASSERT_EQ(12, read(fds[1], buf, sizeof(buf)));
+  ASSERT_EQ(0, memcmp(buf, "Hello, world", 12));
+
+  uv_close((uv_handle_t *)&udp, close_cb);
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(0, close(fds[1]));
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}
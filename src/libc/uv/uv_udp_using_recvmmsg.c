@@ -0,0 +1,9 @@
+// Copyright (c) 2019 Nuxi, https://nuxi.nl/
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <uv.h>
+
+int uv_udp_using_recvmmsg(const uv_udp_t *handle) {
+  return (handle->__flags & UV_UDP_RECVMMSG) != 0;
+}
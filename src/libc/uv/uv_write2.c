@@ -4,6 +4,7 @@
 
 #include <common/uv.h>
 
+#include <cloudabi_syscalls.h>
 #include <stdlib.h>
 #include <string.h>
 #include <uv.h>
@@ -27,16 +28,61 @@ int uv_write2(uv_write_t *req, uv_stream_t *handle, const uv_buf_t *bufs,
   // Initialize the write request.
   req->handle = handle;
   req->send_handle = send_handle;
-  req->__bufs = reallocarray(NULL, sizeof(uv_buf_t), nbufs);
-  if (req->__bufs == NULL)
+  req->__cb = cb;
+  __uv_req_init((uv_req_t *)req, UV_WRITE);
+
+  // Allocate storage for the buffers upfront, so that no errors can
+  // occur after data has been written. Small numbers of buffers fit in
+  // the request itself.
+  if (nbufs <= __arraycount(req->__bufsml)) {
+    req->__bufs = req->__bufsml;
+  } else {
+    req->__bufs = reallocarray(NULL, sizeof(uv_buf_t), nbufs);
+    if (req->__bufs == NULL)
+      return UV_ENOMEM;
+  }
+  if (!__uv_subscriptions_reserve(handle->loop, 1)) {
+    __uv_write_free_bufs(req);
     return UV_ENOMEM;
+  }
+
+  // If no other writes are pending, attempt to write the data
+  // immediately. This saves a round trip through the event loop for
+  // streams that are writable, which is the common case.
+  size_t skip = 0;
+  if (__uv_shutdowns_empty(&handle->__shutdown_queue) &&
+      __uv_writes_empty(&handle->__write_queue)) {
+    size_t nwritten;
+    cloudabi_errno_t error =
+        __uv_stream_write(handle, bufs, nbufs, send_handle, &nwritten);
+    if (error == 0) {
+      req->send_handle = NULL;
+      while (nbufs > 0 && nwritten >= bufs->len) {
+        nwritten -= bufs->len;
+        ++bufs;
+        --nbufs;
+      }
+      skip = nwritten;
+    }
+    if (nbufs == 0 || (error != 0 && error != CLOUDABI_EAGAIN)) {
+      // Write completed or failed. The callback still needs to be
+      // invoked from within the event loop.
+      __uv_write_free_bufs(req);
+      req->__bufs = NULL;
+      req->__nbufs_done = 0;
+      req->__nbufs_total = 0;
+      __uv_write_complete(req, -error);
+      return 0;
+    }
+  }
+
+  // Enqueue the remaining buffers.
   memcpy(req->__bufs, bufs, sizeof(uv_buf_t) * nbufs);
+  req->__bufs[0].base += skip;
+  req->__bufs[0].len -= skip;
   req->__nbufs_done = 0;
   req->__nbufs_total = nbufs;
-  req->__cb = cb;
-  __uv_req_init((uv_req_t *)req, UV_WRITE);
-
-  // Enqueue the write request.
+  // This cannot fail, as a subscription has been reserved above.
   __uv_stream_start_writing(handle);
   __uv_writes_insert_last(&handle->__write_queue, req);
   for (unsigned int i = 0; i < req->__nbufs_total; ++i)
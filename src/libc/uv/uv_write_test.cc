@@ -4,6 +4,7 @@
 
 #include <unistd.h>
 #include <uv.h>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -96,9 +97,8 @@ TEST(uv_write, example) {
   ASSERT_EQ(0,
             uv_write(&req2, (uv_stream_t *)&out, bufs2, 2, write_cb2_success));
 
-  // Run the loop to force writes to complete.
-  // TODO(ed): The official libuv already performes writes eagerly.
-  // Should we do the same?
+  // Data is written eagerly, but callbacks are only invoked by the
+  // loop.
   ASSERT_EQ(0, state);
   ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
   ASSERT_EQ(2, state);
@@ -119,3 +119,76 @@ TEST(uv_write, example) {
   ASSERT_EQ(3, state);
   ASSERT_EQ(0, uv_loop_close(&loop));
 }
+
+namespace {
+
+struct PartialState {
+  std::vector<char> received;
+  int writes;
+};
+
+void alloc_cb_partial(uv_handle_t *handle, size_t suggested_size,
+                      uv_buf_t *buf) {
+  static char storage[65536];
+  *buf = uv_buf_init(storage, sizeof(storage));
+}
+
+void read_cb_partial(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf) {
+  auto state = static_cast<PartialState *>(stream->data);
+  ASSERT_LE(0, nread);
+  state->received.insert(state->received.end(), buf->base, buf->base + nread);
+  if (state->received.size() == 1 << 20)
+    ASSERT_EQ(0, uv_read_stop(stream));
+}
+
+void write_cb_partial(uv_write_t *req, int status) {
+  ASSERT_EQ(0, status);
+  ++static_cast<PartialState *>(req->data)->writes;
+}
+
+}  // namespace
+
+TEST(uv_write, partial) {
+  uv_loop_t loop;
+  ASSERT_EQ(0, uv_loop_init(&loop));
+
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  uv_pipe_t in, out;
+  ASSERT_EQ(0, uv_pipe_init(&loop, &in, 0));
+  ASSERT_EQ(0, uv_pipe_open(&in, fds[0]));
+  ASSERT_EQ(0, uv_pipe_init(&loop, &out, 0));
+  ASSERT_EQ(0, uv_pipe_open(&out, fds[1]));
+
+  // Write more data than fits in the pipe, spread out over more
+  // buffers than can be stored in the request inline. The array of
+  // buffers does not need to remain valid.
+  std::vector<char> data(1 << 20);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = i * 13;
+  PartialState state = {};
+  uv_write_t req;
+  req.data = &state;
+  {
+    uv_buf_t bufs[8];
+    for (size_t i = 0; i < 8; ++i)
+      bufs[i] = uv_buf_init(&data[i << 17], 1 << 17);
+    ASSERT_EQ(0, uv_write(&req, (uv_stream_t *)&out, bufs, 8,
+                          write_cb_partial));
+  }
+  ASSERT_LT(0, out.write_queue_size);
+
+  // Writes should complete as the data is read from the other end.
+  in.data = &state;
+  ASSERT_EQ(0, uv_read_start((uv_stream_t *)&in, alloc_cb_partial,
+                             read_cb_partial));
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(1, state.writes);
+  ASSERT_EQ(0, out.write_queue_size);
+  ASSERT_EQ(data, state.received);
+
+  uv_close((uv_handle_t *)&in, [](uv_handle_t *) {});
+  uv_close((uv_handle_t *)&out, [](uv_handle_t *) {});
+  ASSERT_EQ(0, uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(0, uv_loop_close(&loop));
+}